@@ -0,0 +1,203 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef HAL_UV_HAL_INC_UI_UV_UICHART_H_
+#define HAL_UV_HAL_INC_UI_UV_UICHART_H_
+
+
+#include <uv_hal_config.h>
+#include "uv_utilities.h"
+#include "uv_uigraph.h"
+
+/// @file: defines a uichart module. Uichart plots live signals, such as sensor
+/// readings or CAN values, as one or more traces scrolling from right to left.
+/// The axes, grid, current value lines and title are drawn by uigraph.
+///
+/// A trace can hold tens of thousands of samples. Every horizontal pixel of
+/// the chart shows a column: the smallest and the biggest of the samples that
+/// fall on it. The columns are made as the samples are pushed, so drawing a
+/// trace is one line strip through two points per pixel however many samples
+/// it holds.
+
+#if CONFIG_UI
+
+
+/// @brief: One pixel column of a trace: the range of the samples on it
+typedef struct {
+	int16_t min;
+	int16_t max;
+} uv_uichart_column_st;
+
+
+/// @brief: One signal plotted on the chart
+typedef struct {
+	/// @brief: Ring buffer of the latest samples, used to make the columns
+	/// again when the samples per pixel change. Can be NULL.
+	int16_t *samples;
+	uint16_t samples_len;
+	uint16_t sample_head;
+	uint16_t sample_count;
+	/// @brief: Ring buffer of the columns, newest at *column_head* - 1. This
+	/// is the history that can be scrolled back to.
+	uv_uichart_column_st *columns;
+	uint16_t columns_len;
+	uint16_t column_head;
+	uint16_t column_count;
+	/// @brief: The column being filled with samples
+	uv_uichart_column_st acc;
+	uint16_t acc_count;
+	/// @brief: Columns made while the chart was paused. The view stays put
+	/// by looking this much further back.
+	uint16_t held;
+	color_t color;
+} uv_uichart_trace_st;
+
+
+/// @brief: Initializes a trace
+///
+/// @param samples: Buffer of *samples_len* samples, or NULL. Without it the
+/// history is cleared when the samples per pixel change.
+/// @param columns: Buffer of *columns_len* columns. The chart can show and
+/// scroll back this many pixels of the trace.
+/// @param color: The color the trace is drawn with
+void uv_uichart_trace_init(uv_uichart_trace_st *this,
+		int16_t *samples, uint16_t samples_len,
+		uv_uichart_column_st *columns, uint16_t columns_len, color_t color);
+
+
+
+typedef struct {
+	EXTENDS(uv_uigraph_st);
+
+	uv_uichart_trace_st *traces;
+	uint8_t trace_count;
+	/// @brief: Buffer the traces' line strips are put together in, one trace
+	/// at a time
+	uv_ui_linestrip_point_st *strip;
+	uint16_t strip_len;
+	uint16_t samples_per_px;
+	/// @brief: How many columns back from the newest the view is scrolled
+	uint16_t scroll;
+	bool paused;
+	bool autoscale;
+	/// @brief: True while a touch which started inside this chart is down
+	bool dragging;
+} uv_uichart_st;
+
+
+
+
+#ifdef this
+#undef this
+#endif
+#define this ((uv_uichart_st*)me)
+
+
+
+/// @brief: Initializes the chart
+///
+/// @param traces: Array of *trace_count* traces, initialized with
+/// uv_uichart_trace_init()
+/// @param strip_buffer: Buffer for drawing a trace. Two points are needed
+/// per horizontal pixel, so *strip_len* should be twice the chart's width.
+/// With less, only the newest columns that fit are drawn.
+/// @param samples_per_px: How many samples make one pixel column
+/// @param min_x: The value shown at the left edge of the X axis, e.g. how
+/// many seconds of samples the chart is wide as a negative number
+/// @param max_x: The value shown at the right edge of the X axis
+/// @param min_y: The minimum value for the Y axis, i.e. the bottom edge
+/// @param max_y: The maximum value for the Y axis, i.e. the top edge
+/// @param style: Pointer to the ui style used
+void uv_uichart_init(void *me, uv_uichart_trace_st *traces, uint8_t trace_count,
+		uv_ui_linestrip_point_st *strip_buffer, uint16_t strip_len,
+		uint16_t samples_per_px, int32_t min_x, int32_t max_x,
+		int32_t min_y, int32_t max_y, const uv_uistyle_st *style);
+
+
+/// @brief: Adds a sample to the trace *trace*. Takes constant time, and
+/// refreshes the chart when a new column is complete and the chart is not
+/// paused. Should be called from the same task that steps the UI.
+void uv_uichart_push(void *me, uint8_t trace, int16_t value);
+
+
+/// @brief: Clears the samples of every trace
+void uv_uichart_clear(void *me);
+
+
+/// @brief: Sets how many samples make one pixel column. The columns are made
+/// again from the traces' sample buffers, which takes time relative to
+/// their length.
+void uv_uichart_set_samples_per_px(void *me, uint16_t value);
+
+
+static inline uint16_t uv_uichart_get_samples_per_px(void *me) {
+	return this->samples_per_px;
+}
+
+
+/// @brief: Pauses or resumes the chart. While paused the samples are still
+/// taken, but the view stays where it is. Resuming returns to the newest
+/// samples. Dragging the chart sideways pauses it and scrolls back in
+/// history, clicking it resumes.
+void uv_uichart_set_paused(void *me, bool value);
+
+
+static inline bool uv_uichart_get_paused(void *me) {
+	return this->paused;
+}
+
+
+/// @brief: When enabled, the Y axis is fitted to the samples in view every
+/// time the chart is drawn. Defaults to false.
+static inline void uv_uichart_set_autoscale(void *me, bool value) {
+	this->autoscale = value;
+	uv_ui_refresh(this);
+}
+
+
+static inline bool uv_uichart_get_autoscale(void *me) {
+	return this->autoscale;
+}
+
+
+/// @brief: Draw function. Normally this is called internally but it can also be
+/// called when using draw callbacks
+void uv_uichart_draw(void *me, const uv_bounding_box_st *pbb);
+
+
+void uv_uichart_touch(void *me, uv_touch_st *touch);
+
+
+
+
+#undef this
+
+
+
+
+#endif
+#endif /* HAL_UV_HAL_INC_UI_UV_UICHART_H_ */
@@ -67,6 +67,19 @@ used on a touchscreen display."
 /// 20 ms cycle) that nobody notices the key going.
 #define UIDISPLAY_UNCLAIMED_KEY_CYCLES	3
 
+/// @brief: What the last frame drawn took, see uv_uidisplay_get_stats()
+typedef struct {
+	/// @brief: Objects drawn. An object in two of the areas redrawn counts
+	/// twice.
+	uint16_t drawn;
+	/// @brief: Objects left as they were, outside every area redrawn. The
+	/// children of a window skipped are not counted.
+	uint16_t skipped;
+	/// @brief: The areas redrawn, or 0 when the whole screen was
+	uint8_t areas;
+} uv_uidisplay_stats_st;
+
+
 /// @brief: Main display class. This represents a whole display.
 typedef struct {
 	EXTENDS(uv_uiwindow_st);
@@ -80,6 +93,11 @@ typedef struct {
 	int16_t drag_y;
 	/// @brief: Stores the current state of the press event
 	int16_t press_state;
+	/// @brief: Whether the screen is touched and where, as the input events
+	/// taken out of the queue leave it
+	bool down;
+	int16_t down_x;
+	int16_t down_y;
 
 	// small delay so that two presses cannot happen directly after one another
 	uv_delay_st press_delay;
@@ -89,7 +107,15 @@ typedef struct {
 	bool touch_ind;
 	uv_delay_st touch_ind_delay;
 	uv_touch_st touch;
+	// where the touch indicator was last drawn
+	int16_t ind_x;
+	int16_t ind_y;
+#endif
+#if CONFIG_UI_DIRTY_RECTS
+	/// @brief: The areas refreshed since the last frame
+	uv_uidirty_st dirty;
 #endif
+	uv_uidisplay_stats_st stats;
 #if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
 	/// @brief: The key left unclaimed at the head of the key queue, and for how
 	/// many cycles it has been sitting there. Keys are peeked rather than
@@ -147,6 +173,13 @@ void uv_uidisplay_clear(void *me);
 uv_uiobject_ret_e uv_uidisplay_step(void *me, uint32_t step_ms);
 
 
+/// @brief: Returns what the last frame drawn took: how many objects were
+/// drawn and how many a partial redraw left alone
+static inline const uv_uidisplay_stats_st *uv_uidisplay_get_stats(const void *me) {
+	return &this->stats;
+}
+
+
 /// @brief: Refreshes the screen and redraw all children instantly.
 /// This is automatically called after every step cycle, but can also
 /// be called anytime inside the gui step task.
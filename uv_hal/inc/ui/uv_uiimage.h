@@ -37,6 +37,13 @@
 #if CONFIG_UI
 
 
+/// @brief: The color the image is filled with while its media is still being
+/// loaded
+#if !defined(CONFIG_UI_IMAGE_PLACEHOLDER_COLOR)
+#define CONFIG_UI_IMAGE_PLACEHOLDER_COLOR		C(0x40808080)
+#endif
+
+
 
 
 
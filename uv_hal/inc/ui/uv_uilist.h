@@ -40,6 +40,10 @@
 #error "CONFIG_UI_LIST_ENTRY_HEIGHT should define the height of a single entry in list in pixels"
 #endif
 
+/// @brief: The most rows a list with a source can show. The rows are indexed
+/// like the selection, which is an int16_t so that it can be -1 for none.
+#define UILIST_SOURCE_ROWS_MAX			INT16_MAX
+
 
 
 typedef struct   {
@@ -70,6 +74,15 @@ typedef struct   {
 	// callback for drawing the entries
 	void (*draw_entry)(void *me, void *entry, bool selected, uv_bounding_box_st *bb);
 	alignment_e align;
+	/// @brief: The rows of a list given a source with uv_uilist_set_source(),
+	/// NULL when the list holds its entries itself
+	uint16_t (*source_count)(void *source_ptr);
+	void *(*source_row)(void *source_ptr, uint16_t index);
+	void *source_ptr;
+	/// @brief: How far a list with a source is scrolled, in pixels
+	int32_t scroll;
+	/// @brief: True while a list with a source is being dragged
+	bool dragging;
 } uv_uilist_st;
 
 
@@ -187,13 +200,37 @@ static inline int16_t uv_uilist_get_selected(void *me) {
 
 
 
-/// @brief: Returns the current list entry count
+/// @brief: Returns the current list entry count. For a list with a source,
+/// at most UILIST_SOURCE_ROWS_MAX.
 static inline int16_t uv_uilist_get_count(void *me) {
-	return uv_vector_size(&this->entries);
+	return (this->source_count != NULL) ?
+			(int16_t) MIN(this->source_count(this->source_ptr), UILIST_SOURCE_ROWS_MAX) :
+			uv_vector_size(&this->entries);
 }
 
 
 
+/// @brief: Makes the list show the rows of a data source instead of entries
+/// of its own, for lists too long to hold: a fault log, the files on an
+/// external memory. *count* returns the number of rows and *row* the entry of
+/// row *index*, of the type the list draws (uv_uilist_entry_st for uilist).
+/// The entry only has to stay valid until the next call.
+///
+/// Only the rows in view are asked for, drawn and hit-tested, so how long a
+/// list is does not show in how fast it is. A list with a source does not
+/// grow to fit its rows: it keeps its size and scrolls them itself when
+/// dragged, so it should not be put in a scrolling window. Call
+/// uv_ui_refresh() on it when the rows change. Pass NULL as *count* to go back
+/// to the list's own entries.
+///
+/// A source has at most UILIST_SOURCE_ROWS_MAX rows, and the rows after that
+/// are never shown. Returns false and leaves the list as it was when *count*
+/// already returns more.
+bool uv_uilist_set_source(void *me, uint16_t (*count)(void *source_ptr),
+		void *(*row)(void *source_ptr, uint16_t index), void *source_ptr);
+
+
+
 /// @brief: Selects an entry from the list
 void uv_uilist_select(void *me, int16_t index);
 static inline void uv_uilist_set_selected(void *me, int16_t index) {
@@ -218,7 +255,9 @@ void uv_uilist_clear(void *me);
 
 /// @brief: Indexes the list and returns the string at *index*
 static inline uv_uilist_entry_st *uv_uilist_at(void *me, uint16_t index) {
-	return (uv_uilist_entry_st*) uv_vector_at(&this->entries, index);
+	return (this->source_row != NULL) ?
+			(uv_uilist_entry_st*) this->source_row(this->source_ptr, index) :
+			(uv_uilist_entry_st*) uv_vector_at(&this->entries, index);
 }
 
 
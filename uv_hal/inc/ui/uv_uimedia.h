@@ -53,6 +53,13 @@ typedef struct {
 	uv_uimedia_types_e type;
 	/// @brief: when false, this bitmap is hidden and is not drawn
 	bool visible;
+	/// @brief: true while the bitmap waits to be loaded asynchronously. It
+	/// has no size yet, and is not drawn.
+	bool loading;
+	/// @brief: true when the bitmap was evicted from the display's memory to
+	/// make room for another. It is not drawn, but asks to be loaded again
+	/// when drawing it is tried.
+	bool evicted;
 	// union of file type dependent properties
 	union {
 		struct {
@@ -113,6 +120,12 @@ static inline bool uv_uimedia_get_visible(uv_uimedia_st *this) {
 	return this->visible;
 }
 
+/// @brief: Returns true once the bitmap is in the display's memory and can
+/// be drawn, false while it waits to be loaded or was evicted
+static inline bool uv_uimedia_is_resident(const uv_uimedia_st *this) {
+	return !this->loading && !this->evicted;
+}
+
 /// @brief: Returns the end address of the image. A new media file can be
 /// loaded right to this address
 static inline uint32_t uv_uimedia_get_end_addr(uv_uimedia_st *this) {
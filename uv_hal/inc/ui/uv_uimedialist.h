@@ -197,6 +197,15 @@ static inline void uv_uimedialist_clear(void *me) {
 }
 
 
+/// @brief: Makes the media list show the rows of a data source, see
+/// uv_uilist_set_source(). *row* returns uv_uimedialist_entry_st's.
+static inline bool uv_uimedialist_set_source(void *me,
+		uint16_t (*count)(void *source_ptr),
+		void *(*row)(void *source_ptr, uint16_t index), void *source_ptr) {
+	return uv_uilist_set_source(me, count, row, source_ptr);
+}
+
+
 
 /// @brief: Indexes the list and returns the string at *index*
 static inline uv_uimedialist_entry_st *uv_uimedialist_at(void *me, uint16_t index) {
@@ -33,6 +33,7 @@
 #include <uv_hal_config.h>
 #include "ui/uv_ui_styles.h"
 #include "uv_utilities.h"
+#include "uv_ui_dirty.h"
 #if CONFIG_LCD
 #include "uv_lcd.h"
 #elif CONFIG_FT81X
@@ -56,6 +57,29 @@
 #define CONFIG_UI_FOCUS_LINE_W			3
 #endif
 
+/// @brief: Pixels added around the area of a refreshed object, for what
+/// objects draw just past their bounding box: the offset points of a shadow,
+/// a focus outline.
+#if !defined(CONFIG_UI_DIRTY_MARGIN)
+#define CONFIG_UI_DIRTY_MARGIN			4
+#endif
+
+/// @brief: Idle objects. An object whose step callback has nothing to do until
+/// something happens to it returns UIOBJECT_RETURN_IDLE, and is not stepped
+/// again until woken: by a touch, a refresh, being shown or enabled, or a
+/// timer set with uv_ui_wake_after(). A window whose children are all idle,
+/// and which has no application step callback, is idle itself, so a screen
+/// left alone costs next to nothing to step. 0 steps every object every cycle.
+#if !defined(CONFIG_UI_IDLE_STEP)
+#define CONFIG_UI_IDLE_STEP				1
+#endif
+
+/// @brief: How many objects can wait for a uv_ui_wake_after() timer at once.
+/// When all are taken the object is woken right away instead.
+#if !defined(CONFIG_UI_WAKE_TIMERS)
+#define CONFIG_UI_WAKE_TIMERS			8
+#endif
+
 #if !defined(CONFIG_UI_DISABLED_OBJECT_BRIGHTNESS)
 #warning "CONFIG_UI_DISABLED_OBJECT_BRIGHTNESS not defined. Defaults to 1. Should be between INT8_MIN + 1 ... INT8_MAX"
 #endif
@@ -132,7 +156,11 @@ enum {
 	/// window structures which are using unions to save memory. When this is returned,
 	/// the whole display is redrawn only next step cycle, making sure that all
 	/// objects get redrawn.
-	UIOBJECT_RETURN_KILLED = (1 << 1)
+	UIOBJECT_RETURN_KILLED = (1 << 1),
+	/// @brief: Returned by an object's step function when it has nothing to
+	/// do until something happens to it, see CONFIG_UI_IDLE_STEP. Not to be
+	/// returned by application step callbacks.
+	UIOBJECT_RETURN_IDLE = (1 << 2)
 };
 typedef uint8_t uv_uiobject_ret_e;
 
@@ -182,16 +210,42 @@ typedef struct   uv_uiobject_st {
 	/// @brief: True while this object holds the focus. At most one object in a
 	/// display has it.
 	bool focused;
+#endif
 	/// @brief: True when this object is a uv_uiwindow_st (or anything deriving
-	/// from one), so the focus traversal knows it can descend into it. Set by
-	/// uv_uiwindow_init. The step callback cannot be used to tell: a tab window
-	/// installs its own.
+	/// from one), so the focus traversal knows it can descend into it and a
+	/// refresh knows to invalidate its cache. Set by uv_uiwindow_init. The step
+	/// callback cannot be used to tell: a tab window installs its own.
 	bool is_window;
+#if CONFIG_UI_IDLE_STEP
+	/// @brief: True when the step function returned UIOBJECT_RETURN_IDLE and
+	/// the object has not been woken since. Cleared by uv_ui_wake().
+	bool idle;
 #endif
 } uv_uiobject_st;
 
 
 
+#if CONFIG_UI_DIRTY_RECTS
+/// @brief: Makes uv_ui_refresh record the areas of refreshed objects to
+/// *dirty* when the object is in the tree under *root*. Called by the display
+/// that is being stepped.
+void _uv_ui_set_dirty(void *root, uv_uidirty_st *dirty);
+
+/// @brief: Returns the root and the set last given to _uv_ui_set_dirty, so that
+/// a nested display can give them back. Both are NULL before the first.
+void _uv_ui_get_dirty(void **root, uv_uidirty_st **dirty);
+
+/// @brief: Limits the drawing to *area*, for a partial redraw:
+/// _uv_uiobject_draw skips the objects that do not reach into it, and every
+/// mask is cut down to it. NULL draws everything again.
+void _uv_uiobject_set_draw_area(const uv_uidirty_rect_st *area);
+#endif
+
+/// @brief: Returns how many objects _uv_uiobject_draw has drawn and skipped
+/// since the last call
+void _uv_uiobject_get_draw_counts(uint16_t *drawn, uint16_t *skipped);
+
+
 /// @brief: Initializes the bounding box
 void uv_bounding_box_init(uv_bounding_box_st *bb,
 		int16_t x, int16_t y, uint16_t width, uint16_t height);
@@ -211,6 +265,38 @@ void uv_bb_set_marging(uv_bb_st *bb, uint16_t hmargin, uint16_t vmargin);
 void uv_ui_refresh(void *me);
 
 
+/// @brief: Refreshes a part of the screen the object is on, given in global
+/// coordinates, rather than the whole object. For things drawn over the
+/// objects, such as the touch indicator.
+void uv_ui_refresh_area(void *me, int16_t x, int16_t y,
+		uint16_t width, uint16_t height);
+
+
+/// @brief: Wakes an idle object and the windows it is in, so that they are
+/// stepped again. A refresh, a touch, and showing or enabling the object
+/// wake it without this.
+void uv_ui_wake(void *me);
+
+
+/// @brief: Wakes the object after *ms* milliseconds, for an object that
+/// sleeps until a time, such as a blinking indicator. Replaces the object's
+/// earlier timer, if it had one.
+///
+/// @note: The timers keep a pointer to the object: cancel the timer with
+/// uv_ui_wake_cancel() before the memory of the object is used for
+/// something else. Initializing an object cancels its timer.
+void uv_ui_wake_after(void *me, uint16_t ms);
+
+
+/// @brief: Cancels the wake-up timer of the object, if it had one
+void uv_ui_wake_cancel(void *me);
+
+
+/// @brief: Counts the wake-up timers down and wakes the objects whose time
+/// is up. Called by the display being stepped.
+void _uv_ui_wake_timers_step(uint16_t step_ms);
+
+
 /// @brief: Refreshes the object's parent. With this it is guaranteed that
 /// everything gets refreshed the right way, but this has more overheat than uv_ui_refresh.
 void uv_ui_refresh_parent(void *me);
@@ -266,6 +352,7 @@ void uv_ui_hide(void *me);
 static inline void uv_ui_show(void *me) {
 	this->visible = true;
 	uv_ui_refresh_parent(this);
+	uv_ui_wake(this);
 }
 
 /// @brief: Enabled the object. This functionality might not be implemented
@@ -359,6 +446,8 @@ static inline uv_bounding_box_st *uv_uibb(const void *me) {
 /// if the new bounding box differs from the current one.
 static inline void uv_uibb_set(void *me, uv_bounding_box_st bb) {
 	if (memcmp(&this->bb, &bb, sizeof(this->bb)) != 0) {
+		// both where the object was and where it goes
+		uv_ui_refresh(me);
 		this->bb = bb;
 		uv_ui_refresh(me);
 	}
@@ -377,6 +466,12 @@ int16_t uv_ui_get_xglobal(const void *me);
 int16_t uv_ui_get_yglobal(const void *me);
 
 
+/// @brief: Returns the part of the object that can be seen, in global
+/// coordinates: its bounding box cut down to each of its parents and to the
+/// screen. The width and height are 0 when nothing of it is visible.
+uv_bb_st uv_ui_get_visible_bb(const void *me);
+
+
 
 #undef this
 
@@ -34,6 +34,15 @@
 /// @file: Defines different uitransitions which can be used to animate
 /// UI objects. Note that by default UI objects are static and animating
 /// some parameters from the might cause unexpected results.
+///
+/// A transition attached to an object with uv_uitransition_attach() is stepped
+/// by the display once a frame, by the time that has actually passed since the
+/// previous frame, so an animation takes as long as it says however regularly
+/// the UI happens to be stepped. Transitions not attached are stepped by the
+/// application with uv_uitransition_step().
+///
+/// The easing curves are tables of 16 segments in fixed point, interpolated
+/// with integer math.
 
 
 #include "uv_ui.h"
@@ -51,6 +60,14 @@ typedef enum {
 	UITRANSITION_FINISH
 } uv_uitransition_state_e;
 
+/// @brief: The fixed point one of the transition progress
+#define UITRANSITION_ONE				32768
+
+/// @brief: The longest time a transition is advanced by at once. A UI that
+/// was not stepped for longer than this continues its animations from where
+/// they were rather than jumping to their end.
+#define UITRANSITION_MAX_STEP_MS		1000
+
 /// @brief: uitransition easing values
 typedef enum {
 	UITRANSITION_EASING_LINEAR = 0,
@@ -66,6 +83,11 @@ typedef struct {
 
 	void *parallel;
 	void *series;
+	/// @brief: The object this is attached to, or NULL
+	void *parent;
+	/// @brief: The next attached transition stepped by the display
+	void *next_active;
+	bool active;
 	int16_t duration_ms;
 	int16_t current_time_ms;
 	uv_uitransition_state_e state;
@@ -159,6 +181,18 @@ static inline int16_t uv_uitransition_get_duration_ms(void *me) {
 }
 
 
+/// @brief: Attaches the transition to *obj*. The display steps an attached
+/// transition once a frame while it plays, and refreshes *obj* for it, so the
+/// application must not step it itself. NULL detaches it, which has to be
+/// done before a transition still playing is initialized again.
+void uv_uitransition_attach(void *me, void *obj);
+
+
+/// @brief: Returns the number of attached transitions the display is
+/// currently stepping
+uint16_t uv_uitransition_get_active_count(void);
+
+
 
 /// @bief: Transition animating a signed 16 bit integer value.
 /// Since 16-bit integers are used in most places in UI library.
@@ -202,14 +236,19 @@ void _uv_uitransition_init(void *me, uv_uitransition_easing_e easing,
 		uint16_t duration_ms, void (*calc_callb)(void *me));
 
 
-/// @bief: Step function is called automatically from the uiobject where
-/// the transition is attached. This function shouldn't be called by the user application.
+/// @bief: Steps a transition which is not attached to an object. Attached
+/// transitions are stepped by the display.
 ///
 /// @param parent: The parent object to which this uitransition is attached. Will be
 /// refreshed automatically when transition plays. Can also be set to NULL.
 void uv_uitransition_step(void *me, void *parent, uint16_t step_ms);
 
 
+/// @brief: Steps the attached transitions by the time since the previous
+/// call. Called by the display once a frame.
+void _uv_uitransitions_step(void);
+
+
 #undef this
 
 
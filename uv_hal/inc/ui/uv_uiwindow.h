@@ -48,6 +48,19 @@
 #endif
 
 
+#if CONFIG_UI_WINDOW_CACHE
+/// @brief: The cached drawing of a window, see uv_uiwindow_set_cache
+typedef struct {
+	uv_ui_record_st record;
+	/// @brief: Global position of the window when it was recorded
+	int16_t x;
+	int16_t y;
+	/// @brief: The parent's bounding box it was recorded in
+	uv_bounding_box_st pbb;
+} uv_uiwindow_cache_st;
+#endif
+
+
 /// @brief: A window GUI element. Window is an holder of other objects.
 /// Inherits from the uv_uiobject_st.
 ///
@@ -78,6 +91,12 @@ struct   _uv_uiwindow_st {
 	uv_uiobject_st **objects;
 	/// @brief: Object array length
 	uint16_t objects_count;
+	/// @brief: True when the children are stacked top to bottom in the order
+	/// they were added, each starting where the one before it ends. Only the
+	/// children in view are then drawn and touched, found by halving instead of
+	/// going through them all. Set by windows that lay out long columns of
+	/// children, such as uv_uitreeview.
+	bool stacked;
 	/// @brief: Indicates dragging has been started for this window
 	bool dragging;
 	/// @brief: Set to false if window should have a background. That is,
@@ -94,6 +113,10 @@ struct   _uv_uiwindow_st {
 	/// @param ptr: A user defined pointer which can be used to hold a pointer to the actual
 	/// UI module structure
 	uv_uiobject_ret_e (*app_step_callb)(void *user_ptr, const uint16_t step_ms);
+#if CONFIG_UI_WINDOW_CACHE
+	/// @brief: The cached drawing of the window and its children, or NULL
+	uv_uiwindow_cache_st *cache;
+#endif
 };
 
 
@@ -245,6 +268,29 @@ void uv_uiwindow_draw(void *me, const uv_bounding_box_st *pbb);
 void uv_uiwindow_draw_scrollbars(void *me, const uv_bounding_box_st *pbb);
 
 
+#if CONFIG_UI_WINDOW_CACHE
+/// @brief: Caches the drawing of the window and its children. The first time
+/// the window is drawn its drawing calls are recorded into *buffer*, and after
+/// that replayed instead of drawing the children again, until uv_ui_refresh is
+/// called on the window or on anything in it. Meant for windows with many
+/// children that seldom change: a screen of labels, frames and images.
+///
+/// @note: A child that changes what it draws without calling uv_ui_refresh
+/// keeps showing what was recorded. A buffer too small for the window leaves it
+/// drawn as usual.
+///
+/// @param cache: The cache, which has to live as long as the window. NULL
+/// turns caching off.
+/// @param buffer: Memory for the recording, aligned at least as uint16_t
+void uv_uiwindow_set_cache(void *me, uv_uiwindow_cache_st *cache,
+		void *buffer, uint16_t buffer_len);
+
+/// @brief: Draws the window from its cache, or records the cache while
+/// drawing it. Called by _uv_uiobject_draw for windows that have one.
+void _uv_uiwindow_draw_cached(void *me, const uv_bounding_box_st *pbb);
+#endif
+
+
 /// @brief: Draws the children objects. Will be called inside _uv_uiwindow_draw function,
 /// but if custom draw function is added to this uiwindow, this should
 /// be called at the end of that custom function to update the children.
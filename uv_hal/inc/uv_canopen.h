@@ -211,6 +211,11 @@ initialization structure."
 #if !defined(CONFIG_CANOPEN_BAUDRATE_INDEX)
 #define CONFIG_CANOPEN_BAUDRATE_INDEX		0x5FF7
 #endif
+/// @brief: The first of the CPUTIME_COUNT read only objects of the uv_cputime
+/// slots, one for each slot in the order of uv_cputime_slot_e
+#if !defined(CONFIG_CANOPEN_CPUTIME_INDEX)
+#define CONFIG_CANOPEN_CPUTIME_INDEX		0x5F00
+#endif
 #if !defined(CONFIG_CANOPEN_SDO_SEGMENTED)
 #error "CONFIG_CANOPEN_SDO_SEGMENTED should be defined as 1 if SDO segmented transfers \
 should be enabled. Defaults to 0. Segmented parth takes roughly 1k4 bytes of flash space."
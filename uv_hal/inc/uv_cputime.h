@@ -0,0 +1,178 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_INC_UV_CPUTIME_H_
+#define UV_HAL_INC_UV_CPUTIME_H_
+
+#include <uv_hal_config.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// @file: CPU time spent in each step of the HAL task, waiting for the HAL
+/// mutex, in the idle task and in the application's own steps.
+///
+/// Every measured piece of code has a slot that keeps the count, minimum,
+/// average and maximum of its times and a histogram of them. The times come
+/// from the DWT cycle counter on the Cortex-M targets and from the monotonic
+/// clock on Linux and Windows, and are kept in nanoseconds on all of them.
+///
+/// Each slot is written by one task only, or under the HAL mutex, so adding a
+/// time takes no lock. The slots are read by the "cputime" terminal command
+/// and as CANopen objects from CONFIG_CANOPEN_CPUTIME_INDEX onwards, one per
+/// slot, whose sub-indexes are the uint32_t members of uv_cputime_st in order.
+
+
+/// @brief: Set to 1 to measure the HAL steps. 0 compiles the measurements,
+/// the terminal command and the CANopen objects out.
+#if !defined(CONFIG_CPUTIME)
+#define CONFIG_CPUTIME					0
+#endif
+
+/// @brief: Slots for the application's own steps, from CPUTIME_APP onwards.
+/// The application times them with uv_cputime_begin() and uv_cputime_end().
+#if !defined(CONFIG_CPUTIME_APP_SLOTS)
+#define CONFIG_CPUTIME_APP_SLOTS		4
+#endif
+
+
+/// @brief: Buckets of the histogram. The first is the times under 1 us,
+/// every one after that the times up to twice as long as the one before,
+/// and the last everything from 16.384 ms up.
+#define CPUTIME_HIST_BUCKETS			16
+
+/// @brief: The number of slots measured by the HAL itself, CPUTIME_HAL_STEP
+/// to CPUTIME_IDLE_TASK. The application slots start after them, at
+/// CPUTIME_APP.
+#define CPUTIME_HAL_SLOTS				7
+
+
+/// @brief: The measured pieces of code
+typedef enum {
+	/// @brief: All of the HAL task's step while it holds the HAL mutex
+	CPUTIME_HAL_STEP = 0,
+	CPUTIME_HAL_CAN,
+	CPUTIME_HAL_UART,
+	CPUTIME_HAL_STDOUT,
+	CPUTIME_HAL_CANOPEN,
+	/// @brief: The time any task waited in _uv_rtos_halmutex_lock()
+	CPUTIME_HALMUTEX_WAIT,
+	/// @brief: The task given to uv_rtos_add_idle_task()
+	CPUTIME_IDLE_TASK,
+	/// @brief: The first of the CONFIG_CPUTIME_APP_SLOTS application slots
+	CPUTIME_APP = CPUTIME_HAL_SLOTS,
+	CPUTIME_COUNT = CPUTIME_APP + CONFIG_CPUTIME_APP_SLOTS
+} uv_cputime_slot_e;
+
+
+/// @brief: The times of one slot. The members up to and including the
+/// histogram are uint32_t one after another, which is what the CANopen
+/// object of the slot reads.
+typedef struct {
+	/// @brief: Times added since reset
+	uint32_t count;
+	/// @brief: UINT32_MAX when nothing was added
+	uint32_t min_ns;
+	uint32_t avg_ns;
+	uint32_t max_ns;
+	uint32_t hist[CPUTIME_HIST_BUCKETS];
+
+	/// @brief: The average is taken over these. Both are halved when the sum
+	/// would overflow, so a long run weighs the latest times a little more.
+	uint32_t sum_ns;
+	uint32_t sum_count;
+} uv_cputime_st;
+
+/// @brief: The uint32_t members of uv_cputime_st read as a CANopen array
+#define CPUTIME_OBJ_LEN					(4 + CPUTIME_HIST_BUCKETS)
+
+
+/// @brief: The slots. Exposed for the CANopen object dictionary, use
+/// uv_cputime_get() otherwise.
+extern uv_cputime_st _uv_cputime[CPUTIME_COUNT];
+
+
+void uv_cputime_reset(uv_cputime_st *this);
+
+/// @brief: Adds a time of *ns* nanoseconds to *this*
+void uv_cputime_add(uv_cputime_st *this, uint32_t ns);
+
+/// @brief: Returns the histogram bucket of a time of *ns* nanoseconds
+uint8_t uv_cputime_bucket(uint32_t ns);
+
+/// @brief: Returns the upper edge of *bucket* in microseconds, UINT32_MAX for
+/// the last one
+uint32_t uv_cputime_bucket_us(uint8_t bucket);
+
+
+
+/// @brief: Starts the clock. Called once by the HAL before the scheduler is
+/// started.
+void uv_cputime_init(void);
+
+/// @brief: Returns the clock's counter. It wraps around, only the difference
+/// of two readings means something.
+uint32_t uv_cputime_now(void);
+
+/// @brief: Returns the nanoseconds from the reading *start* of
+/// uv_cputime_now() to now
+uint32_t uv_cputime_ns_since(uint32_t start);
+
+/// @brief: Returns slot *slot*
+uv_cputime_st *uv_cputime_get(uv_cputime_slot_e slot);
+
+/// @brief: Returns the name of *slot* as the terminal command shows it
+const char *uv_cputime_name(uv_cputime_slot_e slot);
+
+/// @brief: Resets all slots
+void uv_cputime_reset_all(void);
+
+
+/// @brief: Starts timing a step. Returns the start to give to uv_cputime_end().
+static inline uint32_t uv_cputime_begin(void) {
+	return uv_cputime_now();
+}
+
+/// @brief: Adds the time from *start* to now to *slot*
+static inline void uv_cputime_end(uv_cputime_slot_e slot, uint32_t start) {
+	uv_cputime_add(&_uv_cputime[slot], uv_cputime_ns_since(start));
+}
+
+
+/// @brief: Runs *step* and adds its time to *slot* when CONFIG_CPUTIME is set
+#if CONFIG_CPUTIME
+#define UV_CPUTIME_STEP(slot, step)		do { \
+	uint32_t _cputime_start = uv_cputime_begin(); \
+	step; \
+	uv_cputime_end(slot, _cputime_start); \
+} while (0)
+#else
+#define UV_CPUTIME_STEP(slot, step)		do { step; } while (0)
+#endif
+
+
+#endif /* UV_HAL_INC_UV_CPUTIME_H_ */
@@ -0,0 +1,78 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_INC_UV_FRAMEBUFFER_H_
+#define UV_HAL_INC_UV_FRAMEBUFFER_H_
+
+#include <uv_hal_config.h>
+#include <stdint.h>
+
+/// @file: Fills and copies of pixels in a framebuffer in the CPU's memory, as
+/// drawn to by uv_lcd.
+///
+/// A fill stores the pixel value 8 bytes at a time once the destination is
+/// aligned to that, which the Cortex-M4 does as one STRD and a host as one
+/// store, and only the pixels before and after that span are stored one by
+/// one. A rectangle as wide as the framebuffer is filled as one span. The
+/// pixel at a time versions are kept as the reference the fast ones are
+/// checked and measured against.
+
+
+/// @brief: Sets *count* 16-bit pixels from *dest* to *value*
+void uv_fb_fill16(uint16_t *dest, uint16_t value, uint32_t count);
+
+/// @brief: Sets *count* 32-bit pixels from *dest* to *value*
+void uv_fb_fill32(uint32_t *dest, uint32_t value, uint32_t count);
+
+
+/// @brief: Fills a rectangle of *width* x *height* 16-bit pixels whose
+/// top-left pixel is at *dest*, in a framebuffer *stride* pixels wide
+void uv_fb_fill_rect16(uint16_t *dest, uint32_t stride,
+		uint32_t width, uint32_t height, uint16_t value);
+
+/// @brief: Fills a rectangle of *width* x *height* 32-bit pixels whose
+/// top-left pixel is at *dest*, in a framebuffer *stride* pixels wide
+void uv_fb_fill_rect32(uint32_t *dest, uint32_t stride,
+		uint32_t width, uint32_t height, uint32_t value);
+
+
+/// @brief: Copies *rows* rows of *row_len* bytes from *src* to *dest*. The
+/// strides are the bytes from the start of one row to the next. Rows that
+/// follow each other in both are copied as one.
+void uv_fb_blit(void *dest, uint32_t dest_stride,
+		const void *src, uint32_t src_stride, uint32_t row_len, uint32_t rows);
+
+
+/// @brief: uv_fb_fill16 a pixel at a time
+void uv_fb_fill16_scalar(uint16_t *dest, uint16_t value, uint32_t count);
+
+/// @brief: uv_fb_fill32 a pixel at a time
+void uv_fb_fill32_scalar(uint32_t *dest, uint32_t value, uint32_t count);
+
+
+#endif /* UV_HAL_INC_UV_FRAMEBUFFER_H_ */
@@ -31,6 +31,7 @@
 
 #include "uv_utilities.h"
 #include "uv_ui_common.h"
+#include "uv_ramalloc.h"
 
 #if CONFIG_FT81X
 
@@ -127,6 +128,38 @@
  available media RAM by the same amount."
 #endif
 
+#if !defined(CONFIG_FT81X_DL_BURST_LEN)
+/// @brief: The display list words staged in RAM and written to RAM_DL in one
+/// SPI transaction
+#define CONFIG_FT81X_DL_BURST_LEN		128
+#endif
+#if !defined(CONFIG_FT81X_CMD_BURST_LEN)
+/// @brief: The co-processor command bytes staged in RAM and written to RAM_CMD
+/// in one SPI transaction
+#define CONFIG_FT81X_CMD_BURST_LEN		128
+#endif
+
+#if !defined(CONFIG_FT81X_MEDIA_QUEUE_LEN)
+/// @brief: The bitmaps that can wait to be loaded asynchronously
+#define CONFIG_FT81X_MEDIA_QUEUE_LEN	16
+#endif
+#if !defined(CONFIG_FT81X_MEDIA_LOAD_CHUNK)
+/// @brief: The bytes of an asynchronously loaded bitmap copied from the
+/// external memory on one display step
+#define CONFIG_FT81X_MEDIA_LOAD_CHUNK	4096
+#endif
+#if !defined(CONFIG_FT81X_RAMG_BLOCKS)
+/// @brief: The blocks RAM_G can be split into: the custom fonts, the bitmaps
+/// and the free memory between them together
+#define CONFIG_FT81X_RAMG_BLOCKS		64
+#endif
+#if !defined(CONFIG_FT81X_MEDIA_CACHE)
+/// @brief: 1 lets the bitmaps drawn least recently be evicted from RAM_G
+/// when a new one does not fit, to be loaded again from the external memory
+/// when they are next drawn. With 0 the new bitmap fails to load instead.
+#define CONFIG_FT81X_MEDIA_CACHE		0
+#endif
+
 #define FT81X_PCLK_POL_RISING	0
 #define FT81X_PCLK_POL_FALLING	1
 
@@ -185,6 +218,17 @@ extern volatile uint8_t ft81x_buffer[FT81X_PREPROCESSOR_SIZE];
 uint32_t uv_ft81x_get_ramdl_usage(void);
 
 
+/// @brief: Returns the usage of RAM_G below the media FIFO, where the custom
+/// fonts and the bitmaps are, and how fragmented its free memory is
+void uv_ft81x_get_ramg_usage(uv_ramalloc_stats_st *stats);
+
+
+/// @brief: Returns the bytes written and read over SPI, and the SPI
+/// transactions they took, when drawing the last frame. Either pointer can
+/// be NULL.
+void uv_ft81x_get_spi_usage(uint32_t *bytes, uint32_t *transactions);
+
+
 /// @brief: Magic marker at the start of a custom font binary (".bin" media file)
 #define UV_FT81X_FONT_MAGIC		"UVFT"
 #define UV_FT81X_FONT_VERSION	1
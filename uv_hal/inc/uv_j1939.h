@@ -9,6 +9,7 @@
 #define HAL_UV_HAL_INC_UV_J1939_H_
 
 #include "uv_can.h"
+#include "uv_utilities.h"
 #include <stdbool.h>
 
 /// @file Defines for SAE J1939 protocol
@@ -111,4 +112,128 @@ static inline uint8_t uv_j1939_get_source_address(uv_can_msg_st *msg) {
 }
 
 
+/// @brief: PDU format values below this are PDU1 (destination specific) messages,
+/// where the PDU specific byte is the destination address instead of a part of the PGN
+#define UV_J1939_PDU2_FORMAT_MIN	0xF0
+
+/// @brief: Returns the PGN of the message with the destination address of
+/// PDU1 format messages masked off. Unlike uv_j1939_get_pgn(), this is the same
+/// for a given PGN regardless of who the message was addressed to. 0 in case of error.
+static inline uint16_t uv_j1939_get_pdu_pgn(uv_can_msg_st *msg) {
+	uint16_t pgn = uv_j1939_get_pgn(msg);
+	if ((pgn >> 8) < UV_J1939_PDU2_FORMAT_MIN) {
+		pgn &= 0xFF00;
+	}
+	return pgn;
+}
+
+
+
+
+/// @brief: Transport protocol connection management control byte for
+/// Broadcast Announce Message
+#define UV_J1939_TP_CM_BAM			0x20
+
+/// @brief: PGN's of the transport protocol messages
+#define UV_J1939_PGN_TP_CM			0xEC00
+#define UV_J1939_PGN_TP_DT			0xEB00
+
+/// @brief: Source address filter value which matches messages from any source
+#define UV_J1939_SA_ANY				0xFFFF
+
+
+/// @brief: PGN handler callback.
+///
+/// @param pgn: The PGN of the received message
+/// @param source_address: The source address of the received message
+/// @param data: Pointer to the message payload. For single frame messages this
+/// points directly to the received CAN message's data, for transport protocol
+/// messages to the dispatcher's reassembly buffer. The data is valid only for the
+/// duration of the callback.
+/// @param data_len: The length of *data* in bytes
+typedef void (*uv_j1939_pgn_callb_t)(void *user_ptr, uint16_t pgn,
+		uint8_t source_address, const uint8_t *data, uint16_t data_len);
+
+
+/// @brief: A single entry in the dispatch table
+typedef struct {
+	uint16_t pgn;
+	/// @brief: Source address this handler accepts, or UV_J1939_SA_ANY
+	uint16_t source_address;
+	uv_j1939_pgn_callb_t callb;
+} uv_j1939_handler_st;
+
+
+/// @brief: Dispatches received J1939 messages to PGN handlers.
+///
+/// The handlers are kept in a table sorted by PGN and source address, so that
+/// every received extended frame costs a single binary search regardless of how
+/// many PGN's are registered. Transport protocol (BAM) messages are reassembled
+/// into a caller given buffer and the completed message is dispatched through the
+/// same table, so a handler doesn't need to care how its PGN arrived.
+///
+/// Only one transport protocol transfer is reassembled at a time. A BAM
+/// announcing a PGN which has no handlers is ignored and doesn't interrupt an
+/// ongoing transfer.
+typedef struct {
+	uv_vector_st handlers;
+	uint8_t *tp_buffer;
+	uint16_t tp_buffer_len;
+	uint16_t tp_pgn;
+	uint16_t tp_byte_count;
+	uint8_t tp_source_address;
+	uint8_t tp_packet_count;
+	uint8_t tp_next_seq;
+} uv_j1939_dispatch_st;
+
+
+/// @brief: Initializes the dispatch table
+///
+/// @param handler_buffer: Buffer where the handlers are stored
+/// @param handler_buffer_len: The maximum number of handlers
+/// @param tp_buffer: Buffer where transport protocol messages are reassembled.
+/// Transport protocol messages longer than this are ignored. Can be NULL if
+/// transport protocol messages are not received.
+/// @param tp_buffer_len: The size of *tp_buffer* in bytes
+void uv_j1939_dispatch_init(uv_j1939_dispatch_st *this,
+		uv_j1939_handler_st *handler_buffer, uint16_t handler_buffer_len,
+		void *tp_buffer, uint16_t tp_buffer_len);
+
+
+/// @brief: Registers *callb* to be called when *pgn* is received from
+/// *source_address*. Also configures the CAN hardware to receive the PGN.
+///
+/// @note: Adding a handler is not thread safe with uv_j1939_dispatch_rx. Add the
+/// handlers before the dispatcher is hooked to the CAN receive callback.
+///
+/// @param pgn: The PGN. For PDU1 format PGN's the destination address byte is ignored.
+/// @param source_address: The source address to accept or UV_J1939_SA_ANY
+/// @return: ERR_BUFFER_OVERFLOW if the handler buffer is full
+uv_errors_e uv_j1939_dispatch_add(uv_j1939_dispatch_st *this,
+		uint16_t pgn, uint16_t source_address, uv_j1939_pgn_callb_t callb);
+
+
+/// @brief: Removes the handler added with the same arguments
+///
+/// @return: ERR_INVALID_DATA if no such handler was found
+uv_errors_e uv_j1939_dispatch_remove(uv_j1939_dispatch_st *this,
+		uint16_t pgn, uint16_t source_address, uv_j1939_pgn_callb_t callb);
+
+
+/// @brief: Returns the count of registered handlers
+static inline uint16_t uv_j1939_dispatch_get_count(uv_j1939_dispatch_st *this) {
+	return uv_vector_size(&this->handlers);
+}
+
+
+/// @brief: Passes a received CAN message through the dispatch table. Meant to be
+/// called from the CAN receive callback registered with uv_can_add_rx_callback.
+/// Handlers are called in the context of the caller, e.g. from the CAN ISR on MCU targets.
+///
+/// @return: true if the message was consumed by the dispatcher, either by
+/// calling at least one handler or as a part of an ongoing transport protocol
+/// transfer. Standard messages are never consumed.
+bool uv_j1939_dispatch_rx(uv_j1939_dispatch_st *this, uv_can_msg_st *msg);
+
+
 #endif /* HAL_UV_HAL_INC_UV_J1939_H_ */
@@ -194,6 +194,23 @@
 Usually external RAM is required"
 #endif
 #endif
+#if !defined(CONFIG_LCD_DMA)
+/// @brief: 1 copies the large images drawn with uv_lcd_draw_mimage to the
+/// framebuffer with the GPDMA
+#define CONFIG_LCD_DMA					0
+#endif
+#if CONFIG_LCD_DMA
+#if !defined(CONFIG_LCD_DMA_CHANNEL)
+/// @brief: The GPDMA channel the images are copied with. 7 has the lowest
+/// priority.
+#define CONFIG_LCD_DMA_CHANNEL			7
+#endif
+#if !defined(CONFIG_LCD_DMA_MIN_BYTES)
+/// @brief: The smallest copy made with the GPDMA. The CPU copies the smaller
+/// ones faster than the GPDMA is set up.
+#define CONFIG_LCD_DMA_MIN_BYTES		4096
+#endif
+#endif
 #if CONFIG_LCD_TOUCHSCREEN
 #if !defined(CONFIG_LCD_X_L_ADC) || !defined(CONFIG_LCD_X_L_GPIO)
 #error "CONFIG_LCD_X_L_ADC should define the ADC channel used to X Left input and\
@@ -378,6 +395,26 @@ static inline void uv_lcd_draw_rect(int32_t x, int32_t y, int32_t width, int32_t
 }
 
 
+/// @brief: Draws an image as in *uv_lcd_draw_image* for all pixels which are
+/// inside the defined mask rectangle.
+void uv_lcd_draw_mimage(int32_t x, int32_t y, int32_t width, int32_t height,
+		const LCD_PIXEL_TYPE *image, const uv_bounding_box_st *maskbb);
+
+/// @brief: Draws an image on the screen
+///
+/// @param x: The X coordinate of the left-top corner of the image
+/// @param y: The Y coordinate of the left-top corner of the image
+/// @param width: The width of the image in pixels
+/// @param height: The height of the image in pixels
+/// @param image: The pixels of the image row after row, in the display's
+/// pixel format
+static inline void uv_lcd_draw_image(int32_t x, int32_t y, int32_t width, int32_t height,
+		const LCD_PIXEL_TYPE *image) {
+	uv_bounding_box_st bb = { 0, 0, LCD_W_PX, LCD_H_PX };
+	uv_lcd_draw_mimage(x, y, width, height, image, &bb);
+}
+
+
 /// @brief: Draws a solid color frame as in *uv_lcd_draw_frame* for all pixels which are inside
 /// the defined mask rectangle.
 ///
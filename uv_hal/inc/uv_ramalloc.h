@@ -0,0 +1,189 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_INC_UV_RAMALLOC_H_
+#define UV_HAL_INC_UV_RAMALLOC_H_
+
+#include <uv_hal_config.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// @file: An allocator of memory the CPU does not address itself, such as the
+/// graphics RAM of a display controller.
+///
+/// The memory is kept track of here, in a table of blocks sorted by address
+/// that covers all of it: a block is either free or used by an *owner*. A
+/// freed block is merged with the free blocks next to it, so free memory is
+/// never split into more pieces than the used blocks between them make.
+///
+/// The memory itself is only touched through the *move* callback, when the
+/// used blocks are compacted to the start of the memory to put the free
+/// memory in one piece. The owner of a moved block is told its new address.
+/// Pinned blocks are never moved. When the memory runs out, the evictable
+/// block used least recently is given back and its owner told so, which is
+/// what lets the memory serve as a cache of something that can be loaded
+/// again.
+
+
+/// @brief: The address returned when nothing could be allocated
+#define UV_RAMALLOC_NONE			UINT32_MAX
+
+/// @brief: The alignment of every block, in bytes
+#define UV_RAMALLOC_ALIGN			4
+
+
+/// @brief: How a used block may be treated, given to the allocation functions
+enum {
+	/// @brief: The block is never moved
+	UV_RAMALLOC_PINNED = (1 << 0),
+	/// @brief: The block can be evicted when the memory runs out
+	UV_RAMALLOC_EVICTABLE = (1 << 1)
+};
+typedef uint8_t uv_ramalloc_flags_e;
+
+
+typedef struct {
+	uint32_t addr;
+	uint32_t size;
+	/// @brief: The owner of a used block, NULL when the block is free
+	void *owner;
+	/// @brief: When the block was last used, see uv_ramalloc_touch()
+	uint32_t last_use;
+	uv_ramalloc_flags_e flags;
+} uv_ramalloc_block_st;
+
+
+typedef struct {
+	/// @brief: The bytes in used blocks
+	uint32_t used;
+	/// @brief: The bytes in free blocks
+	uint32_t free;
+	/// @brief: The size of the largest free block
+	uint32_t largest_free;
+	/// @brief: The number of used blocks
+	uint16_t blocks;
+	/// @brief: The number of free blocks
+	uint16_t holes;
+	/// @brief: The part of the free memory, in 1/1000, that is not in the
+	/// largest free block. 0 when all free memory is in one piece.
+	uint16_t fragmentation;
+	/// @brief: The blocks evicted since the allocator was initialized
+	uint32_t evictions;
+} uv_ramalloc_stats_st;
+
+
+typedef struct {
+	uv_ramalloc_block_st *blocks;
+	uint16_t len;
+	uint16_t count;
+	uint32_t base;
+	uint32_t size;
+	uint32_t clock;
+	uint32_t evictions;
+	/// @brief: Copies *len* bytes from *src* to *dest*, which is always below
+	/// *src*. The ranges never overlap.
+	void (*move)(uint32_t dest, uint32_t src, uint32_t len);
+	/// @brief: Tells the owner of a moved block its new address
+	void (*moved)(void *owner, uint32_t addr);
+	/// @brief: Tells the owner of an evicted block that the block is gone
+	void (*evict)(void *owner);
+} uv_ramalloc_st;
+
+
+/// @brief: Initializes the allocator to hand out the *size* bytes starting
+/// from *base*, keeping track of them in the *len* entries of *blocks*. The
+/// memory can be split into at most *len* blocks, used and free together.
+void uv_ramalloc_init(uv_ramalloc_st *this, uv_ramalloc_block_st *blocks,
+		uint16_t len, uint32_t base, uint32_t size);
+
+
+/// @brief: Sets the callbacks that move the memory and tell the owners of the
+/// blocks about it. Without *move*, the memory is never compacted, and without
+/// *evict*, nothing is evicted.
+void uv_ramalloc_set_callbacks(uv_ramalloc_st *this,
+		void (*move)(uint32_t dest, uint32_t src, uint32_t len),
+		void (*moved)(void *owner, uint32_t addr),
+		void (*evict)(void *owner));
+
+
+/// @brief: Allocates *size* bytes for *owner* from the lowest free block they
+/// fit. When none is big enough the memory is compacted, and when the free
+/// memory is not enough, evictable blocks are evicted least recently used
+/// first. *owner* cannot be NULL, which is what marks a block free.
+///
+/// @return: The address of the block, UV_RAMALLOC_NONE if there is no room
+uint32_t uv_ramalloc_alloc(uv_ramalloc_st *this, uint32_t size,
+		void *owner, uv_ramalloc_flags_e flags);
+
+
+/// @brief: Allocates the *size* bytes at *addr* for *owner*, for memory that
+/// was already written before its size was known. Nothing is moved or evicted.
+///
+/// @return: *addr*, or UV_RAMALLOC_NONE if the memory there is not free
+uint32_t uv_ramalloc_alloc_at(uv_ramalloc_st *this, uint32_t addr,
+		uint32_t size, void *owner, uv_ramalloc_flags_e flags);
+
+
+/// @brief: Frees the used block at *addr*
+void uv_ramalloc_free(uv_ramalloc_st *this, uint32_t addr);
+
+
+/// @brief: Returns the owner of the used block at *addr*, NULL if there is
+/// none
+void *uv_ramalloc_get_owner(const uv_ramalloc_st *this, uint32_t addr);
+
+
+/// @brief: Marks the used block at *addr* as used just now, which is what
+/// keeps it from being evicted ahead of the blocks not used as recently
+void uv_ramalloc_touch(uv_ramalloc_st *this, uint32_t addr);
+
+
+/// @brief: Evicts the evictable block used least recently
+///
+/// @return: false if there was none
+bool uv_ramalloc_evict(uv_ramalloc_st *this);
+
+
+/// @brief: Moves the used blocks that are not pinned down over the free
+/// memory below them, so that the free memory between two pinned blocks, and
+/// after the last one, is in one piece
+///
+/// @return: The bytes moved
+uint32_t uv_ramalloc_compact(uv_ramalloc_st *this);
+
+
+/// @brief: Returns the size of the free block at the end of the memory, and
+/// its address in *addr*
+uint32_t uv_ramalloc_get_tail(const uv_ramalloc_st *this, uint32_t *addr);
+
+
+/// @brief: Returns the usage and fragmentation of the memory
+void uv_ramalloc_get_stats(const uv_ramalloc_st *this, uv_ramalloc_stats_st *stats);
+
+
+#endif /* UV_HAL_INC_UV_RAMALLOC_H_ */
@@ -98,6 +98,19 @@ typedef enum {
 	// out of. Payload is remote_can_stats_st verbatim.
 	// [0x85][CAN_STATS][remote_can_stats_st]
 	REMOTE_MSG_TYPE_CAN_STATS,
+	// Many CAN frames in one message, compactly coded (either direction).
+	// [0x85][CAN_BATCH][batch_len][frames: batch_len], see "CAN batches"
+	// below for the frame coding. Each batch decodes on its own, so a lost
+	// payload never corrupts the next one. Older sinks skip it as an unknown
+	// type, so a device should only batch for a sink known to decode it.
+	REMOTE_MSG_TYPE_CAN_BATCH,
+	// What the UI mirroring sink can decode beyond the base command stream
+	// (sink -> source), sent when it connects. REMOTE_UI_CAP_* bits. The
+	// source answers nothing: it picks the most compact color mode both ends
+	// support and marks every UI chunk coded in it with REMOTE_UI_FLAG_RGB565
+	// or REMOTE_UI_FLAG_PALETTE. A sink that never sends this gets ARGB8888.
+	// [0x85][UI_CAPS][caps]
+	REMOTE_MSG_TYPE_UI_CAPS,
 	REMOTE_MSG_TYPE_COUNT
 } remote_msg_types_e;
 
@@ -123,7 +136,13 @@ typedef enum {
 // ui_flags bits
 #define REMOTE_UI_FLAG_FRAME_START		(1 << 0)
 #define REMOTE_UI_FLAG_FRAME_END		(1 << 1)
-#define REMOTE_UI_FLAG_RGB565			(1 << 2)	// reserved for a future 2-byte color mode
+// the chunk belongs to a frame coded in the RGB565 / palette color mode, see
+// uv_ui_remote.h
+#define REMOTE_UI_FLAG_RGB565			(1 << 2)
+#define REMOTE_UI_FLAG_PALETTE			(1 << 3)
+// UI_CAPS bits
+#define REMOTE_UI_CAP_RGB565			(1 << 0)
+#define REMOTE_UI_CAP_PALETTE			(1 << 1)
 
 
 /// @brief: Structure for masking can messages that should be sent via remote.
@@ -243,6 +262,46 @@ typedef struct __attribute__((packed)) {
 } remote_can_stats_st;
 
 
+// --- CAN batches -----------------------------------------------------------
+//
+// A REMOTE_MSG_TYPE_CAN_BATCH carries frames back to back, each as:
+//
+//   [hdr][id_delta: varint][time_delta: varint][data]
+//
+// hdr        bit 7 REMOTE_CAN_BATCH_HDR_EXT, bit 6 REMOTE_CAN_BATCH_HDR_XOR,
+//            bits 3..0 data length (0...8). Bits 5..4 are zero.
+// id_delta   the id minus the id of the previous frame of the same type
+//            (standard or extended) in the batch, 0 for the first of each,
+//            zigzag coded so a small step either way is one byte.
+// time_delta milliseconds since the previous frame in the batch (0 for the
+//            first). The batch carries no absolute time.
+// data       without XOR, the data bytes as is. With XOR, a byte with bit i
+//            set for every data byte i that differs from the reference,
+//            followed by the XOR of only those bytes.
+//
+// The reference of a bulk class frame is the latest earlier frame of the same
+// id and type in the batch, as found in a REMOTE_CAN_BATCH_REF_COUNT slot table
+// which both ends update identically after every bulk frame
+// (remote_can_batch_ref_st). Every other frame, and a bulk frame whose id is not
+// in the table, is coded against all zero bytes — which still pays off for the
+// mostly empty payloads J1939 and PDO traffic is full of.
+//
+// Varints are little endian base 128: seven bits per byte, bit 7 set on every
+// byte but the last.
+
+#define REMOTE_CAN_BATCH_HDR_EXT		(1u << 7)
+#define REMOTE_CAN_BATCH_HDR_XOR		(1u << 6)
+#define REMOTE_CAN_BATCH_HDR_DLC_MASK	(0x0Fu)
+// Frame bytes carried per batch. Keeps a whole batch within a uint8_t length
+// and within the framer's receive buffer.
+#define REMOTE_CAN_BATCH_DATA_MAX_LEN	200
+// Size of the XOR reference table
+#define REMOTE_CAN_BATCH_REF_COUNT		16
+// Longest a single frame can code to: header, 5 byte id delta, 5 byte time
+// delta, XOR mask and 8 data bytes
+#define REMOTE_CAN_BATCH_FRAME_MAX_LEN	(1 + 5 + 5 + 1 + 8)
+
+
 #define REMOTE_MSG_TYPE_CONNECT_LEN				(sizeof(uint64_t) + sizeof(uint8_t) + 2)
 #define REMOTE_MSG_TYPE_CONNECT_SERIAL_INDEX	2
 #define REMOTE_MSG_TYPE_CONNECT_NODEID_INDEX	10
@@ -263,12 +322,17 @@ typedef struct __attribute__((packed)) {
 #define REMOTE_MSG_TYPE_UI_INFO_LEN				6
 #define REMOTE_MSG_TYPE_CLOSE_LEN				2
 #define REMOTE_MSG_TYPE_CAN_STATS_LEN			(2 + sizeof(remote_can_stats_st))
+// CAN_BATCH is variable length like CAN, patched from the batch_len byte
+#define REMOTE_MSG_TYPE_CAN_BATCH_LEN(batch_len)	(3 + (batch_len))
+#define REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN		REMOTE_MSG_TYPE_CAN_BATCH_LEN(REMOTE_CAN_BATCH_DATA_MAX_LEN)
+#define REMOTE_MSG_TYPE_UI_CAPS_LEN				3
 #define REMOTE_MSG_TYPE_MAX_LEN					(MAX(\
-		REMOTE_MSG_TYPE_UI_LEN, \
+		REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN, \
+		MAX(REMOTE_MSG_TYPE_UI_LEN, \
 		MAX(REMOTE_MSG_TYPE_CONNECT_LEN, \
 		MAX(REMOTE_MSG_TYPE_CAN_MAX_LEN,\
 				MAX(REMOTE_MSG_TYPE_RXCONF_LEN,\
-						REMOTE_MSG_TYPE_RXCLEAR_LEN)))))
+						REMOTE_MSG_TYPE_RXCLEAR_LEN))))))
 
 
 static inline const char *remote_msg_type_to_str(remote_msg_types_e type) {
@@ -319,6 +383,12 @@ static inline const char *remote_msg_type_to_str(remote_msg_types_e type) {
 	case REMOTE_MSG_TYPE_CAN_STATS:
 		ret = "CAN_STATS";
 		break;
+	case REMOTE_MSG_TYPE_CAN_BATCH:
+		ret = "CAN_BATCH";
+		break;
+	case REMOTE_MSG_TYPE_UI_CAPS:
+		ret = "UI_CAPS";
+		break;
 	default:
 		break;
 	}
@@ -22,7 +22,9 @@
 
 
 /// @brief: Called for each complete message the framer decodes. *data* points
-/// at the whole message including the start byte and the type.
+/// at the whole message including the start byte and the type. It points either
+/// into the buffer given to remote_stream_feed() or into the framer's own
+/// rx_data, and is valid only for the duration of the callback.
 typedef void (*remote_frame_callb_t)(void *user, remote_msg_types_e type,
 		const uint8_t *data, uint8_t len);
 
@@ -57,6 +59,91 @@ void remote_can_msg_encode(const uv_can_msg_st *msg, uint8_t *dest);
 void remote_can_msg_decode(const uint8_t *data, uv_can_msg_st *dest);
 
 
+/// @brief: The XOR reference table of a CAN batch. Both the encoder and the
+/// decoder keep one and update it identically, which is what lets a frame name
+/// its reference without spending a byte on it.
+typedef struct {
+	struct {
+		/// id with REMOTE_CAN_ID_EXT_FLAG for extended frames
+		uint32_t id;
+		uint8_t data_len;
+		uint8_t data[8];
+	} slot[REMOTE_CAN_BATCH_REF_COUNT];
+	uint8_t count;
+	/// next slot to overwrite when the table is full
+	uint8_t next;
+} remote_can_batch_ref_st;
+
+
+/// @brief: Builds one REMOTE_MSG_TYPE_CAN_BATCH message.
+typedef struct {
+	/// the whole message, header included
+	uint8_t msg[REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN];
+	uint8_t frame_count;
+	/// frame bytes the batch may grow to, REMOTE_CAN_BATCH_DATA_MAX_LEN at most
+	uint8_t max_len;
+	uint32_t prev_std_id;
+	uint32_t prev_ext_id;
+	uint32_t prev_time_ms;
+	remote_can_batch_ref_st ref;
+} remote_can_batch_st;
+
+
+/// @brief: Empties the batch and lets it grow to REMOTE_CAN_BATCH_DATA_MAX_LEN
+void remote_can_batch_clear(remote_can_batch_st *this);
+
+
+/// @brief: Limits the whole batch message to *msg_len* bytes, for filling the
+/// room left in a remote_pack_st rather than leaving it unused. Values
+/// below the message header or above REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN are
+/// clamped. Frames already in the batch are kept even if they exceed it.
+void remote_can_batch_set_max_len(remote_can_batch_st *this, uint16_t msg_len);
+
+
+/// @brief: Codes *msg* into the batch.
+///
+/// @param time_ms: The time the frame was received, in any monotonic
+/// millisecond time base. Only the differences between frames are sent.
+/// @return: false if the frame doesn't fit — send the batch, clear it and retry.
+bool remote_can_batch_append(remote_can_batch_st *this,
+		const uv_can_msg_st *msg, uint32_t time_ms);
+
+
+/// @brief: Returns the count of frames in the batch
+static inline uint8_t remote_can_batch_get_count(const remote_can_batch_st *this) {
+	return this->frame_count;
+}
+
+
+/// @brief: Returns the whole batch message, ready for remote_pack_append().
+/// Its length is remote_can_batch_get_len().
+static inline const uint8_t *remote_can_batch_get_msg(const remote_can_batch_st *this) {
+	return this->msg;
+}
+
+
+/// @brief: Returns the length of the whole batch message
+static inline uint8_t remote_can_batch_get_len(const remote_can_batch_st *this) {
+	return (uint8_t) REMOTE_MSG_TYPE_CAN_BATCH_LEN(this->msg[2]);
+}
+
+
+/// @brief: Called once per frame decoded from a batch, in order.
+///
+/// @param time_ms: Milliseconds since the first frame of the batch
+typedef void (*remote_can_batch_callb_t)(void *user, const uv_can_msg_st *msg,
+		uint32_t time_ms);
+
+
+/// @brief: Decodes every frame of a CAN batch. *data* points at the whole
+/// message, start byte and all — i.e. at what the framer hands its callback.
+///
+/// @return: false if the batch is malformed. The frames before the fault
+/// have been delivered by then.
+bool remote_can_batch_decode(const uint8_t *data, uint8_t len,
+		remote_can_batch_callb_t callb, void *user);
+
+
 /// @brief: Largest transport payload a batch of messages is packed into. On the
 /// iot link this is one MQTT message; batching matters there because a publish
 /// costs a full AT round trip regardless of size. Override per project.
@@ -82,6 +169,12 @@ void remote_stream_reset(remote_stream_st *this);
 /// @brief: Feeds *len* received bytes through the framer, invoking *callb* once
 /// per complete message with *user* passed back to it. Safe to call with
 /// arbitrary chunk boundaries — messages may span calls.
+///
+/// Bytes between messages are skipped with memchr, a message lying wholly
+/// inside *data* is passed to *callb* in place, and only a message spanning
+/// calls is copied into rx_data — in one piece per call once its length is
+/// known. Feeding a whole payload at once is therefore much cheaper than
+/// feeding it in small pieces.
 void remote_stream_feed(remote_stream_st *this, const uint8_t *data,
 		uint16_t len, remote_frame_callb_t callb, void *user);
 
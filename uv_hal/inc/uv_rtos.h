@@ -52,6 +52,7 @@
 #include "task.h"
 #include "semphr.h"
 #include "uv_utilities.h"
+#include "uv_cputime.h"
 #include <uv_hal_config.h>
 
 #if !defined(CONFIG_RTOS_HEAP_SIZE)
@@ -437,9 +438,16 @@ extern uv_mutex_st halmutex;
 /// @brief: Locks the HAL layer mutex for hal task functions.
 ///
 /// @note: Only for HAL library inner use. Can be unlocked only from
-/// other threads.
+/// other threads. The time waited is added to CPUTIME_HALMUTEX_WAIT once
+/// the mutex is held, which keeps the slot to one writer at a time.
 static inline void _uv_rtos_halmutex_lock(void) {
+#if CONFIG_CPUTIME
+	uint32_t start = uv_cputime_begin();
+	uv_mutex_lock(&halmutex);
+	uv_cputime_end(CPUTIME_HALMUTEX_WAIT, start);
+#else
 	uv_mutex_lock(&halmutex);
+#endif
 }
 
 /// @brief: Unlocks the HAL layer mutex for hal task functions
@@ -37,6 +37,7 @@
 #include <stdarg.h>
 #include "uv_stdout.h"
 #include "uv_errors.h"
+#include "uv_cputime.h"
 
 /// @file: A terminal interface which can be used over UART or CAN bus.
 /// HAL layer takes care of parsing and redirecting the messages over UART or CAN.
@@ -144,6 +145,9 @@ typedef enum {
 #if CONFIG_NON_VOLATILE_MEMORY
 	CMD_SAVE,
 	CMD_REVERT,
+#endif
+#if CONFIG_CPUTIME
+	CMD_CPUTIME,
 #endif
 	CMD_RESET
 } uv_common_commands_e;
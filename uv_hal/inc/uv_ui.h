@@ -60,6 +60,7 @@
 #include "ui/uv_uiacceptdialog.h"
 #include "ui/uv_uimedialist.h"
 #include "ui/uv_uigraph.h"
+#include "ui/uv_uichart.h"
 #include "ui/uv_uigauge.h"
 #include "ui/uv_uivalveslider.h"
 #include <stdarg.h>
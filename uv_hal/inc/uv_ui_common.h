@@ -39,6 +39,8 @@
 #include "ui/uv_uimedia.h"
 #include "uv_spi.h"
 #include "uv_w25q128.h"
+#include "uv_ui_input.h"
+#include "uv_ui_dirty.h"
 
 
 /// @file: Defines the GUI drawing interface. These functions need to be implemented
@@ -52,6 +54,15 @@
 #endif
 
 
+/// @brief: Recorded drawing: the drawing calls made between uv_ui_record_begin
+/// and uv_ui_record_end are stored in a buffer and can be replayed later
+/// without running the code that made them. uv_uiwindow uses this to cache
+/// windows whose children seldom change. 0 compiles it out.
+#if !defined(CONFIG_UI_WINDOW_CACHE)
+#define CONFIG_UI_WINDOW_CACHE			1
+#endif
+
+
 /// @brief: Wrapper for font data for UI library
 typedef struct {
 	uint16_t char_height;
@@ -93,6 +104,13 @@ typedef struct {
 	uint16_t custom_stride;		// bytes per glyph row (L4)
 	uint16_t custom_width;		// glyph cell width in pixels
 #endif
+#if CONFIG_UI_HEADLESS
+	// The headless backend draws text from a remote UI font body: the metrics
+	// header followed by a 4 bits per pixel atlas of one cell a glyph slot (see
+	// UV_UI_REMOTE_FONT_BODY_HDR_LEN). NULL when the font could not be loaded.
+	uint8_t *body;
+	uint32_t body_len;
+#endif
 } ui_font_st;
 typedef ui_font_st uv_font_st;
 
@@ -325,6 +343,14 @@ void uv_ui_clear(color_t c);
 bool uv_ui_get_refresh_request(void);
 
 
+/// @brief: Returns true when what was drawn in the last frame is still there
+/// when the next one starts, so that a frame may redraw only a part of the
+/// screen. False on the backends that build every frame from nothing, and
+/// while a remote sink mirrors the screen, since the sink draws every frame
+/// over the last full one.
+bool uv_ui_get_frame_preserved(void);
+
+
 
 #if !CONFIG_W25Q128
 /// @brief: Declaration of unused types for external memories that are not used
@@ -363,6 +389,21 @@ typedef void uv_w25q128_st;
 uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 		uv_w25q128_st *exmem, const char *filename);
 
+
+/// @brief: Queues the bitmap to be loaded like uv_uimedia_newbitmapexmem, and
+/// returns right away. The file is copied to the display a chunk at a time on
+/// the display steps that follow, so that a screen opens without waiting for
+/// its images. Until then the bitmap is not resident (see
+/// uv_uimedia_is_resident) and is not drawn, and once it is, the screen is
+/// drawn again. The backends that load from memory of their own load it right
+/// away.
+///
+/// The FT81X backend also loads a bitmap this way when one evicted with
+/// CONFIG_FT81X_MEDIA_CACHE is drawn again. That load waits for room in the
+/// queue instead of loading in the middle of the frame.
+void uv_uimedia_newbitmapexmem_async(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename);
+
 #if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
 /// @brief: Host-only variant of uv_uimedia_newbitmapexmem that decodes a PNG
 /// image straight from a memory buffer (e.g. one compiled into the binary)
@@ -512,16 +553,17 @@ void uv_ui_touchscreen_set_transform_matrix(ui_transfmat_st *transform_matrix);
 bool uv_ui_get_touch(int16_t *x, int16_t *y);
 
 
-/// @brief: Returns and clears the mouse-wheel movement accumulated since the
-/// previous call, in wheel notches (positive = scrolled up / away from the user,
-/// negative = down). Implemented on the host (Linux/Windows) UI backends; returns
-/// 0 on targets without a mouse wheel.
+/// @brief: Returns and clears the mouse-wheel movement the display has taken
+/// out of the input queue since the previous call, in wheel notches
+/// (positive = scrolled up / away from the user, negative = down). 0 on
+/// targets without a mouse wheel.
 int16_t uv_ui_get_scroll(void);
 
 
 
 /// @brief: Returns the key pressed. If no keys were pressed,
-/// returns '\0'. This is implemented only on targets with a physical keyboard.
+/// returns '\0'. Keys come from the backends with a physical keyboard and
+/// from the remote UI.
 char uv_ui_get_key_press(void);
 
 
@@ -554,6 +596,71 @@ const char *uv_ui_get_clipboard(void);
 char uv_ui_peek_key_press(void);
 
 
+
+/// @brief: Returns the time input events are stamped with, in microseconds.
+/// Wraps around every 71 minutes, so only differences mean anything.
+uint32_t uv_ui_input_time_us(void);
+
+
+/// @brief: Adds an input event, stamped with the current time, to the input
+/// queue. Called by the backends and the remote UI as the input happens, also
+/// from another task. Keys go into a queue of their own, which the
+/// uv_ui_*_key_press functions read; the rest is taken out by the display
+/// step in the order it was pushed. A touch is pushed when the screen is
+/// touched and whenever the touch moves, and a release when it ends.
+///
+/// @param value: Wheel notches of a scroll, the character of a key
+void uv_ui_input_push(uv_ui_input_type_e type, int16_t x, int16_t y, int16_t value);
+
+
+/// @brief: Asks the backend to push the input that has happened since the
+/// previous call. Called by the display step before it reads the queue.
+void uv_ui_input_poll(void);
+
+
+/// @brief: Takes the oldest touch or scroll event out into *event*. Returns
+/// false when there is none.
+bool uv_ui_input_pop(uv_ui_input_event_st *event);
+
+
+/// @brief: Returns the number of input events dropped because a queue was full
+uint32_t uv_ui_input_get_dropped(void);
+
+
+#if CONFIG_UI_INPUT_LATENCY
+typedef enum {
+	/// @brief: From the input to the end of drawing the frame that answers it,
+	/// when the display list is handed to uv_ui_dlswap()
+	UI_LATENCY_DRAW = 0,
+	/// @brief: From the input to the return of the swap, when the frame is
+	/// on the screen
+	UI_LATENCY_SWAP,
+	UI_LATENCY_COUNT
+} uv_ui_latency_e;
+
+/// @brief: Returns the histogram of input latencies *which*.
+/// uv_ui_latency_percentile() gives the percentiles from it.
+///
+/// An input is measured when the display takes it and the same step draws a
+/// frame. Input that does not change the screen - a touch on nothing - has
+/// no frame to measure against and is not counted.
+const uv_ui_latency_st *uv_ui_input_get_latency(uv_ui_latency_e which);
+
+/// @brief: Clears the latency histograms
+void uv_ui_input_reset_latency(void);
+#endif
+
+
+/// @brief: Called by the display when an input event stamped *time_us*
+/// has been acted on, for the latency measurement. Not to be called by the
+/// application.
+void _uv_ui_input_consumed(uint32_t time_us);
+
+/// @brief: Called by the display at the end of its step. Input acted on in a
+/// step that drew nothing is forgotten.
+void _uv_ui_input_frame_end(void);
+
+
 /// @brief: Sets the color mode for the ft81x. The mode affects  how different colors
 /// are drawn on the screen.
 void uv_ui_set_color_mode(ui_color_modes_e value);
@@ -602,6 +709,59 @@ const char *uv_str_next_line(const char *str);
 /// @brief: Sets the drawing mask which masks all drawing functions to the masked area
 void uv_ui_set_mask(int16_t x, int16_t y, int16_t width, int16_t height);
 
+/// @brief: Cuts every mask set from now on down to *bb*, for a display that
+/// redraws only a part of the screen. NULL removes the limit.
+void uv_ui_set_mask_limit(const uv_bb_st *bb);
+
+
+#if CONFIG_UI_WINDOW_CACHE
+/// @brief: A list of recorded drawing calls. The buffer holds the arguments of
+/// each call: strings and points are copied, fonts and bitmaps are referred to
+/// and have to outlive the recording.
+typedef struct {
+	/// @brief: The buffer, aligned at least as uint16_t
+	uint8_t *buffer;
+	uint16_t buffer_len;
+	/// @brief: Bytes of the buffer used by the recording
+	uint16_t len;
+	/// @brief: True when the recording holds every call made while it was
+	/// recorded, and nothing has been changed since
+	bool valid;
+	/// @brief: Set when a call could not be recorded
+	bool spoiled;
+} uv_ui_record_st;
+
+/// @brief: Initializes an empty recording
+void uv_ui_record_init(uv_ui_record_st *rec, void *buffer, uint16_t buffer_len);
+
+/// @brief: Starts recording the drawing calls into *rec*. The calls are also
+/// drawn as usual.
+///
+/// @return: false when the recording could not be started: only one recording
+/// is made at a time, and none while the mask is limited to a partial redraw,
+/// as the objects outside of it are not drawn at all.
+bool uv_ui_record_begin(uv_ui_record_st *rec);
+
+/// @brief: Stops recording.
+///
+/// @return: true when the recording is valid. A recording is spoiled when the
+/// buffer ran out, when a call that cannot be replayed was made (clearing the
+/// screen, swapping the display list, a forced mask) or when the recording was
+/// invalidated while it was being made.
+bool uv_ui_record_end(uv_ui_record_st *rec);
+
+/// @brief: Marks the recording out of date
+void uv_ui_record_invalidate(uv_ui_record_st *rec);
+
+/// @brief: Spoils the recording being made, if any. For drawing functions that
+/// do not go through the recorded calls.
+void uv_ui_record_spoil(void);
+
+/// @brief: Makes the recorded calls again, in the same order. The mask limit
+/// of a partial redraw and the remote UI apply as if they were made directly.
+void uv_ui_record_replay(const uv_ui_record_st *rec);
+#endif
+
 /// @brief: OpenGL impelemtetaion of mask is commented since it takes long time to render the screen.
 /// This forces the mask
 #if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
@@ -633,6 +793,34 @@ void uv_ui_confwindow_exec(const uv_uistyle_st *style);
 
 
 
+#if CONFIG_UI_HEADLESS
+/// @brief: The headless backend draws into an ARGB8888 framebuffer in memory
+/// instead of a window, for running the UI on a machine without a display.
+/// There is nobody to touch it, so the input comes from these functions.
+///
+/// Setting the UV_UI_HEADLESS_PNG environment variable to a directory writes
+/// every frame there as frame_NNNNN.png.
+
+/// @brief: Sets the touch the next uv_ui_get_touch returns, and pushes it
+/// into the input queue
+void uv_ui_headless_set_touch(bool pressed, int16_t x, int16_t y);
+
+/// @brief: Pushes a scroll of *notches* into the input queue
+void uv_ui_headless_scroll(int16_t notches);
+
+/// @brief: Queues *key* for uv_ui_get_key_press
+void uv_ui_headless_key_press(char key);
+
+/// @brief: Returns the framebuffer, CONFIG_FT81X_HSIZE pixels a row, and the
+/// number of frames swapped so far in *frames*, if not NULL
+const uint32_t *uv_ui_headless_get_framebuffer(uint32_t *frames);
+
+/// @brief: Writes the framebuffer into a PNG file. Returns false on error.
+bool uv_ui_headless_save_png(const char *filename);
+#endif
+
+
+
 /// @brief: Backend implementations of the drawing / touch primitives.
 ///
 /// The public uv_ui_* functions above are thin wrappers implemented in the
@@ -661,6 +849,11 @@ void uv_ui_draw_string_impl(char *str, ui_font_st *font,
 		int16_t x, int16_t y, ui_align_e align, color_t color);
 void uv_ui_set_mask_impl(int16_t x, int16_t y, int16_t width, int16_t height);
 bool uv_ui_get_touch_impl(int16_t *x, int16_t *y);
+bool uv_ui_frame_preserved_impl(void);
+/// @brief: Pushes the input that has happened since the previous call with
+/// uv_ui_input_push(). Backends that push from their event callbacks only
+/// have to run their event loop here.
+void uv_ui_input_poll_impl(void);
 
 
 // The remote UI encoder uses the types declared above; include it here so the
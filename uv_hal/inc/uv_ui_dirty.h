@@ -0,0 +1,87 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_INC_UV_UI_DIRTY_H_
+#define UV_HAL_INC_UV_UI_DIRTY_H_
+
+#include <uv_hal_config.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// @file: The areas of a display refreshed since it was last drawn.
+///
+/// uv_ui_refresh records the area of each refreshed object here, and on a
+/// backend that keeps the last frame the display redraws only these areas.
+/// Areas that overlap or touch are kept merged into one, and a full set merges
+/// the new area with the one that grows the least from it.
+
+
+/// @brief: Partial redraws. A refresh records the area of the object it was
+/// made on, and on a backend that keeps the last frame (see
+/// uv_ui_get_frame_preserved) the display redraws only those areas, up to this
+/// many separate ones. More than that are merged together. 0 compiles partial
+/// redraws out, and every refresh redraws the whole screen.
+#if !defined(CONFIG_UI_DIRTY_RECTS)
+#define CONFIG_UI_DIRTY_RECTS			4
+#endif
+
+
+#if CONFIG_UI_DIRTY_RECTS
+
+/// @brief: An area in global coordinates
+typedef struct {
+	int16_t x;
+	int16_t y;
+	int16_t width;
+	int16_t height;
+} uv_uidirty_rect_st;
+
+typedef struct {
+	uv_uidirty_rect_st rect[CONFIG_UI_DIRTY_RECTS];
+	uint8_t count;
+} uv_uidirty_st;
+
+
+/// @brief: Empties the set
+static inline void uv_uidirty_clear(uv_uidirty_st *dirty) {
+	dirty->count = 0;
+}
+
+/// @brief: Adds an area to the set. Areas of no size are ignored. When the
+/// set is full the area is merged with the one that grows the least from it.
+void uv_uidirty_add(uv_uidirty_st *dirty,
+		int16_t x, int16_t y, int16_t width, int16_t height);
+
+/// @brief: True when *a* and *b* overlap or are closer than *margin* to each
+/// other
+bool uv_uidirty_near(const uv_uidirty_rect_st *a,
+		const uv_uidirty_rect_st *b, int16_t margin);
+
+#endif
+
+#endif /* UV_HAL_INC_UV_UI_DIRTY_H_ */
@@ -0,0 +1,154 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_INC_UV_UI_INPUT_H_
+#define UV_HAL_INC_UV_UI_INPUT_H_
+
+#include <uv_hal_config.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// @file: Input events and how long they take to reach the screen.
+///
+/// The UI backends push what the user does - touches, releases, mouse wheel
+/// notches and keys - into a queue as it happens, each with the time it
+/// happened. The display takes them out in order on its step, so a tap shorter
+/// than one step cycle is still a press and a click, and the time from an
+/// input to the frame that answers it can be measured.
+///
+/// The queue the backends push into is in uv_ui_common.c, see
+/// uv_ui_input_push().
+
+
+/// @brief: Length of the queue of touch and scroll events
+#if !defined(CONFIG_UI_INPUT_QUEUE_LEN)
+#define CONFIG_UI_INPUT_QUEUE_LEN		32
+#endif
+
+/// @brief: Length of the queue of key presses
+#if !defined(CONFIG_UI_KEY_QUEUE_LEN)
+#define CONFIG_UI_KEY_QUEUE_LEN			20
+#endif
+
+/// @brief: Measures the time from the inputs to the frames drawn for them,
+/// see uv_ui_input_get_latency(). 0 compiles the measurement out.
+#if !defined(CONFIG_UI_INPUT_LATENCY)
+#define CONFIG_UI_INPUT_LATENCY			1
+#endif
+
+
+typedef enum {
+	/// @brief: The screen is touched at (x, y). Pushed when the touch starts
+	/// and every time it moves.
+	UI_INPUT_TOUCH = 0,
+	/// @brief: The touch ended at (x, y)
+	UI_INPUT_RELEASE,
+	/// @brief: The mouse wheel turned *value* notches, positive away from the
+	/// user
+	UI_INPUT_SCROLL,
+	/// @brief: The key *value* was pressed
+	UI_INPUT_KEY
+} uv_ui_input_type_e;
+
+
+typedef struct {
+	/// @brief: When the input happened, in microseconds of
+	/// uv_ui_input_time_us()
+	uint32_t time_us;
+	int16_t x;
+	int16_t y;
+	int16_t value;
+	uint8_t type;
+} uv_ui_input_event_st;
+
+
+/// @brief: Bounded FIFO of input events
+typedef struct {
+	uv_ui_input_event_st *events;
+	uint16_t len;
+	uint16_t head;
+	uint16_t count;
+	/// @brief: Events lost to a full queue since init
+	uint32_t dropped;
+} uv_ui_input_queue_st;
+
+
+/// @brief: Initializes *this* on a buffer of *len* events
+void uv_ui_input_queue_init(uv_ui_input_queue_st *this,
+		uv_ui_input_event_st *buffer, uint16_t len);
+
+/// @brief: Adds *event* to the end of the queue. A touch that follows a touch
+/// still in the queue only moves it, keeping the time of the first: what is
+/// between two steps is not seen anyway, and this way a held touch never
+/// fills the queue. Returns false when the queue was full and the event was
+/// dropped.
+bool uv_ui_input_queue_push(uv_ui_input_queue_st *this,
+		const uv_ui_input_event_st *event);
+
+/// @brief: Returns the oldest event without taking it out, or NULL when the
+/// queue is empty
+const uv_ui_input_event_st *uv_ui_input_queue_peek(const uv_ui_input_queue_st *this);
+
+/// @brief: Takes the oldest event out into *event*. Returns false when the
+/// queue is empty.
+bool uv_ui_input_queue_pop(uv_ui_input_queue_st *this, uv_ui_input_event_st *event);
+
+static inline uint16_t uv_ui_input_queue_count(const uv_ui_input_queue_st *this) {
+	return this->count;
+}
+
+
+
+/// @brief: Buckets of the latency histogram. The first 8 are a microsecond
+/// each, after that every doubling of time is split into 4, so a percentile
+/// is within 25 % of the time measured.
+#define UI_LATENCY_BUCKETS				124
+
+
+/// @brief: Histogram of latencies
+typedef struct {
+	uint16_t bucket[UI_LATENCY_BUCKETS];
+	/// @brief: Latencies added since reset
+	uint32_t count;
+	uint32_t max_us;
+} uv_ui_latency_st;
+
+
+void uv_ui_latency_reset(uv_ui_latency_st *this);
+
+/// @brief: Adds a latency of *us* microseconds. When a bucket would overflow,
+/// all of them are halved, which keeps the percentiles.
+void uv_ui_latency_add(uv_ui_latency_st *this, uint32_t us);
+
+/// @brief: Returns the latency *permille* / 1000 of the latencies added are
+/// below, as the upper edge of its bucket. 500 is the median, 990 the 99th
+/// percentile. 0 when nothing was added.
+uint32_t uv_ui_latency_percentile(const uv_ui_latency_st *this, uint16_t permille);
+
+
+#endif /* UV_HAL_INC_UV_UI_INPUT_H_ */
@@ -37,9 +37,10 @@
 ///
 /// Serializes the HAL uv_ui_draw_* commands into a compact binary command
 /// stream so that another device can rebuild the identical display. This
-/// module is the SOURCE side only: it captures one frame at a time into a
-/// single buffer and hands it to the transport (uvcan REMOTE module) which
-/// pulls the bytes with uv_ui_remote_frame_pending() / uv_ui_remote_frame_sent().
+/// module is the SOURCE side only: it captures frames into a small set of
+/// buffers and hands the newest complete one to the transport (uvcan REMOTE
+/// module) which pulls the bytes with uv_ui_remote_frame_pending() /
+/// uv_ui_remote_frame_sent().
 ///
 /// This header is included at the end of uv_ui_common.h (after the UI types are
 /// defined). The encode functions are called from the public uv_ui_draw_*
@@ -95,10 +96,201 @@ typedef enum {
 	// clearing first, which is what the dialogs running their own exec loop do:
 	// they put their window over the existing display list and swap. The sink
 	// replays its last full frame before applying this one.
-	UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP = 0x0B
+	UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP = 0x0B,
+	// Delta frame: see "delta frames" below
+	UV_UI_REMOTE_OP_FRAME_DELTA = 0x0C,
+	UV_UI_REMOTE_OP_COPY        = 0x0D,
+	// Palette entry: see "color modes" below
+	UV_UI_REMOTE_OP_COLOR       = 0x0E
 } uv_ui_remote_op_e;
 
 
+// --- color modes -------------------------------------------------------------
+//
+// Every drawing op carries a color, and on a typical screen a color field is a
+// fifth of the stream, so a sink that can take them narrower is sent them
+// narrower. The layout above is ARGB8888, the mode every sink understands. The
+// other two change only the width of the color field of each op - nothing
+// moves but the fields after it:
+//
+//   RGB565:  2 bytes, 5-6-5 bits, alpha dropped. Translucent colors arrive
+//            opaque, so this is for sinks that cannot do better.
+//   PALETTE: 1 byte, an index into a palette of 256 entries that the frame
+//            itself fills in with COLOR ops:
+//
+//     COLOR (6):  [op:1][index:1][color:4]
+//
+//            An index stands for the color the last COLOR op before it gave
+//            it, counting from the start of the frame. Every frame defines the
+//            colors it uses, so a frame is understood without the one before
+//            it, and the encoder keeps an index for a color for as long as it
+//            can, so a screen that did not change codes to the same bytes and
+//            delta frames work as well as ever. FRAME_BEGIN keeps its full
+//            color in this mode, since nothing can precede it.
+//
+// The source chooses the mode of each frame from what the sink says it can
+// decode: RGB565 when it can, and the palette mode when that codes the frame
+// smaller still, which it does not on a screen with few ops of each color.
+// The transport marks each frame with the mode it is in. A delta frame is
+// always in the mode of its base.
+typedef enum {
+	UV_UI_REMOTE_COLOR_ARGB8888 = 0,
+	UV_UI_REMOTE_COLOR_RGB565,
+	UV_UI_REMOTE_COLOR_PALETTE,
+	UV_UI_REMOTE_COLOR_MODE_COUNT
+} uv_ui_remote_color_mode_e;
+
+#define UV_UI_REMOTE_COLOR_LEN			6
+#define UV_UI_REMOTE_PALETTE_SIZE		256
+
+/// @brief: Color modes a sink can decode beyond ARGB8888, as it reports them.
+/// Deliberately the same bit positions the transport uses, so it passes them
+/// straight through.
+#define UV_UI_REMOTE_CAP_RGB565			(1 << 0)
+#define UV_UI_REMOTE_CAP_PALETTE		(1 << 1)
+
+/// @brief: Marks a frame coded in the RGB565 / palette mode, in the same bit
+/// positions the transport uses for the chunks of a UI frame
+#define UV_UI_REMOTE_FRAME_FLAG_RGB565	(1 << 2)
+#define UV_UI_REMOTE_FRAME_FLAG_PALETTE	(1 << 3)
+
+/// @brief: Palette of one end of the stream. The source keeps it across
+/// frames, which is what keeps the indexes of a screen stable; the sink only
+/// needs it while restoring a frame.
+typedef struct {
+	uint32_t color[UV_UI_REMOTE_PALETTE_SIZE];
+	// when each entry was last used, counted in colors coded, so that the one
+	// given up for a new color is the one unused for longest. 0 for never.
+	uint32_t stamp[UV_UI_REMOTE_PALETTE_SIZE];
+	uint16_t count;
+	uint32_t uses;
+} uv_ui_remote_palette_st;
+
+/// @brief: Bytes a color field takes in *mode*
+uint8_t uv_ui_remote_color_len(uv_ui_remote_color_mode_e mode);
+
+/// @brief: ARGB8888 to RGB565 and back. Alpha comes back as 0xFF.
+uint16_t uv_ui_remote_rgb565(uint32_t argb);
+uint32_t uv_ui_remote_rgb565_argb(uint16_t c);
+
+/// @brief: Empties the palette, as at the start of a session
+void uv_ui_remote_palette_init(uv_ui_remote_palette_st *this);
+
+/// @brief: Source side: rewrites a whole ARGB8888 frame into *dest* in *mode*.
+///
+/// @param palette: the session's palette, used and updated in the palette
+/// mode only
+///
+/// @return: length of the frame in *mode*, or 0 when *frame* is malformed or
+/// the result does not fit in *dest_len* bytes. The frame should then be sent
+/// as it is.
+uint16_t uv_ui_remote_color_convert(uv_ui_remote_palette_st *palette,
+		uv_ui_remote_color_mode_e mode, const uint8_t *frame, uint16_t len,
+		uint8_t *dest, uint16_t dest_len);
+
+/// @brief: Source side: the length a whole ARGB8888 frame would have in
+/// *mode* without any COLOR ops, which is its length in the RGB565 and
+/// ARGB8888 modes. Nothing is written. 0 when *frame* is malformed.
+uint16_t uv_ui_remote_color_size(uv_ui_remote_color_mode_e mode,
+		const uint8_t *frame, uint16_t len);
+
+/// @brief: Sink side: rewrites a whole frame in *mode*, as received or as
+/// rebuilt from a delta, back into ARGB8888 for a sink that draws that
+///
+/// @param palette: workspace for the palette mode, needs no initialising
+///
+/// @return: length of the ARGB8888 frame, or 0 when *frame* is malformed or
+/// the result does not fit in *dest_len* bytes
+uint16_t uv_ui_remote_color_restore(uv_ui_remote_palette_st *palette,
+		uv_ui_remote_color_mode_e mode, const uint8_t *frame, uint16_t len,
+		uint8_t *dest, uint16_t dest_len);
+
+
+// --- delta frames ------------------------------------------------------------
+//
+// Most frames differ from the one before by a few ops - a value that ticked, a
+// cursor that blinked - so instead of the whole command stream the encoder
+// sends what changed, against the last frame the transport finished sending:
+//
+//   FRAME_DELTA (9):  [op:1][base_hash:4][frame_hash:4]
+//   COPY        (5):  [op:1][first:2][count:2]
+//
+// A delta frame opens with FRAME_DELTA in place of FRAME_BEGIN /
+// FRAME_BEGIN_KEEP, and is followed by a mix of ordinary ops and COPY ops up to
+// and including a FRAME_END. COPY stands for *count* consecutive ops of the
+// base frame, starting from op index *first*, where op 0 is the base frame's
+// own FRAME_BEGIN or FRAME_BEGIN_KEEP. Expanding the COPY ops rebuilds the new
+// frame exactly as the encoder captured it, opening op included, so from then
+// on the sink handles it like any other frame. FRAME_END is never copied: a
+// delta frame always ends with a literal one.
+//
+// base_hash and frame_hash are the FNV-1a hashes (uv_ui_remote_frame_hash())
+// of the whole base frame and the whole rebuilt frame. A sink that does not
+// hold a frame hashing to base_hash, or rebuilds one that does not hash to
+// frame_hash, has lost a frame somewhere: it drops the delta and asks for a
+// screen again, and a request for a screen is always answered with a full
+// frame. Full frames are also sent every CONFIG_UI_REMOTE_KEYFRAME_INTERVAL
+// frames regardless, so a sink that never notices is behind for a bounded time.
+
+/// @brief: Maximum number of ops in a frame that a delta can be computed
+/// against. A frame with more is always sent whole.
+#if !defined(CONFIG_UI_REMOTE_DELTA_OPS_MAX)
+#define CONFIG_UI_REMOTE_DELTA_OPS_MAX		256
+#endif
+
+#define UV_UI_REMOTE_FRAME_DELTA_LEN	9
+#define UV_UI_REMOTE_COPY_LEN			5
+
+/// @brief: Where each op of a frame starts, and a hash of each op, so that two
+/// frames can be compared op by op without parsing either again.
+typedef struct {
+	uint16_t count;
+	uint16_t off[CONFIG_UI_REMOTE_DELTA_OPS_MAX + 1];
+	uint32_t hash[CONFIG_UI_REMOTE_DELTA_OPS_MAX];
+} uv_ui_remote_frame_index_st;
+
+/// @brief: FNV-1a hash of *len* bytes, as used for base_hash and frame_hash
+uint32_t uv_ui_remote_frame_hash(const uint8_t *data, uint16_t len);
+
+/// @brief: Length of the op at the start of *data* in color mode *mode*,
+/// including its opcode, or 0 for an unknown opcode or an op that does not fit
+/// in *len* bytes
+uint16_t uv_ui_remote_op_len(uv_ui_remote_color_mode_e mode,
+		const uint8_t *data, uint16_t len);
+
+/// @brief: Indexes the ops of a whole frame in color mode *mode* into *idx*.
+///
+/// @return: false if the frame is malformed or has more than
+/// CONFIG_UI_REMOTE_DELTA_OPS_MAX ops
+bool uv_ui_remote_frame_index(uv_ui_remote_frame_index_st *idx,
+		uv_ui_remote_color_mode_e mode, const uint8_t *frame, uint16_t len);
+
+/// @brief: Writes *frame* into *dest* as a delta frame against *base*.
+/// Both frames have to be indexed first.
+///
+/// @return: length of the delta frame, or 0 when it would not be shorter than
+/// *frame* itself or does not fit in *dest_len* bytes. The frame should then be
+/// sent whole.
+uint16_t uv_ui_remote_delta_encode(
+		const uint8_t *base, const uv_ui_remote_frame_index_st *base_idx,
+		const uint8_t *frame, const uv_ui_remote_frame_index_st *frame_idx,
+		uint8_t *dest, uint16_t dest_len);
+
+/// @brief: Sink side: rebuilds the frame a delta frame stands for into *dest*.
+///
+/// @param mode: the color mode the delta came in, which is the base's too
+/// @param base: the last frame the sink rebuilt or received whole, as it came
+/// in rather than restored to ARGB8888
+///
+/// @return: length of the rebuilt frame, or 0 when *delta* is malformed, does
+/// not apply to *base*, or the result does not fit in *dest_len* bytes. The
+/// sink should then ask for a screen again.
+uint16_t uv_ui_remote_delta_apply(uv_ui_remote_color_mode_e mode,
+		const uint8_t *base, uint16_t base_len,
+		const uint8_t *delta, uint16_t delta_len,
+		uint8_t *dest, uint16_t dest_len);
+
+
 // --- assets ------------------------------------------------------------------
 //
 // The command stream refers to fonts and bitmaps but does not carry them: a
@@ -112,6 +304,14 @@ typedef enum {
 #define UV_UI_REMOTE_ASSET_KIND_FONT	0
 #define UV_UI_REMOTE_ASSET_KIND_BITMAP	1
 
+/// @brief: Flag on the kind byte of a UI_ASSET_REQ and of the asset header.
+/// A sink that decodes run-length coded assets sets it in its request; the
+/// answer then has it set when the payload is run-length coded, see
+/// "asset compression" below. A sink that leaves it clear gets the asset
+/// as it is stored, so older sinks keep working unchanged.
+#define UV_UI_REMOTE_ASSET_KIND_RLE		(1 << 7)
+#define UV_UI_REMOTE_ASSET_KIND_MASK	0x7F
+
 /// @brief: Asset payload bytes per chunk. The link carries at most 200 bytes per
 /// UI chunk, and the first asset chunk spends 9 of them on the header below, so
 /// every chunk is sized for the worst case and fits whichever it turns out to
@@ -146,6 +346,145 @@ typedef enum {
 #define UV_UI_REMOTE_FONT_BODY_HDR_LEN	(7 + UV_UI_REMOTE_FONT_WIDTHS)
 
 
+// --- asset compression --------------------------------------------------------
+//
+// Glyph atlases are mostly blank and UI bitmaps mostly flat, so assets are
+// coded with a byte-wise run-length code that either end can run chunk by chunk
+// without holding the whole asset: the source codes straight out of flash with
+// a small window, the sink decodes each chunk as it arrives. The payload bytes
+// of all chunks of the asset, after the header, form one stream of:
+//
+//   [0x00..0x7F][n+1 literal bytes]    n+1 = 1..128 bytes copied as they are
+//   [0x80..0xFF][byte]                 the byte repeated (c - 0x80 + 2) = 2..129 times
+//
+// total_len in the header is the decoded length. The source never splits one
+// of these across chunks, but the decoder does not rely on that.
+
+/// @brief: Source window in bytes. The coder only decides on a run once it can
+/// see as far as the longest one, so it needs this much of the asset at a time.
+#define UV_UI_REMOTE_RLE_WINDOW			256
+#define UV_UI_REMOTE_RLE_LOOKAHEAD		130
+
+/// @brief: Source side state of a run-length coded asset
+typedef struct {
+	uint8_t window[UV_UI_REMOTE_RLE_WINDOW];
+	uint16_t len;
+} uv_ui_remote_rle_enc_st;
+
+/// @brief: Sink side state of a run-length coded asset
+typedef struct {
+	// bytes still to come of the current literal or run, and which
+	uint8_t left;
+	bool run;
+} uv_ui_remote_rle_dec_st;
+
+/// @brief: Clears the coder for a new asset
+void uv_ui_remote_rle_enc_init(uv_ui_remote_rle_enc_st *this);
+
+/// @brief: Room left in the window. The caller copies up to this many bytes of
+/// the asset to &this->window[this->len] and adds them to this->len.
+uint16_t uv_ui_remote_rle_enc_space(const uv_ui_remote_rle_enc_st *this);
+
+/// @brief: Codes from the window into *dest* as far as *dest_len* allows.
+///
+/// @param last: true when the window holds the rest of the asset. Until then
+/// the window is only coded down to UV_UI_REMOTE_RLE_LOOKAHEAD bytes, so the
+/// result never depends on where the window happened to be refilled.
+///
+/// @return: bytes written to *dest*
+uint16_t uv_ui_remote_rle_encode(uv_ui_remote_rle_enc_st *this, bool last,
+		uint8_t *dest, uint16_t dest_len);
+
+/// @brief: Clears the decoder for a new asset
+void uv_ui_remote_rle_dec_init(uv_ui_remote_rle_dec_st *this);
+
+/// @brief: Decodes the next *len* payload bytes of an asset into *dest*.
+///
+/// @return: bytes written to *dest*. Output past *dest_len* is dropped, so a
+/// sink decoding straight into a buffer of total_len bytes cannot overrun it.
+uint32_t uv_ui_remote_rle_decode(uv_ui_remote_rle_dec_st *this,
+		const uint8_t *src, uint16_t len, uint8_t *dest, uint32_t dest_len);
+
+
+// --- reference sink -----------------------------------------------------------
+//
+// A decoder that draws whole frames of the command stream into an ARGB8888
+// framebuffer in memory, so that a sink has something to start from rather
+// than a specification, and so that the stream can be checked and measured on
+// a desk. Shapes are drawn the way the host backends draw them: rectangle
+// corners of *radius*, lines *width* wide with round ends, polygons and the
+// filled strips by the even-odd rule. Edges are not antialiased; text is, by
+// the 4-bit glyph atlas.
+//
+// Every shape is cut into horizontal spans and each span filled or blended in
+// one loop over the row, which is the part that takes the time and the part
+// the compiler turns into vector code.
+
+/// @brief: A bitmap as the sink decoded it from its asset: ARGB8888 pixels,
+/// *width* to a row
+typedef struct {
+	const uint32_t *pixels;
+	uint16_t width;
+	uint16_t height;
+} uv_ui_remote_image_st;
+
+/// @brief: Returns the font asset body (see UV_UI_REMOTE_FONT_BODY_HDR_LEN)
+/// the sink holds for *font_id* and its length in *len*, or NULL when it has
+/// none yet. Strings in a font without glyphs are not drawn.
+typedef const uint8_t *(*uv_ui_remote_font_get_t)(void *user, uint8_t font_id,
+		uint32_t *len);
+
+/// @brief: Fills *dest* with the decoded bitmap for *id* and returns true, or
+/// returns false when the sink does not have it yet
+typedef bool (*uv_ui_remote_image_get_t)(void *user, uint32_t id,
+		uv_ui_remote_image_st *dest);
+
+typedef struct {
+	uint32_t *fb;
+	uint16_t width;
+	uint16_t height;
+	// pixels from one row to the next
+	uint16_t stride;
+	// the MASK in effect, clipped to the framebuffer: x0 <= x < x1
+	int16_t clip_x0;
+	int16_t clip_y0;
+	int16_t clip_x1;
+	int16_t clip_y1;
+	uv_ui_remote_font_get_t font_callb;
+	uv_ui_remote_image_get_t image_callb;
+	void *user;
+	uint32_t palette[UV_UI_REMOTE_PALETTE_SIZE];
+} uv_ui_remote_raster_st;
+
+/// @brief: Draws into *fb*, *width* x *height* pixels, *stride* pixels a row
+void uv_ui_remote_raster_init(uv_ui_remote_raster_st *this, uint32_t *fb,
+		uint16_t width, uint16_t height, uint16_t stride);
+
+/// @brief: Installs where the fonts and bitmaps come from. Without them
+/// strings and bitmaps are skipped.
+void uv_ui_remote_raster_set_assets(uv_ui_remote_raster_st *this,
+		uv_ui_remote_font_get_t font_callb, uv_ui_remote_image_get_t image_callb,
+		void *user);
+
+/// @brief: Draws a whole frame in color mode *mode*, as received or rebuilt
+/// from a delta. A FRAME_BEGIN_KEEP frame draws over what the framebuffer
+/// holds.
+///
+/// @return: false when the frame is malformed. What was drawn up to that
+/// point stays drawn.
+bool uv_ui_remote_raster_frame(uv_ui_remote_raster_st *this,
+		uv_ui_remote_color_mode_e mode, const uint8_t *frame, uint16_t len);
+
+/// @brief: Draws commands that are not a whole frame, for a backend that draws
+/// each call as it is made. The mask and the palette carry over from one call
+/// to the next; FRAME_BEGIN clears the framebuffer and the mask as in a frame,
+/// and FRAME_END stops the drawing.
+///
+/// @return: false when the commands are malformed
+bool uv_ui_remote_raster_ops(uv_ui_remote_raster_st *this,
+		uv_ui_remote_color_mode_e mode, const uint8_t *ops, uint16_t len);
+
+
 /// @brief: Reverse input action byte (sink -> source). The sink reports raw
 /// press / release; this device's existing uv_uidisplay_step gesture state
 /// machine derives DRAG / CLICK from the stream.
@@ -159,12 +498,50 @@ typedef enum {
 
 #if CONFIG_UI_REMOTE
 
-/// @brief: Size of the single frame command buffer in bytes. A frame that
-/// exceeds this is dropped (never truncated / partially sent).
+/// @brief: Size of a frame command buffer in bytes. A frame that exceeds this
+/// is dropped (never truncated / partially sent).
 #if !defined(CONFIG_UI_REMOTE_BUFFER_SIZE)
 #define CONFIG_UI_REMOTE_BUFFER_SIZE	4096
 #endif
 
+/// @brief: Number of frame buffers. With two the UI task can always capture
+/// the newest screen while the transport sends the last one, so no screen is
+/// lost to a slow link. One halves the RAM and brings back the old behaviour:
+/// a screen drawn during a transmit is skipped and redrawn afterwards. Every
+/// buffer costs CONFIG_UI_REMOTE_BUFFER_SIZE, twice that with
+/// CONFIG_UI_REMOTE_DELTA.
+#if !defined(CONFIG_UI_REMOTE_FRAME_BUFFERS)
+#define CONFIG_UI_REMOTE_FRAME_BUFFERS	2
+#endif
+#if (CONFIG_UI_REMOTE_FRAME_BUFFERS < 1) || (CONFIG_UI_REMOTE_FRAME_BUFFERS > 8)
+#error "CONFIG_UI_REMOTE_FRAME_BUFFERS should be between 1 and 8"
+#endif
+
+/// @brief: Enables delta frames. Costs a second frame sized buffer for the
+/// delta and a uv_ui_remote_frame_index_st per frame buffer: with the defaults
+/// 2 x (4096 + 1540) bytes, about 11 kB of static RAM. That is a lot on the LPC
+/// parts, so it is on by default only on Linux and Windows.
+#if !defined(CONFIG_UI_REMOTE_DELTA)
+#if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
+#define CONFIG_UI_REMOTE_DELTA			1
+#else
+#define CONFIG_UI_REMOTE_DELTA			0
+#endif
+#endif
+
+/// @brief: A full frame is sent at least this often, counted in frames sent,
+/// however well the deltas are doing.
+#if !defined(CONFIG_UI_REMOTE_KEYFRAME_INTERVAL)
+#define CONFIG_UI_REMOTE_KEYFRAME_INTERVAL	50
+#endif
+
+/// @brief: Enables the RGB565 and palette color modes for sinks that ask for
+/// them. Costs a uv_ui_remote_palette_st, and a frame sized buffer without
+/// CONFIG_UI_REMOTE_DELTA.
+#if !defined(CONFIG_UI_REMOTE_COLOR_MODES)
+#define CONFIG_UI_REMOTE_COLOR_MODES	1
+#endif
+
 /// @brief: Maximum number of distinct bitmap assets that can be registered and
 /// referenced by a compact id on the wire.
 #if !defined(CONFIG_UI_REMOTE_ASSET_MAX)
@@ -178,11 +555,35 @@ typedef enum {
 #define CONFIG_UI_REMOTE_ASSET_REQ_MAX	4
 #endif
 
-// One chunk is prepared per frame boundary, since that is where the UI task can
-// safely read flash, and only one is in flight at a time. That paces a transfer
-// at 192 bytes per frame - about 9 kB/s at 20 ms frames, so well under a second
-// for a bitmap and a few seconds for a full glyph atlas. Raising it means
-// staging several chunks, which is a ring buffer rather than a constant.
+/// @brief: Number of asset chunks that can be staged for the transport at
+/// once, each UV_UI_REMOTE_ASSET_HDR_LEN + UV_UI_REMOTE_ASSET_CHUNK bytes of
+/// RAM. A power of two.
+#if !defined(CONFIG_UI_REMOTE_ASSET_CHUNKS)
+#define CONFIG_UI_REMOTE_ASSET_CHUNKS	4
+#endif
+#if (CONFIG_UI_REMOTE_ASSET_CHUNKS & (CONFIG_UI_REMOTE_ASSET_CHUNKS - 1)) || \
+	(CONFIG_UI_REMOTE_ASSET_CHUNKS > 128)
+#error "CONFIG_UI_REMOTE_ASSET_CHUNKS should be a power of two, at most 128"
+#endif
+
+/// @brief: Asset bytes read per frame boundary at most. This is what paces a
+/// transfer: the default is about 38 kB/s at 20 ms frames.
+#if !defined(CONFIG_UI_REMOTE_ASSET_FRAME_BUDGET)
+#define CONFIG_UI_REMOTE_ASSET_FRAME_BUDGET	(4 * UV_UI_REMOTE_ASSET_CHUNK)
+#endif
+
+/// @brief: Time in ms the UI task may spend reading asset chunks at one frame
+/// boundary, for providers reading slow storage
+#if !defined(CONFIG_UI_REMOTE_ASSET_TIME_BUDGET_MS)
+#define CONFIG_UI_REMOTE_ASSET_TIME_BUDGET_MS	2
+#endif
+
+// Chunks are read at frame boundaries, since that is where the UI task can
+// safely read flash, into a ring of CONFIG_UI_REMOTE_ASSET_CHUNKS that the
+// transport drains in order, so several can be in flight at once. A frame
+// boundary reads until the ring is full or either budget above runs out, and
+// the ring hands out nothing while a finished screen is waiting for the
+// transport, so assets fill the gaps between frames rather than delaying them.
 
 /// @brief: Initializes the remote UI encoder (disabled until a sink connects).
 void uv_ui_remote_init(void);
@@ -191,7 +592,9 @@ void uv_ui_remote_init(void);
 /// asset registry.
 void uv_ui_remote_reset(void);
 
-/// @brief: Housekeeping hook (currently a no-op). Kept for lifecycle symmetry.
+/// @brief: Stages the chunks of the asset transfers in progress, as each frame
+/// boundary does, so that they go on while no frames are drawn. Called by the
+/// UI task from uv_uidisplay_step, between frames.
 void uv_ui_remote_step(uint16_t step_ms);
 
 /// @brief: Enables / disables mirroring. The transport enables this when a
@@ -202,6 +605,16 @@ void uv_ui_remote_set_enabled(bool enabled);
 /// @brief: True when mirroring is active (a sink is connected).
 bool uv_ui_remote_active(void);
 
+/// @brief: Records the UV_UI_REMOTE_CAP_* bits the sink reported. Called from
+/// the transport task.
+///
+/// From the next frame on, each frame goes in the mode that codes it smallest
+/// of those both ends support, RGB565 when the palette mode is no smaller. A
+/// frame in another mode than the one before it goes whole. A sink that
+/// reports nothing is sent ARGB8888, and so is every sink until it has
+/// reported, so a reconnect starts from there again.
+void uv_ui_remote_set_sink_caps(uint8_t caps);
+
 
 /// @brief: Asks for the screen to be drawn again and sent, because a sink is
 /// waiting on one.
@@ -216,11 +629,11 @@ void uv_ui_remote_request_frame(void);
 
 /// @brief: True when the screen should be drawn again for the sink's benefit.
 ///
-/// Only one frame is held at a time, so a screen drawn while the transport is
-/// still sending the last one cannot be captured and is lost. That is normally
-/// harmless - the screen after it is captured instead - but if the display then
-/// stops changing there is no screen after it, and the sink is left showing
-/// something the device moved on from, indefinitely.
+/// A screen that could not be captured - every buffer busy, which takes a
+/// single buffer being transmitted, or a frame too big for one - is lost. That
+/// is normally harmless - the screen after it is captured instead - but if the
+/// display then stops changing there is no screen after it, and the sink is
+/// left showing something the device moved on from, indefinitely.
 ///
 /// This asks for one more draw in exactly that case: a screen was drawn, it was
 /// missed, and no later one has replaced it. A display that is not changing
@@ -278,33 +691,64 @@ void uv_ui_remote_asset_requested(uint8_t kind, uint32_t id);
 /// instead of reading from something that is no longer there.
 void uv_ui_remote_asset_cancel(uint8_t kind, uint32_t id);
 
-/// @brief: Returns true and points *data / *len at the next prepared asset
+/// @brief: Returns true and points *data / *len at the oldest staged asset
 /// chunk, with *flags carrying REMOTE_UI_FLAG_FRAME_START / _END equivalents
 /// for the asset (first / last chunk). The buffer is owned by the encoder and
 /// stays valid until uv_ui_remote_asset_chunk_sent().
 bool uv_ui_remote_asset_chunk_pending(const uint8_t **data, uint16_t *len,
 		uint8_t *flags);
 
-/// @brief: Releases the chunk returned above once it is on the link.
+/// @brief: Releases the chunk returned above once it is on the link. The next
+/// one staged, if any, is returned by the next call to
+/// uv_ui_remote_asset_chunk_pending().
 void uv_ui_remote_asset_chunk_sent(void);
 
 
+/// @brief: Asset transfer metrics, for tuning the budgets above
+typedef struct {
+	// the last transfer to complete: its last chunk went on the link
+	uint8_t last_kind;
+	uint32_t last_id;
+	uint32_t last_bytes;
+	// from opening the transfer to its last chunk being sent
+	uint32_t last_ms;
+	// since the last uv_ui_remote_reset()
+	uint32_t transfers;
+	uint32_t total_bytes;
+	// chunk bytes put on the link, headers included. Against total_bytes this
+	// is what run-length coding saves.
+	uint32_t wire_bytes;
+} uv_ui_remote_asset_stats_st;
+
+/// @brief: Copies the asset transfer metrics to *dest*
+void uv_ui_remote_get_asset_stats(uv_ui_remote_asset_stats_st *dest);
+
+
 // --- transport pull interface (called by the uvcan REMOTE module) -----------
 
-/// @brief: Returns true and points *data / *len at the completed frame buffer
-/// when a frame is ready to transmit. The buffer is owned by the encoder and is
-/// stable until uv_ui_remote_frame_sent() is called.
+/// @brief: Returns true and points *data / *len at the newest completed frame
+/// when one is ready to transmit. Frames completed while an earlier one was
+/// still waiting replace it, so a slow link skips screens rather than falling
+/// behind. With CONFIG_UI_REMOTE_DELTA this may be a
+/// delta frame rather than the frame itself. The buffer is owned by the encoder
+/// and is stable until uv_ui_remote_frame_sent() is called.
 bool uv_ui_remote_frame_pending(const uint8_t **data, uint16_t *len);
 
+/// @brief: UV_UI_REMOTE_FRAME_FLAG_* bits of the pending frame, for the
+/// transport to set on each of its chunks. 0 for an ARGB8888 frame.
+uint8_t uv_ui_remote_frame_flags(void);
+
 /// @brief: Called by the transport once the whole pending frame has been
-/// written to the link. Releases the buffer; gathering of the next frame
-/// resumes at the following frame boundary (dlswap).
+/// written to the link. Releases the buffer. The frame becomes the one the
+/// next delta frame is computed against.
 void uv_ui_remote_frame_sent(void);
 
 
 // --- reverse input (sink -> source) -----------------------------------------
 
 /// @brief: Injects a remote input event. Called from the transport rx handler.
+/// The touch, scroll and key are pushed into the UI input queue, see
+/// uv_ui_input_push().
 void uv_ui_remote_input_inject(uint8_t action, int16_t x, int16_t y,
 		int16_t scroll, char key);
 
@@ -312,13 +756,6 @@ void uv_ui_remote_input_inject(uint8_t action, int16_t x, int16_t y,
 /// uv_ui_get_touch() wrapper.
 bool uv_ui_remote_get_touch(int16_t *x, int16_t *y);
 
-/// @brief: Returns and clears accumulated remote scroll notches.
-int16_t uv_ui_remote_get_scroll(void);
-
-/// @brief: Returns and clears the last remote key press ('\0' if none).
-char uv_ui_remote_get_key(void);
-
-
 // --- encode hooks (called from the uv_ui_draw_* wrappers in uv_ui_common.c) --
 
 void uv_ui_remote_encode_clear(color_t c);
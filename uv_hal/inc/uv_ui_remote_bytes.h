@@ -0,0 +1,87 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_INC_UV_UI_REMOTE_BYTES_H_
+#define UV_HAL_INC_UV_UI_REMOTE_BYTES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/// @file: Byte helpers shared by the remote UI coders. Only for their inner
+/// use: the fields of the remote UI stream are little endian, and a frame is
+/// written through a writer that stops at the end of its buffer instead of
+/// passing it.
+
+
+/// @brief: Append target for a frame being written
+typedef struct {
+	uint8_t *dest;
+	uint16_t len;
+	uint16_t max;
+	/// @brief: Set once a write did not fit. Nothing is written after that.
+	bool overflow;
+} _uv_ui_remote_writer_st;
+
+
+/// @brief: Appends *len* bytes from *data* to *w*, or sets its overflow
+/// flag when they do not fit
+static inline void _uv_ui_remote_wr(_uv_ui_remote_writer_st *w,
+		const uint8_t *data, uint16_t len) {
+	if (!w->overflow && ((uint32_t) w->len + len <= w->max)) {
+		memcpy(&w->dest[w->len], data, len);
+		w->len = (uint16_t) (w->len + len);
+	}
+	else {
+		w->overflow = true;
+	}
+}
+
+
+static inline void _uv_ui_remote_put32(uint8_t *dest, uint32_t v) {
+	dest[0] = (uint8_t) (v & 0xFFu);
+	dest[1] = (uint8_t) ((v >> 8) & 0xFFu);
+	dest[2] = (uint8_t) ((v >> 16) & 0xFFu);
+	dest[3] = (uint8_t) ((v >> 24) & 0xFFu);
+}
+
+
+static inline uint16_t _uv_ui_remote_get16(const uint8_t *src) {
+	return (uint16_t) (src[0] | (src[1] << 8));
+}
+
+
+static inline uint32_t _uv_ui_remote_get32(const uint8_t *src) {
+	return (uint32_t) src[0] |
+			((uint32_t) src[1] << 8) |
+			((uint32_t) src[2] << 16) |
+			((uint32_t) src[3] << 24);
+}
+
+
+#endif /* UV_HAL_INC_UV_UI_REMOTE_BYTES_H_ */
@@ -30,6 +30,7 @@
 #include "canopen/canopen_obj_dict.h"
 #include "uv_canopen.h"
 #include "uv_terminal.h"
+#include "uv_cputime.h"
 #include <string.h>
 #include CONFIG_MAIN_H
 #if CONFIG_W25Q128
@@ -82,6 +83,16 @@ extern uint32_t CONFIG_CANOPEN_OBJ_DICT_APP_PARAMS_COUNT (void);
 	.data_ptr = &CONFIG_NON_VOLATILE_START.canopen_data.txpdo_maps[x] \
 	}, \
 
+#define CPUTIME_OBJ(x)	{ \
+	.main_index = CONFIG_CANOPEN_CPUTIME_INDEX + x, \
+	.array_max_size = CPUTIME_OBJ_LEN, \
+	.permissions = CANOPEN_RO, \
+	.type = CANOPEN_ARRAY32, \
+	.data_ptr = &_uv_cputime[x] \
+	}, \
+
+#define CPUTIME_APP_OBJ(x)	CPUTIME_OBJ(CPUTIME_APP + x)
+
 
 
 const canopen_object_st com_params[] = {
@@ -230,6 +241,10 @@ const canopen_object_st com_params[] = {
 				.permissions = CANOPEN_RW,
 				.data_ptr = &exmem_clear_req
 		},
+#endif
+#if CONFIG_CPUTIME
+		REPEAT(CPUTIME_HAL_SLOTS, CPUTIME_OBJ)
+		REPEAT(CONFIG_CPUTIME_APP_SLOTS, CPUTIME_APP_OBJ)
 #endif
 		{
 				.main_index = CONFIG_CANOPEN_IDENTITY_INDEX,
@@ -97,6 +97,8 @@ uv_uiobject_ret_e uv_uibutton_step(void *me, uint16_t step_ms) {
 	}
 	else {
 		uv_delay_init(&this->delay, CONFIG_UI_BUTTON_LONGPRESS_DELAY_MS);
+		// nothing to count until the button is pressed again
+		ret |= UIOBJECT_RETURN_IDLE;
 	}
 
 	return ret;
@@ -0,0 +1,326 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "uv_uichart.h"
+
+
+#if CONFIG_UI
+
+
+
+void uv_uichart_trace_init(uv_uichart_trace_st *this,
+		int16_t *samples, uint16_t samples_len,
+		uv_uichart_column_st *columns, uint16_t columns_len, color_t color) {
+	this->samples = samples;
+	this->samples_len = (samples == NULL) ? 0 : samples_len;
+	this->sample_head = 0;
+	this->sample_count = 0;
+	this->columns = columns;
+	this->columns_len = (columns == NULL) ? 0 : columns_len;
+	this->column_head = 0;
+	this->column_count = 0;
+	this->acc_count = 0;
+	this->held = 0;
+	this->color = color;
+}
+
+
+/// @brief: Adds *value* to the column being filled. Returns true when the
+/// column was complete and added to the trace.
+static bool trace_add(uv_uichart_trace_st *this, int16_t value,
+		uint16_t samples_per_px) {
+	bool ret = false;
+	if (this->acc_count == 0) {
+		this->acc.min = value;
+		this->acc.max = value;
+	}
+	else {
+		this->acc.min = MIN(this->acc.min, value);
+		this->acc.max = MAX(this->acc.max, value);
+	}
+	this->acc_count++;
+	if ((this->acc_count >= samples_per_px) &&
+			(this->columns_len != 0)) {
+		this->columns[this->column_head] = this->acc;
+		this->column_head = (this->column_head + 1 == this->columns_len) ?
+				0 : this->column_head + 1;
+		if (this->column_count < this->columns_len) {
+			this->column_count++;
+		}
+		this->acc_count = 0;
+		ret = true;
+	}
+	return ret;
+}
+
+
+static void trace_clear_columns(uv_uichart_trace_st *this) {
+	this->column_head = 0;
+	this->column_count = 0;
+	this->acc_count = 0;
+	this->held = 0;
+}
+
+
+/// @brief: Returns the column *back* columns before the newest one.
+/// *back* should be less than column_count.
+static inline const uv_uichart_column_st *trace_column(
+		const uv_uichart_trace_st *this, uint16_t back) {
+	int32_t i = (int32_t) this->column_head - 1 - back;
+	if (i < 0) {
+		i += this->columns_len;
+	}
+	return &this->columns[i];
+}
+
+
+
+#define this ((uv_uichart_st*)me)
+
+
+
+void uv_uichart_init(void *me, uv_uichart_trace_st *traces, uint8_t trace_count,
+		uv_ui_linestrip_point_st *strip_buffer, uint16_t strip_len,
+		uint16_t samples_per_px, int32_t min_x, int32_t max_x,
+		int32_t min_y, int32_t max_y, const uv_uistyle_st *style) {
+	uv_uigraph_init(this, NULL, 0, min_x, max_x, min_y, max_y, style);
+	this->traces = traces;
+	this->trace_count = trace_count;
+	this->strip = strip_buffer;
+	this->strip_len = strip_len;
+	this->samples_per_px = MAX(samples_per_px, 1);
+	this->scroll = 0;
+	this->paused = false;
+	this->autoscale = false;
+	this->dragging = false;
+
+	uv_uiobject_set_draw_callb(this, &uv_uichart_draw);
+	uv_uiobject_set_touch_callb(this, &uv_uichart_touch);
+}
+
+
+void uv_uichart_push(void *me, uint8_t trace, int16_t value) {
+	if (trace < this->trace_count) {
+		uv_uichart_trace_st *t = &this->traces[trace];
+		if (t->samples_len != 0) {
+			t->samples[t->sample_head] = value;
+			t->sample_head = (t->sample_head + 1 == t->samples_len) ?
+					0 : t->sample_head + 1;
+			if (t->sample_count < t->samples_len) {
+				t->sample_count++;
+			}
+		}
+		if (trace_add(t, value, this->samples_per_px)) {
+			if (this->paused) {
+				if (t->held < UINT16_MAX) {
+					t->held++;
+				}
+			}
+			else {
+				uv_ui_refresh(this);
+			}
+		}
+	}
+}
+
+
+void uv_uichart_clear(void *me) {
+	for (uint8_t i = 0; i < this->trace_count; i++) {
+		this->traces[i].sample_head = 0;
+		this->traces[i].sample_count = 0;
+		trace_clear_columns(&this->traces[i]);
+	}
+	this->scroll = 0;
+	uv_ui_refresh(this);
+}
+
+
+void uv_uichart_set_samples_per_px(void *me, uint16_t value) {
+	value = MAX(value, 1);
+	if (value != this->samples_per_px) {
+		this->samples_per_px = value;
+		for (uint8_t i = 0; i < this->trace_count; i++) {
+			uv_uichart_trace_st *t = &this->traces[i];
+			trace_clear_columns(t);
+			// make the columns again from the oldest sample to the newest
+			int32_t s = (int32_t) t->sample_head - t->sample_count;
+			if (s < 0) {
+				s += t->samples_len;
+			}
+			for (uint16_t j = 0; j < t->sample_count; j++) {
+				trace_add(t, t->samples[s], value);
+				s = (s + 1 == t->samples_len) ? 0 : s + 1;
+			}
+		}
+		this->scroll = 0;
+		uv_ui_refresh(this);
+	}
+}
+
+
+void uv_uichart_set_paused(void *me, bool value) {
+	if (value != this->paused) {
+		this->paused = value;
+		if (!value) {
+			// back to the newest samples
+			this->scroll = 0;
+			for (uint8_t i = 0; i < this->trace_count; i++) {
+				this->traces[i].held = 0;
+			}
+		}
+		uv_ui_refresh(this);
+	}
+}
+
+
+/// @brief: Returns the y coordinate of *value* on a content area starting at
+/// *y* and *h* pixels high
+static inline int16_t value_to_y(void *me, int16_t value, int16_t y, int16_t h) {
+	int32_t range = ((uv_uigraph_st*) this)->max_y - ((uv_uigraph_st*) this)->min_y;
+	int32_t ret = y + h;
+	if (range != 0) {
+		ret -= ((int32_t) value - ((uv_uigraph_st*) this)->min_y) * h / range;
+		LIMITS(ret, y, y + h);
+	}
+	return (int16_t) ret;
+}
+
+
+/// @brief: Fits the Y axis to the *columns* newest columns in view
+static void autoscale(void *me, uint16_t columns) {
+	int32_t lo = INT16_MAX;
+	int32_t hi = INT16_MIN;
+	for (uint8_t i = 0; i < this->trace_count; i++) {
+		const uv_uichart_trace_st *t = &this->traces[i];
+		uint32_t back = (uint32_t) this->scroll + t->held;
+		for (uint16_t j = 0; (j < columns) && (back + j < t->column_count); j++) {
+			const uv_uichart_column_st *c = trace_column(t, back + j);
+			lo = MIN(lo, c->min);
+			hi = MAX(hi, c->max);
+		}
+	}
+	if (lo <= hi) {
+		// leave some room above and below the traces
+		int32_t margin = (hi - lo) / 10 + 1;
+		((uv_uigraph_st*) this)->min_y = lo - margin;
+		((uv_uigraph_st*) this)->max_y = hi + margin;
+	}
+	else {
+
+	}
+}
+
+
+void uv_uichart_draw(void *me, const uv_bounding_box_st *pbb) {
+	if (this->autoscale) {
+		// the content width is known only after drawing the axes, whose
+		// labels depend on the scale: fit to the width of the last draw
+		uint16_t w = ((uv_uigraph_st*) this)->content_w;
+		autoscale(this, (w != 0) ? w : uv_uibb(this)->width);
+	}
+	// the axes, grid and title. This also leaves the mask on the content area.
+	uv_uigraph_draw(this, pbb);
+
+	int16_t x = uv_ui_get_xglobal(this) + ((uv_uigraph_st*) this)->content_x;
+	int16_t y = uv_ui_get_yglobal(this);
+	int16_t cw = ((uv_uigraph_st*) this)->content_w;
+	int16_t ch = ((uv_uigraph_st*) this)->content_h;
+	uint16_t columns = MIN(MAX(cw, 0), this->strip_len / 2);
+
+	for (uint8_t i = 0; i < this->trace_count; i++) {
+		const uv_uichart_trace_st *t = &this->traces[i];
+		uint32_t back = (uint32_t) this->scroll + t->held;
+		uint16_t n = 0;
+		int16_t last = 0;
+		for (uint16_t j = 0; (j < columns) && (back + j < t->column_count); j++) {
+			const uv_uichart_column_st *c = trace_column(t, back + j);
+			int16_t px = x + cw - 1 - j;
+			int16_t ymin = value_to_y(this, c->min, y, ch);
+			int16_t ymax = value_to_y(this, c->max, y, ch);
+			// start the column from the end nearer the last one, so that the
+			// strip does not cross the column
+			if ((n != 0) && (abs(last - ymax) < abs(last - ymin))) {
+				int16_t tmp = ymin;
+				ymin = ymax;
+				ymax = tmp;
+			}
+			this->strip[n].x = px;
+			this->strip[n].y = ymin;
+			this->strip[n + 1].x = px;
+			this->strip[n + 1].y = ymax;
+			n += 2;
+			last = ymax;
+		}
+		if (n >= 2) {
+			uv_ui_draw_linestrip(this->strip, n, CONFIG_UI_GRAPH_LINE_WIDTH,
+					t->color, UI_STRIP_TYPE_LINE);
+		}
+	}
+}
+
+
+void uv_uichart_touch(void *me, uv_touch_st *touch) {
+	if (touch->action == TOUCH_PRESSED) {
+		this->dragging = true;
+	}
+	else if (touch->action == TOUCH_DRAG) {
+		// drags are given to every child, see uv_uigraph_st::dragging
+		if (this->dragging && (touch->x != 0)) {
+			// dragging to the right brings older samples in view
+			uint16_t max = 0;
+			for (uint8_t i = 0; i < this->trace_count; i++) {
+				max = MAX(max, this->traces[i].column_count);
+			}
+			int32_t scroll = (int32_t) this->scroll + touch->x;
+			LIMITS(scroll, 0, MAX((int32_t) max - 1, 0));
+			this->paused = true;
+			if (scroll != this->scroll) {
+				this->scroll = scroll;
+				uv_ui_refresh(this);
+			}
+			touch->action = TOUCH_NONE;
+		}
+	}
+	else if (touch->action == TOUCH_CLICKED) {
+		this->dragging = false;
+		if (this->paused) {
+			uv_uichart_set_paused(this, false);
+			touch->action = TOUCH_NONE;
+		}
+	}
+	else if (touch->action == TOUCH_RELEASED) {
+		this->dragging = false;
+	}
+	else {
+
+	}
+}
+
+
+#endif
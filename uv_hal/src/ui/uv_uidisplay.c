@@ -29,6 +29,7 @@
 
 #include <ui/uv_uidisplay.h>
 #include "uv_lcd.h"
+#include "ui/uv_uitransition.h"
 #include <stdlib.h>
 
 #if CONFIG_UI
@@ -50,9 +51,17 @@ enum {
 
 static void _uv_uidisplay_draw(void *me, const uv_bounding_box_st *pbb);
 
+// The display or dialog whose objects were drawn last. A dialog running its own
+// exec loop draws over the display, so the display has to be drawn whole when
+// it gets the screen back. Only compared, never dereferenced.
+static void *on_screen = NULL;
+
 
 void uv_uidisplay_draw(void *me) {
 	_uv_uidisplay_draw(this, uv_uibb(this));
+#if CONFIG_UI_DIRTY_RECTS
+	uv_uidirty_clear(&this->dirty);
+#endif
 }
 
 void uv_uidisplay_draw_touch_ind(void *me) {
@@ -72,17 +81,42 @@ void uv_uidisplay_draw_touch_ind(void *me) {
 						reli,
 						0,
 						TOUCH_IND_DIAM_PX));
+			this->ind_x = this->press_x;
+			this->ind_y = this->press_y;
 		}
 	}
 }
 
 
+/// @brief: Refreshes where the touch indicator is drawn and where it was
+static void refresh_touch_ind(void *me) {
+	uv_ui_refresh_area(this, this->ind_x - TOUCH_IND_DIAM_PX / 2,
+			this->ind_y - TOUCH_IND_DIAM_PX / 2, TOUCH_IND_DIAM_PX, TOUCH_IND_DIAM_PX);
+	uv_ui_refresh_area(this, this->press_x - TOUCH_IND_DIAM_PX / 2,
+			this->press_y - TOUCH_IND_DIAM_PX / 2, TOUCH_IND_DIAM_PX, TOUCH_IND_DIAM_PX);
+}
+
+
+/// @brief: Draws the background of the display over *area*, or over the whole
+/// screen when *area* is NULL
+static void draw_background(void *me, const uv_bb_st *area) {
+	if (area == NULL) {
+		uv_ui_clear(this->display_c);
+	}
+	else {
+		// not uv_ui_clear: that clears the whole screen
+		uv_ui_draw_rrect(area->x, area->y, area->width, area->height, 0,
+				this->display_c);
+	}
+	uv_ui_draw_point(LCD_WPPT(500), -400, uv_uic_brighten(this->display_c, 20), 1000);
+}
+
+
 static void _uv_uidisplay_draw(void *me, const uv_bounding_box_st *pbb) {
 	uv_ui_set_mask(uv_ui_get_xglobal(this), uv_ui_get_yglobal(this),
 			uv_uibb(this)->width, uv_uibb(this)->height);
 
-	uv_ui_clear(this->display_c);
-	uv_ui_draw_point(LCD_WPPT(500), -400, uv_uic_brighten(this->display_c, 20), 1000);
+	draw_background(this, NULL);
 
 	// draw all the objects added to the screen
 	_uv_uiwindow_draw_children(this, pbb);
@@ -96,6 +130,28 @@ static void _uv_uidisplay_draw(void *me, const uv_bounding_box_st *pbb) {
 }
 
 
+#if CONFIG_UI_DIRTY_RECTS
+/// @brief: Redraws only the areas refreshed since the last frame, on a backend
+/// that still has the rest of the last frame. Each area is drawn like the
+/// whole screen would be, with every mask cut down to the area and the objects
+/// outside it skipped.
+static void draw_areas(void *me) {
+	for (uint8_t i = 0; i < this->dirty.count; i++) {
+		const uv_uidirty_rect_st *rect = &this->dirty.rect[i];
+		uv_bb_st area;
+		uv_bounding_box_init(&area, rect->x, rect->y, rect->width, rect->height);
+		_uv_uiobject_set_draw_area(rect);
+		uv_ui_set_mask(area.x, area.y, area.width, area.height);
+		draw_background(this, &area);
+		_uv_uiwindow_draw_children(this, uv_uibb(this));
+		uv_uidisplay_draw_touch_ind(this);
+	}
+	_uv_uiobject_set_draw_area(NULL);
+	uv_ui_dlswap();
+}
+#endif
+
+
 void uv_uidisplay_init(void *me, uv_uiobject_st **objects, const uv_uistyle_st *style) {
 	uv_uiwindow_init(me, objects, style);
 	// display fills the whole screen
@@ -105,6 +161,9 @@ void uv_uidisplay_init(void *me, uv_uiobject_st **objects, const uv_uistyle_st *
 	uv_uibb(me)->height = LCD_H_PX;
 	this->display_c = style->display_c;
 	this->touch_ind = true;
+	this->ind_x = 0;
+	this->ind_y = 0;
+	memset(&this->stats, 0, sizeof(this->stats));
 	uv_delay_end(&this->touch_ind_delay);
 	uv_ui_refresh_parent(this);
 	uv_uiobject_set_draw_callb(this, &_uv_uidisplay_draw);
@@ -117,21 +176,117 @@ void uv_uidisplay_init(void *me, uv_uiobject_st **objects, const uv_uistyle_st *
 	uv_moving_aver_init(&this->avr_x, UI_TOUCH_AVERAGE_COUNT);
 	uv_moving_aver_init(&this->avr_y, UI_TOUCH_AVERAGE_COUNT);
 	this->press_state = RELEASED;
+	this->down = false;
+	this->down_x = 0;
+	this->down_y = 0;
 #endif
 #if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
 	this->unclaimed_key = '\0';
 	this->unclaimed_cycles = 0;
 #endif
+#if CONFIG_UI_DIRTY_RECTS
+	uv_uidirty_clear(&this->dirty);
+#endif
 }
 
 
 
 #define DRAG_MAX_SPEED_PX		50
 
+#if CONFIG_UI_TOUCHSCREEN
+
+/// @brief: Starts a press where the screen is touched
+static void touch_press(void *me) {
+	this->touch.x = uv_moving_aver_step(&this->avr_x, this->down_x);
+	this->touch.y = uv_moving_aver_step(&this->avr_y, this->down_y);
+	this->press_x = this->touch.x;
+	this->press_y = this->touch.y;
+	this->touch.action = TOUCH_PRESSED;
+	this->press_state = PRESSING;
+}
+
+
+/// @brief: Follows a press that goes on: it is down at where it started until
+/// it moves too far, and a drag after that
+static void touch_hold(void *me) {
+	this->touch.x = uv_moving_aver_step(&this->avr_x, this->down_x);
+	this->touch.y = uv_moving_aver_step(&this->avr_y, this->down_y);
+	if (this->press_state == PRESSING) {
+		if (abs(this->press_x - this->touch.x) > CONFIG_UI_CLICK_THRESHOLD ||
+				abs(this->press_y - this->touch.y) > CONFIG_UI_CLICK_THRESHOLD) {
+			this->touch.action = TOUCH_DRAG;
+			this->drag_x = this->touch.x;
+			this->drag_y = this->touch.y;
+			this->touch.x = 0;
+			this->touch.y = 0;
+			this->press_state = DRAGGING;
+		}
+		else {
+			this->touch.action = TOUCH_IS_DOWN;
+			this->touch.x = this->press_x;
+			this->touch.y = this->press_y;
+		}
+	}
+	else {
+		// store the current position
+		int16_t tx = this->touch.x, ty = this->touch.y;
+		this->touch.action = TOUCH_DRAG;
+		// drag event gives an offset from
+		// last drag position as parameters
+		this->touch.x -= this->drag_x;
+		this->touch.y -= this->drag_y;
+		if (abs(this->touch.x) > DRAG_MAX_SPEED_PX ||
+				abs(this->touch.y) > DRAG_MAX_SPEED_PX) {
+			// dragging speed exceeded the maximum allowed dragging speed.
+			// This might indicate a faulty press, thus we ignore the dragging
+			// on this step cycle
+			this->touch.x = 0;
+			this->touch.y = 0;
+		}
+		// save current position to drag variables
+		this->drag_x = tx;
+		this->drag_y = ty;
+	}
+}
+
+
+/// @brief: Ends a press, as a click if it never became a drag
+static void touch_release(void *me) {
+	this->touch.x = this->press_x;
+	this->touch.y = this->press_y;
+	if (this->press_state == PRESSING) {
+		this->touch.action = TOUCH_CLICKED;
+	}
+	else {
+		this->touch.action = TOUCH_RELEASED;
+	}
+	uv_delay_init(&this->press_delay, UIDISPLAY_PRESS_DELAY_MS);
+	uv_moving_aver_reset(&this->avr_x);
+	uv_moving_aver_reset(&this->avr_y);
+	this->press_state = RELEASED;
+}
+
+#endif
+
+
+
 uv_uiobject_ret_e uv_uidisplay_step(void *me, uint32_t step_ms) {
 	uv_uiobject_ret_e ret;
 	this->touch.action = TOUCH_NONE;
 
+#if CONFIG_UI_DIRTY_RECTS
+	// refreshes are recorded for this display from now on, and also between
+	// its steps. A dialog stepped from inside this step hands them back to the
+	// display that had them when it returns.
+	void *dirty_root;
+	uv_uidirty_st *dirty;
+	_uv_ui_get_dirty(&dirty_root, &dirty);
+	_uv_ui_set_dirty(this, &this->dirty);
+#endif
+
+	// the backend pushes the input that has come since the last step
+	uv_ui_input_poll();
+
 #if CONFIG_UI_ENABLEFOCUS
 	// Tab belongs to the display, not to whatever is focused: it is what moves
 	// the focus on. Peeked rather than popped so every other key is left in the
@@ -148,75 +303,57 @@ uv_uiobject_ret_e uv_uidisplay_step(void *me, uint32_t step_ms) {
 	}
 #endif
 
-	// get touch data from the LCD
 #if CONFIG_UI_TOUCHSCREEN
-	bool t = uv_ui_get_touch(&this->touch.x, &this->touch.y);
-
 	uv_delay(&this->press_delay, step_ms);
 
-	if (t &&
-			uv_delay_has_ended(&this->press_delay)) {
-		this->touch.x = uv_moving_aver_step(&this->avr_x, this->touch.x);
-		this->touch.y = uv_moving_aver_step(&this->avr_y, this->touch.y);
-		if (this->press_state == RELEASED) {
-			this->press_x = this->touch.x;
-			this->press_y = this->touch.y;
-			this->touch.action = TOUCH_PRESSED;
-			this->press_state = PRESSING;
-		}
-		else if (this->press_state == PRESSING) {
-			if (abs(this->press_x - this->touch.x) > CONFIG_UI_CLICK_THRESHOLD ||
-					abs(this->press_y - this->touch.y) > CONFIG_UI_CLICK_THRESHOLD) {
-				this->touch.action = TOUCH_DRAG;
-				this->drag_x = this->touch.x;
-				this->drag_y = this->touch.y;
-				this->touch.x = 0;
-				this->touch.y = 0;
-				this->press_state = DRAGGING;
+	// The touch events are taken out in the order they happened until one of
+	// them makes a touch action. A step delivers one action, so a tap shorter
+	// than a step is a press on this step and a click on the next one rather
+	// than nothing at all. A press that comes during the delay after a release
+	// is only noted, and starts when the delay is over if still down.
+	uv_ui_input_event_st e;
+	while ((this->touch.action == TOUCH_NONE) && uv_ui_input_pop(&e)) {
+		if (e.type == UI_INPUT_TOUCH) {
+			this->down = true;
+			this->down_x = e.x;
+			this->down_y = e.y;
+			if ((this->press_state == RELEASED) &&
+					uv_delay_has_ended(&this->press_delay)) {
+				touch_press(this);
 			}
 			else {
-				this->touch.action = TOUCH_IS_DOWN;
-				this->touch.x = this->press_x;
-				this->touch.y = this->press_y;
 			}
 		}
-		else if (this->press_state == DRAGGING) {
-			// store the current position
-			int16_t tx = this->touch.x, ty = this->touch.y;
-			this->touch.action = TOUCH_DRAG;
-			// drag event gives an offset from
-			// last drag position as parameters
-			this->touch.x -= this->drag_x;
-			this->touch.y -= this->drag_y;
-			if (abs(this->touch.x) > DRAG_MAX_SPEED_PX ||
-					abs(this->touch.y) > DRAG_MAX_SPEED_PX) {
-				// dragging speed exceeded the maximum allowed dragging speed.
-				// This might indicate a faulty press, thus we ignore the dragging
-				// on this step cycle
-				this->touch.x = 0;
-				this->touch.y = 0;
+		else if (e.type == UI_INPUT_RELEASE) {
+			this->down = false;
+			if (this->press_state != RELEASED) {
+				touch_release(this);
+			}
+			else {
 			}
-			// save current position to drag variables
-			this->drag_x = tx;
-			this->drag_y = ty;
+		}
+		else {
+			// scrolls are summed up by uv_ui_input_pop
+		}
+		if ((this->touch.action != TOUCH_NONE) ||
+				(this->press_state != RELEASED)) {
+			_uv_ui_input_consumed(e.time_us);
+		}
+		else {
 		}
 	}
-	else {
+	if ((this->touch.action == TOUCH_NONE) && this->down) {
 		if (this->press_state != RELEASED) {
-			this->touch.x = this->press_x;
-			this->touch.y = this->press_y;
-			if (this->press_state == PRESSING) {
-				this->touch.action = TOUCH_CLICKED;
-			}
-			else {
-				this->touch.action = TOUCH_RELEASED;
-			}
-			uv_delay_init(&this->press_delay, UIDISPLAY_PRESS_DELAY_MS);
-			uv_moving_aver_reset(&this->avr_x);
-			uv_moving_aver_reset(&this->avr_y);
-			this->press_state = RELEASED;
+			touch_hold(this);
+		}
+		else if (uv_delay_has_ended(&this->press_delay)) {
+			touch_press(this);
+		}
+		else {
 		}
 	}
+	else {
+	}
 	if (this->touch.action == TOUCH_PRESSED) {
 		uv_delay_init(&this->touch_ind_delay, TOUCH_IND_DELAY_MS);
 	}
@@ -225,10 +362,16 @@ uv_uiobject_ret_e uv_uidisplay_step(void *me, uint32_t step_ms) {
 				!uv_delay_has_ended(&this->touch_ind_delay)) {
 			// update every second step cycle to make display react better
 			if ((this->touch_ind_delay % (step_ms * 2)) == 0) {
-				uv_ui_refresh(this);
+				refresh_touch_ind(this);
 			}
 		}
 	}
+#else
+	// nothing to touch: the events are only taken out, which sums up the
+	// scrolls
+	uv_ui_input_event_st e;
+	while (uv_ui_input_pop(&e)) {
+	}
 #endif
 	// call user touch callback
 	if ((((uv_uiobject_st*) this)->vrtl_touch) && (this->touch.action != TOUCH_NONE)) {
@@ -240,8 +383,20 @@ uv_uiobject_ret_e uv_uidisplay_step(void *me, uint32_t step_ms) {
 	// propagate touches to all objects in reverse order
 	_uv_uiwindow_touch(this, &this->touch);
 
+	// wake the objects whose timers are up before stepping
+	_uv_ui_wake_timers_step(step_ms);
+	// the attached transitions go by the clock rather than by step_ms, which
+	// is what the step was meant to take rather than what it took
+	_uv_uitransitions_step();
+#if CONFIG_UI_REMOTE
+	// asset chunks keep going out while the screen stands still
+	uv_ui_remote_step((uint16_t) step_ms);
+#endif
+
 	// call the step function and let it propagate through all objects in order
 	ret = uv_uiwindow_step(me, step_ms);
+	// the display itself is stepped by the application every cycle
+	ret &= (uv_uiobject_ret_e) ~UIOBJECT_RETURN_IDLE;
 
 #if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
 	// Everything reads the key queue by peeking and only pops what it wants,
@@ -282,19 +437,53 @@ uv_uiobject_ret_e uv_uidisplay_step(void *me, uint32_t step_ms) {
 		uv_ui_refresh(this);
 	}
 
-	// if refreshing was requested in the step functions, draw the whole screen
-	if (((uv_uiobject_st *) this)->refresh || ret == UIOBJECT_RETURN_REFRESH ||
-			uv_ui_get_refresh_request()
+	// the whole screen is drawn when asked for without saying where, and when
+	// something else was drawn over it. The backend is asked first, since it
+	// may have work of its own to move on every step.
+	bool whole = uv_ui_get_refresh_request() ||
+			(ret == UIOBJECT_RETURN_REFRESH) ||
+			(on_screen != this)
 #if CONFIG_UI_REMOTE
 			// a mirroring sink is showing a screen this device has already
 			// moved on from, and nothing else is going to redraw it
 			|| uv_ui_remote_redraw_wanted()
 #endif
-			) {
+			;
+	// if refreshing was requested in the step functions, draw the screen
+	if (((uv_uiobject_st *) this)->refresh || whole) {
 		((uv_uiobject_st*) this)->refresh = true;
+#if CONFIG_UI_DIRTY_RECTS
+		// a refresh that did not come through uv_ui_refresh leaves no area
+		// behind, and a dialog draws itself in its own way: both are drawn whole
+		if (!whole && (this->dirty.count > 0) &&
+				(((uv_uiobject_st*) this)->vrtl_draw == &_uv_uidisplay_draw) &&
+				uv_ui_get_frame_preserved()) {
+			draw_areas(this);
+			((uv_uiobject_st*) this)->refresh = false;
+			this->stats.areas = this->dirty.count;
+		}
+		else {
+			_uv_uiobject_draw(this, uv_uibb(this));
+			this->stats.areas = 0;
+		}
+		uv_uidirty_clear(&this->dirty);
+#else
 		_uv_uiobject_draw(this, uv_uibb(this));
+#endif
+		_uv_uiobject_get_draw_counts(&this->stats.drawn, &this->stats.skipped);
+		on_screen = this;
 	}
 
+#if CONFIG_UI_DIRTY_RECTS
+	if (dirty_root != NULL) {
+		_uv_ui_set_dirty(dirty_root, dirty);
+	}
+	else {
+	}
+#endif
+	// input taken this step that drew nothing had no frame to measure against
+	_uv_ui_input_frame_end();
+
 	return ret;
 }
 
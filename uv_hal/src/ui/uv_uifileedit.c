@@ -484,6 +484,11 @@ bool uv_uifiledialog_exec(const char *title,
 		uv_rtos_task_delay(20);
 	}
 	pthread_join(tid, NULL);
+	// what was clicked at the window behind the chooser was not meant for it
+	uv_ui_input_event_st e;
+	uv_ui_input_poll();
+	while (uv_ui_input_pop(&e)) {
+	}
 	return a.result;
 #elif CONFIG_TARGET_WIN
 	// The Win32 chooser is modal and runs its own message pump; disable the
@@ -57,7 +57,13 @@ static inline void draw(void *me, const uv_bounding_box_st *pbb) {
 	int16_t w = uv_uibb(this)->width;
 	int16_t h = uv_uibb(this)->height;
 
-	if (this->media != NULL) {
+	if ((this->media != NULL) && !uv_uimedia_is_resident(this->media)) {
+		// drawn again once the media is loaded. The media is still asked to
+		// be drawn, which is what loads an evicted one again.
+		uv_ui_draw_rrect(x, y, w, h, 0, CONFIG_UI_IMAGE_PLACEHOLDER_COLOR);
+		uv_ui_draw_bitmap_ext(this->media, x, y, w, h, this->wrap, this->blend_c);
+	}
+	else if (this->media != NULL) {
 		int16_t mw = this->media->width;
 		int16_t mh = this->media->height;
 
@@ -77,6 +83,8 @@ static inline void draw(void *me, const uv_bounding_box_st *pbb) {
 
 		uv_ui_draw_bitmap_ext(this->media, x, y, mw, mh, this->wrap, this->blend_c);
 	}
+	else {
+	}
 }
 
 
@@ -32,6 +32,9 @@
 
 #define this ((uv_uilist_st*)me)
 
+// the entries are drawn overlapping by their border line
+#define ENTRY_PITCH		(CONFIG_UI_LIST_ENTRY_HEIGHT - 1)
+
 static void touch(void *me, uv_touch_st *touch);
 static void draw(void *me, const uv_bounding_box_st *pbb);
 static void draw_entry(void *me, void *entry, bool selected, uv_bounding_box_st *bb);
@@ -49,50 +52,99 @@ void uv_uilist_init(void *me, uv_uilist_entry_st *buffer,
 	this->text_c = style->text_color;
 	this->font = style->font;
 	this->draw_entry = &draw_entry;
+	this->source_count = NULL;
+	this->source_row = NULL;
+	this->source_ptr = NULL;
+	this->scroll = 0;
+	this->dragging = false;
 	uv_uiobject_set_draw_callb(this, &draw);
 	uv_uiobject_set_touch_callb(this, &touch);
 }
 
 
 void uv_uilist_recalc_height(void *me) {
-	if (uv_uibb(this)->height <
-			uv_vector_size(&this->entries) * CONFIG_UI_LIST_ENTRY_HEIGHT) {
+	// a list with a source keeps its size and scrolls instead
+	if ((this->source_count == NULL) &&
+			(uv_uibb(this)->height <
+			uv_vector_size(&this->entries) * CONFIG_UI_LIST_ENTRY_HEIGHT)) {
 		uv_uibb(this)->height =
 				uv_vector_size(&this->entries) * CONFIG_UI_LIST_ENTRY_HEIGHT;
 	}
 }
 
 
+/// @brief: Returns how far the rows of a list with a source can be scrolled
+static int32_t scroll_max(void *me, int16_t count) {
+	int32_t ret = (int32_t) count * ENTRY_PITCH + 1 - uv_uibb(this)->height;
+	return MAX(ret, 0);
+}
+
+
+/// @brief: Returns the global y coordinate of the first entry
+static int32_t first_y(void *me, int16_t count) {
+	int32_t ret = uv_ui_get_yglobal(this);
+	if (this->source_count != NULL) {
+		this->scroll = MIN(this->scroll, scroll_max(this, count));
+		ret -= this->scroll;
+	}
+	else if (uv_ui_get_valignment(this->align) == VALIGN_CENTER) {
+		ret += uv_uibb(this)->height / 2 -
+				(CONFIG_UI_LIST_ENTRY_HEIGHT * count / 2);
+	}
+	else {
+	}
+	return ret;
+}
+
+
 static void draw(void *me, const uv_bounding_box_st *pbb) {
-	uint16_t i;
 	int16_t x = uv_ui_get_xglobal(this);
 	int16_t thisy = uv_ui_get_yglobal(this);
-	uint16_t entry_height = CONFIG_UI_LIST_ENTRY_HEIGHT;
-	int16_t y;
-	valignment_e valign = uv_ui_get_valignment(this->align);
-	if (valign == VALIGN_CENTER) {
-		y = thisy + uv_uibb(this)->height / 2 -
-				(entry_height * uv_vector_size(&this->entries) / 2);
+	int16_t w = uv_uibb(this)->width;
+	int16_t count = uv_uilist_get_count(this);
+	int32_t y = first_y(this, count);
+
+	if (this->selected_index >= count) {
+		this->selected_index = count - 1;
+	}
+
+	// only the entries in view are drawn
+	uv_bb_st vis = uv_ui_get_visible_bb(this);
+	int32_t first = 0;
+	int32_t last = count;
+	int32_t below = vis.y + vis.height - y;
+	if (vis.y > y) {
+		first = (vis.y - y) / ENTRY_PITCH;
+	}
+	if ((vis.width == 0) || (below <= 0)) {
+		last = 0;
 	}
 	else {
-		y = thisy;
+		last = MIN(last, (below - 1) / ENTRY_PITCH + 1);
 	}
-
-	if (this->selected_index >= uv_vector_size(&this->entries)) {
-		this->selected_index = uv_vector_size(&this->entries) - 1;
+	if (this->source_count != NULL) {
+		// the entries cut by the edges are drawn in part
+		uv_ui_set_mask(vis.x, vis.y, vis.width, vis.height);
+		if (scroll_max(this, count) > 0) {
+			w -= CONFIG_UI_WINDOW_SCROLLBAR_WIDTH;
+		}
+		else {
+		}
+	}
+	else {
+		// the entries that do not fit the list are left out
+		int32_t fit = uv_uibb(this)->height + thisy - y - CONFIG_UI_LIST_ENTRY_HEIGHT;
+		last = (fit < 0) ? 0 : MIN(last, fit / ENTRY_PITCH + 1);
 	}
-
 
 	uv_bounding_box_st bb;
+	bool selected_drawn = false;
 	uv_bounding_box_st selected_bb;
-	for (i = 0; i < uv_vector_size(&this->entries); i++) {
+	for (int32_t i = first; i < last; i++) {
 		bb.x = x;
-		bb.y = y;
-		bb.width = uv_uibb(this)->width;
-		bb.height = entry_height;
-		if ((uv_uibb(this)->height + thisy) < (y + entry_height)) {
-			break;
-		}
+		bb.y = y + i * ENTRY_PITCH;
+		bb.width = w;
+		bb.height = CONFIG_UI_LIST_ENTRY_HEIGHT;
 		if (this->selected_index != i) {
 			if (this->draw_entry) {
 				this->draw_entry(this, uv_uilist_at(this, i), false, &bb);
@@ -100,14 +152,29 @@ static void draw(void *me, const uv_bounding_box_st *pbb) {
 		}
 		else {
 			selected_bb = bb;
+			selected_drawn = true;
 		}
-		y += entry_height - 1;
 	}
-	if (this->selected_index != -1) {
+	if (selected_drawn) {
 		if (this->draw_entry) {
 			this->draw_entry(this, uv_uilist_at(this, this->selected_index), true, &selected_bb);
 		}
 	}
+
+	if ((this->source_count != NULL) && (scroll_max(this, count) > 0)) {
+		int32_t content_h = (int32_t) count * ENTRY_PITCH + 1;
+		int16_t h = uv_uibb(this)->height;
+		int16_t handle_h = MAX((int32_t) h * h / content_h,
+				CONFIG_UI_WINDOW_SCROLLBAR_WIDTH);
+		int16_t handle_y = thisy + (int16_t) ((int64_t) (h - handle_h) *
+				this->scroll / scroll_max(this, count));
+		uv_ui_draw_rrect(x + w, thisy, CONFIG_UI_WINDOW_SCROLLBAR_WIDTH, h,
+				CONFIG_UI_WINDOW_SCROLLBAR_WIDTH / 2, uv_uic_brighten(this->bg_c, -40));
+		uv_ui_draw_rrect(x + w, handle_y, CONFIG_UI_WINDOW_SCROLLBAR_WIDTH, handle_h,
+				CONFIG_UI_WINDOW_SCROLLBAR_WIDTH / 2, this->bg_c);
+	}
+	else {
+	}
 }
 
 static void draw_entry(void *me, void *entry, bool selected, uv_bounding_box_st *bb) {
@@ -128,7 +195,8 @@ static void draw_entry(void *me, void *entry, bool selected, uv_bounding_box_st
 
 
 uv_uiobject_ret_e uv_uilist_step(void *me, uint16_t step_ms) {
-	uv_uiobject_ret_e ret = UIOBJECT_RETURN_ALIVE;
+	// clicked is set by a touch, which wakes the list again
+	uv_uiobject_ret_e ret = UIOBJECT_RETURN_IDLE;
 
 	this->clicked = false;
 
@@ -136,22 +204,36 @@ uv_uiobject_ret_e uv_uilist_step(void *me, uint16_t step_ms) {
 }
 
 static void touch(void *me, uv_touch_st *touch) {
-	if (touch->action == TOUCH_CLICKED) {
-		int16_t index = -1;
-		int16_t y;
-		if (uv_ui_get_valignment(this->align) == VALIGN_CENTER) {
-			y = (touch->y - ((uv_uibb(this)->height -
-				CONFIG_UI_LIST_ENTRY_HEIGHT * uv_vector_size(&this->entries)) / 2));
+	int16_t count = uv_uilist_get_count(this);
+	if ((this->source_count != NULL) && (touch->action == TOUCH_PRESSED)) {
+		// taken so that the window the list is in does not start scrolling
+		this->dragging = true;
+		touch->action = TOUCH_NONE;
+	}
+	else if ((this->source_count != NULL) && (touch->action == TOUCH_DRAG)) {
+		// every object is given the drags, wherever they are
+		if (this->dragging) {
+			int32_t scroll = this->scroll - touch->y;
+			scroll = MAX(scroll, 0);
+			scroll = MIN(scroll, scroll_max(this, count));
+			if (scroll != this->scroll) {
+				this->scroll = scroll;
+				uv_ui_refresh(this);
+			}
+			else {
+			}
+			touch->action = TOUCH_NONE;
 		}
 		else {
-			y = touch->y;
-		}
-		if (y >= 0) {
-			index = y / CONFIG_UI_LIST_ENTRY_HEIGHT;
 		}
+	}
+	else if (touch->action == TOUCH_CLICKED) {
+		this->dragging = false;
+		int32_t y = touch->y + uv_ui_get_yglobal(this) - first_y(this, count);
+		int32_t index = (y >= 0) ? (y / ENTRY_PITCH) : -1;
 
 		if ((index >= 0) &&
-				(index < uv_vector_size(&this->entries))) {
+				(index < count)) {
 			this->clicked = true;
 			this->selected_index = index;
 			uv_ui_refresh(this);
@@ -159,6 +241,30 @@ static void touch(void *me, uv_touch_st *touch) {
 			touch->action = TOUCH_NONE;
 		}
 	}
+	else if (touch->action == TOUCH_RELEASED) {
+		this->dragging = false;
+	}
+	else {
+	}
+}
+
+
+bool uv_uilist_set_source(void *me, uint16_t (*count)(void *source_ptr),
+		void *(*row)(void *source_ptr, uint16_t index), void *source_ptr) {
+	bool ret = (count == NULL) || (count(source_ptr) <= UILIST_SOURCE_ROWS_MAX);
+	if (ret) {
+		this->source_count = count;
+		this->source_row = (count != NULL) ? row : NULL;
+		this->source_ptr = source_ptr;
+		this->scroll = 0;
+		this->dragging = false;
+		this->selected_index = -1;
+		uv_uilist_recalc_height(this);
+		uv_ui_refresh(this);
+	}
+	else {
+	}
+	return ret;
 }
 
 
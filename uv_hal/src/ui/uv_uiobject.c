@@ -32,11 +32,33 @@
 #if CONFIG_UI
 
 #include "ui/uv_uiwindow.h"
+#include "ui/uv_uitransition.h"
 #include "uv_utilities.h"
 #include <stddef.h>
 
 #define this ((uv_uiobject_st*) me)
 
+
+// objects drawn and skipped, for the display's statistics
+static uint16_t drawn_count = 0;
+static uint16_t skipped_count = 0;
+
+#if CONFIG_UI_IDLE_STEP
+// the objects waiting for uv_ui_wake_after(), NULL in the free ones
+static struct {
+	uv_uiobject_st *obj;
+	int32_t ms;
+} wake_timers[CONFIG_UI_WAKE_TIMERS];
+#endif
+
+#if CONFIG_UI_DIRTY_RECTS
+// the tree whose refreshes are recorded, and where to
+static void *dirty_root = NULL;
+static uv_uidirty_st *dirty_set = NULL;
+// the area of the partial redraw in progress, NULL when drawing everything
+static const uv_uidirty_rect_st *draw_area = NULL;
+#endif
+
 /// @brief: Initializes the bounding box
 void uv_bounding_box_init(uv_bounding_box_st *bb,
 		int16_t x, int16_t y, uint16_t width, uint16_t height) {
@@ -69,9 +91,64 @@ static bool uiobject_effective_enabled(const uv_uiobject_st *obj) {
 }
 
 
+#if CONFIG_UI_DIRTY_RECTS
+void _uv_ui_set_dirty(void *root, uv_uidirty_st *dirty) {
+	dirty_root = root;
+	dirty_set = dirty;
+}
+
+
+void _uv_ui_get_dirty(void **root, uv_uidirty_st **dirty) {
+	*root = dirty_root;
+	*dirty = dirty_set;
+}
+
+
+void _uv_uiobject_set_draw_area(const uv_uidirty_rect_st *area) {
+	draw_area = area;
+	if (area != NULL) {
+		uv_bb_st bb;
+		uv_bounding_box_init(&bb, area->x, area->y, area->width, area->height);
+		uv_ui_set_mask_limit(&bb);
+	}
+	else {
+		uv_ui_set_mask_limit(NULL);
+	}
+}
+#endif
+
+
+void _uv_uiobject_get_draw_counts(uint16_t *drawn, uint16_t *skipped) {
+	*drawn = drawn_count;
+	*skipped = skipped_count;
+	drawn_count = 0;
+	skipped_count = 0;
+}
+
+
 bool _uv_uiobject_draw(void *me, const uv_bounding_box_st *pbb) {
 	bool ret = false;
+#if CONFIG_UI_DIRTY_RECTS
+	if ((draw_area != NULL) && this->refresh && this->visible) {
+		uv_uidirty_rect_st bb = {
+				.x = uv_ui_get_xglobal(this),
+				.y = uv_ui_get_yglobal(this),
+				.width = this->bb.width,
+				.height = this->bb.height
+		};
+		if (!uv_uidirty_near(&bb, draw_area, CONFIG_UI_DIRTY_MARGIN)) {
+			// nothing of it is redrawn, nor of its children
+			this->refresh = false;
+			skipped_count++;
+		}
+		else {
+		}
+	}
+	else {
+	}
+#endif
 	if (this->refresh && this->vrtl_draw && this->visible) {
+		drawn_count++;
 		if (!uiobject_effective_enabled(this)) {
 			uv_ui_set_color_mode(COLOR_MODE_GRAYSCALE);
 			uv_ui_set_grayscale_luminosity(CONFIG_UI_DISABLED_OBJECT_BRIGHTNESS);
@@ -79,7 +156,16 @@ bool _uv_uiobject_draw(void *me, const uv_bounding_box_st *pbb) {
 		else {
 			uv_ui_set_color_mode(COLOR_MODE_RGB);
 		}
+#if CONFIG_UI_WINDOW_CACHE
+		if (this->is_window && (((uv_uiwindow_st*) this)->cache != NULL)) {
+			_uv_uiwindow_draw_cached(me, pbb);
+		}
+		else {
+			this->vrtl_draw(me, pbb);
+		}
+#else
 		this->vrtl_draw(me, pbb);
+#endif
 		ret = true;
 	}
 	this->refresh = false;
@@ -98,6 +184,12 @@ void uv_uiobject_init(void *me) {
 	uv_ui_refresh(this);
 	this->enabled = true;
 	this->transition = NULL;
+	this->is_window = false;
+#if CONFIG_UI_IDLE_STEP
+	this->idle = false;
+	// the memory may have held an object waiting for a timer
+	uv_ui_wake_cancel(this);
+#endif
 }
 
 
@@ -106,14 +198,97 @@ uv_uiobject_ret_e uv_uiobject_step(void *me, uint16_t step_ms) {
 	if (this->step_callb) {
 		ret = this->step_callb(this, step_ms);
 	}
+#if CONFIG_UI_IDLE_STEP
+	// a transition attached to the object keeps it awake while it plays
+	this->idle = ((ret & UIOBJECT_RETURN_IDLE) &&
+			((this->transition == NULL) ||
+			!uv_uitransition_is_playing(this->transition)));
+#endif
+	// the parent learns of it from the flag, not from the return value
+	ret &= (uv_uiobject_ret_e) ~UIOBJECT_RETURN_IDLE;
 	return ret;
 }
 
 
+void uv_ui_wake(void *me) {
+#if CONFIG_UI_IDLE_STEP
+	// the windows are woken all the way up: one hidden or disabled may have
+	// been put to sleep with children still awake
+	uv_uiobject_st *t = me;
+	while (t != NULL) {
+		t->idle = false;
+		t = (uv_uiobject_st*) t->parent;
+	}
+#endif
+}
+
+
+void uv_ui_wake_after(void *me, uint16_t ms) {
+#if CONFIG_UI_IDLE_STEP
+	int16_t free = -1;
+	int16_t i;
+	for (i = 0; i < CONFIG_UI_WAKE_TIMERS; i++) {
+		if (wake_timers[i].obj == this) {
+			break;
+		}
+		else if ((wake_timers[i].obj == NULL) &&
+				(free < 0)) {
+			free = i;
+		}
+		else {
+		}
+	}
+	if (i == CONFIG_UI_WAKE_TIMERS) {
+		i = free;
+	}
+	if (i >= 0) {
+		wake_timers[i].obj = this;
+		wake_timers[i].ms = ms;
+	}
+	else {
+		// no timer free, the object checks its time on every step instead
+		uv_ui_wake(this);
+	}
+#else
+	(void) ms;
+#endif
+}
+
+
+void uv_ui_wake_cancel(void *me) {
+#if CONFIG_UI_IDLE_STEP
+	for (uint16_t i = 0; i < CONFIG_UI_WAKE_TIMERS; i++) {
+		if (wake_timers[i].obj == this) {
+			wake_timers[i].obj = NULL;
+		}
+	}
+#endif
+}
+
+
+void _uv_ui_wake_timers_step(uint16_t step_ms) {
+#if CONFIG_UI_IDLE_STEP
+	for (uint16_t i = 0; i < CONFIG_UI_WAKE_TIMERS; i++) {
+		if (wake_timers[i].obj != NULL) {
+			wake_timers[i].ms -= step_ms;
+			if (wake_timers[i].ms <= 0) {
+				uv_ui_wake(wake_timers[i].obj);
+				wake_timers[i].obj = NULL;
+			}
+		}
+	}
+#else
+	(void) step_ms;
+#endif
+}
+
+
 void uv_ui_hide(void *me) {
 	if (this) {
 		if (this->visible) {
 			uv_ui_refresh_parent(this);
+			// stepped once more hidden, see uv_uiwindow_step
+			uv_ui_wake(this);
 		}
 		this->visible = false;
 	}
@@ -146,6 +321,7 @@ void uv_ui_set_enabled(void *me, bool enabled) {
 			else {
 				uv_ui_refresh(this);
 			}
+			uv_ui_wake(this);
 		}
 		this->enabled = enabled;
 	}
@@ -183,10 +359,39 @@ int16_t uv_ui_get_yglobal(const void *me) {
 }
 
 
+uv_bb_st uv_ui_get_visible_bb(const void *me) {
+	uv_bb_st ret;
+	uv_bounding_box_init(&ret, 0, 0, 0, 0);
+	if (this != NULL) {
+		int16_t x0 = MAX(uv_ui_get_xglobal(this), 0);
+		int16_t y0 = MAX(uv_ui_get_yglobal(this), 0);
+		int16_t x1 = MIN(uv_ui_get_xglobal(this) + this->bb.width, LCD_W_PX);
+		int16_t y1 = MIN(uv_ui_get_yglobal(this) + this->bb.height, LCD_H_PX);
+		const uv_uiobject_st *p = (const uv_uiobject_st*) this->parent;
+		while (p != NULL) {
+			int16_t px = uv_ui_get_xglobal(p);
+			int16_t py = uv_ui_get_yglobal(p);
+			x0 = MAX(x0, px);
+			y0 = MAX(y0, py);
+			x1 = MIN(x1, px + p->bb.width);
+			y1 = MIN(y1, py + p->bb.height);
+			p = (const uv_uiobject_st*) p->parent;
+		}
+		if ((x1 > x0) && (y1 > y0)) {
+			uv_bounding_box_init(&ret, x0, y0, x1 - x0, y1 - y0);
+		}
+		else {
+		}
+	}
+	return ret;
+}
+
+
 void uv_uiobject_set_visible(void *me, bool value) {
 	if (this != NULL) {
 		if (this->visible != value) {
 			uv_ui_refresh(this);
+			uv_ui_wake(this);
 		}
 		this->visible = value;
 	}
@@ -194,16 +399,62 @@ void uv_uiobject_set_visible(void *me, bool value) {
 
 
 
+#if CONFIG_UI_WINDOW_CACHE
+static void invalidate_cache(uv_uiobject_st *obj) {
+	if (obj->is_window && (((uv_uiwindow_st*) obj)->cache != NULL)) {
+		uv_ui_record_invalidate(&((uv_uiwindow_st*) obj)->cache->record);
+	}
+	else {
+	}
+}
+#endif
+
+
 void uv_ui_refresh(void *me) {
+	if (me != NULL) {
+		uv_ui_refresh_area(me, uv_ui_get_xglobal(this), uv_ui_get_yglobal(this),
+				this->bb.width, this->bb.height);
+	}
+}
+
+
+void uv_ui_refresh_area(void *me, int16_t x, int16_t y,
+		uint16_t width, uint16_t height) {
 	if (me != NULL) {
 		// refreshing sets only the furthest parent's refresh flag
 		// e.g. uidisplay is refreshed first. Each uiwindow is responsible
 		// for refreshing their children afterwards
 		uv_uiobject_st *t = me;
+#if CONFIG_UI_WINDOW_CACHE
+		// the cached drawing of every window it is in is now out of date
+		invalidate_cache(t);
+#endif
+#if CONFIG_UI_IDLE_STEP
+		// and whatever changed may need stepping
+		t->idle = false;
+#endif
 		while (t->parent != NULL) {
 			t = (uv_uiobject_st*) t->parent;
+#if CONFIG_UI_WINDOW_CACHE
+			invalidate_cache(t);
+#endif
+#if CONFIG_UI_IDLE_STEP
+			t->idle = false;
+#endif
 		}
 		t->refresh = true;
+#if CONFIG_UI_DIRTY_RECTS
+		// a tree not on the display being stepped is drawn whole when it gets
+		// there, so its areas are not needed
+		if ((t == dirty_root) && (dirty_set != NULL)) {
+			uv_uidirty_add(dirty_set, x - CONFIG_UI_DIRTY_MARGIN,
+					y - CONFIG_UI_DIRTY_MARGIN,
+					(int16_t) (width + CONFIG_UI_DIRTY_MARGIN * 2),
+					(int16_t) (height + CONFIG_UI_DIRTY_MARGIN * 2));
+		}
+		else {
+		}
+#endif
 	}
 }
 
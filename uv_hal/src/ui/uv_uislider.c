@@ -232,6 +232,10 @@ static uv_uiobject_ret_e step(void *me, uint16_t step_ms) {
 	uv_uiobject_ret_e ret = UIOBJECT_RETURN_ALIVE;
 
 	uv_delay(&this->longpress_delay, step_ms);
+	if (uv_delay_has_ended(&this->longpress_delay)) {
+		// the delay is started again by a touch, which wakes the slider
+		ret |= UIOBJECT_RETURN_IDLE;
+	}
 
 	return ret;
 }
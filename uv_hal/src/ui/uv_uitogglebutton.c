@@ -73,7 +73,8 @@ void uv_uitogglebutton_init(void *me, bool state, char *text, const uv_uistyle_s
 
 
 uv_uiobject_ret_e uv_uitogglebutton_step(void *me, uint16_t step_ms) {
-	uv_uiobject_ret_e ret = UIOBJECT_RETURN_ALIVE;
+	// the flags are set by touches, which wake the button again
+	uv_uiobject_ret_e ret = UIOBJECT_RETURN_IDLE;
 
 	this->clicked = false;
 	this->is_down = false;
@@ -50,7 +50,8 @@ void uv_uitoucharea_init(void *me) {
 static uv_uiobject_ret_e step(void *me, uint16_t step_ms) {
 	this->touch.action = TOUCH_NONE;
 
-	return UIOBJECT_RETURN_ALIVE;
+	// the touch is set by the next touch, which wakes the area again
+	return UIOBJECT_RETURN_IDLE;
 }
 
 
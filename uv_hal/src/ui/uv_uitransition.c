@@ -41,6 +41,38 @@ void uv_uiscalartransition_calc(void *me);
 #define this	((_uv_uitransition_st *)me)
 
 
+/// @brief: The easing curves from 0 to UITRANSITION_ONE, indexed by
+/// uv_uitransition_easing_e, in 16 segments which are interpolated linearly.
+/// The quadratic curves are off by less than 0.1 % of the transition.
+#define EASING_SEGMENT_BITS		11
+static const uint16_t easing_tables[4][(UITRANSITION_ONE >> EASING_SEGMENT_BITS) + 1] = {
+		// UITRANSITION_EASING_LINEAR
+		{ 0, 2048, 4096, 6144, 8192, 10240, 12288, 14336, 16384,
+				18432, 20480, 22528, 24576, 26624, 28672, 30720, 32768 },
+		// UITRANSITION_EASING_OUT_QUAD
+		{ 0, 3968, 7680, 11136, 14336, 17280, 19968, 22400, 24576,
+				26496, 28160, 29568, 30720, 31616, 32256, 32640, 32768 },
+		// UITRANSITION_EASING_IN_QUAD
+		{ 0, 128, 512, 1152, 2048, 3200, 4608, 6272, 8192,
+				10368, 12800, 15488, 18432, 21632, 25088, 28800, 32768 },
+		// UITRANSITION_EASING_INOUT_QUAD
+		{ 0, 256, 1024, 2304, 4096, 6400, 9216, 12544, 16384,
+				20224, 23552, 26368, 28672, 30464, 31744, 32512, 32768 }
+};
+
+
+/// @brief: The attached transitions being stepped, and the frame clock
+static struct {
+	void *first;
+	uint16_t count;
+	uint32_t last_us;
+	// the part of a millisecond not yet stepped
+	uint32_t carry_us;
+} active = {
+		.first = NULL
+};
+
+
 static void set_state(void *me, uv_uitransition_state_e state) {
 	uv_uitransition_state_e last_state = this->state;
 	this->state = state;
@@ -58,6 +90,9 @@ void _uv_uitransition_init(void *me, uv_uitransition_easing_e easing,
 	this->speed_ppt = 1000;
 	this->parallel = NULL;
 	this->series = NULL;
+	this->parent = NULL;
+	this->next_active = NULL;
+	this->active = false;
 	this->state = UITRANSITION_INIT;
 	this->state_change_callback = NULL;
 }
@@ -115,6 +150,123 @@ void uv_uitransition_step(void *me, void *parent, uint16_t step_ms) {
 
 
 
+/// @brief: Adds an attached transition to the ones stepped by the display
+static void activate(void *me) {
+	if ((this->parent != NULL) && !this->active) {
+		if (active.first == NULL) {
+			// the clock only runs while something plays: the first frame
+			// steps from here, not from whenever the display last stepped
+			active.last_us = uv_ui_input_time_us();
+			active.carry_us = 0;
+		}
+		else {
+		}
+		this->active = true;
+		this->next_active = active.first;
+		active.first = this;
+		active.count++;
+		uv_ui_wake(this->parent);
+	}
+	else {
+	}
+}
+
+
+/// @brief: Removes a transition from the ones stepped by the display
+static void deactivate(void *me) {
+	void **link = &active.first;
+	while ((*link != NULL) && (*link != me)) {
+		link = &((_uv_uitransition_st*) *link)->next_active;
+	}
+	if (*link != NULL) {
+		*link = this->next_active;
+		active.count--;
+	}
+	else {
+	}
+	this->next_active = NULL;
+	this->active = false;
+}
+
+
+/// @brief: Returns true if the transition or one following it still has
+/// something to do
+static bool is_running(const void *me) {
+	bool ret = false;
+	if (me != NULL) {
+		ret = uv_uitransition_is_playing(this) ||
+				// the end value is set on the step after finishing
+				((this->state == UITRANSITION_FINISH) &&
+						(this->current_time_ms == this->duration_ms)) ||
+				is_running(this->series) ||
+				is_running(this->parallel);
+	}
+	else {
+	}
+	return ret;
+}
+
+
+void uv_uitransition_attach(void *me, void *obj) {
+	if (obj != NULL) {
+		((uv_uiobject_st*) obj)->transition = me;
+	}
+	else {
+	}
+	this->parent = obj;
+	if (obj == NULL) {
+		deactivate(this);
+	}
+	else if (uv_uitransition_is_playing(this)) {
+		activate(this);
+	}
+	else {
+	}
+}
+
+
+uint16_t uv_uitransition_get_active_count(void) {
+	return active.count;
+}
+
+
+void _uv_uitransitions_step(void) {
+	uint32_t now = uv_ui_input_time_us();
+	uint32_t step_us = now - active.last_us + active.carry_us;
+	active.last_us = now;
+	if (active.first == NULL) {
+		// nothing plays: the next transition starts from this frame
+		active.carry_us = 0;
+	}
+	else {
+		uint16_t step_ms = (uint16_t) MIN(step_us / 1000, UITRANSITION_MAX_STEP_MS);
+		active.carry_us = (step_us < UITRANSITION_MAX_STEP_MS * 1000) ? step_us % 1000 : 0;
+		void **link = &active.first;
+		while (*link != NULL) {
+			void *me = *link;
+			uv_uitransition_step(this, this->parent, step_ms);
+			if (!this->active) {
+				// detached by its state change callback, and already unlinked
+			}
+			else if (!is_running(this)) {
+				// a transition played by the state change callback was put
+				// first, in front of this one when this one was the first
+				while (*link != me) {
+					link = &((_uv_uitransition_st*) *link)->next_active;
+				}
+				*link = this->next_active;
+				this->next_active = NULL;
+				this->active = false;
+				active.count--;
+			}
+			else {
+				link = &this->next_active;
+			}
+		}
+	}
+}
+
+
 /// @brief: Starts the uitransition
 void uv_uitransition_play(void *me) {
 	if (this->state == UITRANSITION_FINISH) {
@@ -127,6 +279,7 @@ void uv_uitransition_play(void *me) {
 	else {
 		this->state = UITRANSITION_FINISH;
 	}
+	activate(this);
 
 	if (this->parallel) {
 		uv_uitransition_play(this->parallel);
@@ -144,6 +297,7 @@ void uv_uitransition_reverseplay(void *me) {
 	else {
 		this->state = UITRANSITION_INIT;
 	}
+	activate(this);
 
 	if (this->parallel) {
 		uv_uitransition_reverseplay(this->parallel);
@@ -185,39 +339,33 @@ void uv_uitransition_set_position(uv_uitransition_st *me, uint16_t value) {
 
 
 
-static int16_t scalar_calc(uv_uitransition_easing_e easing, int16_t current_time_ms,
-		int16_t duration_ms, int16_t start_val, int16_t end_val) {
-	int16_t ret = 0;
-	if (easing == UITRANSITION_EASING_LINEAR) {
-		int16_t rel = uv_reli(current_time_ms, 0, duration_ms);
-		ret = uv_lerpi(rel, start_val, end_val);
-	}
-	else if (easing == UITRANSITION_EASING_IN_QUAD) {
-		int16_t rel = uv_reli(current_time_ms, 0, duration_ms);
-		ret = uv_lerpi(rel * rel / 1000, start_val, end_val);
-	}
-	else if (easing == UITRANSITION_EASING_OUT_QUAD) {
-		int16_t rel = uv_reli(current_time_ms, 0, duration_ms);
-		ret = uv_lerpi(- rel * (rel - 2000) / 1000, start_val, end_val);
-	}
-	else if (easing == UITRANSITION_EASING_INOUT_QUAD) {
-		int16_t rel = uv_reli(current_time_ms, 0, duration_ms / 2);
-		if (rel < 1000) {
-			ret = uv_lerpi(rel * rel / 1000, start_val, end_val + (start_val - end_val) / 2);
-		}
-		else {
-			rel -= 1000;
-			ret = uv_lerpi(- (rel * (rel - 2000) / 1000 - 1010), start_val,
-					(end_val + (start_val - end_val) / 2));
-		}
+/// @brief: Returns how far the transition is, eased, from 0 to
+/// UITRANSITION_ONE
+static int32_t eased_progress(const void *me) {
+	int32_t t = this->current_time_ms;
+	LIMITS(t, 0, this->duration_ms);
+	int32_t p = (this->duration_ms > 0) ?
+			(t * UITRANSITION_ONE / this->duration_ms) : UITRANSITION_ONE;
+	const uint16_t *table = easing_tables[this->easing & 0x3];
+	int32_t i = p >> EASING_SEGMENT_BITS;
+	int32_t ret = table[i];
+	if (p < UITRANSITION_ONE) {
+		ret += ((table[i + 1] - ret) * (p & ((1 << EASING_SEGMENT_BITS) - 1))) >>
+				EASING_SEGMENT_BITS;
 	}
 	else {
-
 	}
 	return ret;
 }
 
 
+/// @brief: Returns the value *progress* of the way from *start_val* to
+/// *end_val*
+static int32_t scalar_calc(int32_t progress, int32_t start_val, int32_t end_val) {
+	return start_val + (end_val - start_val) * progress / UITRANSITION_ONE;
+}
+
+
 #undef this
 #define this	((uv_uiscalartransition_st *) me)
 
@@ -233,9 +381,7 @@ void uv_uiscalartransition_init(void *me, uv_uitransition_easing_e easing,
 
 
 void uv_uiscalartransition_calc(void *me) {
-	*this->cur_val = scalar_calc(((_uv_uitransition_st*) this)->easing,
-			((_uv_uitransition_st*) this)->current_time_ms,
-			((_uv_uitransition_st*) this)->duration_ms,
+	*this->cur_val = (int16_t) scalar_calc(eased_progress(this),
 			this->start_val, this->end_val);
 }
 
@@ -257,25 +403,14 @@ void uv_uicolortransition_init(void *me, uv_uitransition_easing_e easing,
 
 
 void uv_uicolortransition_calc(void *me) {
+	// the easing is worked out once for all the channels
+	int32_t progress = eased_progress(this);
 	uint32_t result = 0;
 	for (uint8_t i = 0; i < 4; i++) {
-		int16_t val, start_val, end_val;
-		start_val = (this->start_c >> (i * 8)) & 0xFF;
-		end_val = (this->end_c >> (i * 8)) & 0xFF;
-
-		val = scalar_calc(((_uv_uitransition_st*) this)->easing,
-				((_uv_uitransition_st*) this)->current_time_ms,
-				((_uv_uitransition_st*) this)->duration_ms,
-				start_val, end_val);
-		if (val < 0) {
-			val = 0;
-		}
-		else if (val > 0xFF) {
-			val = 0xFF;
-		}
-		else {
-
-		}
+		int32_t start_val = (this->start_c >> (i * 8)) & 0xFF;
+		int32_t end_val = (this->end_c >> (i * 8)) & 0xFF;
+		// between the two, as the eased progress never leaves 0 ... 1
+		uint32_t val = (uint32_t) scalar_calc(progress, start_val, end_val);
 		result += (val << (i * 8));
 	}
 	*this->cur_c = result;
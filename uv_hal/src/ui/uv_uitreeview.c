@@ -37,7 +37,7 @@
 #define XOFFSET	20
 
 
-static void uitreeview_recalc_height(void *me);
+static void uitreeview_relayout(void *me, uint16_t from);
 static void uv_uitreeobject_draw(void *me, const uv_bounding_box_st *pbb);
 static void touch(void *me, uv_touch_st *touch);
 
@@ -135,23 +135,39 @@ uv_bounding_box_st uv_uitreeobject_get_content_bb(void *me) {
 void uv_uitreeview_init(void *me,
 		uv_uitreeobject_st ** const object_array, const uv_uistyle_st * style) {
 	uv_uiwindow_init(this, (uv_uiobject_st ** const) object_array, style);
+	// the objects are laid out one below the other
+	((uv_uiwindow_st*) this)->stacked = true;
 	this->one_active = true;
 }
 
 
 
 
+/// @brief: Returns the index of *obj* in the tree view
+static uint16_t index_of(void *me, const uv_uitreeobject_st *obj) {
+	uint16_t i;
+	for (i = 0; i < ((uv_uiwindow_st*) this)->objects_count; i++) {
+		if ((const void*) ((uv_uiwindow_st*) this)->objects[i] == (const void*) obj) {
+			break;
+		}
+	}
+	return i;
+}
+
+
 void uv_uitreeview_open(void *me, uv_uitreeobject_st *obj) {
+	uint16_t from = index_of(this, obj);
 	if (this->one_active) {
+		// closed without laying out after each: the layout is done once below
 		for (uint16_t i = 0; i < ((uv_uiwindow_st*)this)->objects_count; i++) {
 			if (((uv_uiobject_st*) ((uv_uiwindow_st*) this)->objects[i])->enabled) {
-				uv_uitreeview_close(this,
-						(uv_uitreeobject_st*) ((uv_uiwindow_st*)this)->objects[i]);
+				((uv_uiobject_st*) ((uv_uiwindow_st*) this)->objects[i])->enabled = false;
+				from = MIN(from, i);
 			}
 		}
 	}
 	((uv_uiobject_st*) obj)->enabled = true;
-	uitreeview_recalc_height(this);
+	uitreeview_relayout(this, from);
 	uv_uiwindow_content_move_to(this, 0, uv_uibb(obj)->y);
 	if (obj->show_callb) {
 		obj->show_callb(obj);
@@ -161,7 +177,7 @@ void uv_uitreeview_open(void *me, uv_uitreeobject_st *obj) {
 
 void uv_uitreeview_close(void *me, uv_uitreeobject_st *obj) {
 	((uv_uiobject_st*) obj)->enabled = false;
-	uitreeview_recalc_height(this);
+	uitreeview_relayout(this, index_of(this, obj));
 }
 
 
@@ -179,10 +195,21 @@ void uv_uitreeview_add(void *me, uv_uitreeobject_st * const object,
 }
 
 
-static void uitreeview_recalc_height(void *me) {
-	uint16_t content_height = 0;
+/// @brief: Lays out the objects from *from* on again. The ones before it have
+/// not changed, so only the objects below one opened or closed are moved.
+static void uitreeview_relayout(void *me, uint16_t from) {
 	uv_uitreeobject_st ** const objs = (uv_uitreeobject_st ** const) ((uv_uiwindow_st*) this)->objects;
-	for (int i = 0; i < ((uv_uiwindow_st*) this)->objects_count; i++) {
+	uint16_t count = ((uv_uiwindow_st*) this)->objects_count;
+	int16_t content_height = 0;
+	if ((from > 0) && (from <= count)) {
+		content_height = uv_uibb(objs[from - 1])->y +
+				((((uv_uiobject_st*) objs[from - 1])->enabled) ?
+				uv_uibb(objs[from - 1])->height : CONFIG_UI_TREEVIEW_ITEM_HEIGHT);
+	}
+	else {
+		from = 0;
+	}
+	for (uint16_t i = from; i < count; i++) {
 		uv_uibb(objs[i])->y = content_height;
 		content_height += (((uv_uiobject_st*) objs[i])->enabled) ?
 				uv_uibb(objs[i])->height : CONFIG_UI_TREEVIEW_ITEM_HEIGHT;
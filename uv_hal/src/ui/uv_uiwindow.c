@@ -127,6 +127,38 @@ void uv_uiwindow_draw_scrollbars(void *me, const uv_bounding_box_st *pbb) {
 	}
 }
 
+/// @brief: Returns the children of a stacked window in view as [*first*, *last*).
+/// The children are ordered by their y coordinate, so the one the top edge of
+/// the view falls on is the last one starting above it.
+static void stacked_range(void *me, int16_t *first, int16_t *last) {
+	int16_t top = -this->content_bb.y;
+	int16_t bottom = top + uv_uibb(this)->height;
+	int16_t lo = 0;
+	int16_t hi = this->objects_count;
+	while (lo < hi) {
+		int16_t mid = lo + (hi - lo) / 2;
+		if (uv_uibb(this->objects[mid])->y <= top) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	*first = MAX(lo - 1, 0);
+	hi = this->objects_count;
+	while (lo < hi) {
+		int16_t mid = lo + (hi - lo) / 2;
+		if (uv_uibb(this->objects[mid])->y < bottom) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	*last = lo;
+}
+
+
 void _uv_uiwindow_draw_children(void *me, const uv_bounding_box_st *pbb) {
 
 	uv_bounding_box_st bb = *uv_uibb(this);
@@ -147,7 +179,14 @@ void _uv_uiwindow_draw_children(void *me, const uv_bounding_box_st *pbb) {
 		bb.height -= (bb.y + bb.height) - (pbb->y + pbb->height);
 	}
 
-	for (int16_t i = 0; i < this->objects_count; i++) {
+	int16_t first = 0;
+	int16_t last = this->objects_count;
+	if (this->stacked) {
+		stacked_range(this, &first, &last);
+	}
+	else {
+	}
+	for (int16_t i = first; i < last; i++) {
 		((uv_uiobject_st*) this->objects[i])->refresh = true;
 		bool ret = _uv_uiobject_draw(this->objects[i], pbb);
 
@@ -160,6 +199,43 @@ void _uv_uiwindow_draw_children(void *me, const uv_bounding_box_st *pbb) {
 }
 
 
+#if CONFIG_UI_WINDOW_CACHE
+void uv_uiwindow_set_cache(void *me, uv_uiwindow_cache_st *cache,
+		void *buffer, uint16_t buffer_len) {
+	if (cache != NULL) {
+		uv_ui_record_init(&cache->record, buffer, buffer_len);
+	}
+	else {
+	}
+	this->cache = cache;
+}
+
+
+void _uv_uiwindow_draw_cached(void *me, const uv_bounding_box_st *pbb) {
+	uv_uiwindow_cache_st *cache = this->cache;
+	int16_t x = uv_ui_get_xglobal(this);
+	int16_t y = uv_ui_get_yglobal(this);
+	// the recording is in global coordinates and clipped to the parent, so it
+	// goes out of date also when the parent scrolls or moves the window
+	if (cache->record.valid &&
+			(x == cache->x) && (y == cache->y) &&
+			(memcmp(pbb, &cache->pbb, sizeof(cache->pbb)) == 0)) {
+		uv_ui_record_replay(&cache->record);
+	}
+	else if (uv_ui_record_begin(&cache->record)) {
+		((uv_uiobject_st*) this)->vrtl_draw(this, pbb);
+		uv_ui_record_end(&cache->record);
+		cache->x = x;
+		cache->y = y;
+		cache->pbb = *pbb;
+	}
+	else {
+		((uv_uiobject_st*) this)->vrtl_draw(this, pbb);
+	}
+}
+#endif
+
+
 static void _uv_uiwindow_draw(void *me, const uv_bounding_box_st *pbb) {
 	uv_uiwindow_draw(this, pbb);
 	_uv_uiwindow_draw_children(this, pbb);
@@ -179,14 +255,16 @@ void uv_uiwindow_init(void *me, uv_uiobject_st **const object_array, const uv_ui
 	this->handle_c = style->bg_c;
 	this->dragging = false;
 	this->transparent = true;
+	this->stacked = false;
 	this->app_step_callb = NULL;
 	this->user_ptr = NULL;
 	uv_uiobject_set_draw_callb(this, &_uv_uiwindow_draw);
 	uv_uiobject_set_touch_callb(this, &_uv_uiwindow_touch);
 	uv_uiobject_set_step_callb(this, &uv_uiwindow_step);
-#if CONFIG_UI_ENABLEFOCUS
 	// marks this as something the focus traversal may descend into
 	((uv_uiobject_st*) this)->is_window = true;
+#if CONFIG_UI_WINDOW_CACHE
+	this->cache = NULL;
 #endif
 }
 
@@ -334,8 +412,22 @@ void uv_uiwindow_content_move(const void *me, const int16_t dx, const int16_t dy
 
 
 
+#if CONFIG_UI_IDLE_STEP
+/// @brief: True when *obj* is a window whose application step callback is
+/// called. The application polls its objects there, so it is never idle.
+static bool runs_app_step(const uv_uiobject_st *obj) {
+	return (obj->is_window &&
+			obj->enabled &&
+			(((const uv_uiwindow_st*) obj)->app_step_callb != NULL));
+}
+#endif
+
+
 uv_uiobject_ret_e uv_uiwindow_step(void *me, uint16_t step_ms) {
 	uv_uiobject_ret_e ret = UIOBJECT_RETURN_ALIVE;
+#if CONFIG_UI_IDLE_STEP
+	bool idle = !runs_app_step((uv_uiobject_st*) this);
+#endif
 
 	// call application step callback if one is assigned
 	if ((this->app_step_callb != NULL) &&
@@ -346,23 +438,53 @@ uv_uiobject_ret_e uv_uiwindow_step(void *me, uint16_t step_ms) {
 	if (!(ret & UIOBJECT_RETURN_KILLED)) {
 		// call step functions for all children which are visible
 		for (int16_t i = 0; i < this->objects_count; i++) {
+			uv_uiobject_st *obj = this->objects[i];
 			// call child object's step function
-			if (this->objects[i]->step_callb) {
-				ret |= uv_uiobject_step(this->objects[i], step_ms);
+#if CONFIG_UI_IDLE_STEP
+			if ((obj->step_callb != NULL) &&
+					!obj->idle) {
+				ret |= uv_uiobject_step(obj, step_ms);
+				// a hidden or disabled object is stepped once after it was
+				// hidden or disabled, to let it settle, and then left alone
+				// until shown or enabled again
+				if ((!obj->visible || !obj->enabled) &&
+						!runs_app_step(obj)) {
+					obj->idle = true;
+				}
+				else {
+				}
+			}
+			idle = idle && ((obj->step_callb == NULL) || obj->idle);
+#else
+			if (obj->step_callb) {
+				ret |= uv_uiobject_step(obj, step_ms);
 			}
+#endif
 			if (ret & UIOBJECT_RETURN_KILLED) {
 				break;
 			}
 		}
 	}
+#if CONFIG_UI_IDLE_STEP
+	if (idle && !(ret & UIOBJECT_RETURN_KILLED)) {
+		ret |= UIOBJECT_RETURN_IDLE;
+	}
+#endif
 	return ret;
 }
 
 void _uv_uiwindow_touch(void *me, uv_touch_st *touch) {
 	// touch event is unique for each children object
 
+	int16_t first = 0;
+	int16_t last = this->objects_count;
+	if (this->stacked) {
+		stacked_range(this, &first, &last);
+	}
+	else {
+	}
 	int16_t i;
-	for (i = this->objects_count - 1; i >= 0; i--) {
+	for (i = last - 1; i >= first; i--) {
 		uv_touch_st t2 = *touch;
 
 		if (this->objects[i]->visible &&
@@ -381,6 +503,11 @@ void _uv_uiwindow_touch(void *me, uv_touch_st *touch) {
 				}
 			}
 			uv_touch_action_e touch_propagate = t2.action;
+#if CONFIG_UI_IDLE_STEP
+			if (t2.action != TOUCH_NONE) {
+				uv_ui_wake(this->objects[i]);
+			}
+#endif
 
 			// call child's touch callback
 			this->objects[i]->vrtl_touch(this->objects[i], &t2);
@@ -426,6 +553,7 @@ void uv_uiwindow_set_stepcallback(void *me,
 		void *user_ptr) {
 	this->app_step_callb = step;
 	this->user_ptr = user_ptr;
+	uv_ui_wake(this);
 }
 
 
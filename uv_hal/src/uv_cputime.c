@@ -0,0 +1,171 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "uv_cputime.h"
+#include "uv_utilities.h"
+#if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
+#include <time.h>
+#else
+#include "chip.h"
+#endif
+
+
+// Only the clock depends on the target. The statistics take times in
+// nanoseconds, so the tests can feed them any time they need.
+
+
+uv_cputime_st _uv_cputime[CPUTIME_COUNT];
+
+
+/// @brief: Nanoseconds per tick of the clock as a 16.16 fixed point number,
+/// so that converting a time is one 32 x 32 bit multiply
+static uint32_t ns_per_tick_q16 = (1u << 16);
+
+
+static const char *names[CPUTIME_HAL_SLOTS] = {
+		"hal",
+		"can",
+		"uart",
+		"stdout",
+		"canopen",
+		"halmutex",
+		"idle"
+};
+
+
+
+void uv_cputime_reset(uv_cputime_st *this) {
+	this->count = 0;
+	this->min_ns = UINT32_MAX;
+	this->avg_ns = 0;
+	this->max_ns = 0;
+	for (uint8_t i = 0; i < CPUTIME_HIST_BUCKETS; i++) {
+		this->hist[i] = 0;
+	}
+	this->sum_ns = 0;
+	this->sum_count = 0;
+}
+
+
+uint8_t uv_cputime_bucket(uint32_t ns) {
+	uint32_t us = ns / 1000;
+	// the bits in the microseconds, 0 for the times under 1 us
+	uint8_t ret = (us == 0) ? 0 : (32 - __builtin_clz(us));
+	return MIN(ret, CPUTIME_HIST_BUCKETS - 1);
+}
+
+
+uint32_t uv_cputime_bucket_us(uint8_t bucket) {
+	return (bucket >= (CPUTIME_HIST_BUCKETS - 1)) ? UINT32_MAX : (1u << bucket);
+}
+
+
+void uv_cputime_add(uv_cputime_st *this, uint32_t ns) {
+	this->count++;
+	if (ns < this->min_ns) {
+		this->min_ns = ns;
+	}
+	else {
+	}
+	if (ns > this->max_ns) {
+		this->max_ns = ns;
+	}
+	else {
+	}
+	this->hist[uv_cputime_bucket(ns)]++;
+
+	while ((this->sum_count != 0) && ((UINT32_MAX - this->sum_ns) < ns)) {
+		// halved through the average, so that an odd count does not skew it
+		uint32_t avg = this->sum_ns / this->sum_count;
+		this->sum_count /= 2;
+		this->sum_ns = avg * this->sum_count;
+	}
+	if ((UINT32_MAX - this->sum_ns) < ns) {
+		// one time alone is longer than the sum can hold
+		this->sum_ns = ns;
+		this->sum_count = 1;
+	}
+	else {
+		this->sum_ns += ns;
+		this->sum_count++;
+	}
+	this->avg_ns = this->sum_ns / this->sum_count;
+}
+
+
+
+void uv_cputime_init(void) {
+#if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
+	// the clock counts nanoseconds already
+	ns_per_tick_q16 = (1u << 16);
+#else
+	SystemCoreClockUpdate();
+	ns_per_tick_q16 = (uint32_t) ((1000000000ull << 16) / SystemCoreClock);
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	uv_cputime_reset_all();
+}
+
+
+uint32_t uv_cputime_now(void) {
+	uint32_t ret;
+#if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ret = (uint32_t) ts.tv_sec * 1000000000u + (uint32_t) ts.tv_nsec;
+#else
+	ret = DWT->CYCCNT;
+#endif
+	return ret;
+}
+
+
+uint32_t uv_cputime_ns_since(uint32_t start) {
+	uint64_t ns = ((uint64_t) (uv_cputime_now() - start) * ns_per_tick_q16) >> 16;
+	return (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t) ns;
+}
+
+
+uv_cputime_st *uv_cputime_get(uv_cputime_slot_e slot) {
+	return &_uv_cputime[slot];
+}
+
+
+const char *uv_cputime_name(uv_cputime_slot_e slot) {
+	return (slot < CPUTIME_HAL_SLOTS) ? names[slot] : "app";
+}
+
+
+void uv_cputime_reset_all(void) {
+	for (uint8_t i = 0; i < CPUTIME_COUNT; i++) {
+		uv_cputime_reset(&_uv_cputime[i]);
+	}
+}
@@ -0,0 +1,155 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "uv_framebuffer.h"
+#include <string.h>
+
+
+// uv_lcd is the only user on the device, but the loops write nothing but the
+// buffer they are given, so they are left unguarded for the host tests and
+// benchmarks to measure them.
+
+
+/// @brief: The unit of the wide stores. Stores of it alias the pixels.
+typedef uint64_t __attribute__((may_alias)) fb_word_t;
+
+#define WORD_ALIGN_MASK		(sizeof(fb_word_t) - 1)
+
+
+
+/// @brief: Stores *word* to *count* words from *dest*, 4 at a time
+static void fill_words(fb_word_t *dest, fb_word_t word, uint32_t count) {
+	while (count >= 4) {
+		dest[0] = word;
+		dest[1] = word;
+		dest[2] = word;
+		dest[3] = word;
+		dest += 4;
+		count -= 4;
+	}
+	while (count != 0) {
+		*(dest++) = word;
+		count--;
+	}
+}
+
+
+void uv_fb_fill16(uint16_t *dest, uint16_t value, uint32_t count) {
+	// the pixels up to the first aligned word
+	while ((count != 0) && ((uintptr_t) dest & WORD_ALIGN_MASK)) {
+		*(dest++) = value;
+		count--;
+	}
+	uint32_t words = count / (sizeof(fb_word_t) / sizeof(uint16_t));
+	fill_words((fb_word_t *) dest, (fb_word_t) value * 0x0001000100010001ull, words);
+	dest += words * (sizeof(fb_word_t) / sizeof(uint16_t));
+	count -= words * (sizeof(fb_word_t) / sizeof(uint16_t));
+	while (count != 0) {
+		*(dest++) = value;
+		count--;
+	}
+}
+
+
+void uv_fb_fill32(uint32_t *dest, uint32_t value, uint32_t count) {
+	if ((count != 0) && ((uintptr_t) dest & WORD_ALIGN_MASK)) {
+		*(dest++) = value;
+		count--;
+	}
+	else {
+	}
+	uint32_t words = count / (sizeof(fb_word_t) / sizeof(uint32_t));
+	fill_words((fb_word_t *) dest, (fb_word_t) value * 0x0000000100000001ull, words);
+	dest += words * (sizeof(fb_word_t) / sizeof(uint32_t));
+	count -= words * (sizeof(fb_word_t) / sizeof(uint32_t));
+	if (count != 0) {
+		*dest = value;
+	}
+	else {
+	}
+}
+
+
+void uv_fb_fill_rect16(uint16_t *dest, uint32_t stride,
+		uint32_t width, uint32_t height, uint16_t value) {
+	if (width == stride) {
+		uv_fb_fill16(dest, value, width * height);
+	}
+	else {
+		for (uint32_t j = 0; j < height; j++) {
+			uv_fb_fill16(dest, value, width);
+			dest += stride;
+		}
+	}
+}
+
+
+void uv_fb_fill_rect32(uint32_t *dest, uint32_t stride,
+		uint32_t width, uint32_t height, uint32_t value) {
+	if (width == stride) {
+		uv_fb_fill32(dest, value, width * height);
+	}
+	else {
+		for (uint32_t j = 0; j < height; j++) {
+			uv_fb_fill32(dest, value, width);
+			dest += stride;
+		}
+	}
+}
+
+
+void uv_fb_blit(void *dest, uint32_t dest_stride,
+		const void *src, uint32_t src_stride, uint32_t row_len, uint32_t rows) {
+	uint8_t *d = dest;
+	const uint8_t *s = src;
+	if ((dest_stride == row_len) && (src_stride == row_len)) {
+		memcpy(d, s, row_len * rows);
+	}
+	else {
+		for (uint32_t j = 0; j < rows; j++) {
+			memcpy(d, s, row_len);
+			d += dest_stride;
+			s += src_stride;
+		}
+	}
+}
+
+
+void uv_fb_fill16_scalar(uint16_t *dest, uint16_t value, uint32_t count) {
+	for (uint32_t i = 0; i < count; i++) {
+		dest[i] = value;
+	}
+}
+
+
+void uv_fb_fill32_scalar(uint32_t *dest, uint32_t value, uint32_t count) {
+	for (uint32_t i = 0; i < count; i++) {
+		dest[i] = value;
+	}
+}
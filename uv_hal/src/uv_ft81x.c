@@ -52,6 +52,8 @@
 #define WRITE8_LEN						4
 #define WRITE16_LEN						5
 #define WRITE32_LEN						7
+// the address header of every memory write
+#define ADDR_OFFSET						3
 #define DRAW_LINE_BUF_LEN				6
 // glyphs are translated and streamed to RAM_CMD in small chunks of this many
 // bytes, so a drawn text line needs only a tiny stack buffer regardless of its
@@ -399,6 +401,11 @@ typedef enum {
 
 
 static inline void writedl(uint32_t data);
+static void dl_flush(void);
+static void cmd_dl_sync(void);
+static void cmd_dl_fetch(void);
+static void cmd_put(const void *src, uint16_t len);
+static void cmd_flush(void);
 static uint8_t read8(const ft81x_reg_e address);
 static uint16_t read16(const ft81x_reg_e address);
 static uint32_t read32(const ft81x_reg_e address);
@@ -417,6 +424,7 @@ static void set_font(const uint8_t font);
 static void set_cell(const uint8_t cell);
 static bool cmd_wait(void);
 static void cmd_romfont(uint8_t bitmap_handle, uint8_t font_number);
+static void ramg_init(void);
 static void draw_line(char *str, ui_font_st *font,
 		int16_t x, int16_t y, ui_align_e align, color_t color, uint16_t len);
 
@@ -443,6 +451,22 @@ typedef struct {
 typedef struct {
 	uint32_t dl_index;
 	uint32_t dl_index_max;
+	// the display list words not yet written to RAM_DL, behind the room
+	// left for the address they are written to
+	spi_data_t dl_buf[ADDR_OFFSET + CONFIG_FT81X_DL_BURST_LEN * 4];
+	uint16_t dl_staged;
+	// the co-processor command bytes not yet written to RAM_CMD
+	spi_data_t cmd_buf[ADDR_OFFSET + CONFIG_FT81X_CMD_BURST_LEN];
+	uint16_t cmd_staged;
+	// what REG_CMD_DL was last set to, or read as
+	uint32_t cmd_dl;
+	// the SPI traffic of the frame being drawn and of the last one drawn
+	struct {
+		uint32_t bytes;
+		uint32_t transactions;
+		uint32_t frame_bytes;
+		uint32_t frame_transactions;
+	} spi;
 	color_st color;
 	color_st clear_color;
 	bool color_init;
@@ -461,6 +485,10 @@ typedef struct {
 		int16_t width;
 		int16_t height;
 	} mask;
+	// the touch as last pushed into the input queue
+	bool touched;
+	int16_t touch_x;
+	int16_t touch_y;
 
 } uv_ft81x_st;
 
@@ -510,6 +538,10 @@ bool uv_ui_init(void) {
 
 	this->dl_index = 0;
 	this->dl_index_max = 0;
+	this->dl_staged = 0;
+	this->cmd_staged = 0;
+	this->cmd_dl = UINT32_MAX;
+	memset(&this->spi, 0, sizeof(this->spi));
 	this->backlight = 50;
 	this->mask.x = 0;
 	this->mask.y = 0;
@@ -595,6 +627,7 @@ bool uv_ui_init(void) {
 
 		// let the project install custom fonts (ASCII + Nordic glyphs) over the
 		// ROM fonts on the slots that render translatable text
+		ramg_init();
 		uv_ui_load_custom_fonts();
 #if CONFIG_UI_REMOTE
 		// a mirroring sink asks for images by name; this is what fetches them
@@ -631,16 +664,32 @@ bool uv_ui_init(void) {
 #endif
 
 
+static void ft81x_spi_write(const spi_data_t *wb, uint16_t len) {
+	FT81X_SSELECT;
+	uv_spi_write_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL, wb, 8, len);
+	FT81X_SRELEASE;
+	this->spi.bytes += len;
+	this->spi.transactions++;
+}
+
+
+static void ft81x_spi_readwrite(const spi_data_t *wb, spi_data_t *rb, uint16_t len) {
+	FT81X_SSELECT;
+	uv_spi_readwrite_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL, wb, rb, 8, len);
+	FT81X_SRELEASE;
+	this->spi.bytes += len;
+	this->spi.transactions++;
+}
+
+
+
 static uint8_t read8(const ft81x_reg_e address) {
 	spi_data_t wb[READ8_LEN] = {};
 	spi_data_t rb[READ8_LEN] = {};
 	wb[0] = FT81X_PREFIX_READ | ((address >> 16) & 0x3F);
 	wb[1] = (address >> 8) & 0xFF;
 	wb[2] = (address) & 0xFF;
-	FT81X_SSELECT;
-	uv_spi_readwrite_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL,
-				wb, rb, 8, READ8_LEN);
-	FT81X_SRELEASE;
+	ft81x_spi_readwrite(wb, rb, READ8_LEN);
 	return (uint8_t) rb[4];
 }
 
@@ -652,9 +701,7 @@ static uint16_t read16(const ft81x_reg_e address) {
 	wb[0] = FT81X_PREFIX_READ | ((address >> 16) & 0x3F);
 	wb[1] = (address >> 8) & 0xFF;
 	wb[2] = address & 0xFF;
-	FT81X_SSELECT;
-	uv_spi_readwrite_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL, wb, rb, 8, READ16_LEN);
-	FT81X_SRELEASE;
+	ft81x_spi_readwrite(wb, rb, READ16_LEN);
 	uint16_t ret = rb[4] + (rb[5] << 8);
 	return ret;
 }
@@ -667,15 +714,12 @@ static uint32_t read32(const ft81x_reg_e address) {
 	wb[0] = FT81X_PREFIX_READ | ((address >> 16) & 0x3F);
 	wb[1] = (address >> 8) & 0xFF;
 	wb[2] = (address) & 0xFF;
-	FT81X_SSELECT;
-	uv_spi_readwrite_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL, wb, rb, 8, READ32_LEN);
-	FT81X_SRELEASE;
+	ft81x_spi_readwrite(wb, rb, READ32_LEN);
 	uint32_t ret = ((uint32_t) rb[7] << 24) + ((uint32_t) rb[6] << 16) + ((uint32_t) rb[5] << 8) + rb[4];
 	return ret;
 }
 
 
-#define ADDR_OFFSET		3
 #define WRITESTR_BUFFER_LEN	64
 static void writestr(const ft81x_reg_e address,
 		const char *src, char *dest, const uint16_t len) {
@@ -696,16 +740,10 @@ static void writestr(const ft81x_reg_e address,
 			wb[i + ADDR_OFFSET] = src[written + i];
 		}
 		if (dest == NULL) {
-			FT81X_SSELECT;
-			uv_spi_write_sync(CONFIG_FT81X_SPI_CHANNEL,
-					CONFIG_FT81X_SSEL, wb, 8, l + ADDR_OFFSET);
-			FT81X_SRELEASE;
+			ft81x_spi_write(wb, l + ADDR_OFFSET);
 		}
 		else {
-			FT81X_SSELECT;
-			uv_spi_readwrite_sync(CONFIG_FT81X_SPI_CHANNEL,
-					CONFIG_FT81X_SSEL, wb, wb, 8, l + ADDR_OFFSET);
-			FT81X_SRELEASE;
+			ft81x_spi_readwrite(wb, wb, l + ADDR_OFFSET);
 			for (uint16_t i = 0; i < l; i++) {
 				dest[written + i] = wb[i + ADDR_OFFSET];
 			}
@@ -718,22 +756,99 @@ static void writestr(const ft81x_reg_e address,
 }
 
 
+/// @brief: Stages a display list word. The staged words are written to RAM_DL
+/// in one burst when the buffer fills up, and before anything else has to see
+/// the display list as it is.
 static inline void writedl(uint32_t data) {
 	DEBUG("index: %u, writedl: 0x%x 0x%x\n", (unsigned int) this->dl_index,
 			(unsigned int) data >> 24, (unsigned int) data & ~(0xFFFF << 24));
-	write32(MEMMAP_RAM_DL_BEGIN + this->dl_index, data);
+	if (this->dl_staged == CONFIG_FT81X_DL_BURST_LEN * 4) {
+		dl_flush();
+	}
+	spi_data_t *d = &this->dl_buf[ADDR_OFFSET + this->dl_staged];
+	d[0] = data & 0xFF;
+	d[1] = (data >> 8) & 0xFF;
+	d[2] = (data >> 16) & 0xFF;
+	d[3] = (data >> 24) & 0xFF;
+	this->dl_staged += 4;
 	this->dl_index += 4;
 }
 
+
+/// @brief: Writes the staged display list words to RAM_DL
+static void dl_flush(void) {
+	if (this->dl_staged != 0) {
+		uint32_t addr = MEMMAP_RAM_DL_BEGIN + this->dl_index - this->dl_staged;
+		this->dl_buf[0] = FT81X_PREFIX_WRITE | ((addr >> 16) & 0x3F);
+		this->dl_buf[1] = (addr >> 8) & 0xFF;
+		this->dl_buf[2] = addr & 0xFF;
+		ft81x_spi_write(this->dl_buf, ADDR_OFFSET + this->dl_staged);
+		this->dl_staged = 0;
+	}
+}
+
+
+/// @brief: Hands the display list over to the co-processor: the staged words
+/// are written out and REG_CMD_DL points after them. REG_CMD_DL is left alone
+/// when it already does, as it does after a co-processor command when nothing
+/// was drawn in between.
+static void cmd_dl_sync(void) {
+	dl_flush();
+	if (this->cmd_dl != this->dl_index) {
+		write16(REG_CMD_DL, this->dl_index);
+		this->cmd_dl = this->dl_index;
+	}
+}
+
+
+/// @brief: Takes the display list back from the co-processor after it has
+/// appended to it
+static void cmd_dl_fetch(void) {
+	this->dl_index = read16(REG_CMD_DL);
+	this->cmd_dl = this->dl_index;
+}
+
+
+/// @brief: Stages co-processor command bytes, to be written to RAM_CMD in
+/// one burst by cmd_flush()
+static void cmd_put(const void *src, uint16_t len) {
+	const uint8_t *s = src;
+	while (len != 0) {
+		if (this->cmd_staged == CONFIG_FT81X_CMD_BURST_LEN) {
+			cmd_flush();
+		}
+		uint16_t l = uv_mini(len, CONFIG_FT81X_CMD_BURST_LEN - this->cmd_staged);
+		for (uint16_t i = 0; i < l; i++) {
+			this->cmd_buf[ADDR_OFFSET + this->cmd_staged + i] = s[i];
+		}
+		this->cmd_staged += l;
+		s += l;
+		len -= l;
+	}
+}
+
+
+/// @brief: Writes the staged co-processor command bytes to RAM_CMD. The FT81X
+/// wraps a continuous write at the end of the RAM_CMD ring by itself.
+static void cmd_flush(void) {
+	if (this->cmd_staged != 0) {
+		uint32_t addr = MEMMAP_RAM_CMD_BEGIN + this->cmdwriteaddr;
+		this->cmd_buf[0] = FT81X_PREFIX_WRITE | ((addr >> 16) & 0x3F);
+		this->cmd_buf[1] = (addr >> 8) & 0xFF;
+		this->cmd_buf[2] = addr & 0xFF;
+		ft81x_spi_write(this->cmd_buf, ADDR_OFFSET + this->cmd_staged);
+		this->cmdwriteaddr = (this->cmdwriteaddr + this->cmd_staged) % RAMCMD_SIZE;
+		this->cmd_staged = 0;
+	}
+}
+
 static void write8(const ft81x_reg_e address, uint8_t value) {
 	spi_data_t wb[WRITE8_LEN] = {};
 	wb[0] = FT81X_PREFIX_WRITE | ((address >> 16) & 0x3F);
 	wb[1] = (address >> 8) & 0xFF;
 	wb[2] = (address) & 0xFF;
 	wb[3] = value;
-	FT81X_SSELECT;
-	uv_spi_write_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL, wb, 8, WRITE8_LEN);
-	FT81X_SRELEASE;
+	ft81x_spi_write(wb, WRITE8_LEN);
 }
 
 
@@ -745,9 +860,7 @@ static void write16(const ft81x_reg_e address, uint16_t value) {
 	wb[2] = (address) & 0xFF;
 	wb[3] = value & 0xFF;
 	wb[4] = (value >> 8) & 0xFF;
-	FT81X_SSELECT;
-	uv_spi_write_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL, wb, 8, WRITE16_LEN);
-	FT81X_SRELEASE;
+	ft81x_spi_write(wb, WRITE16_LEN);
 }
 
 
@@ -761,9 +874,7 @@ static void write32(const ft81x_reg_e address, uint32_t value) {
 	wb[4] = (value >> 8) & 0xFF;
 	wb[5] = (value >> 16) & 0xFF;
 	wb[6] = (value >> 24) & 0xFF;
-	FT81X_SSELECT;
-	uv_spi_write_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL, wb, 8, WRITE32_LEN);
-	FT81X_SRELEASE;
+	ft81x_spi_write(wb, WRITE32_LEN);
 }
 
 
@@ -773,9 +884,7 @@ static void writehostcmd(const ft81x_hostcmds_e hostcmd, uint8_t parameter) {
 	wb[0] = hostcmd;
 	wb[1] = parameter;
 	wb[2] = 0;
-	FT81X_SSELECT;
-	uv_spi_write_sync(CONFIG_FT81X_SPI_CHANNEL, CONFIG_FT81X_SSEL, wb, 8, 3);
-	FT81X_SRELEASE;
+	ft81x_spi_write(wb, 3);
 }
 
 
@@ -850,6 +959,7 @@ static void set_font(const uint8_t font) {
 	if (this->font != font) {
 		DEBUG("Setting bitmap handle (font)\n");
 		writedl(BITMAP_HANDLE(font));
+		this->font = font;
 	}
 }
 
@@ -858,18 +968,23 @@ static void set_cell(const uint8_t cell) {
 	if (this->cell != cell) {
 		DEBUG("Setting cell\n");
 		writedl(CELL(cell));
+		this->cell = cell;
 	}
 }
 
 /// @brief: Waits until co-processor has processed all transactions
 static bool cmd_wait(void) {
 	bool ret = true;
-	// co-processor might modify the begin type, thus set it to undefined
+	// co-processor might modify the begin type and the bitmap handle and cell,
+	// thus set them to undefined
 	this->begin_type = 0xFF;
+	this->font = 0xFF;
+	this->cell = 0xFF;
+	// REG_CMD_WRITE was last written with cmdwriteaddr, only the read pointer
+	// has to be polled
 	uint16_t cmdread = read16(REG_CMD_READ);
-	uint16_t cmdwrite = read16(REG_CMD_WRITE);
 
-	while (cmdread != cmdwrite) {
+	while (cmdread != this->cmdwriteaddr) {
 		if (cmdread == 0xFFF) {
 			// fault. Recover from it and return error code
 			// printf("co-processor fault!!\n");
@@ -877,11 +992,11 @@ static bool cmd_wait(void) {
 			write16(REG_CMD_READ, this->cmdwriteaddr);
 			write16(REG_CMD_WRITE, this->cmdwriteaddr);
 			write8(REG_CPURESET, 0);
+			this->cmd_dl = UINT32_MAX;
 			ret = false;
 			break;
 		}
 		cmdread = read16(REG_CMD_READ);
-		cmdwrite = read16(REG_CMD_WRITE);
 		uv_rtos_task_yield();
 	}
 	return ret;
@@ -889,7 +1004,7 @@ static bool cmd_wait(void) {
 
 static void cmd_romfont(uint8_t bitmap_handle, uint8_t font_number) {
 	// set the RAMDL offset where co-processor writes the DL entries
-	write16(REG_CMD_DL, this->dl_index);
+	cmd_dl_sync();
 
 	DEBUG("Loading ROM font %u to bitmap handle %u\n",
 			font_number, bitmap_handle);
@@ -909,7 +1024,7 @@ static void cmd_romfont(uint8_t bitmap_handle, uint8_t font_number) {
 	// last thing is to wait for the co-processor to finish
 	// and update current dl_index
 	cmd_wait();
-	this->dl_index = read16(REG_CMD_DL);
+	cmd_dl_fetch();
 }
 
 
@@ -918,7 +1033,7 @@ static void cmd_romfont(uint8_t bitmap_handle, uint8_t font_number) {
 // of the first glyph cell in the bitmap.
 static void cmd_setfont2(uint8_t bitmap_handle, uint32_t metric_addr,
 		uint8_t firstchar) {
-	write16(REG_CMD_DL, this->dl_index);
+	cmd_dl_sync();
 
 	uint32_t cmd[4];
 	cmd[0] = CMD_SETFONT2;
@@ -932,7 +1047,7 @@ static void cmd_setfont2(uint8_t bitmap_handle, uint32_t metric_addr,
 	write16(REG_CMD_WRITE, this->cmdwriteaddr);
 
 	cmd_wait();
-	this->dl_index = read16(REG_CMD_DL);
+	cmd_dl_fetch();
 }
 
 
@@ -956,10 +1071,10 @@ static void draw_line(char *str, ui_font_st *font,
 	}
 
 	// set the RAMDL offset where co-processor writes the DL entries
-	write16(REG_CMD_DL, this->dl_index);
+	cmd_dl_sync();
 
-	// write header information as a bulk transfer
-	// FT81X automatically wraps continuous writes to RAM_CMD ring buffer space
+	// the header, the glyphs and the null termination are staged and written
+	// to RAM_CMD as one burst
 	DEBUG("CMD_TEXT: (%i, %i), font %i\n", x, y, font->handle);
 	uint16_t buf[DRAW_LINE_BUF_LEN];
 	*((uint32_t*) &buf[0]) = CMD_TEXT;
@@ -967,13 +1082,11 @@ static void draw_line(char *str, ui_font_st *font,
 	buf[3] = y;
 	buf[4] = font->handle;
 	buf[5] = align;
-	writestr(MEMMAP_RAM_CMD_BEGIN + this->cmdwriteaddr,
-			(const char*) buf, NULL, DRAW_LINE_BUF_LEN * 2);
-	this->cmdwriteaddr = (this->cmdwriteaddr + DRAW_LINE_BUF_LEN * 2) % RAMCMD_SIZE;
+	cmd_put(buf, DRAW_LINE_BUF_LEN * 2);
 
 	// Translate the UTF-8 line into single-byte font glyph codes (ASCII passes
 	// through, ä ö å etc. map to their low glyph slots) so the codes match the
-	// font's glyph table, and stream the result to RAM_CMD a chunk at a time.
+	// font's glyph table, and stage the result a chunk at a time.
 	// Using a small fixed chunk buffer keeps the stack footprint constant and
 	// independent of the line length.
 	// ROM fonts (custom_metric_addr == 0) lack ä ö å, so fall back to ASCII.
@@ -991,21 +1104,21 @@ static void draw_line(char *str, ui_font_st *font,
 			glyphs[n] = (char) uv_ui_codepoint_glyph(cp, nordic);
 			n++;
 		}
-		writestr(MEMMAP_RAM_CMD_BEGIN + this->cmdwriteaddr, glyphs, NULL, n);
-		this->cmdwriteaddr = (this->cmdwriteaddr + n) % RAMCMD_SIZE;
+		cmd_put(glyphs, n);
 	}
 
 	// write null termination marks until cmdwriteaddr is in world boundary
-	uint8_t nul = 4 - (this->cmdwriteaddr % 4);
-	write32(MEMMAP_RAM_CMD_BEGIN + this->cmdwriteaddr, 0);
-	this->cmdwriteaddr = (this->cmdwriteaddr + nul) % RAMCMD_SIZE;
+	const uint8_t zeros[4] = { 0 };
+	uint8_t nul = 4 - ((this->cmdwriteaddr + this->cmd_staged) % 4);
+	cmd_put(zeros, nul);
+	cmd_flush();
 
 	write16(REG_CMD_WRITE, this->cmdwriteaddr);
 
 	// last thing is to wait for the co-processor to finish
 	// and update current dl_index
 	cmd_wait();
-	this->dl_index = read16(REG_CMD_DL);
+	cmd_dl_fetch();
 
 }
 
@@ -1018,6 +1131,7 @@ static void draw_line(char *str, ui_font_st *font,
 
 void uv_ui_dlswap_impl(void) {
 	writedl(DISPLAY());
+	dl_flush();
 	write8(REG_DLSWAP, 0x2);
 	DEBUG("ramdl index: 0x%x\n", (unsigned int) this->dl_index);
 	if (this->dl_index_max < this->dl_index) {
@@ -1036,6 +1150,10 @@ void uv_ui_dlswap_impl(void) {
 		}
 		uv_rtos_task_yield();
 	}
+	this->spi.frame_bytes = this->spi.bytes;
+	this->spi.frame_transactions = this->spi.transactions;
+	this->spi.bytes = 0;
+	this->spi.transactions = 0;
 	// set the vertex format to pixel precision
 	writedl(VERTEX_FORMAT(0));
 }
@@ -1094,12 +1212,61 @@ uint32_t uv_ft81x_get_ramdl_usage(void) {
 }
 
 
+void uv_ft81x_get_spi_usage(uint32_t *bytes, uint32_t *transactions) {
+	if (bytes != NULL) {
+		*bytes = this->spi.frame_bytes;
+	}
+	else {
+	}
+	if (transactions != NULL) {
+		*transactions = this->spi.frame_transactions;
+	}
+	else {
+	}
+}
+
+
+
 
+// RAM_G below the media FIFO, shared by the custom fonts and the bitmaps.
+// The fonts are registered to the co-processor by their address and are
+// pinned; the bitmaps are moved over the holes the freed ones leave.
+static uv_ramalloc_st ramg;
+static uv_ramalloc_block_st ramg_blocks[CONFIG_FT81X_RAMG_BLOCKS];
 
-// Dynamic bitmap memory allocator state.
-// Each allocation in FT81X RAM is: [uint32_t data_size][uint32_t owner_ptr][pixel data...]
-#define FT81X_ALLOC_HEADER_SIZE		8
-static uint32_t ft81x_alloc_next = 0;
+
+void uv_ft81x_get_ramg_usage(uv_ramalloc_stats_st *stats) {
+	uv_ramalloc_get_stats(&ramg, stats);
+}
+
+
+/// @brief: A bitmap load, from finding the file to decoding it into RAM_G.
+/// Copying the file to the media FIFO is what takes the time; the
+/// asynchronous loads do it in chunks over several display steps, and the
+/// co-processor decodes the file once all of it is there.
+typedef struct {
+	uv_uimedia_st *bitmap;
+	uv_w25q128_st *exmem;
+	uv_fd_st fd;
+	bool found;
+	// the bytes of the file copied to the media FIFO so far
+	uint32_t offset;
+} media_load_st;
+
+// the asynchronous loads waiting, the first of which is in progress
+static struct {
+	struct {
+		uv_uimedia_st *bitmap;
+		uv_w25q128_st *exmem;
+	} queue[CONFIG_FT81X_MEDIA_QUEUE_LEN];
+	uint16_t count;
+	// true once the first load has been begun into *current*
+	bool started;
+	media_load_st current;
+} media;
+
+static bool media_step(uint32_t budget);
+static void media_dequeue(uint16_t index);
 
 
 // default weak hook: projects override this to install custom fonts
@@ -1191,17 +1358,21 @@ bool uv_ft81x_load_custom_font(uint8_t ui_font_index, uv_w25q128_st *exmem,
 			(hdr.stride > 0) && (hdr.height > 0)) {
 
 		uint32_t glyphs_len = (uint32_t) hdr.stride * hdr.height * 128u;
+		uint32_t glyphs_size = (glyphs_len + 3u) & ~3u;
 
-		// reserve RAM_G ahead of any media bitmaps (this runs during display
-		// init, before the app loads media). Keep everything 4-byte aligned.
-		uint32_t glyph_addr = (ft81x_alloc_next + 3u) & ~3u;
+		// the glyphs and the metric block after them. This runs during display
+		// init, before the app loads media, so the font sits at the bottom of
+		// RAM_G below the bitmaps.
+		uint32_t glyph_addr = uv_ramalloc_alloc(&ramg,
+				glyphs_size + FONT_METRICS_FONT_LEN,
+				&ui_fonts[ui_font_index], UV_RAMALLOC_PINNED);
 
 		// stream the glyph bitmap from external memory into RAM_G in chunks so
 		// we never need a large RAM buffer for the whole font
 		uint8_t buf[FONT_LOAD_CHUNK];
 		uint32_t file_off = sizeof(hdr) + 128u;	// header + width table
 		uint32_t done = 0;
-		bool ok = true;
+		bool ok = (glyph_addr != UV_RAMALLOC_NONE);
 		while ((done < glyphs_len) && ok) {
 			uint32_t want = uv_mini(FONT_LOAD_CHUNK, glyphs_len - done);
 			uint32_t got = uv_exmem_read_fd(exmem, &fd, buf, want, file_off + done);
@@ -1228,13 +1399,10 @@ bool uv_ft81x_load_custom_font(uint8_t ui_font_index, uv_w25q128_st *exmem,
 				metric[35] = hdr.height;
 				metric[36] = MEMMAP_RAM_G_BEGIN + glyph_addr;
 
-				uint32_t metric_addr = (glyph_addr + glyphs_len + 3u) & ~3u;
+				uint32_t metric_addr = glyph_addr + glyphs_size;
 				writestr(MEMMAP_RAM_G_BEGIN + metric_addr, (const char*) metric,
 						NULL, FONT_METRICS_FONT_LEN);
 
-				// advance the allocator so media bitmaps load after the font data
-				ft81x_alloc_next = metric_addr + FONT_METRICS_FONT_LEN;
-
 				// replace the ROM font on this handle with the custom font
 				cmd_setfont2(ui_fonts[ui_font_index].handle,
 						MEMMAP_RAM_G_BEGIN + metric_addr, 0);
@@ -1251,6 +1419,11 @@ bool uv_ft81x_load_custom_font(uint8_t ui_font_index, uv_w25q128_st *exmem,
 				ret = true;
 			}
 		}
+		if (!ret && (glyph_addr != UV_RAMALLOC_NONE)) {
+			uv_ramalloc_free(&ramg, glyph_addr);
+		}
+		else {
+		}
 	}
 	return ret;
 }
@@ -1270,16 +1443,76 @@ static void ft81x_cmd_memcpy(uint32_t dest, uint32_t src, uint32_t num) {
 }
 
 
+static void ramg_moved(void *owner, uint32_t addr) {
+	// only the bitmaps are not pinned
+	((uv_uimedia_st *) owner)->addr = addr;
+}
+
+
+static void ramg_evict(void *owner) {
+	uv_uimedia_st *bitmap = owner;
+	// keeps the rest for the image to be laid out as before, until it is
+	// loaded again
+	bitmap->evicted = true;
+	bitmap->addr = 0;
+}
+
+
+static void ramg_init(void) {
+	uv_ramalloc_init(&ramg, ramg_blocks, CONFIG_FT81X_RAMG_BLOCKS,
+			0, FT81X_MEDIAFIFO_ADDR);
+	uv_ramalloc_set_callbacks(&ramg, &ft81x_cmd_memcpy, &ramg_moved,
+			&ramg_evict);
+}
+
+
 #define LOAD_BUFFER_LEN		60
-uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
+
+/// @brief: Copies the next at most *budget* bytes of the file being loaded to
+/// the media FIFO, from where the co-processor decodes it.
+///
+/// @return: true once the whole file has been copied, or when there is
+/// nothing to copy since the file was not found or does not fit the FIFO
+static bool media_feed(media_load_st *l, uint32_t budget) {
+	uint32_t buffer[LOAD_BUFFER_LEN / 4];
+	bool ret = false;
+	if (!l->found || (l->fd.file_size > CONFIG_FT81X_MEDIA_MAXSIZE)) {
+		ret = true;
+	}
+	else {
+		while (!ret && (budget != 0)) {
+			uint32_t size = uv_exmem_read_fd(l->exmem, &l->fd, (void*) buffer,
+					uv_mini(LOAD_BUFFER_LEN, budget), l->offset);
+			if (size == 0) {
+				// last, align memory to 4 bytes border
+				if (l->offset % 4) {
+					uint8_t stuff = 4 - (l->offset % 4);
+					memset(buffer, 0, stuff);
+					writestr(FT81X_MEDIAFIFO_ADDR + l->offset,
+							(const char *) buffer, NULL, stuff);
+					l->offset += stuff;
+				}
+				ret = true;
+			}
+			else {
+				writestr(FT81X_MEDIAFIFO_ADDR + l->offset,
+						(const char *) buffer, NULL, size);
+				l->offset += size;
+				budget -= uv_mini(size, budget);
+			}
+		}
+	}
+	return ret;
+}
+
+
+/// @brief: Finds the file of a bitmap load and works out the bitmap format
+static void media_begin(media_load_st *l, uv_uimedia_st *bitmap,
 		uv_w25q128_st *exmem, const char *filename) {
-	uint8_t cmd_header_len_bytes = 12;
-	uint32_t buffer[LOAD_BUFFER_LEN / 4 + cmd_header_len_bytes / 4];
-	uint32_t offset = 0;
-	uv_fd_st fd;
-	uint32_t size = 0;
-	uint32_t header_addr = ft81x_alloc_next;
-	uint32_t pixel_addr = header_addr + FT81X_ALLOC_HEADER_SIZE;
+	uint32_t buffer[8];
+	l->bitmap = bitmap;
+	l->exmem = exmem;
+	l->offset = 0;
 
 	// The bitmap keeps the name it was loaded from: it is what identifies it to
 	// a mirroring sink, and the only way back to the file when one asks for the
@@ -1291,41 +1524,29 @@ uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 	// one is remembering the only one.
 	media_exmem = exmem;
 
-	bool found = uv_exmem_find(exmem, (char*) filename, &fd);
+	l->found = uv_exmem_find(exmem, (char*) filename, &l->fd);
 
-	// RAM_G overflow guard: media bitmaps are decoded upward from pixel_addr and
-	// must stay below the media-download FIFO at the top of RAM_G. Custom fonts
-	// occupy the bottom of RAM_G, so a media-heavy screen can exhaust the space.
-	// If we are already at/over the FIFO there is no room at all, so refuse the
-	// load here rather than letting the co-processor scribble over the FIFO.
-	bool ram_full = (pixel_addr >= FT81X_MEDIAFIFO_ADDR);
-	if (ram_full) {
-		uv_terminal_enable(TERMINAL_CAN);
-		printf("FT81X RAM_G full: cannot load %s (next addr 0x%x >= FIFO 0x%x)\n",
-				filename, (unsigned) pixel_addr, (unsigned) FT81X_MEDIAFIFO_ADDR);
-	}
-
-	bitmap->addr = pixel_addr;
 	bitmap->type = UV_UIMEDIA_IMAGE;
 	bitmap->visible = true;
+	bitmap->evicted = false;
 
 	// specify the bitmap format
-	if (strstr(filename, ".jp" ) != NULL ||
-			strstr(filename, ".JP") != NULL) {
+	if (strstr(bitmap->filename, ".jp" ) != NULL ||
+			strstr(bitmap->filename, ".JP") != NULL) {
 		// color jpgs are in RGB565
 		bitmap->format = BITMAP_FORMAT_RGB565;
 	}
 	else {
 		// PNG image, check the color type from png format
 		// This hard-coded thingie is PNG format dependent
-		uv_exmem_read_fd(exmem, &fd, (void*) buffer, 26, 0);
+		uv_exmem_read_fd(l->exmem, &l->fd, (void*) buffer, 26, 0);
 		uint8_t bitdepth = ((uint8_t*) buffer)[24];
 		uint8_t ctype = ((uint8_t*) buffer)[25];
 
 		if (bitdepth != 8) {
 			uv_terminal_enable(TERMINAL_CAN);
 			printf("Error parsing PNG bitmap %s: Bit depth has to be 8, but was %u\n",
-					filename, bitdepth);
+					bitmap->filename, bitdepth);
 		}
 		if (ctype & 0x1) {
 			// paletted image
@@ -1340,14 +1561,45 @@ uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 			bitmap->format = BITMAP_FORMAT_RGB565;
 		}
 	}
+}
+
+
+/// @brief: Decodes the file copied to the media FIFO into the free memory at
+/// the end of RAM_G. Its size is not known before it is decoded.
+///
+/// @param ram_full: Set to true when the bitmap failed to load for the lack
+/// of room
+///
+/// @return: The size of the decoded bitmap, 0 in case of error
+static uint32_t media_decode_tail(media_load_st *l, bool *ram_full) {
+	uint8_t cmd_header_len_bytes = 12;
+	uint32_t buffer[4];
+	uv_uimedia_st *bitmap = l->bitmap;
+	uint32_t size = 0;
+	uint32_t pixel_addr;
+	uv_ramalloc_stats_st stats;
+
+	uv_ramalloc_get_stats(&ramg, &stats);
+	uint32_t room = uv_ramalloc_get_tail(&ramg, &pixel_addr);
+	if (room < stats.free) {
+		// gathers the holes left by the freed bitmaps to the end
+		uv_ramalloc_compact(&ramg);
+		room = uv_ramalloc_get_tail(&ramg, &pixel_addr);
+	}
+	else {
+	}
+	// If there is no room at all, the load is refused here rather than
+	// letting the co-processor scribble over the media FIFO above.
+	*ram_full = (room == 0);
 
+	bitmap->addr = pixel_addr;
 
 	// CONFIG_FT81X_MEDIA_MAXSIZE specifies the maximum media size available
-	if (found && !ram_full && fd.file_size <= CONFIG_FT81X_MEDIA_MAXSIZE) {
+	if (l->found && !*ram_full && l->fd.file_size <= CONFIG_FT81X_MEDIA_MAXSIZE) {
 		// set the RAMDL offset where co-processor writes the DL entries
-		write16(REG_CMD_DL, this->dl_index);
+		cmd_dl_sync();
 
-		// setup a mediafifo
+		// setup a mediafifo over the file already copied to it
 		buffer[0] = CMD_MEDIAFIFO;
 		buffer[1] = FT81X_MEDIAFIFO_ADDR;
 		buffer[2] = CONFIG_FT81X_MEDIA_MAXSIZE;
@@ -1357,31 +1609,9 @@ uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 		write16(REG_CMD_WRITE, this->cmdwriteaddr);
 		// wait for the co-processor to finish
 		cmd_wait();
-		write32(REG_MEDIAFIFO_WRITE, 0);
 		write32(REG_MEDIAFIFO_READ, 0);
-
-		// download the bitmap to mediafifo
-		size = uv_exmem_read_fd(exmem, &fd,
-				(void*) buffer, LOAD_BUFFER_LEN, offset);
-
-		do {
-			writestr(FT81X_MEDIAFIFO_ADDR + offset, (const char *) buffer, NULL, size);
-			offset += size;
-			size = uv_exmem_read_fd(exmem, &fd,
-					buffer, LOAD_BUFFER_LEN, offset);
-		}
-		while (size != 0);
-
-		// last, align memory to 4 bytes border
-		if (offset % 4) {
-			uint8_t stuff = 4 - (offset % 4);
-			memset(buffer, 0, stuff);
-			writestr(FT81X_MEDIAFIFO_ADDR + offset,
-					(const char *) buffer, NULL, stuff);
-			offset += stuff;
-		}
 		// update mediafifo write register
-		write32(REG_MEDIAFIFO_WRITE, offset);
+		write32(REG_MEDIAFIFO_WRITE, l->offset);
 
 		// create bitmap structure, based on communication manual data
 		buffer[0] = CMD_LOADIMAGE;
@@ -1446,14 +1676,15 @@ uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 			if (!bitmap->width || !bitmap->height) {
 				size = 0;
 			}
-			// the decode may have run past the media FIFO at the top of RAM_G,
-			// corrupting it. Reject the bitmap and report it rather than drawing
-			// a corrupted image (peak media + fonts exceed the RAM_G budget).
-			else if ((bitmap->addr + bitmap->size) > FT81X_MEDIAFIFO_ADDR) {
+			// the decode may have run past the free memory into the media
+			// FIFO at the top of RAM_G, corrupting it. Reject the bitmap rather
+			// than drawing a corrupted image.
+			else if (bitmap->size > room) {
 				uv_terminal_enable(TERMINAL_CAN);
-				printf("FT81X RAM_G overflow: %s at 0x%x size %u crosses FIFO 0x%x\n",
-						filename, (unsigned) bitmap->addr, (unsigned) bitmap->size,
-						(unsigned) FT81X_MEDIAFIFO_ADDR);
+				printf("FT81X RAM_G overflow: %s at 0x%x size %u, %u bytes free\n",
+						bitmap->filename, (unsigned) bitmap->addr, (unsigned) bitmap->size,
+						(unsigned) room);
+				*ram_full = true;
 				size = 0;
 			}
 			else {
@@ -1467,6 +1698,36 @@ uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 	else {
 		size = 0;
 	}
+	return size;
+}
+
+
+/// @brief: Decodes the file copied to the media FIFO into RAM_G
+///
+/// @return: The size of the decoded bitmap, 0 in case of error
+static uint32_t media_decode(media_load_st *l) {
+	uv_uimedia_st *bitmap = l->bitmap;
+	bool ram_full;
+	uint32_t size = media_decode_tail(l, &ram_full);
+#if CONFIG_FT81X_MEDIA_CACHE
+	// Evicted one at a time, least recently drawn first, until it fits. A
+	// decode that ran out of room may have run into the media FIFO, so the
+	// file is copied there again.
+	while ((size == 0) && ram_full && uv_ramalloc_evict(&ramg)) {
+		l->offset = 0;
+		media_feed(l, UINT32_MAX);
+		size = media_decode_tail(l, &ram_full);
+	}
+#endif
+	if ((size != 0) &&
+			(uv_ramalloc_alloc_at(&ramg, bitmap->addr, bitmap->size, bitmap,
+			CONFIG_FT81X_MEDIA_CACHE ? UV_RAMALLOC_EVICTABLE : 0) == UV_RAMALLOC_NONE)) {
+		// no room left in the block table
+		ram_full = true;
+		size = 0;
+	}
+	else {
+	}
 
 	if (size == 0) {
 		// The bitmap failed to load. Report why and which file, since the
@@ -1474,10 +1735,10 @@ uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 		// the first custom-font glyph atlas), so a bad/missing media file shows
 		// up on screen as a garbled 40x40 image.
 		uv_terminal_enable(TERMINAL_CAN);
-		printf("FT81X media load FAILED: %s (%s)\n", filename,
-				(!found) ? "not found on exmem" :
+		printf("FT81X media load FAILED: %s (%s)\n", bitmap->filename,
+				(!l->found) ? "not found on exmem" :
 				ram_full ? "RAM_G full" :
-				(fd.file_size > CONFIG_FT81X_MEDIA_MAXSIZE) ? "file too large" :
+				(l->fd.file_size > CONFIG_FT81X_MEDIA_MAXSIZE) ? "file too large" :
 				"decode failed / corrupt");
 		// error occurred, specify the settings for bitmap
 		// data which wont cause anything unexpected
@@ -1492,18 +1753,93 @@ uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 		bitmap->palette_size = 0;
 	}
 	else {
-		// write allocation header to FT81X RAM: [data_size][owner_ptr]
-		uint32_t hdr[2];
-		hdr[0] = bitmap->size;
-		hdr[1] = (uint32_t)(uintptr_t) bitmap;
-		writestr(header_addr, (const char *) hdr, NULL, FT81X_ALLOC_HEADER_SIZE);
-		ft81x_alloc_next = header_addr + FT81X_ALLOC_HEADER_SIZE + bitmap->size;
 	}
+	bitmap->loading = false;
 
 	return size;
 }
 
 
+
+
+uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename) {
+	// the queued loads share the media FIFO with this one
+	while (media.count != 0) {
+		media_step(UINT32_MAX);
+	}
+	media_load_st l;
+	media_begin(&l, bitmap, exmem, filename);
+	media_feed(&l, UINT32_MAX);
+	return media_decode(&l);
+}
+
+
+void uv_uimedia_newbitmapexmem_async(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename) {
+	if (media.count == CONFIG_FT81X_MEDIA_QUEUE_LEN) {
+		// no room to wait in, so it does not wait
+		uv_uimedia_newbitmapexmem(bitmap, exmem, filename);
+	}
+	else {
+		bitmap->filename = filename;
+		bitmap->type = UV_UIMEDIA_IMAGE;
+		bitmap->visible = true;
+		bitmap->addr = 0;
+		bitmap->size = 0;
+		bitmap->width = 0;
+		bitmap->height = 0;
+		bitmap->loading = true;
+		bitmap->evicted = false;
+		media.queue[media.count].bitmap = bitmap;
+		media.queue[media.count].exmem = exmem;
+		media.count++;
+	}
+}
+
+
+/// @brief: Moves the first queued load on by at most *budget* bytes, and
+/// decodes it once all of it has been copied
+///
+/// @return: true when a bitmap was decoded and can be drawn
+static bool media_step(uint32_t budget) {
+	bool ret = false;
+	if (media.count != 0) {
+		if (!media.started) {
+			media_begin(&media.current, media.queue[0].bitmap,
+					media.queue[0].exmem, media.queue[0].bitmap->filename);
+			media.started = true;
+		}
+		else {
+		}
+		if (media_feed(&media.current, budget)) {
+			media_decode(&media.current);
+			media_dequeue(0);
+			ret = true;
+		}
+		else {
+		}
+	}
+	else {
+	}
+	return ret;
+}
+
+
+/// @brief: Removes the queued load at *index*
+static void media_dequeue(uint16_t index) {
+	if (index == 0) {
+		media.started = false;
+	}
+	else {
+	}
+	media.count--;
+	for (uint16_t i = index; i < media.count; i++) {
+		media.queue[i] = media.queue[i + 1];
+	}
+}
+
+
 void uv_uimedia_free(uv_uimedia_st *bitmap) {
 #if CONFIG_UI_REMOTE
 	// the image is about to stop existing, so abandon any transfer of it; the
@@ -1511,54 +1847,48 @@ void uv_uimedia_free(uv_uimedia_st *bitmap) {
 	uv_ui_remote_asset_cancel(UV_UI_REMOTE_ASSET_KIND_BITMAP,
 			uv_ui_remote_bitmap_id(bitmap));
 #endif
-	if (bitmap->addr < FT81X_ALLOC_HEADER_SIZE) {
-		memset(bitmap, 0, sizeof(*bitmap));
+	for (uint16_t i = 0; i < media.count; i++) {
+		if (media.queue[i].bitmap == bitmap) {
+			// never decoded, so there is nothing in RAM_G to give back
+			media_dequeue(i);
+			break;
+		}
+		else {
+		}
+	}
+	if (uv_ramalloc_get_owner(&ramg, bitmap->addr) == bitmap) {
+		// The hole is left for the compaction before the next decode to
+		// gather up, which moves every bitmap above it only once however
+		// many are freed in between.
+		uv_ramalloc_free(&ramg, bitmap->addr);
 	}
 	else {
-		uint32_t header_addr = bitmap->addr - FT81X_ALLOC_HEADER_SIZE;
-		uint32_t data_size = read32(header_addr);
-		uint32_t block_size = FT81X_ALLOC_HEADER_SIZE + data_size;
-		uint32_t src = header_addr + block_size;
-
-		// compact: move each block in chunks no larger than block_size
-		// to avoid overlapping memcpy regions, since ft81x_cmd_memcpy
-		// does not support overlap. The gap between dest and cur is
-		// always block_size, so chunks of that size never overlap.
-		uint32_t dest = header_addr;
-		uint32_t cur = src;
-		while (cur < ft81x_alloc_next) {
-			uint32_t cur_size = read32(cur);
-			uint32_t owner = read32(cur + 4);
-			uv_uimedia_st *owner_bmp = (uv_uimedia_st *)(uintptr_t) owner;
-			uint32_t cur_block_size = FT81X_ALLOC_HEADER_SIZE + cur_size;
-
-			uint32_t remaining = cur_block_size;
-			uint32_t chunk_dest = dest;
-			uint32_t chunk_src = cur;
-			while (remaining > 0) {
-				uint32_t chunk = (remaining < block_size) ? remaining : block_size;
-				ft81x_cmd_memcpy(chunk_dest, chunk_src, chunk);
-				chunk_dest += chunk;
-				chunk_src += chunk;
-				remaining -= chunk;
-			}
-
-			owner_bmp->addr = dest + FT81X_ALLOC_HEADER_SIZE;
-
-			cur += cur_block_size;
-			dest += cur_block_size;
-		}
-		ft81x_alloc_next -= block_size;
-
-		memset(bitmap, 0, sizeof(*bitmap));
+		// still loading, evicted or failed to load, so it has no memory
 	}
+	memset(bitmap, 0, sizeof(*bitmap));
 }
 
 void uv_ui_draw_bitmap_ext_impl(uv_uimedia_st *bitmap, int16_t x, int16_t y,
 		int16_t w, int16_t h, uint32_t wrap, color_t c) {
 
-	if (bitmap->visible &&
+	if (bitmap->evicted) {
+		// Wanted again, so loaded again, and drawn once it is. Never loaded
+		// here and now: a decode can move or evict the bitmaps this display
+		// list already draws. With the queue full it is left evicted, and
+		// asked for again on the redraw that the next finished load causes.
+		if ((media_exmem != NULL) &&
+				(media.count < CONFIG_FT81X_MEDIA_QUEUE_LEN)) {
+			uv_uimedia_newbitmapexmem_async(bitmap, media_exmem, bitmap->filename);
+		}
+		else {
+		}
+	}
+	else if (!bitmap->loading && bitmap->visible &&
 			uv_ui_is_visible(x, y, bitmap->width, bitmap->height)) {
+#if CONFIG_FT81X_MEDIA_CACHE
+		// what keeps the bitmaps on the screen from being evicted
+		uv_ramalloc_touch(&ramg, bitmap->addr);
+#endif
 		// set the blend color
 		set_color(c);
 
@@ -1749,7 +2079,7 @@ void uv_ui_touchscreen_calibrate(ui_transfmat_st *transform_matrix) {
 			LCD_HPPT(100),
 			UI_ALIGN_CENTER_TOP,
 			C(0xFFFFFFFF));
-	write16(REG_CMD_DL, this->dl_index);
+	cmd_dl_sync();
 
 	while (true) {
 		// wait until the screen is not pressed
@@ -1775,7 +2105,7 @@ void uv_ui_touchscreen_calibrate(ui_transfmat_st *transform_matrix) {
 			DEBUG("Calibration failed. Retrying...\n");
 		}
 	}
-	this->dl_index = read16(REG_CMD_DL);
+	cmd_dl_fetch();
 	DEBUG("screen calibration done\n");
 	uv_ui_dlswap_impl();
 	uv_ui_clear_impl(CONFIG_FT81X_SCREEN_COLOR);
@@ -1823,6 +2153,25 @@ bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
 }
 
 
+void uv_ui_input_poll_impl(void) {
+	// The touch controller has no event buffer of its own: the register is
+	// read once a step, and a touch shorter than that is not seen
+	int16_t x = 0, y = 0;
+	bool t = uv_ui_get_touch_impl(&x, &y);
+	if (t) {
+		this->touch_x = x;
+		this->touch_y = y;
+		uv_ui_input_push(UI_INPUT_TOUCH, x, y, 0);
+	}
+	else if (this->touched) {
+		uv_ui_input_push(UI_INPUT_RELEASE, this->touch_x, this->touch_y, 0);
+	}
+	else {
+	}
+	this->touched = t;
+}
+
+
 
 
 int16_t uv_ui_get_string_width(char *str, ui_font_st *font) {
@@ -1943,6 +2292,15 @@ void uv_ui_set_mask_impl(int16_t x, int16_t y, int16_t width, int16_t height) {
 
 // Returns true if the hardware requestes the UI to refresh. On FT81X this never happens
 bool uv_ui_get_refresh_request(void) {
+	// asked once every display step, which is where the asynchronous media
+	// loads move on. A bitmap becoming resident asks for the screen to be
+	// drawn again, with it in place of its placeholder.
+	return media_step(CONFIG_FT81X_MEDIA_LOAD_CHUNK);
+}
+
+
+bool uv_ui_frame_preserved_impl(void) {
+	// the display list is written from the start every frame
 	return false;
 }
 
@@ -6,6 +6,7 @@
  */
 
 #include "uv_j1939.h"
+#include <string.h>
 #include CONFIG_MAIN_H
 
 
@@ -89,3 +90,255 @@ uv_errors_e uv_j1939_dm1_get_dtc(j1939_dtc_st *dest,
 	return ret;
 }
 
+
+
+
+/// @brief: Orders the handlers by PGN and then by source address. UV_J1939_SA_ANY
+/// sorts after every real source address.
+static int32_t handler_cmp(uint16_t pgn, uint16_t sa, uv_j1939_handler_st *h) {
+	int32_t ret;
+	if (pgn != h->pgn) {
+		ret = (pgn < h->pgn) ? -1 : 1;
+	}
+	else if (sa != h->source_address) {
+		ret = (sa < h->source_address) ? -1 : 1;
+	}
+	else {
+		ret = 0;
+	}
+	return ret;
+}
+
+
+/// @brief: Returns the index of the first handler which doesn't order before
+/// (*pgn*, *sa*), or the handler count if there is none
+static uint16_t lower_bound(uv_j1939_dispatch_st *this, uint16_t pgn, uint16_t sa) {
+	uint16_t lo = 0;
+	uint16_t hi = uv_vector_size(&this->handlers);
+	while (lo < hi) {
+		uint16_t mid = lo + (hi - lo) / 2;
+		if (handler_cmp(pgn, sa, uv_vector_at(&this->handlers, mid)) > 0) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+
+/// @brief: Calls every handler matching *pgn* and *sa*.
+///
+/// @return: true if at least one handler was called
+static bool dispatch(uv_j1939_dispatch_st *this, uint16_t pgn, uint8_t sa,
+		const uint8_t *data, uint16_t data_len) {
+	bool ret = false;
+	// the handlers of a PGN are contiguous, the source address specific ones first
+	for (uint16_t i = lower_bound(this, pgn, 0); i < uv_vector_size(&this->handlers); i++) {
+		uv_j1939_handler_st *h = uv_vector_at(&this->handlers, i);
+		if (h->pgn != pgn) {
+			break;
+		}
+		if (h->source_address == sa ||
+				h->source_address == UV_J1939_SA_ANY) {
+			h->callb(__uv_get_user_ptr(), pgn, sa, data, data_len);
+			ret = true;
+		}
+	}
+	return ret;
+}
+
+
+/// @brief: Returns true if any handler would accept *pgn* from *sa*
+static bool has_handler(uv_j1939_dispatch_st *this, uint16_t pgn, uint8_t sa) {
+	bool ret = false;
+	for (uint16_t i = lower_bound(this, pgn, 0); i < uv_vector_size(&this->handlers); i++) {
+		uv_j1939_handler_st *h = uv_vector_at(&this->handlers, i);
+		if (h->pgn != pgn) {
+			break;
+		}
+		if (h->source_address == sa ||
+				h->source_address == UV_J1939_SA_ANY) {
+			ret = true;
+			break;
+		}
+	}
+	return ret;
+}
+
+
+void uv_j1939_dispatch_init(uv_j1939_dispatch_st *this,
+		uv_j1939_handler_st *handler_buffer, uint16_t handler_buffer_len,
+		void *tp_buffer, uint16_t tp_buffer_len) {
+	uv_vector_init(&this->handlers, handler_buffer,
+			handler_buffer_len, sizeof(uv_j1939_handler_st));
+	this->tp_buffer = tp_buffer;
+	this->tp_buffer_len = (tp_buffer == NULL) ? 0 : tp_buffer_len;
+	this->tp_pgn = 0;
+	this->tp_byte_count = 0;
+	this->tp_source_address = 0;
+	this->tp_packet_count = 0;
+	this->tp_next_seq = 0;
+
+	if (this->tp_buffer_len) {
+		uv_can_config_rx_message(CONFIG_CANOPEN_CHANNEL,
+				UV_J1939_PGN_TP_CM << 8,
+				0xFF00UL << 8,
+				CAN_EXT);
+		uv_can_config_rx_message(CONFIG_CANOPEN_CHANNEL,
+				UV_J1939_PGN_TP_DT << 8,
+				0xFF00UL << 8,
+				CAN_EXT);
+	}
+}
+
+
+uv_errors_e uv_j1939_dispatch_add(uv_j1939_dispatch_st *this,
+		uint16_t pgn, uint16_t source_address, uv_j1939_pgn_callb_t callb) {
+	uv_errors_e ret = ERR_NONE;
+	uint32_t mask = UV_J1939_PGN_MASK;
+	if ((pgn >> 8) < UV_J1939_PDU2_FORMAT_MIN) {
+		pgn &= 0xFF00;
+		mask &= ~0xFF00UL;
+	}
+	if (source_address != UV_J1939_SA_ANY) {
+		source_address &= 0xFF;
+		mask |= 0xFF;
+	}
+
+	if (callb == NULL) {
+		ret = ERR_NULL_PTR;
+	}
+	else {
+		uv_j1939_handler_st h = {
+				.pgn = pgn,
+				.source_address = source_address,
+				.callb = callb
+		};
+		// after any existing equal entries, so that handlers are called
+		// in the order they were added
+		uint16_t index = lower_bound(this, pgn, source_address);
+		while (index < uv_vector_size(&this->handlers) &&
+				handler_cmp(pgn, source_address,
+						uv_vector_at(&this->handlers, index)) == 0) {
+			index++;
+		}
+		ret = uv_vector_insert(&this->handlers, index, &h);
+	}
+	if (ret == ERR_NONE) {
+		uv_can_config_rx_message(CONFIG_CANOPEN_CHANNEL,
+				((uint32_t) pgn << 8) | (source_address & 0xFF),
+				mask,
+				CAN_EXT);
+	}
+	return ret;
+}
+
+
+uv_errors_e uv_j1939_dispatch_remove(uv_j1939_dispatch_st *this,
+		uint16_t pgn, uint16_t source_address, uv_j1939_pgn_callb_t callb) {
+	uv_errors_e ret = ERR_INVALID_DATA;
+	if ((pgn >> 8) < UV_J1939_PDU2_FORMAT_MIN) {
+		pgn &= 0xFF00;
+	}
+	if (source_address != UV_J1939_SA_ANY) {
+		source_address &= 0xFF;
+	}
+	for (uint16_t i = lower_bound(this, pgn, source_address);
+			i < uv_vector_size(&this->handlers); i++) {
+		uv_j1939_handler_st *h = uv_vector_at(&this->handlers, i);
+		if (handler_cmp(pgn, source_address, h) != 0) {
+			break;
+		}
+		if (h->callb == callb) {
+			ret = uv_vector_remove(&this->handlers, i, 1);
+			break;
+		}
+	}
+	return ret;
+}
+
+
+static bool tp_cm_rx(uv_j1939_dispatch_st *this, uv_can_msg_st *msg, uint8_t sa) {
+	bool ret = false;
+	if (msg->data_length == 8) {
+		if (this->tp_byte_count != 0 &&
+				sa == this->tp_source_address) {
+			// a new announcement or an abort from the same source
+			// cancels the ongoing transfer
+			this->tp_byte_count = 0;
+			ret = true;
+		}
+		if (msg->data_8bit[0] == UV_J1939_TP_CM_BAM &&
+				this->tp_byte_count == 0) {
+			uint16_t byte_count = msg->data_8bit[1] | (msg->data_8bit[2] << 8);
+			uint8_t packet_count = msg->data_8bit[3];
+			uint16_t pgn = msg->data_8bit[5] | (msg->data_8bit[6] << 8);
+			if ((pgn >> 8) < UV_J1939_PDU2_FORMAT_MIN) {
+				pgn &= 0xFF00;
+			}
+			if (byte_count != 0 &&
+					byte_count <= this->tp_buffer_len &&
+					packet_count == (byte_count + 6) / 7 &&
+					has_handler(this, pgn, sa)) {
+				this->tp_pgn = pgn;
+				this->tp_byte_count = byte_count;
+				this->tp_packet_count = packet_count;
+				this->tp_source_address = sa;
+				this->tp_next_seq = 1;
+				ret = true;
+			}
+		}
+	}
+	return ret;
+}
+
+
+static bool tp_dt_rx(uv_j1939_dispatch_st *this, uv_can_msg_st *msg, uint8_t sa) {
+	bool ret = false;
+	if (this->tp_byte_count != 0 &&
+			sa == this->tp_source_address) {
+		ret = true;
+		if (msg->data_length == 8 &&
+				msg->data_8bit[0] == this->tp_next_seq) {
+			uint16_t offset = (this->tp_next_seq - 1) * 7;
+			uint16_t len = uv_mini(7, this->tp_byte_count - offset);
+			memcpy(&this->tp_buffer[offset], &msg->data_8bit[1], len);
+			if (this->tp_next_seq == this->tp_packet_count) {
+				uint16_t byte_count = this->tp_byte_count;
+				this->tp_byte_count = 0;
+				dispatch(this, this->tp_pgn, sa, this->tp_buffer, byte_count);
+			}
+			else {
+				this->tp_next_seq++;
+			}
+		}
+		else {
+			// lost or out of order packet, BAM has no retransmission
+			this->tp_byte_count = 0;
+		}
+	}
+	return ret;
+}
+
+
+bool uv_j1939_dispatch_rx(uv_j1939_dispatch_st *this, uv_can_msg_st *msg) {
+	bool ret = false;
+	if (msg->type == CAN_EXT) {
+		uint16_t pgn = uv_j1939_get_pdu_pgn(msg);
+		uint8_t sa = uv_j1939_get_source_address(msg);
+		if (this->tp_buffer_len != 0 &&
+				pgn == UV_J1939_PGN_TP_CM) {
+			ret = tp_cm_rx(this, msg, sa);
+		}
+		else if (this->tp_buffer_len != 0 &&
+				pgn == UV_J1939_PGN_TP_DT) {
+			ret = tp_dt_rx(this, msg, sa);
+		}
+		else {
+			ret = dispatch(this, pgn, sa, msg->data_8bit, msg->data_length);
+		}
+	}
+	return ret;
+}
@@ -29,7 +29,11 @@
 
 #include "uv_lcd.h"
 #include "uv_emc.h"
+#include "uv_framebuffer.h"
 #include <string.h>
+#if CONFIG_LCD_DMA
+#include "uv_rtos.h"
+#endif
 #if CONFIG_LCD_TOUCHSCREEN
 #include "uv_adc.h"
 #include "uv_gpio.h"
@@ -46,6 +50,28 @@ lcd_line_t *lcd = (lcd_line_t *) CONFIG_LCD_BUFFER_ADDRESS;
 static volatile uint8_t double_buffer_swap_req = false;
 #endif
 
+#if CONFIG_LCD_DMA
+/// @brief: A GPDMA linked list item, laid out as the controller reads it. A
+/// blit copies each row with one.
+typedef struct {
+	uint32_t src;
+	uint32_t dest;
+	uint32_t lli;
+	uint32_t control;
+} dma_lli_st;
+
+static dma_lli_st dma_lli[LCD_H_PX];
+
+// the most words one linked list item can copy
+#define DMA_TRANSFER_MAX	4095
+// word wide transfers in bursts of 32, with both addresses incremented, as
+// gpdma_17xx_40xx.c sets memory to memory transfers up
+#define DMA_CONTROL(words)	((words) | \
+							(4 << 12) | (4 << 15) | \
+							(2 << 18) | (2 << 21) | \
+							(1 << 26) | (1 << 27))
+#endif
+
 #if CONFIG_LCD_TOUCHSCREEN
 typedef struct {
 	uint16_t x;
@@ -136,6 +162,12 @@ uv_errors_e _uv_lcd_init(void) {
 
 	uv_lcd_draw_rect(0, 0, LCD_W(1.0f), LCD_H(1.0f), C(0));
 
+#if CONFIG_LCD_DMA
+	// enable power to the GPDMA and the controller itself, little-endian
+	LPC_SC->PCONP |= (1 << 29);
+	LPC_GPDMA->DMACConfig = 1;
+#endif
+
 #if CONFIG_LCD_DOUBLE_BUFFER
 	LPC_LCD->INTMSK |= (1 << 2);
 	LPC_LCD->INTCLR |= (1 << 2);
@@ -183,39 +215,113 @@ void LCD_IRQHandler(void) {
 
 
 
-#define draw_hline(x, y, length, color)	\
-	do { int32_t hlinei; \
-		LCD_PIXEL_TYPE *hlineptr = &lcd[y][x]; \
-		for (hlinei = 0; hlinei < length; hlinei++) { \
-			*(hlineptr++) = *((int32_t*) &color); \
-		} \
-	} while(0)
+/// @brief: Clips the rectangle at *x*, *y* to the mask and to the screen
+///
+/// @return: false if nothing of it is left
+static bool clip(int32_t *x, int32_t *y, int32_t *width, int32_t *height,
+		const uv_bounding_box_st *maskbb) {
+	bool ret = true;
+	if (*x < maskbb->x) {
+		*width -= maskbb->x - *x;
+		*x = maskbb->x;
+	}
+	if (*y < maskbb->y) {
+		*height -= maskbb->y - *y;
+		*y = maskbb->y;
+	}
+
+	if (*x > LCD_W_PX || *y > LCD_H_PX) {
+		ret = false;
+	}
+	else {
+		if ((*x + *width) > (maskbb->x + maskbb->width)) { *width = maskbb->x + maskbb->width - *x; }
+		if ((*y + *height) > (maskbb->y + maskbb->height)) { *height = maskbb->y + maskbb->height - *y; }
+		if (*x + *width > LCD_W_PX) { *width = LCD_W_PX - *x; }
+		if (*y + *height > LCD_H_PX) { *height = LCD_H_PX - *y; }
+		if ((*width < 0) || (*height < 0)) {
+			ret = false;
+		}
+	}
+	return ret;
+}
 
 
 void uv_lcd_draw_mrect(int32_t x, int32_t y, int32_t width, int32_t height, const color_t c,
 		const uv_bounding_box_st *maskbb) {
+	if (clip(&x, &y, &width, &height, maskbb)) {
+		// a rectangle as wide as the screen is filled as one span
+#if CONFIG_LCD_BITS_PER_PIXEL == LCD_24_BPP
+		uv_fb_fill_rect32(&lcd[y][x], LCD_W_PX, width, height, (uint32_t) c);
+#else
+		uv_fb_fill_rect16(&lcd[y][x], LCD_W_PX, width, height, (uint16_t) c);
+#endif
+	}
+}
+
 
-	if (x < maskbb->x) {
-		width -= maskbb->x - x;
-		x = maskbb->x;
+#if CONFIG_LCD_DMA
+/// @brief: Copies the rows with the GPDMA, one linked list item per row, and
+/// yields to the other tasks until it is done
+static void dma_blit(uint8_t *dest, const uint8_t *src, uint32_t src_stride,
+		uint32_t row_len, uint32_t rows) {
+	for (uint32_t j = 0; j < rows; j++) {
+		dma_lli[j].src = (uint32_t) src;
+		dma_lli[j].dest = (uint32_t) dest;
+		dma_lli[j].lli = (j + 1 < rows) ? (uint32_t) &dma_lli[j + 1] : 0;
+		dma_lli[j].control = DMA_CONTROL(row_len / 4);
+		src += src_stride;
+		dest += sizeof(lcd[0]);
 	}
-	if (y < maskbb->y) {
-		height -= maskbb->y - y;
-		y = maskbb->y;
+	LPC_GPDMA->DMACIntTCClear = (1 << CONFIG_LCD_DMA_CHANNEL);
+	LPC_GPDMA->DMACIntErrClr = (1 << CONFIG_LCD_DMA_CHANNEL);
+	LPC_GPDMACH_TypeDef *ch = (LPC_GPDMACH_TypeDef *)
+			((uint32_t) LPC_GPDMACH0 + 0x20 * CONFIG_LCD_DMA_CHANNEL);
+	ch->CSrcAddr = dma_lli[0].src;
+	ch->CDestAddr = dma_lli[0].dest;
+	ch->CLLI = dma_lli[0].lli;
+	ch->CControl = dma_lli[0].control;
+	// memory to memory, enabled
+	ch->CConfig = 1;
+	while (LPC_GPDMA->DMACEnbldChns & (1 << CONFIG_LCD_DMA_CHANNEL)) {
+		uv_rtos_task_yield();
 	}
+}
+#endif
 
-	if (x > LCD_W_PX || y > LCD_H_PX) { return; }
 
-	if ((x + width) > (maskbb->x + maskbb->width)) { width = maskbb->x + maskbb->width - x; }
-	if ((y + height) > (maskbb->y + maskbb->height)) { height = maskbb->y + maskbb->height - y; }
-	if (x + width > LCD_W_PX) { width = LCD_W_PX - x; }
-	if (y + height > LCD_H_PX) { height = LCD_H_PX - y; }
-	if ((width < 0) || (height < 0)) {
-		return;
-	}
-	uint32_t j;
-	for (j = y; j < y + height; j++) {
-		draw_hline(x, j, width, c);
+void uv_lcd_draw_mimage(int32_t x, int32_t y, int32_t width, int32_t height,
+		const LCD_PIXEL_TYPE *image, const uv_bounding_box_st *maskbb) {
+	int32_t cx = x;
+	int32_t cy = y;
+	int32_t cw = width;
+	int32_t ch = height;
+	if (clip(&cx, &cy, &cw, &ch, maskbb)) {
+		// the rows of the image stay as long however much of them is clipped
+		const LCD_PIXEL_TYPE *src = &image[(cy - y) * width + (cx - x)];
+		uint32_t src_stride = width * sizeof(LCD_PIXEL_TYPE);
+		uint32_t row_len = cw * sizeof(LCD_PIXEL_TYPE);
+		bool dma = false;
+#if CONFIG_LCD_DMA
+		// the GPDMA copies words, and is worth setting up only for the
+		// large copies
+		dma = ((row_len * ch) >= CONFIG_LCD_DMA_MIN_BYTES) &&
+				(((uint32_t) src & 3) == 0) &&
+				(((uint32_t) &lcd[cy][cx] & 3) == 0) &&
+				((src_stride & 3) == 0) &&
+				((row_len & 3) == 0) &&
+				((row_len / 4) <= DMA_TRANSFER_MAX);
+		if (dma) {
+			dma_blit((uint8_t *) &lcd[cy][cx], (const uint8_t *) src,
+					src_stride, row_len, ch);
+		}
+		else {
+		}
+#endif
+		if (!dma) {
+			uv_fb_blit(&lcd[cy][cx], sizeof(lcd[0]), src, src_stride, row_len, ch);
+		}
+		else {
+		}
 	}
 }
 
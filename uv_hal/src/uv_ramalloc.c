@@ -0,0 +1,447 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "uv_ramalloc.h"
+#include "uv_utilities.h"
+#include <string.h>
+
+
+// The allocator only keeps addresses and never touches the memory it hands
+// out, which is the FT81X's RAM_G on the device. Having no CONFIG_FT81X guard
+// lets the host tests run it against a plain address range.
+
+
+#define ALIGN_UP(x)		(((x) + (UV_RAMALLOC_ALIGN - 1)) & ~(uint32_t) (UV_RAMALLOC_ALIGN - 1))
+
+
+
+/// @brief: Returns the index of the block at *addr*, -1 if no block starts there
+static int32_t find(const uv_ramalloc_st *this, uint32_t addr) {
+	int32_t ret = -1;
+	int32_t lo = 0;
+	int32_t hi = (int32_t) this->count - 1;
+	while (lo <= hi) {
+		int32_t mid = (lo + hi) / 2;
+		if (this->blocks[mid].addr == addr) {
+			ret = mid;
+			break;
+		}
+		else if (this->blocks[mid].addr < addr) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid - 1;
+		}
+	}
+	return ret;
+}
+
+
+/// @brief: Opens a new entry in the table at *index*
+static void insert(uv_ramalloc_st *this, uint16_t index) {
+	memmove(&this->blocks[index + 1], &this->blocks[index],
+			(this->count - index) * sizeof(this->blocks[0]));
+	this->count++;
+}
+
+
+/// @brief: Removes the entry at *index* from the table
+static void remove_block(uv_ramalloc_st *this, uint16_t index) {
+	memmove(&this->blocks[index], &this->blocks[index + 1],
+			(this->count - index - 1) * sizeof(this->blocks[0]));
+	this->count--;
+}
+
+
+/// @brief: Turns *size* bytes at *addr* of the free block at *index* into a
+/// used block, splitting the rest off as free blocks before and after it
+static uint32_t claim(uv_ramalloc_st *this, uint16_t index, uint32_t addr,
+		uint32_t size, void *owner, uv_ramalloc_flags_e flags) {
+	uint32_t ret = UV_RAMALLOC_NONE;
+	uv_ramalloc_block_st *b = &this->blocks[index];
+	uint32_t before = addr - b->addr;
+	uint32_t after = b->addr + b->size - addr - size;
+	uint16_t needed = (before != 0) + (after != 0);
+
+	if ((this->count + needed) <= this->len) {
+		if (before != 0) {
+			insert(this, index);
+			this->blocks[index].size = before;
+			index++;
+		}
+		else {
+
+		}
+		if (after != 0) {
+			insert(this, index);
+			this->blocks[index + 1].addr = addr + size;
+			this->blocks[index + 1].size = after;
+		}
+		else {
+
+		}
+		b = &this->blocks[index];
+		b->addr = addr;
+		b->size = size;
+		b->owner = owner;
+		b->flags = flags;
+		b->last_use = ++this->clock;
+		ret = addr;
+	}
+	else {
+		// no room in the table for the free blocks left over
+	}
+	return ret;
+}
+
+
+/// @brief: Returns the index of the lowest free block *size* bytes fit in
+/// without overflowing the table, -1 if there is none
+static int32_t fit(const uv_ramalloc_st *this, uint32_t size) {
+	int32_t ret = -1;
+	for (uint16_t i = 0; i < this->count; i++) {
+		const uv_ramalloc_block_st *b = &this->blocks[i];
+		if ((b->owner == NULL) &&
+				((b->size == size) ||
+				((b->size > size) && (this->count < this->len)))) {
+			ret = i;
+			break;
+		}
+		else {
+
+		}
+	}
+	return ret;
+}
+
+
+static uint32_t free_bytes(const uv_ramalloc_st *this) {
+	uint32_t ret = 0;
+	for (uint16_t i = 0; i < this->count; i++) {
+		if (this->blocks[i].owner == NULL) {
+			ret += this->blocks[i].size;
+		}
+		else {
+
+		}
+	}
+	return ret;
+}
+
+
+
+void uv_ramalloc_init(uv_ramalloc_st *this, uv_ramalloc_block_st *blocks,
+		uint16_t len, uint32_t base, uint32_t size) {
+	this->blocks = blocks;
+	this->len = len;
+	this->base = base;
+	this->size = size;
+	this->clock = 0;
+	this->evictions = 0;
+	this->move = NULL;
+	this->moved = NULL;
+	this->evict = NULL;
+	memset(&this->blocks[0], 0, sizeof(this->blocks[0]));
+	this->blocks[0].addr = base;
+	this->blocks[0].size = size;
+	this->count = 1;
+}
+
+
+void uv_ramalloc_set_callbacks(uv_ramalloc_st *this,
+		void (*move)(uint32_t dest, uint32_t src, uint32_t len),
+		void (*moved)(void *owner, uint32_t addr),
+		void (*evict)(void *owner)) {
+	this->move = move;
+	this->moved = moved;
+	this->evict = evict;
+}
+
+
+uint32_t uv_ramalloc_alloc(uv_ramalloc_st *this, uint32_t size,
+		void *owner, uv_ramalloc_flags_e flags) {
+	uint32_t ret = UV_RAMALLOC_NONE;
+	size = ALIGN_UP(size);
+
+	if ((size != 0) && (owner != NULL)) {
+		int32_t i = fit(this, size);
+		if ((i < 0) && (this->move != NULL) && (free_bytes(this) >= size)) {
+			uv_ramalloc_compact(this);
+			i = fit(this, size);
+		}
+		else {
+
+		}
+		while ((i < 0) && uv_ramalloc_evict(this)) {
+			i = fit(this, size);
+			if ((i < 0) && (this->move != NULL) && (free_bytes(this) >= size)) {
+				uv_ramalloc_compact(this);
+				i = fit(this, size);
+			}
+			else {
+
+			}
+		}
+		if (i >= 0) {
+			ret = claim(this, i, this->blocks[i].addr, size, owner, flags);
+		}
+		else {
+
+		}
+	}
+	else {
+
+	}
+	return ret;
+}
+
+
+uint32_t uv_ramalloc_alloc_at(uv_ramalloc_st *this, uint32_t addr,
+		uint32_t size, void *owner, uv_ramalloc_flags_e flags) {
+	uint32_t ret = UV_RAMALLOC_NONE;
+	size = ALIGN_UP(size);
+
+	if ((size != 0) && (owner != NULL) &&
+			(addr == ALIGN_UP(addr))) {
+		for (uint16_t i = 0; i < this->count; i++) {
+			const uv_ramalloc_block_st *b = &this->blocks[i];
+			if (b->addr + b->size > addr) {
+				if ((b->owner == NULL) &&
+						(b->addr <= addr) &&
+						((addr + size) <= (b->addr + b->size))) {
+					ret = claim(this, i, addr, size, owner, flags);
+				}
+				else {
+
+				}
+				break;
+			}
+			else {
+
+			}
+		}
+	}
+	else {
+
+	}
+	return ret;
+}
+
+
+void uv_ramalloc_free(uv_ramalloc_st *this, uint32_t addr) {
+	int32_t i = find(this, addr);
+	if ((i >= 0) && (this->blocks[i].owner != NULL)) {
+		uv_ramalloc_block_st *b = &this->blocks[i];
+		b->owner = NULL;
+		b->flags = 0;
+		b->last_use = 0;
+		if (((uint16_t) i + 1 < this->count) &&
+				(this->blocks[i + 1].owner == NULL)) {
+			b->size += this->blocks[i + 1].size;
+			remove_block(this, i + 1);
+		}
+		else {
+
+		}
+		if ((i > 0) && (this->blocks[i - 1].owner == NULL)) {
+			this->blocks[i - 1].size += this->blocks[i].size;
+			remove_block(this, i);
+		}
+		else {
+
+		}
+	}
+	else {
+
+	}
+}
+
+
+void *uv_ramalloc_get_owner(const uv_ramalloc_st *this, uint32_t addr) {
+	int32_t i = find(this, addr);
+	return (i >= 0) ? this->blocks[i].owner : NULL;
+}
+
+
+void uv_ramalloc_touch(uv_ramalloc_st *this, uint32_t addr) {
+	int32_t i = find(this, addr);
+	if ((i >= 0) && (this->blocks[i].owner != NULL)) {
+		this->blocks[i].last_use = ++this->clock;
+	}
+	else {
+
+	}
+}
+
+
+bool uv_ramalloc_evict(uv_ramalloc_st *this) {
+	int32_t lru = -1;
+	if (this->evict != NULL) {
+		for (uint16_t i = 0; i < this->count; i++) {
+			const uv_ramalloc_block_st *b = &this->blocks[i];
+			if ((b->owner != NULL) &&
+					(b->flags & UV_RAMALLOC_EVICTABLE) &&
+					((lru < 0) ||
+					// compared as a difference to the clock, so that the order
+					// holds over the clock wrapping around
+					((this->clock - b->last_use) >
+					(this->clock - this->blocks[lru].last_use)))) {
+				lru = i;
+			}
+			else {
+
+			}
+		}
+	}
+	else {
+
+	}
+	if (lru >= 0) {
+		void *owner = this->blocks[lru].owner;
+		uv_ramalloc_free(this, this->blocks[lru].addr);
+		this->evictions++;
+		this->evict(owner);
+	}
+	else {
+
+	}
+	return (lru >= 0);
+}
+
+
+uint32_t uv_ramalloc_compact(uv_ramalloc_st *this) {
+	uint32_t ret = 0;
+	uint32_t cursor = this->base;
+	uint16_t n = 0;
+
+	if (this->move != NULL) {
+		// the table is rewritten in place: a block is never written further
+		// up than where it was read from, since every free block written
+		// takes the place of at least one free block skipped
+		for (uint16_t i = 0; i < this->count; i++) {
+			uv_ramalloc_block_st b = this->blocks[i];
+			if (b.owner == NULL) {
+				// free memory is gathered up as the blocks above it move down
+			}
+			else if (b.flags & UV_RAMALLOC_PINNED) {
+				if (cursor < b.addr) {
+					memset(&this->blocks[n], 0, sizeof(this->blocks[n]));
+					this->blocks[n].addr = cursor;
+					this->blocks[n].size = b.addr - cursor;
+					n++;
+				}
+				else {
+
+				}
+				this->blocks[n++] = b;
+				cursor = b.addr + b.size;
+			}
+			else {
+				if (b.addr != cursor) {
+					// moved in pieces no longer than the distance moved, so
+					// that the source and destination of a piece never
+					// overlap
+					uint32_t step = b.addr - cursor;
+					uint32_t done = 0;
+					while (done < b.size) {
+						uint32_t len = uv_mini(step, b.size - done);
+						this->move(cursor + done, b.addr + done, len);
+						done += len;
+					}
+					ret += b.size;
+					b.addr = cursor;
+					if (this->moved != NULL) {
+						this->moved(b.owner, b.addr);
+					}
+					else {
+
+					}
+				}
+				else {
+
+				}
+				this->blocks[n++] = b;
+				cursor = b.addr + b.size;
+			}
+		}
+		if (cursor < this->base + this->size) {
+			memset(&this->blocks[n], 0, sizeof(this->blocks[n]));
+			this->blocks[n].addr = cursor;
+			this->blocks[n].size = this->base + this->size - cursor;
+			n++;
+		}
+		else {
+
+		}
+		this->count = n;
+	}
+	else {
+
+	}
+	return ret;
+}
+
+
+uint32_t uv_ramalloc_get_tail(const uv_ramalloc_st *this, uint32_t *addr) {
+	uint32_t ret = 0;
+	const uv_ramalloc_block_st *b = &this->blocks[this->count - 1];
+	if (b->owner == NULL) {
+		*addr = b->addr;
+		ret = b->size;
+	}
+	else {
+		*addr = this->base + this->size;
+	}
+	return ret;
+}
+
+
+void uv_ramalloc_get_stats(const uv_ramalloc_st *this, uv_ramalloc_stats_st *stats) {
+	memset(stats, 0, sizeof(*stats));
+	for (uint16_t i = 0; i < this->count; i++) {
+		const uv_ramalloc_block_st *b = &this->blocks[i];
+		if (b->owner == NULL) {
+			stats->free += b->size;
+			stats->largest_free = MAX(stats->largest_free, b->size);
+			stats->holes++;
+		}
+		else {
+			stats->used += b->size;
+			stats->blocks++;
+		}
+	}
+	if (stats->free != 0) {
+		stats->fragmentation = (uint16_t)
+				(((uint64_t) (stats->free - stats->largest_free) * 1000) / stats->free);
+	}
+	else {
+
+	}
+	stats->evictions = this->evictions;
+}
@@ -29,6 +29,8 @@ const uint8_t remote_msg_type_len[REMOTE_MSG_TYPE_COUNT + 1] = {
 		REMOTE_MSG_TYPE_UI_INFO_LEN,
 		REMOTE_MSG_TYPE_CLOSE_LEN,
 		REMOTE_MSG_TYPE_CAN_STATS_LEN,
+		REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN,
+		REMOTE_MSG_TYPE_UI_CAPS_LEN,
 		0
 };
 
@@ -64,6 +66,298 @@ void remote_can_msg_decode(const uint8_t *data, uv_can_msg_st *dest) {
 }
 
 
+static uint8_t varint_put(uint8_t *dest, uint32_t value) {
+	uint8_t len = 0;
+	while (value >= 0x80u) {
+		dest[len++] = (uint8_t) (value | 0x80u);
+		value >>= 7;
+	}
+	dest[len++] = (uint8_t) value;
+	return len;
+}
+
+
+/// @brief: Reads a varint from *data*. Returns the count of bytes read, or 0
+/// if it runs past *len* or past 32 bits.
+static uint8_t varint_get(const uint8_t *data, uint16_t len, uint32_t *value) {
+	uint8_t ret = 0;
+	uint32_t v = 0;
+	for (uint8_t i = 0; (i < len) && (i < 5); i++) {
+		v |= (uint32_t) (data[i] & 0x7Fu) << (7 * i);
+		if ((data[i] & 0x80u) == 0u) {
+			ret = i + 1;
+			break;
+		}
+		else {
+		}
+	}
+	*value = v;
+	return ret;
+}
+
+
+static inline uint32_t zigzag(int32_t value) {
+	return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+
+static inline int32_t unzigzag(uint32_t value) {
+	return (int32_t) (value >> 1) ^ -(int32_t) (value & 1u);
+}
+
+
+/// @brief: Returns the reference slot of *id*, or -1 if there is none
+static int8_t batch_ref_find(const remote_can_batch_ref_st *ref, uint32_t id) {
+	int8_t ret = -1;
+	for (uint8_t i = 0; i < ref->count; i++) {
+		if (ref->slot[i].id == id) {
+			ret = (int8_t) i;
+			break;
+		}
+		else {
+		}
+	}
+	return ret;
+}
+
+
+/// @brief: Records a frame as the reference for its id. Must stay identical for
+/// the encoder and the decoder, the wire format depends on it.
+static void batch_ref_update(remote_can_batch_ref_st *ref, uint32_t id,
+		const uint8_t *data, uint8_t data_len) {
+	int8_t i = batch_ref_find(ref, id);
+	if (i < 0) {
+		if (ref->count < REMOTE_CAN_BATCH_REF_COUNT) {
+			i = (int8_t) ref->count++;
+		}
+		else {
+			i = (int8_t) ref->next;
+			ref->next = (uint8_t) ((ref->next + 1u) % REMOTE_CAN_BATCH_REF_COUNT);
+		}
+	}
+	else {
+	}
+	ref->slot[i].id = id;
+	ref->slot[i].data_len = data_len;
+	memset(ref->slot[i].data, 0, sizeof(ref->slot[i].data));
+	memcpy(ref->slot[i].data, data, data_len);
+}
+
+
+/// @brief: Returns the reference *msg* is XOR coded against, as a pointer to
+/// 8 bytes. Must stay identical for the encoder and the decoder.
+static const uint8_t *batch_ref_get(const remote_can_batch_ref_st *ref,
+		uint32_t key, const uv_can_msg_st *msg) {
+	static const uint8_t zeros[8] = { 0 };
+	const uint8_t *ret = zeros;
+	if (remote_can_class_of(msg->id, msg->type) == REMOTE_CAN_CLASS_BULK) {
+		int8_t i = batch_ref_find(ref, key);
+		if (i >= 0) {
+			ret = ref->slot[i].data;
+		}
+		else {
+		}
+	}
+	else {
+	}
+	return ret;
+}
+
+
+/// @brief: Records *msg* as the reference for its id, if it is a bulk class frame
+static void batch_ref_record(remote_can_batch_ref_st *ref,
+		uint32_t key, const uv_can_msg_st *msg) {
+	if (remote_can_class_of(msg->id, msg->type) == REMOTE_CAN_CLASS_BULK) {
+		batch_ref_update(ref, key, msg->data_8bit, msg->data_length);
+	}
+	else {
+	}
+}
+
+
+void remote_can_batch_clear(remote_can_batch_st *this) {
+	this->msg[0] = REMOTE_MSG_START_BYTE;
+	this->msg[1] = REMOTE_MSG_TYPE_CAN_BATCH;
+	this->msg[2] = 0;
+	this->frame_count = 0;
+	this->max_len = REMOTE_CAN_BATCH_DATA_MAX_LEN;
+	this->prev_std_id = 0;
+	this->prev_ext_id = 0;
+	this->prev_time_ms = 0;
+	this->ref.count = 0;
+	this->ref.next = 0;
+}
+
+
+void remote_can_batch_set_max_len(remote_can_batch_st *this, uint16_t msg_len) {
+	if (msg_len < REMOTE_MSG_TYPE_CAN_BATCH_LEN(0)) {
+		msg_len = REMOTE_MSG_TYPE_CAN_BATCH_LEN(0);
+	}
+	else if (msg_len > REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN) {
+		msg_len = REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN;
+	}
+	else {
+	}
+	this->max_len = (uint8_t) (msg_len - REMOTE_MSG_TYPE_CAN_BATCH_LEN(0));
+}
+
+
+bool remote_can_batch_append(remote_can_batch_st *this,
+		const uv_can_msg_st *msg, uint32_t time_ms) {
+	uint8_t frame[REMOTE_CAN_BATCH_FRAME_MAX_LEN];
+	uv_can_msg_st m = *msg;
+	bool ext = (m.type == CAN_EXT);
+	uint32_t *prev_id = ext ? &this->prev_ext_id : &this->prev_std_id;
+	uint8_t len = 1;
+	bool ret;
+
+	m.id &= 0x1FFFFFFFu;
+	if (m.data_length > 8u) {
+		m.data_length = 8u;
+	}
+	else {
+	}
+	uint32_t key = m.id | (ext ? REMOTE_CAN_ID_EXT_FLAG : 0u);
+
+	frame[0] = m.data_length | (ext ? REMOTE_CAN_BATCH_HDR_EXT : 0u);
+	len += varint_put(&frame[len], zigzag((int32_t) (m.id - *prev_id)));
+	len += varint_put(&frame[len], (this->frame_count == 0) ?
+			0u : (time_ms - this->prev_time_ms));
+
+	// a periodic frame mostly repeats itself, and most payloads are mostly
+	// empty: send only the bytes that differ from the reference, when that
+	// is shorter
+	const uint8_t *ref = batch_ref_get(&this->ref, key, &m);
+	uint8_t xor[8];
+	uint8_t mask = 0;
+	uint8_t xor_len = 0;
+	for (uint8_t i = 0; i < m.data_length; i++) {
+		uint8_t x = m.data_8bit[i] ^ ref[i];
+		if (x != 0u) {
+			mask |= (uint8_t) (1u << i);
+			xor[xor_len++] = x;
+		}
+		else {
+		}
+	}
+	if ((xor_len + 1u) < m.data_length) {
+		frame[0] |= REMOTE_CAN_BATCH_HDR_XOR;
+		frame[len++] = mask;
+		memcpy(&frame[len], xor, xor_len);
+		len += xor_len;
+	}
+	else {
+		memcpy(&frame[len], m.data_8bit, m.data_length);
+		len += m.data_length;
+	}
+
+	if (((uint16_t) this->msg[2] + len) > this->max_len) {
+		ret = false;
+	}
+	else {
+		memcpy(&this->msg[3 + this->msg[2]], frame, len);
+		this->msg[2] = (uint8_t) (this->msg[2] + len);
+		this->frame_count++;
+		*prev_id = m.id;
+		this->prev_time_ms = time_ms;
+		batch_ref_record(&this->ref, key, &m);
+		ret = true;
+	}
+	return ret;
+}
+
+
+bool remote_can_batch_decode(const uint8_t *data, uint8_t len,
+		remote_can_batch_callb_t callb, void *user) {
+	remote_can_batch_ref_st ref = { .count = 0, .next = 0 };
+	uint32_t prev_std_id = 0;
+	uint32_t prev_ext_id = 0;
+	uint32_t time_ms = 0;
+	bool ret = (len >= 3u) &&
+			(REMOTE_MSG_TYPE_CAN_BATCH_LEN(data[2]) <= len);
+	uint16_t end = ret ? REMOTE_MSG_TYPE_CAN_BATCH_LEN(data[2]) : 0u;
+	uint16_t i = 3;
+
+	while (ret && (i < end)) {
+		uint8_t hdr = data[i++];
+		bool ext = ((hdr & REMOTE_CAN_BATCH_HDR_EXT) != 0u);
+		uint32_t *prev_id = ext ? &prev_ext_id : &prev_std_id;
+		uv_can_msg_st msg;
+		uint32_t v;
+		uint8_t n;
+
+		msg.type = ext ? CAN_EXT : CAN_STD;
+		msg.data_length = hdr & REMOTE_CAN_BATCH_HDR_DLC_MASK;
+		msg.data_64bit = 0;
+		n = varint_get(&data[i], (uint16_t) (end - i), &v);
+		i = (uint16_t) (i + n);
+		msg.id = (*prev_id + (uint32_t) unzigzag(v)) & 0x1FFFFFFFu;
+		ret = (n != 0u) &&
+				(msg.data_length <= 8u) &&
+				((hdr & ~(REMOTE_CAN_BATCH_HDR_EXT | REMOTE_CAN_BATCH_HDR_XOR |
+						REMOTE_CAN_BATCH_HDR_DLC_MASK)) == 0u);
+		if (ret) {
+			n = varint_get(&data[i], (uint16_t) (end - i), &v);
+			i = (uint16_t) (i + n);
+			time_ms += v;
+			ret = (n != 0u);
+		}
+		else {
+		}
+
+		uint32_t key = msg.id | (ext ? REMOTE_CAN_ID_EXT_FLAG : 0u);
+		if (!ret) {
+		}
+		else if ((hdr & REMOTE_CAN_BATCH_HDR_XOR) != 0u) {
+			const uint8_t *r = batch_ref_get(&ref, key, &msg);
+			ret = (i < end);
+			if (ret) {
+				uint8_t mask = data[i++];
+				memcpy(msg.data_8bit, r, msg.data_length);
+				// a mask bit past the data length is malformed
+				ret = ((mask >> msg.data_length) == 0u);
+				for (uint8_t b = 0; ret && (b < msg.data_length); b++) {
+					if ((mask & (1u << b)) != 0u) {
+						ret = (i < end);
+						if (ret) {
+							msg.data_8bit[b] ^= data[i++];
+						}
+						else {
+						}
+					}
+					else {
+					}
+				}
+			}
+			else {
+			}
+		}
+		else {
+			ret = ((i + msg.data_length) <= end);
+			if (ret) {
+				memcpy(msg.data_8bit, &data[i], msg.data_length);
+				i = (uint16_t) (i + msg.data_length);
+			}
+			else {
+			}
+		}
+
+		if (ret) {
+			*prev_id = msg.id;
+			batch_ref_record(&ref, key, &msg);
+			if (callb != NULL) {
+				callb(user, &msg, time_ms);
+			}
+			else {
+			}
+		}
+		else {
+		}
+	}
+	return ret;
+}
+
+
 void remote_stream_reset(remote_stream_st *this) {
 	this->receiving_type = REMOTE_MSG_TYPE_COUNT;
 	this->byte_count = 0;
@@ -109,9 +403,10 @@ static void stream_feed_byte(remote_stream_st *s, uint8_t c,
 		else {
 		}
 
-		// Byte index 2 of a CAN message is the data length, and of a UI /
-		// UI_ASSET chunk the chunk length. Both are variable length, so patch
-		// the expected message length in as soon as that byte arrives.
+		// Byte index 2 of a CAN message is the data length, of a UI /
+		// UI_ASSET chunk the chunk length and of a CAN_BATCH the batch length.
+		// All are variable length, so patch the expected message length in as
+		// soon as that byte arrives.
 		if ((s->receiving_type == REMOTE_MSG_TYPE_CAN) &&
 				(s->byte_count == 3)) {
 			s->msg_len = REMOTE_MSG_TYPE_CAN_LEN(c);
@@ -133,6 +428,16 @@ static void stream_feed_byte(remote_stream_st *s, uint8_t c,
 			else {
 			}
 		}
+		else if ((s->receiving_type == REMOTE_MSG_TYPE_CAN_BATCH) &&
+				(s->byte_count == 3)) {
+			s->msg_len = REMOTE_MSG_TYPE_CAN_BATCH_LEN(c);
+			if (s->msg_len > REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN) {
+				// batch larger than allowed, abandon the message
+				remote_stream_reset(s);
+			}
+			else {
+			}
+		}
 		else if (s->byte_count == s->msg_len) {
 			remote_msg_types_e type = s->receiving_type;
 			uint8_t len = s->msg_len;
@@ -155,10 +460,114 @@ static void stream_feed_byte(remote_stream_st *s, uint8_t c,
 }
 
 
+/// @brief: True for the types whose exact length is only known from the length
+/// byte at index 2 of the message.
+static inline bool is_variable_len(remote_msg_types_e type) {
+	return ((type == REMOTE_MSG_TYPE_CAN) ||
+			(type == REMOTE_MSG_TYPE_UI) ||
+			(type == REMOTE_MSG_TYPE_UI_ASSET) ||
+			(type == REMOTE_MSG_TYPE_CAN_BATCH));
+}
+
+
+/// @brief: Returns the length of the message starting at *data*, if its header
+/// is wholly inside the *avail* bytes and valid. Returns 0 when it isn't, in
+/// which case the byte wise state machine has to deal with it.
+static uint8_t whole_msg_len(const uint8_t *data, uint16_t avail) {
+	uint8_t ret = 0;
+	if ((avail >= 2) &&
+			(data[1] < REMOTE_MSG_TYPE_COUNT)) {
+		remote_msg_types_e type = (remote_msg_types_e) data[1];
+		if (!is_variable_len(type)) {
+			ret = remote_msg_type_len[type];
+		}
+		else if (avail < 3) {
+			// length byte in the next chunk
+		}
+		else if (type == REMOTE_MSG_TYPE_CAN) {
+			ret = (data[2] <= 8u) ? REMOTE_MSG_TYPE_CAN_LEN(data[2]) : 0;
+		}
+		else if (type == REMOTE_MSG_TYPE_CAN_BATCH) {
+			ret = (data[2] <= REMOTE_CAN_BATCH_DATA_MAX_LEN) ?
+					REMOTE_MSG_TYPE_CAN_BATCH_LEN(data[2]) : 0;
+		}
+		else {
+			ret = (data[2] <= REMOTE_UI_CHUNK_MAX_LEN) ?
+					REMOTE_UI_MSG_LEN(data[2]) : 0;
+		}
+	}
+	else {
+	}
+	return ret;
+}
+
+
 void remote_stream_feed(remote_stream_st *this, const uint8_t *data,
 		uint16_t len, remote_frame_callb_t callb, void *user) {
-	for (uint16_t i = 0; i < len; i++) {
-		stream_feed_byte(this, data[i], callb, user);
+	uint16_t i = 0;
+	while (i < len) {
+		if ((this->receiving_type == REMOTE_MSG_TYPE_COUNT) &&
+				(this->byte_count == 0)) {
+			// hunting: nothing before the next start byte can be a message
+			const uint8_t *start = memchr(&data[i], REMOTE_MSG_START_BYTE,
+					(size_t) (len - i));
+			if (start == NULL) {
+				break;
+			}
+			else {
+				i = (uint16_t) (start - data);
+			}
+			// a message wholly inside the input is handed over in place,
+			// without going through rx_data at all
+			uint8_t msg_len = whole_msg_len(start, (uint16_t) (len - i));
+			if ((msg_len != 0) &&
+					(msg_len <= (len - i))) {
+				if (callb != NULL) {
+					callb(user, (remote_msg_types_e) start[1], start, msg_len);
+				}
+				else {
+				}
+				i = (uint16_t) (i + msg_len);
+			}
+			else {
+				stream_feed_byte(this, data[i], callb, user);
+				i++;
+			}
+		}
+		else if ((this->receiving_type != REMOTE_MSG_TYPE_COUNT) &&
+				((this->byte_count >= 3) ||
+				((this->byte_count >= 2) && !is_variable_len(this->receiving_type)))) {
+			// inside a message whose length is final: take the rest of it, or
+			// as much of it as this chunk has, in one go
+			uint16_t count = (uint16_t) (this->msg_len - this->byte_count);
+			if (count > (len - i)) {
+				count = (uint16_t) (len - i);
+			}
+			else {
+			}
+			memcpy(&this->rx_data[this->byte_count], &data[i], count);
+			this->byte_count = (uint8_t) (this->byte_count + count);
+			i = (uint16_t) (i + count);
+			if (this->byte_count == this->msg_len) {
+				remote_msg_types_e type = this->receiving_type;
+				uint8_t msg_len = this->msg_len;
+				// reset before the callback, as in stream_feed_byte
+				this->receiving_type = REMOTE_MSG_TYPE_COUNT;
+				this->byte_count = 0;
+				if (callb != NULL) {
+					callb(user, type, this->rx_data, msg_len);
+				}
+				else {
+				}
+			}
+			else {
+			}
+		}
+		else {
+			// message header split across chunks
+			stream_feed_byte(this, data[i], callb, user);
+			i++;
+		}
 	}
 }
 
@@ -93,6 +93,9 @@ void uv_terminal_baud_callb(void *me, unsigned int cmd, unsigned int args, argum
 void uv_terminal_man_callb(void *me, unsigned int cmd, unsigned int args, argument_st * argv);
 #endif
 void uv_terminal_reset_callb(void *me, unsigned int cmd, unsigned int args, argument_st * argv);
+#if CONFIG_CPUTIME
+void uv_terminal_cputime_callb(void *me, unsigned int cmd, unsigned int args, argument_st * argv);
+#endif
 #if CONFIG_NON_VOLATILE_MEMORY
 void uv_terminal_save_callb(void *me, unsigned int cmd, unsigned int args, argument_st * argv);
 void uv_terminal_revert_callb(void *me, unsigned int cmd, unsigned int args, argument_st * argv);
@@ -141,6 +144,20 @@ const uv_command_st common_cmds[] = {
 				.callback = uv_terminal_man_callb
 		},
 #endif
+#if CONFIG_CPUTIME
+		{
+				.id = CMD_CPUTIME,
+				.str = "cputime",
+#if CONFIG_TERMINAL_INSTRUCTIONS
+				.instructions =
+						"Logs the count and min/avg/max times in us of the HAL steps,\n"
+						"the HAL mutex waits, the idle task and the application steps.\n"
+						"Usage: cputime (<slot>) or cputime \"reset\"\n"
+						"With a slot number logs the histogram of that slot.",
+#endif
+				.callback = uv_terminal_cputime_callb
+		},
+#endif
 #if CONFIG_NON_VOLATILE_MEMORY
 		{
 				.id = CMD_SAVE,
@@ -450,6 +467,52 @@ void uv_terminal_man_callb(void *me, unsigned int cmd, unsigned int args, argume
 void uv_terminal_reset_callb(void *me, unsigned int cmd, unsigned int args, argument_st *argv) {
 	uv_system_reset();
 }
+#if CONFIG_CPUTIME
+/// @brief: Logs *ns* in microseconds with one decimal
+static void print_us(uint32_t ns) {
+	printf(" %6u.%u", (unsigned int) (ns / 1000), (unsigned int) ((ns % 1000) / 100));
+}
+void uv_terminal_cputime_callb(void *me, unsigned int cmd, unsigned int args, argument_st * argv) {
+	if (args && argv[0].type == ARG_STRING && strcmp(argv[0].str, "reset") == 0) {
+		uv_cputime_reset_all();
+		printf("reset\n");
+	}
+	else if (args && argv[0].type == ARG_INTEGER) {
+		if (argv[0].number < 0 || argv[0].number >= CPUTIME_COUNT) {
+			printf("Invalid slot given: %i\n", (int) argv[0].number);
+		}
+		else {
+			const uv_cputime_st *t = uv_cputime_get(argv[0].number);
+			for (uint8_t i = 0; i < CPUTIME_HIST_BUCKETS; i++) {
+				if (i == CPUTIME_HIST_BUCKETS - 1) {
+					printf("      >= %5u us", (unsigned int) uv_cputime_bucket_us(i - 1));
+				}
+				else {
+					printf("      <  %5u us", (unsigned int) uv_cputime_bucket_us(i));
+				}
+				printf(" %u\n", (unsigned int) t->hist[i]);
+			}
+		}
+	}
+	else {
+		printf("slot            count     min us     avg us     max us\n");
+		for (uint8_t i = 0; i < CPUTIME_COUNT; i++) {
+			const uv_cputime_st *t = uv_cputime_get(i);
+			if (i >= CPUTIME_APP) {
+				printf("%2u %s%-6u", i, uv_cputime_name(i), (unsigned int) (i - CPUTIME_APP));
+			}
+			else {
+				printf("%2u %-9s", i, uv_cputime_name(i));
+			}
+			printf(" %8u", (unsigned int) t->count);
+			print_us((t->count == 0) ? 0 : t->min_ns);
+			print_us(t->avg_ns);
+			print_us(t->max_ns);
+			printf("\n");
+		}
+	}
+}
+#endif
 #if CONFIG_NON_VOLATILE_MEMORY
 void uv_terminal_save_callb(void *me, unsigned int cmd, unsigned int args, argument_st * argv) {
 	if (!uv_memory_save()) {
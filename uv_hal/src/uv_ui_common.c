@@ -28,7 +28,11 @@
 
 
 #include "uv_ui_common.h"
+#include "uv_rtos.h"
 #include <string.h>
+#if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
+#include <time.h>
+#endif
 
 #if CONFIG_UI
 
@@ -143,6 +147,139 @@ static struct {
 #define this (&ui_common)
 
 
+
+#if CONFIG_UI_WINDOW_CACHE
+// --- recorded drawing -------------------------------------------------------
+//
+// A recording is a list of entries, each a 4 byte header (op, unused, length of
+// what follows) and the arguments of the call, padded to 4 bytes. Arguments
+// are kept in the structs below and copied in and out with memcpy; the points
+// of strips and polygons and the characters of strings follow them and are
+// used in place, which needs no more than uint16_t alignment.
+
+enum {
+	REC_MASK = 0,
+	REC_COLOR_MODE,
+	REC_RRECT,
+	REC_POINT,
+	REC_LINE,
+	REC_LINESTRIP,
+	REC_POLYGON,
+	REC_BITMAP,
+	REC_STRING
+};
+
+#define REC_HEADER_LEN		4
+#define REC_PAD(len)		(((len) + 3) & ~3)
+
+typedef struct {
+	int16_t x;
+	int16_t y;
+	int16_t width;
+	int16_t height;
+} rec_mask_st;
+
+typedef struct {
+	ui_color_modes_e mode;
+	int8_t luminosity;
+} rec_color_mode_st;
+
+typedef struct {
+	color_t color;
+	int16_t x;
+	int16_t y;
+	uint16_t width;
+	uint16_t height;
+	uint16_t radius;
+} rec_rrect_st;
+
+typedef struct {
+	color_t color;
+	int16_t x;
+	int16_t y;
+	uint16_t diameter;
+} rec_point_st;
+
+typedef struct {
+	color_t color;
+	int16_t start_x;
+	int16_t start_y;
+	int16_t end_x;
+	int16_t end_y;
+	uint16_t width;
+} rec_line_st;
+
+typedef struct {
+	color_t color;
+	uint16_t point_count;
+	uint16_t line_width;
+	uv_ui_strip_type_e type;
+} rec_strip_st;
+
+typedef struct {
+	uv_uimedia_st *bitmap;
+	uint32_t wrap;
+	color_t color;
+	int16_t x;
+	int16_t y;
+	int16_t w;
+	int16_t h;
+} rec_bitmap_st;
+
+typedef struct {
+	ui_font_st *font;
+	color_t color;
+	int16_t x;
+	int16_t y;
+	ui_align_e align;
+} rec_string_st;
+
+// the recording being made, or NULL
+static uv_ui_record_st *recording = NULL;
+
+
+/// @brief: Appends a call to the recording being made. *data* is copied after
+/// the arguments.
+static void record(uint8_t op, const void *args, uint16_t args_len,
+		const void *data, uint16_t data_len) {
+	uv_ui_record_st *rec = recording;
+	uint32_t len = REC_HEADER_LEN + REC_PAD(args_len) + REC_PAD(data_len);
+	if (rec->spoiled) {
+	}
+	else if (rec->len + len > rec->buffer_len) {
+		rec->spoiled = true;
+	}
+	else {
+		uint8_t *p = &rec->buffer[rec->len];
+		p[0] = op;
+		p[1] = 0;
+		p[2] = (uint8_t) (len - REC_HEADER_LEN);
+		p[3] = (uint8_t) ((len - REC_HEADER_LEN) >> 8);
+		memcpy(&p[REC_HEADER_LEN], args, args_len);
+		if (data_len != 0) {
+			memcpy(&p[REC_HEADER_LEN + REC_PAD(args_len)], data, data_len);
+		}
+		else {
+		}
+		rec->len += len;
+	}
+}
+
+
+static void record_color_mode(void) {
+	if (recording != NULL) {
+		rec_color_mode_st r = {
+				.mode = this->color_mode,
+				.luminosity = this->grayscale_luminosity
+		};
+		record(REC_COLOR_MODE, &r, sizeof(r), NULL, 0);
+	}
+	else {
+	}
+}
+#endif
+
+
 color_t uv_uic_brighten(color_t c, int8_t value) {
 	color_t ret = (c & 0xFF000000);
 	for (uint8_t i = 0; i < 3; i++) {
@@ -168,7 +305,7 @@ color_t uv_uic_alpha(color_t c, int16_t value) {
 	int16_t alpha = (c & 0xFF000000) >> 24;
 	alpha += value;
 	LIMITS(alpha, 0, 0xFF);
-	ret += (alpha << 24);
+	ret += ((color_t) alpha << 24);
 
 	return ret;
 }
@@ -237,6 +374,9 @@ bool uv_ui_is_visible(const int16_t x, const int16_t y,
 
 void uv_ui_set_grayscale_luminosity(int8_t value) {
 	this->grayscale_luminosity = value;
+#if CONFIG_UI_WINDOW_CACHE
+	record_color_mode();
+#endif
 }
 
 
@@ -262,6 +402,9 @@ void uv_ui_draw_shadowrrect(const int16_t x, const int16_t y,
 
 void uv_ui_set_color_mode(ui_color_modes_e value) {
 	this->color_mode = value;
+#if CONFIG_UI_WINDOW_CACHE
+	record_color_mode();
+#endif
 }
 
 
@@ -308,6 +451,173 @@ const char *uv_str_next_line(const char *str) {
 
 
 
+// --- input ------------------------------------------------------------------
+//
+// The backends and the remote UI push input as it happens, possibly from
+// another task, and the display takes it out on its step. Keys have a queue of
+// their own, as they are peeked at and left for someone else to take.
+
+static uv_ui_input_event_st input_buffer[CONFIG_UI_INPUT_QUEUE_LEN];
+static uv_ui_input_event_st key_buffer[CONFIG_UI_KEY_QUEUE_LEN];
+static struct {
+	uv_ui_input_queue_st events;
+	uv_ui_input_queue_st keys;
+	// wheel notches taken out of the queue, for uv_ui_get_scroll
+	int16_t scroll;
+#if CONFIG_UI_INPUT_LATENCY
+	// the oldest input acted on that no frame has answered yet
+	bool pending;
+	uint32_t pending_us;
+	uv_ui_latency_st latency[UI_LATENCY_COUNT];
+#endif
+} input = {
+		.events = {
+				.events = input_buffer,
+				.len = CONFIG_UI_INPUT_QUEUE_LEN
+		},
+		.keys = {
+				.events = key_buffer,
+				.len = CONFIG_UI_KEY_QUEUE_LEN
+		}
+};
+
+
+uint32_t uv_ui_input_time_us(void) {
+	uint32_t ret;
+#if CONFIG_TARGET_LINUX || CONFIG_TARGET_WIN
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ret = (uint32_t) ts.tv_sec * 1000000u + (uint32_t) (ts.tv_nsec / 1000);
+#else
+	ret = uv_rtos_get_tick_count() * (1000000u / uv_rtos_get_tick_rate_hz());
+#endif
+	return ret;
+}
+
+
+void uv_ui_input_push(uv_ui_input_type_e type, int16_t x, int16_t y, int16_t value) {
+	uv_ui_input_event_st e = {
+			.time_us = uv_ui_input_time_us(),
+			.x = x,
+			.y = y,
+			.value = value,
+			.type = (uint8_t) type
+	};
+	uv_enter_critical();
+	(void) uv_ui_input_queue_push((type == UI_INPUT_KEY) ? &input.keys : &input.events, &e);
+	uv_exit_critical();
+}
+
+
+void uv_ui_input_poll(void) {
+	uv_ui_input_poll_impl();
+}
+
+
+bool uv_ui_input_pop(uv_ui_input_event_st *event) {
+	uv_enter_critical();
+	bool ret = uv_ui_input_queue_pop(&input.events, event);
+	uv_exit_critical();
+	if (ret && (event->type == UI_INPUT_SCROLL)) {
+		input.scroll = (int16_t) (input.scroll + event->value);
+	}
+	else {
+	}
+	return ret;
+}
+
+
+uint32_t uv_ui_input_get_dropped(void) {
+	return input.events.dropped + input.keys.dropped;
+}
+
+
+int16_t uv_ui_get_scroll(void) {
+	int16_t ret = input.scroll;
+	input.scroll = 0;
+	return ret;
+}
+
+
+char uv_ui_peek_key_press(void) {
+	const uv_ui_input_event_st *e = uv_ui_input_queue_peek(&input.keys);
+	return (e != NULL) ? (char) e->value : '\0';
+}
+
+
+char uv_ui_get_key_press(void) {
+	char ret = '\0';
+	uv_ui_input_event_st e;
+	uv_enter_critical();
+	bool popped = uv_ui_input_queue_pop(&input.keys, &e);
+	uv_exit_critical();
+	if (popped) {
+		ret = (char) e.value;
+		_uv_ui_input_consumed(e.time_us);
+	}
+	else {
+	}
+	return ret;
+}
+
+
+void _uv_ui_input_consumed(uint32_t time_us) {
+#if CONFIG_UI_INPUT_LATENCY
+	if (!input.pending) {
+		input.pending = true;
+		input.pending_us = time_us;
+	}
+	else {
+	}
+#endif
+}
+
+
+void _uv_ui_input_frame_end(void) {
+#if CONFIG_UI_INPUT_LATENCY
+	input.pending = false;
+#endif
+}
+
+
+#if CONFIG_UI_INPUT_LATENCY
+
+static void input_drawn(void) {
+	if (input.pending) {
+		uv_ui_latency_add(&input.latency[UI_LATENCY_DRAW],
+				uv_ui_input_time_us() - input.pending_us);
+	}
+	else {
+	}
+}
+
+
+static void input_swapped(void) {
+	if (input.pending) {
+		uv_ui_latency_add(&input.latency[UI_LATENCY_SWAP],
+				uv_ui_input_time_us() - input.pending_us);
+		input.pending = false;
+	}
+	else {
+	}
+}
+
+
+const uv_ui_latency_st *uv_ui_input_get_latency(uv_ui_latency_e which) {
+	return &input.latency[which];
+}
+
+
+void uv_ui_input_reset_latency(void) {
+	for (uint8_t i = 0; i < UI_LATENCY_COUNT; i++) {
+		uv_ui_latency_reset(&input.latency[i]);
+	}
+}
+
+#endif
+
+
+
 // --- public drawing / touch wrappers ----------------------------------------
 //
 // Each public uv_ui_* primitive is a thin wrapper: it calls the active backend's
@@ -320,13 +630,25 @@ const char *uv_str_next_line(const char *str) {
 
 void uv_ui_clear(color_t c) {
 	uv_ui_clear_impl(c);
+#if CONFIG_UI_WINDOW_CACHE
+	uv_ui_record_spoil();
+#endif
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_clear(c);
 #endif
 }
 
 void uv_ui_dlswap(void) {
+#if CONFIG_UI_INPUT_LATENCY
+	input_drawn();
+#endif
 	uv_ui_dlswap_impl();
+#if CONFIG_UI_INPUT_LATENCY
+	input_swapped();
+#endif
+#if CONFIG_UI_WINDOW_CACHE
+	uv_ui_record_spoil();
+#endif
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_frame_end();
 #endif
@@ -334,14 +656,43 @@ void uv_ui_dlswap(void) {
 
 void uv_ui_draw_bitmap_ext(uv_uimedia_st *bitmap, int16_t x, int16_t y,
 		int16_t w, int16_t h, uint32_t wrap, color_t c) {
+	// A bitmap not resident has nothing to draw, and no size to draw it at,
+	// but the backend is still told it is wanted: an evicted one is loaded
+	// again from that.
 	uv_ui_draw_bitmap_ext_impl(bitmap, x, y, w, h, wrap, c);
+	if (uv_uimedia_is_resident(bitmap)) {
+#if CONFIG_UI_WINDOW_CACHE
+		if (recording != NULL) {
+			rec_bitmap_st r = { .bitmap = bitmap, .wrap = wrap, .color = c,
+					.x = x, .y = y, .w = w, .h = h };
+			record(REC_BITMAP, &r, sizeof(r), NULL, 0);
+		}
+		else {
+		}
+#endif
 #if CONFIG_UI_REMOTE
-	uv_ui_remote_encode_bitmap(bitmap, x, y, w, h, wrap, c);
+		uv_ui_remote_encode_bitmap(bitmap, x, y, w, h, wrap, c);
 #endif
+	}
+	else {
+#if CONFIG_UI_WINDOW_CACHE
+		// the window has to be drawn again once the bitmap is loaded, and
+		// a replay of what was recorded would only show its placeholder
+		uv_ui_record_spoil();
+#endif
+	}
 }
 
 void uv_ui_draw_point(int16_t x, int16_t y, color_t color, uint16_t diameter) {
 	uv_ui_draw_point_impl(x, y, color, diameter);
+#if CONFIG_UI_WINDOW_CACHE
+	if (recording != NULL) {
+		rec_point_st r = { .color = color, .x = x, .y = y, .diameter = diameter };
+		record(REC_POINT, &r, sizeof(r), NULL, 0);
+	}
+	else {
+	}
+#endif
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_point(x, y, color, diameter);
 #endif
@@ -351,6 +702,15 @@ void uv_ui_draw_rrect(const int16_t x, const int16_t y,
 		const uint16_t width, const uint16_t height,
 		const uint16_t radius, const color_t color) {
 	uv_ui_draw_rrect_impl(x, y, width, height, radius, color);
+#if CONFIG_UI_WINDOW_CACHE
+	if (recording != NULL) {
+		rec_rrect_st r = { .color = color, .x = x, .y = y,
+				.width = width, .height = height, .radius = radius };
+		record(REC_RRECT, &r, sizeof(r), NULL, 0);
+	}
+	else {
+	}
+#endif
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_rrect(x, y, width, height, radius, color);
 #endif
@@ -360,6 +720,15 @@ void uv_ui_draw_line(const int16_t start_x, const int16_t start_y,
 		const int16_t end_x, const int16_t end_y,
 		const uint16_t width, const color_t color) {
 	uv_ui_draw_line_impl(start_x, start_y, end_x, end_y, width, color);
+#if CONFIG_UI_WINDOW_CACHE
+	if (recording != NULL) {
+		rec_line_st r = { .color = color, .start_x = start_x, .start_y = start_y,
+				.end_x = end_x, .end_y = end_y, .width = width };
+		record(REC_LINE, &r, sizeof(r), NULL, 0);
+	}
+	else {
+	}
+#endif
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_line(start_x, start_y, end_x, end_y, width, color);
 #endif
@@ -369,6 +738,15 @@ void uv_ui_draw_linestrip(const uv_ui_linestrip_point_st *points,
 		const uint16_t point_count, const uint16_t line_width, const color_t color,
 		const uv_ui_strip_type_e type) {
 	uv_ui_draw_linestrip_impl(points, point_count, line_width, color, type);
+#if CONFIG_UI_WINDOW_CACHE
+	if (recording != NULL) {
+		rec_strip_st r = { .color = color, .point_count = point_count,
+				.line_width = line_width, .type = type };
+		record(REC_LINESTRIP, &r, sizeof(r), points, point_count * sizeof(points[0]));
+	}
+	else {
+	}
+#endif
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_linestrip(points, point_count, line_width, color, type);
 #endif
@@ -377,6 +755,14 @@ void uv_ui_draw_linestrip(const uv_ui_linestrip_point_st *points,
 void uv_ui_draw_polygon(const uv_ui_linestrip_point_st *points,
 		const uint16_t point_count, const color_t color) {
 	uv_ui_draw_polygon_impl(points, point_count, color);
+#if CONFIG_UI_WINDOW_CACHE
+	if (recording != NULL) {
+		rec_strip_st r = { .color = color, .point_count = point_count };
+		record(REC_POLYGON, &r, sizeof(r), points, point_count * sizeof(points[0]));
+	}
+	else {
+	}
+#endif
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_polygon(points, point_count, color);
 #endif
@@ -385,18 +771,197 @@ void uv_ui_draw_polygon(const uv_ui_linestrip_point_st *points,
 void uv_ui_draw_string(char *str, ui_font_st *font,
 		int16_t x, int16_t y, ui_align_e align, color_t color) {
 	uv_ui_draw_string_impl(str, font, x, y, align, color);
+#if CONFIG_UI_WINDOW_CACHE
+	if (recording != NULL) {
+		rec_string_st r = { .font = font, .color = color, .x = x, .y = y,
+				.align = align };
+		record(REC_STRING, &r, sizeof(r), str, strlen(str) + 1);
+	}
+	else {
+	}
+#endif
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_string(str, font, x, y, align, color);
 #endif
 }
 
+// the area a partial redraw is confined to
+static uv_bb_st mask_limit;
+static bool mask_limited = false;
+
+void uv_ui_set_mask_limit(const uv_bb_st *bb) {
+	mask_limited = (bb != NULL);
+	if (mask_limited) {
+		mask_limit = *bb;
+	}
+	else {
+	}
+}
+
 void uv_ui_set_mask(int16_t x, int16_t y, int16_t width, int16_t height) {
+#if CONFIG_UI_WINDOW_CACHE
+	// recorded as asked for, so that the limit of the replay applies instead
+	if (recording != NULL) {
+		rec_mask_st r = { .x = x, .y = y, .width = width, .height = height };
+		record(REC_MASK, &r, sizeof(r), NULL, 0);
+	}
+	else {
+	}
+#endif
+	if (mask_limited) {
+		int16_t x1 = MIN(x + width, mask_limit.x + mask_limit.width);
+		int16_t y1 = MIN(y + height, mask_limit.y + mask_limit.height);
+		x = MAX(x, mask_limit.x);
+		y = MAX(y, mask_limit.y);
+		width = MAX(x1 - x, 0);
+		height = MAX(y1 - y, 0);
+	}
+	else {
+	}
 	uv_ui_set_mask_impl(x, y, width, height);
 #if CONFIG_UI_REMOTE
 	uv_ui_remote_encode_mask(x, y, width, height);
 #endif
 }
 
+#if CONFIG_UI_WINDOW_CACHE
+void uv_ui_record_init(uv_ui_record_st *rec, void *buffer, uint16_t buffer_len) {
+	rec->buffer = buffer;
+	rec->buffer_len = buffer_len;
+	rec->len = 0;
+	rec->valid = false;
+	rec->spoiled = false;
+}
+
+bool uv_ui_record_begin(uv_ui_record_st *rec) {
+	bool ret = false;
+	if ((recording == NULL) && !mask_limited) {
+		rec->len = 0;
+		rec->valid = false;
+		rec->spoiled = false;
+		recording = rec;
+		// the replay starts in the color mode the recording did
+		record_color_mode();
+		ret = true;
+	}
+	else {
+	}
+	return ret;
+}
+
+bool uv_ui_record_end(uv_ui_record_st *rec) {
+	if (recording == rec) {
+		recording = NULL;
+		rec->valid = !rec->spoiled;
+	}
+	else {
+	}
+	return rec->valid;
+}
+
+void uv_ui_record_invalidate(uv_ui_record_st *rec) {
+	rec->valid = false;
+	if (recording == rec) {
+		// changed while being drawn: what was recorded is already out of date
+		rec->spoiled = true;
+	}
+	else {
+	}
+}
+
+void uv_ui_record_spoil(void) {
+	if (recording != NULL) {
+		recording->spoiled = true;
+	}
+	else {
+	}
+}
+
+void uv_ui_record_replay(const uv_ui_record_st *rec) {
+	uint16_t i = 0;
+	while ((i + REC_HEADER_LEN) <= rec->len) {
+		uint8_t *p = &rec->buffer[i];
+		uint16_t len = p[2] | (p[3] << 8);
+		p += REC_HEADER_LEN;
+		switch (rec->buffer[i]) {
+		case REC_MASK: {
+			rec_mask_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_set_mask(r.x, r.y, r.width, r.height);
+			break;
+		}
+		case REC_COLOR_MODE: {
+			rec_color_mode_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_set_color_mode(r.mode);
+			uv_ui_set_grayscale_luminosity(r.luminosity);
+			break;
+		}
+		case REC_RRECT: {
+			rec_rrect_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_draw_rrect(r.x, r.y, r.width, r.height, r.radius, r.color);
+			break;
+		}
+		case REC_POINT: {
+			rec_point_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_draw_point(r.x, r.y, r.color, r.diameter);
+			break;
+		}
+		case REC_LINE: {
+			rec_line_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_draw_line(r.start_x, r.start_y, r.end_x, r.end_y, r.width, r.color);
+			break;
+		}
+		case REC_LINESTRIP: {
+			rec_strip_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_draw_linestrip((const void *) &p[REC_PAD(sizeof(r))],
+					r.point_count, r.line_width, r.color, r.type);
+			break;
+		}
+		case REC_POLYGON: {
+			rec_strip_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_draw_polygon((const void *) &p[REC_PAD(sizeof(r))],
+					r.point_count, r.color);
+			break;
+		}
+		case REC_BITMAP: {
+			rec_bitmap_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_draw_bitmap_ext(r.bitmap, r.x, r.y, r.w, r.h, r.wrap, r.color);
+			break;
+		}
+		case REC_STRING: {
+			rec_string_st r;
+			memcpy(&r, p, sizeof(r));
+			uv_ui_draw_string((char *) &p[REC_PAD(sizeof(r))], r.font,
+					r.x, r.y, r.align, r.color);
+			break;
+		}
+		default:
+			break;
+		}
+		i += REC_HEADER_LEN + len;
+	}
+}
+#endif
+
+bool uv_ui_get_frame_preserved(void) {
+	bool ret = uv_ui_frame_preserved_impl();
+#if CONFIG_UI_REMOTE
+	if (uv_ui_remote_active()) {
+		ret = false;
+	}
+	else {
+	}
+#endif
+	return ret;
+}
+
 bool uv_ui_get_touch(int16_t *x, int16_t *y) {
 	bool ret;
 #if CONFIG_UI_REMOTE
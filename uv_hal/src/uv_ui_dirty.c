@@ -0,0 +1,115 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "uv_ui_dirty.h"
+#include "uv_utilities.h"
+
+
+#if CONFIG_UI_DIRTY_RECTS
+
+
+static uv_uidirty_rect_st rect_union(const uv_uidirty_rect_st *a,
+		const uv_uidirty_rect_st *b) {
+	uv_uidirty_rect_st ret;
+	int16_t x1 = MAX(a->x + a->width, b->x + b->width);
+	int16_t y1 = MAX(a->y + a->height, b->y + b->height);
+	ret.x = MIN(a->x, b->x);
+	ret.y = MIN(a->y, b->y);
+	ret.width = x1 - ret.x;
+	ret.height = y1 - ret.y;
+	return ret;
+}
+
+
+static int32_t rect_area(const uv_uidirty_rect_st *rect) {
+	return (int32_t) rect->width * rect->height;
+}
+
+
+/// @brief: Takes every area of the set that *rect* reaches out of the set and
+/// into *rect*
+static void absorb(uv_uidirty_st *dirty, uv_uidirty_rect_st *rect) {
+	uint8_t i = 0;
+	while (i < dirty->count) {
+		if (uv_uidirty_near(rect, &dirty->rect[i], 1)) {
+			*rect = rect_union(rect, &dirty->rect[i]);
+			dirty->count--;
+			dirty->rect[i] = dirty->rect[dirty->count];
+			// grown, it may now reach one already looked at
+			i = 0;
+		}
+		else {
+			i++;
+		}
+	}
+}
+
+
+bool uv_uidirty_near(const uv_uidirty_rect_st *a,
+		const uv_uidirty_rect_st *b, int16_t margin) {
+	return ((a->x - margin) < (b->x + b->width)) &&
+			((b->x - margin) < (a->x + a->width)) &&
+			((a->y - margin) < (b->y + b->height)) &&
+			((b->y - margin) < (a->y + a->height));
+}
+
+
+void uv_uidirty_add(uv_uidirty_st *dirty,
+		int16_t x, int16_t y, int16_t width, int16_t height) {
+	if ((width > 0) && (height > 0)) {
+		uv_uidirty_rect_st rect = { .x = x, .y = y, .width = width, .height = height };
+		absorb(dirty, &rect);
+		while (dirty->count == CONFIG_UI_DIRTY_RECTS) {
+			// no room: merge with the area that grows the least from it
+			uint8_t best = 0;
+			int32_t best_growth = INT32_MAX;
+			for (uint8_t i = 0; i < dirty->count; i++) {
+				uv_uidirty_rect_st u = rect_union(&rect, &dirty->rect[i]);
+				int32_t growth = rect_area(&u) - rect_area(&dirty->rect[i]) -
+						rect_area(&rect);
+				if (growth < best_growth) {
+					best = i;
+					best_growth = growth;
+				}
+				else {
+				}
+			}
+			rect = rect_union(&rect, &dirty->rect[best]);
+			dirty->count--;
+			dirty->rect[best] = dirty->rect[dirty->count];
+			absorb(dirty, &rect);
+		}
+		dirty->rect[dirty->count++] = rect;
+	}
+	else {
+	}
+}
+
+
+#endif
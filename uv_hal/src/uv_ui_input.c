@@ -0,0 +1,176 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_ui_input.h"
+#include "uv_utilities.h"
+#include <string.h>
+
+
+// The queue holds no UI types, so the display backends can fill it from
+// their event handlers and the tests can drive it without the UI built.
+
+
+
+void uv_ui_input_queue_init(uv_ui_input_queue_st *this,
+		uv_ui_input_event_st *buffer, uint16_t len) {
+	this->events = buffer;
+	this->len = len;
+	this->head = 0;
+	this->count = 0;
+	this->dropped = 0;
+}
+
+
+bool uv_ui_input_queue_push(uv_ui_input_queue_st *this,
+		const uv_ui_input_event_st *event) {
+	bool ret = true;
+	uv_ui_input_event_st *last = NULL;
+	if (this->count != 0) {
+		uint32_t i = (uint32_t) this->head + this->count - 1;
+		last = &this->events[i % this->len];
+	}
+	if ((last != NULL) &&
+			(last->type == UI_INPUT_TOUCH) &&
+			(event->type == UI_INPUT_TOUCH)) {
+		// a move of the touch not yet taken out
+		last->x = event->x;
+		last->y = event->y;
+	}
+	else if (this->count < this->len) {
+		uint32_t i = (uint32_t) this->head + this->count;
+		this->events[i % this->len] = *event;
+		this->count++;
+	}
+	else {
+		this->dropped++;
+		ret = false;
+	}
+	return ret;
+}
+
+
+const uv_ui_input_event_st *uv_ui_input_queue_peek(const uv_ui_input_queue_st *this) {
+	return (this->count != 0) ? &this->events[this->head] : NULL;
+}
+
+
+bool uv_ui_input_queue_pop(uv_ui_input_queue_st *this, uv_ui_input_event_st *event) {
+	bool ret = false;
+	if (this->count != 0) {
+		*event = this->events[this->head];
+		this->head = (this->head + 1 == this->len) ? 0 : this->head + 1;
+		this->count--;
+		ret = true;
+	}
+	return ret;
+}
+
+
+
+/// @brief: Returns the bucket of *us*
+static uint8_t bucket_of(uint32_t us) {
+	uint8_t ret;
+	if (us < 8) {
+		ret = (uint8_t) us;
+	}
+	else {
+		// position of the highest bit, at least 3
+		uint8_t msb = 3;
+		while ((msb < 31) && ((us >> (msb + 1)) != 0)) {
+			msb++;
+		}
+		// the two bits below it pick the quarter
+		ret = (uint8_t) (8 + (msb - 3) * 4 + ((us >> (msb - 2)) & 3));
+	}
+	return ret;
+}
+
+
+/// @brief: Returns the smallest latency in *bucket*
+static uint32_t bucket_start(uint8_t bucket) {
+	uint32_t ret;
+	if (bucket < 8) {
+		ret = bucket;
+	}
+	else {
+		uint8_t msb = (uint8_t) ((bucket - 8) / 4 + 3);
+		ret = (uint32_t) (4 + (bucket - 8) % 4) << (msb - 2);
+	}
+	return ret;
+}
+
+
+void uv_ui_latency_reset(uv_ui_latency_st *this) {
+	memset(this->bucket, 0, sizeof(this->bucket));
+	this->count = 0;
+	this->max_us = 0;
+}
+
+
+void uv_ui_latency_add(uv_ui_latency_st *this, uint32_t us) {
+	uint8_t b = bucket_of(us);
+	if (this->bucket[b] == UINT16_MAX) {
+		for (uint8_t i = 0; i < UI_LATENCY_BUCKETS; i++) {
+			this->bucket[i] /= 2;
+		}
+	}
+	else {
+	}
+	this->bucket[b]++;
+	this->count++;
+	if (us > this->max_us) {
+		this->max_us = us;
+	}
+	else {
+	}
+}
+
+
+uint32_t uv_ui_latency_percentile(const uv_ui_latency_st *this, uint16_t permille) {
+	uint32_t ret = 0;
+	uint32_t total = 0;
+	for (uint8_t i = 0; i < UI_LATENCY_BUCKETS; i++) {
+		total += this->bucket[i];
+	}
+	if (total != 0) {
+		// the count the percentile is at, rounded up so that 1000 is the last
+		uint32_t target = (total * MIN(permille, 1000) + 999) / 1000;
+		uint32_t sum = 0;
+		for (uint8_t i = 0; i < UI_LATENCY_BUCKETS; i++) {
+			sum += this->bucket[i];
+			if ((sum >= target) && (sum != 0)) {
+				ret = (i + 1 < UI_LATENCY_BUCKETS) ?
+						bucket_start((uint8_t) (i + 1)) - 1 : UINT32_MAX;
+				break;
+			}
+		}
+		// never above what was actually seen
+		ret = MIN(ret, this->max_us);
+	}
+	return ret;
+}
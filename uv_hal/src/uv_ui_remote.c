@@ -27,42 +27,109 @@
  */
 
 #include "uv_ui_common.h"
+#include "uv_rtos.h"
 #include <string.h>
 
 #if CONFIG_UI && CONFIG_UI_REMOTE
 
 
-/// @brief: Single-buffer capture state machine.
+/// @brief: State of one capture buffer.
 ///
-/// The UI task appends encode_* output into *buf* while GATHERING, closes the
-/// frame on frame_end and hands the buffer to the transport (TX). The transport
-/// task drains the buffer read-only and calls frame_sent (-> WAIT). Gathering of
-/// the next frame only resumes after the next frame boundary (dlswap), so a
-/// buffer is never restarted in the middle of a screen.
+/// The UI task captures a frame into a FREE buffer (GATHER) and publishes it
+/// on frame_end (READY). The transport task takes the READY one (TX), drains it
+/// read-only and calls frame_sent. There is at most one READY frame: a frame
+/// completed while the previous one is still waiting for the transport
+/// replaces it, so the transport always picks up the newest screen and never
+/// spends the link on one the display has already moved on from.
+///
+/// With CONFIG_UI_REMOTE_DELTA the frame the transport sent last is kept
+/// (BASE), since the next frame is sent as a delta against it. It is given up
+/// for capturing when no buffer is FREE, which costs the next frame its delta
+/// but never a screen.
 typedef enum {
-	// Not capturing; waiting for a clear (FRAME_BEGIN) to start a new frame.
-	REMOTE_UI_IDLE = 0,
-	// Appending the current frame's commands into buf.
-	REMOTE_UI_GATHER,
-	// buf holds a complete frame; the transport is draining it.
-	REMOTE_UI_TX,
-	// Transmit finished; wait for the next frame_end to realign, then IDLE.
-	REMOTE_UI_WAIT
-} remote_ui_state_e;
+	REMOTE_UI_FRAME_FREE = 0,
+	REMOTE_UI_FRAME_GATHER,
+	REMOTE_UI_FRAME_READY,
+	REMOTE_UI_FRAME_TX,
+	REMOTE_UI_FRAME_BASE
+} remote_ui_frame_state_e;
 
 
-static struct {
+typedef struct {
 	uint8_t buf[CONFIG_UI_REMOTE_BUFFER_SIZE];
-	uint16_t buf_len;
+	uint16_t len;
+	volatile remote_ui_frame_state_e state;
+	// the color mode buf is in once published
+	uv_ui_remote_color_mode_e mode;
+#if CONFIG_UI_REMOTE_DELTA
+	uv_ui_remote_frame_index_st idx;
+	bool indexed;
+	// buf written as a delta frame against the base; zero length when buf
+	// goes whole
+	uint8_t delta[CONFIG_UI_REMOTE_BUFFER_SIZE];
+	uint16_t delta_len;
+#endif
+} remote_ui_frame_st;
+
+#define NO_FRAME		(-1)
+
+
+/// @brief: An asset chunk staged for the transport
+typedef struct {
+	uint8_t buf[UV_UI_REMOTE_ASSET_HDR_LEN + UV_UI_REMOTE_ASSET_CHUNK];
+	uint16_t len;
+	uint8_t flags;
+	// for the last chunk of a transfer, what goes into the metrics once it is
+	// on the link
+	uint8_t kind;
+	uint32_t id;
+	uint32_t total;
+	uint32_t start_tick;
+} remote_ui_asset_chunk_st;
+
+
+static struct {
+	remote_ui_frame_st frame[CONFIG_UI_REMOTE_FRAME_BUFFERS];
+	// the frame being captured, or NULL. Owned by the UI task.
+	remote_ui_frame_st *cur;
 	bool overflow;
+	// No buffer was free when this screen started, so nothing more is captured
+	// until the next frame boundary: opening a frame halfway through a screen
+	// would send the sink half a screen.
+	bool skip_to_boundary;
 	bool enabled;
-	volatile remote_ui_state_e state;
+	// the frame the transport is draining, or NO_FRAME
+	volatile int8_t tx;
 
-	// hash of the last transmitted frame, for send-on-change suppression
+	// hash of the last published frame, for send-on-change suppression
 	uint32_t last_hash;
 
-	// The display was drawn while this buffer was busy with an earlier frame,
-	// so what the sink is looking at is out of date. Only ever set by a screen
+#if CONFIG_UI_REMOTE_DELTA
+	// The frame deltas are computed against: the one the transport is sending
+	// or has sent last, since that is what the sink will have by the time the
+	// next one reaches it. NO_FRAME when there is none to rely on.
+	volatile int8_t base;
+	uint16_t since_keyframe;
+	// set by whoever knows the sink has lost track, so that the next frame is
+	// sent whole
+	volatile bool keyframe_wanted;
+#endif
+
+#if CONFIG_UI_REMOTE_COLOR_MODES
+	// what the sink said it decodes, written by the transport task
+	volatile uint8_t sink_caps;
+	// the palette of the frames published in the palette mode. Owned by the
+	// UI task.
+	uv_ui_remote_palette_st palette;
+#if !CONFIG_UI_REMOTE_DELTA
+	// a frame is rewritten here; with deltas the frame's delta buffer, which
+	// is not in use yet, serves
+	uint8_t convert_buf[CONFIG_UI_REMOTE_BUFFER_SIZE];
+#endif
+#endif
+
+	// The display was drawn while no buffer could capture it, or a captured
+	// frame was dropped, so what the sink is looking at is out of date. Only ever set by a screen
 	// that was actually drawn and actually missed: a display that is not
 	// changing sets it never, and cannot ask for a redraw it does not need.
 	bool missed;
@@ -73,9 +140,11 @@ static struct {
 	// transfer can open.
 	const char *pending_name;
 	uint32_t pending_id;
+	uint8_t pending_kind;
 
 	// --- assets the sink has asked for --------------------------------------
-	// Written by the transport task, read and cleared by the UI task.
+	// Written by the transport task, read and cleared by the UI task. *kind*
+	// keeps the UV_UI_REMOTE_ASSET_KIND_RLE flag the sink asked with.
 	struct {
 		volatile uint8_t kind;
 		volatile uint32_t id;
@@ -85,15 +154,19 @@ static struct {
 	uv_ui_remote_asset_size_t asset_size_callb;
 	uv_ui_remote_asset_read_t asset_read_callb;
 
-	// The chunk being handed to the transport. Filled on the UI task at a frame
+	// Chunks staged for the transport. Filled on the UI task at a frame
 	// boundary (the provider reads flash, which the UI task owns) and drained by
-	// the transport task, so only one chunk is in flight at a time.
+	// the transport task in order. Single producer, single consumer: the UI
+	// task only advances *head*, the transport task only *tail*, both counting
+	// freely and wrapping.
+	remote_ui_asset_chunk_st asset_ring[CONFIG_UI_REMOTE_ASSET_CHUNKS];
+	volatile uint8_t asset_head;
+	volatile uint8_t asset_tail;
+
+	uv_ui_remote_asset_stats_st asset_stats;
+
+	// the transfer in progress
 	struct {
-		uint8_t buf[UV_UI_REMOTE_ASSET_HDR_LEN + UV_UI_REMOTE_ASSET_CHUNK];
-		uint16_t len;
-		uint8_t flags;
-		volatile bool ready;
-		// the transfer in progress
 		bool active;
 		uint8_t kind;
 		uint32_t id;
@@ -101,38 +174,34 @@ static struct {
 		const char *name;
 		uint32_t total;
 		uint32_t offset;
+		uint32_t start_tick;
+		// the asset has been read to the end, for a run-length coded one
+		// whose window may still hold some of it
+		bool eof;
+		uv_ui_remote_rle_enc_st rle;
 	} tx_asset;
 
 	// a font asset is built here when its transfer opens, and chunked out of it
 	uint8_t font_body[UV_UI_REMOTE_FONT_BODY_HDR_LEN];
 
-	// reverse input latch (written by transport task, read by UI task)
+	// reverse input latch (written by transport task, read by UI task). The
+	// events themselves go into the UI input queue.
 	volatile bool in_touched;
 	volatile int16_t in_x;
 	volatile int16_t in_y;
-	volatile int16_t in_scroll;
-	volatile char in_key;
 } remote_ui;
 #define this (&remote_ui)
 
 
-
-static uint32_t fnv1a(const uint8_t *data, uint16_t len) {
-	uint32_t h = 2166136261u;
-	for (uint16_t i = 0; i < len; i++) {
-		h ^= data[i];
-		h *= 16777619u;
-	}
-	return h;
-}
+static void asset_stage_chunks(void);
 
 
 // --- append helpers (little-endian, bounds-checked) -------------------------
 
 static void ap8(uint8_t v) {
-	if (this->buf_len < sizeof(this->buf)) {
-		this->buf[this->buf_len] = v;
-		this->buf_len++;
+	if (this->cur->len < sizeof(this->cur->buf)) {
+		this->cur->buf[this->cur->len] = v;
+		this->cur->len++;
 	}
 	else {
 		this->overflow = true;
@@ -160,7 +229,7 @@ static uint8_t resolve_font_id(const ui_font_st *font) {
 		}
 		// ui_mono_fonts[] only exists on the host backends; the FT81X device has
 		// a single font table, so its strings always resolve into ui_fonts[].
-#if CONFIG_UI_OPENGL || CONFIG_UI_X11
+#if CONFIG_UI_OPENGL || CONFIG_UI_X11 || CONFIG_UI_HEADLESS
 		else if (font == &ui_mono_fonts[i]) {
 			id = (uint8_t) (i | 0x80u);
 		}
@@ -173,6 +242,63 @@ static uint8_t resolve_font_id(const ui_font_st *font) {
 }
 
 
+/// @brief: Takes a buffer to capture a frame into. A FREE one if there is
+/// one, then the delta base, then the READY frame the transport has not picked
+/// up yet - which is about to be replaced by a newer one anyway. Never the one
+/// being transmitted.
+///
+/// @return: false when every buffer is busy, which only happens with a single
+/// buffer while it is being transmitted
+static bool frame_open(void) {
+	static const remote_ui_frame_state_e prefer[] = {
+			REMOTE_UI_FRAME_FREE,
+			REMOTE_UI_FRAME_BASE,
+			REMOTE_UI_FRAME_READY
+	};
+	remote_ui_frame_st *f = NULL;
+	uv_enter_critical();
+	for (uint8_t p = 0; (p < (sizeof(prefer) / sizeof(prefer[0]))) && (f == NULL); p++) {
+		for (uint8_t i = 0; (i < CONFIG_UI_REMOTE_FRAME_BUFFERS) && (f == NULL); i++) {
+			if (this->frame[i].state == prefer[p]) {
+				f = &this->frame[i];
+			}
+			else {
+			}
+		}
+	}
+	if (f != NULL) {
+#if CONFIG_UI_REMOTE_DELTA
+		if (f->state == REMOTE_UI_FRAME_BASE) {
+			this->base = NO_FRAME;
+		}
+		else if ((f->state == REMOTE_UI_FRAME_READY) && (f->delta_len == 0)) {
+			// a whole frame that is never going to be sent, so the one
+			// replacing it has to be
+			this->keyframe_wanted = true;
+		}
+		else {
+		}
+#endif
+		f->state = REMOTE_UI_FRAME_GATHER;
+	}
+	else {
+	}
+	uv_exit_critical();
+
+	this->cur = f;
+	if (f != NULL) {
+		f->len = 0;
+		f->mode = UV_UI_REMOTE_COLOR_ARGB8888;
+		this->overflow = false;
+	}
+	else {
+		this->skip_to_boundary = true;
+		this->missed = true;
+	}
+	return (f != NULL);
+}
+
+
 /// @brief: True when a new command may be appended to the current frame,
 /// opening one first if a draw arrives with no frame in progress.
 ///
@@ -188,16 +314,159 @@ static uint8_t resolve_font_id(const ui_font_st *font) {
 /// over the frame it already has rather than starting from a cleared screen -
 /// the same thing the device is doing to its own display list.
 static bool gathering(void) {
-	if (this->enabled && (this->state == REMOTE_UI_IDLE)) {
-		this->buf_len = 0;
-		this->overflow = false;
-		ap8((uint8_t) UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP);
-		this->state = REMOTE_UI_GATHER;
+	if (this->enabled && (this->cur == NULL) && !this->skip_to_boundary) {
+		if (frame_open()) {
+			ap8((uint8_t) UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP);
+		}
+		else {
+		}
 	}
 	else {
 		// a frame is already open, or we are not capturing at all
 	}
-	return this->enabled && (this->state == REMOTE_UI_GATHER);
+	return this->enabled && (this->cur != NULL);
+}
+
+
+#if CONFIG_UI_REMOTE_DELTA
+/// @brief: Decides how the frame just closed in *f* goes out: as a delta
+/// against the base frame when that is shorter, whole otherwise, and whole at
+/// least every CONFIG_UI_REMOTE_KEYFRAME_INTERVAL frames so that a sink that
+/// has lost a delta somewhere does not stay wrong indefinitely.
+///
+/// Called with no READY frame around, so the transport cannot move the base
+/// while the delta is computed against it.
+static void delta_prepare(remote_ui_frame_st *f) {
+	int8_t base = this->base;
+	bool keyframe = this->keyframe_wanted ||
+			(base == NO_FRAME) ||
+			// the color mode changed, or this one did not fit in it
+			(this->frame[base].mode != f->mode) ||
+			(this->since_keyframe >= CONFIG_UI_REMOTE_KEYFRAME_INTERVAL);
+	this->keyframe_wanted = false;
+	f->delta_len = 0;
+	f->indexed = uv_ui_remote_frame_index(&f->idx, f->mode, f->buf, f->len);
+	if (f->indexed && !keyframe) {
+		remote_ui_frame_st *b = &this->frame[base];
+		f->delta_len = uv_ui_remote_delta_encode(b->buf, &b->idx,
+				f->buf, &f->idx, f->delta, sizeof(f->delta));
+	}
+	else {
+	}
+	if (f->delta_len > 0) {
+		this->since_keyframe++;
+	}
+	else {
+		this->since_keyframe = 0;
+	}
+}
+#endif
+
+
+#if CONFIG_UI_REMOTE_COLOR_MODES
+/// @brief: Rewrites the frame just closed in *f* into the most compact color
+/// mode the sink decodes. Frames are captured in ARGB8888 whatever the mode,
+/// so that the encode hooks stay as they are and the send-on-change hash does
+/// not depend on the mode.
+///
+/// RGB565 comes first: the palette mode defines every color of the frame with
+/// a COLOR op, which a screen with few ops of each color does not win back, so
+/// it is used only when it codes the frame smaller.
+static void color_prepare(remote_ui_frame_st *f) {
+	uint8_t caps = this->sink_caps;
+#if CONFIG_UI_REMOTE_DELTA
+	uint8_t *dest = f->delta;
+#else
+	uint8_t *dest = this->convert_buf;
+#endif
+	uv_ui_remote_color_mode_e mode = UV_UI_REMOTE_COLOR_ARGB8888;
+	uint16_t len = f->len;
+	if (caps & UV_UI_REMOTE_CAP_RGB565) {
+		uint16_t l = uv_ui_remote_color_size(UV_UI_REMOTE_COLOR_RGB565, f->buf, f->len);
+		if (l != 0) {
+			mode = UV_UI_REMOTE_COLOR_RGB565;
+			len = l;
+		}
+		else {
+		}
+	}
+	else {
+	}
+	if ((caps & UV_UI_REMOTE_CAP_PALETTE) && (len > 1)) {
+		// given a byte less room than the frame has in the mode so far, which
+		// stops the rewrite as soon as it is no smaller
+		uint16_t l = uv_ui_remote_color_convert(&this->palette,
+				UV_UI_REMOTE_COLOR_PALETTE, f->buf, f->len,
+				dest, MIN(len - 1, CONFIG_UI_REMOTE_BUFFER_SIZE));
+		if (l != 0) {
+			mode = UV_UI_REMOTE_COLOR_PALETTE;
+			len = l;
+		}
+		else {
+		}
+	}
+	else {
+	}
+	if (mode == UV_UI_REMOTE_COLOR_RGB565) {
+		len = uv_ui_remote_color_convert(&this->palette, mode,
+				f->buf, f->len, dest, CONFIG_UI_REMOTE_BUFFER_SIZE);
+	}
+	else {
+	}
+	if ((mode != UV_UI_REMOTE_COLOR_ARGB8888) && (len != 0)) {
+		memcpy(f->buf, dest, len);
+		f->len = len;
+		f->mode = mode;
+	}
+	else {
+	}
+}
+#endif
+
+
+/// @brief: Publishes the frame just captured as the one to send next,
+/// replacing a READY frame the transport has not got round to
+static void frame_publish(remote_ui_frame_st *f) {
+	uv_enter_critical();
+	for (uint8_t i = 0; i < CONFIG_UI_REMOTE_FRAME_BUFFERS; i++) {
+		if (this->frame[i].state == REMOTE_UI_FRAME_READY) {
+#if CONFIG_UI_REMOTE_DELTA
+			if (this->frame[i].delta_len == 0) {
+				this->keyframe_wanted = true;
+			}
+			else {
+			}
+#endif
+			this->frame[i].state = REMOTE_UI_FRAME_FREE;
+		}
+		else {
+		}
+	}
+	uv_exit_critical();
+
+#if CONFIG_UI_REMOTE_COLOR_MODES
+	color_prepare(f);
+#endif
+#if CONFIG_UI_REMOTE_DELTA
+	delta_prepare(f);
+#endif
+	f->state = REMOTE_UI_FRAME_READY;
+}
+
+
+/// @brief: Frees every buffer and forgets the delta base
+static void frames_reset(void) {
+	this->cur = NULL;
+	this->overflow = false;
+	this->skip_to_boundary = false;
+	this->tx = NO_FRAME;
+	for (uint8_t i = 0; i < CONFIG_UI_REMOTE_FRAME_BUFFERS; i++) {
+		this->frame[i].state = REMOTE_UI_FRAME_FREE;
+		this->frame[i].len = 0;
+	}
+#if CONFIG_UI_REMOTE_DELTA
+	this->base = NO_FRAME;
+#endif
 }
 
 
@@ -205,47 +474,62 @@ static bool gathering(void) {
 void uv_ui_remote_init(void) {
 	memset(this, 0, sizeof(*this));
 	this->enabled = false;
-	this->state = REMOTE_UI_IDLE;
+	frames_reset();
 }
 
 
 void uv_ui_remote_reset(void) {
-	this->buf_len = 0;
-	this->overflow = false;
-	this->state = REMOTE_UI_IDLE;
+	frames_reset();
 	this->last_hash = 0;
 	this->pending_name = NULL;
 	for (uint8_t i = 0; i < CONFIG_UI_REMOTE_ASSET_REQ_MAX; i++) {
 		this->wanted[i].pending = false;
 	}
-	this->tx_asset.ready = false;
+	this->asset_head = 0;
+	this->asset_tail = 0;
 	this->tx_asset.active = false;
+	memset(&this->asset_stats, 0, sizeof(this->asset_stats));
+#if CONFIG_UI_REMOTE_COLOR_MODES
+	this->sink_caps = 0;
+#endif
 	this->missed = false;
 	this->in_touched = false;
-	this->in_scroll = 0;
-	this->in_key = '\0';
 }
 
 
 void uv_ui_remote_step(uint16_t step_ms) {
-	// No periodic work needed for the source-side encoder; the transport pulls
-	// frames on its own schedule. Placeholder for future asset streaming.
 	(void) step_ms;
+	// Frames are pulled by the transport on its own schedule, and asset chunks
+	// are staged at every frame boundary. A screen that stands still has none,
+	// so the chunks are staged here as well, between frames, for a transfer
+	// not to wait for the next change on the screen.
+	if (this->enabled && (this->cur == NULL) && !this->skip_to_boundary) {
+		asset_stage_chunks();
+	}
+	else {
+	}
 }
 
 
 void uv_ui_remote_set_enabled(bool enabled) {
 	if (enabled && !this->enabled) {
+		frames_reset();
 		this->enabled = true;
-		this->state = REMOTE_UI_IDLE;
 		this->last_hash = 0;
 		// a sink that has just connected has nothing at all, so it is owed a
-		// screen by definition
+		// screen by definition, and a whole one
 		this->missed = true;
+#if CONFIG_UI_REMOTE_DELTA
+		this->keyframe_wanted = true;
+#endif
+#if CONFIG_UI_REMOTE_COLOR_MODES
+		// and it has not said what it decodes yet
+		this->sink_caps = 0;
+#endif
 	}
 	else if (!enabled && this->enabled) {
 		this->enabled = false;
-		this->state = REMOTE_UI_IDLE;
+		frames_reset();
 	}
 	else {
 		// no change
@@ -258,6 +542,17 @@ bool uv_ui_remote_active(void) {
 }
 
 
+void uv_ui_remote_set_sink_caps(uint8_t caps) {
+#if CONFIG_UI_REMOTE_COLOR_MODES
+	// Taken up by the next frame published. A frame in a mode other than
+	// its base's goes whole.
+	this->sink_caps = caps;
+#else
+	(void) caps;
+#endif
+}
+
+
 void uv_ui_remote_request_frame(void) {
 	this->missed = true;
 	// Whoever asks for a frame is looking at nothing, so what was sent last is
@@ -266,15 +561,28 @@ void uv_ui_remote_request_frame(void) {
 	// as a duplicate - and the sink that just asked keeps its empty window
 	// until something on the display happens to move.
 	this->last_hash = 0;
+#if CONFIG_UI_REMOTE_DELTA
+	// nor can it be relied on to have the frame a delta would be against
+	this->keyframe_wanted = true;
+#endif
 }
 
 
 bool uv_ui_remote_redraw_wanted(void) {
-	// Not while transmitting: a redraw then could not be captured either, and
-	// would only be work thrown away. Once the buffer frees up the answer turns
-	// true and stays true until a screen has actually been captured.
-	return this->enabled && this->missed &&
-			((this->state == REMOTE_UI_IDLE) || (this->state == REMOTE_UI_WAIT));
+	// Not while every buffer is busy: a redraw then could not be captured
+	// either, and would only be work thrown away. That only ever happens with a
+	// single buffer while it is being transmitted. Once a buffer frees up the
+	// answer turns true and stays true until a screen has actually been
+	// captured.
+	bool free = false;
+	for (uint8_t i = 0; i < CONFIG_UI_REMOTE_FRAME_BUFFERS; i++) {
+		if (this->frame[i].state != REMOTE_UI_FRAME_TX) {
+			free = true;
+		}
+		else {
+		}
+	}
+	return this->enabled && this->missed && free;
 }
 
 
@@ -282,7 +590,7 @@ uint32_t uv_ui_remote_bitmap_id(const uv_uimedia_st *bitmap) {
 	uint32_t id = UV_UI_REMOTE_ASSET_INVALID_ID;
 	if ((bitmap != NULL) && (bitmap->filename != NULL) &&
 			(bitmap->filename[0] != '\0')) {
-		id = fnv1a((const uint8_t *) bitmap->filename,
+		id = uv_ui_remote_frame_hash((const uint8_t *) bitmap->filename,
 				(uint16_t) strlen(bitmap->filename));
 	}
 	else {
@@ -297,23 +605,93 @@ uint32_t uv_ui_remote_bitmap_id(const uv_uimedia_st *bitmap) {
 
 bool uv_ui_remote_frame_pending(const uint8_t **data, uint16_t *len) {
 	bool ret = false;
-	if (this->state == REMOTE_UI_TX) {
+	uv_enter_critical();
+	if (this->tx == NO_FRAME) {
+		for (int8_t i = 0; i < CONFIG_UI_REMOTE_FRAME_BUFFERS; i++) {
+			if (this->frame[i].state == REMOTE_UI_FRAME_READY) {
+				this->frame[i].state = REMOTE_UI_FRAME_TX;
+				this->tx = i;
+#if CONFIG_UI_REMOTE_DELTA
+				// From here on this is what the sink will have by the time the
+				// next frame reaches it, so the old base is no longer needed
+				if ((this->base != NO_FRAME) &&
+						(this->frame[this->base].state == REMOTE_UI_FRAME_BASE)) {
+					this->frame[this->base].state = REMOTE_UI_FRAME_FREE;
+				}
+				else {
+				}
+				this->base = this->frame[i].indexed ? i : NO_FRAME;
+#endif
+			}
+			else {
+			}
+		}
+	}
+	else {
+	}
+	uv_exit_critical();
+
+	if (this->tx != NO_FRAME) {
+		remote_ui_frame_st *f = &this->frame[this->tx];
+		const uint8_t *d = f->buf;
+		uint16_t l = f->len;
+#if CONFIG_UI_REMOTE_DELTA
+		if (f->delta_len > 0) {
+			d = f->delta;
+			l = f->delta_len;
+		}
+		else {
+		}
+#endif
 		if (data != NULL) {
-			*data = this->buf;
+			*data = d;
 		}
 		if (len != NULL) {
-			*len = this->buf_len;
+			*len = l;
 		}
 		ret = true;
 	}
+	else {
+	}
+	return ret;
+}
+
+
+uint8_t uv_ui_remote_frame_flags(void) {
+	uint8_t ret = 0;
+	int8_t tx = this->tx;
+	if (tx != NO_FRAME) {
+		if (this->frame[tx].mode == UV_UI_REMOTE_COLOR_RGB565) {
+			ret = UV_UI_REMOTE_FRAME_FLAG_RGB565;
+		}
+		else if (this->frame[tx].mode == UV_UI_REMOTE_COLOR_PALETTE) {
+			ret = UV_UI_REMOTE_FRAME_FLAG_PALETTE;
+		}
+		else {
+		}
+	}
+	else {
+	}
 	return ret;
 }
 
 
 void uv_ui_remote_frame_sent(void) {
-	if (this->state == REMOTE_UI_TX) {
-		this->state = REMOTE_UI_WAIT;
+	uv_enter_critical();
+	if (this->tx != NO_FRAME) {
+		remote_ui_frame_st *f = &this->frame[this->tx];
+#if CONFIG_UI_REMOTE_DELTA
+		// kept for the next delta to be computed against
+		f->state = (this->base == this->tx) ?
+				REMOTE_UI_FRAME_BASE : REMOTE_UI_FRAME_FREE;
+#else
+		f->state = REMOTE_UI_FRAME_FREE;
+#endif
+		this->tx = NO_FRAME;
+	}
+	else {
 	}
+	uv_exit_critical();
 }
 
 
@@ -325,13 +703,19 @@ void uv_ui_remote_input_inject(uint8_t action, int16_t x, int16_t y,
 		this->in_x = x;
 		this->in_y = y;
 		this->in_touched = true;
+		uv_ui_input_push(UI_INPUT_TOUCH, x, y, 0);
 	}
-	else {
+	else if (this->in_touched) {
 		this->in_touched = false;
+		uv_ui_input_push(UI_INPUT_RELEASE, this->in_x, this->in_y, 0);
+	}
+	else {
+	}
+	if (scroll != 0) {
+		uv_ui_input_push(UI_INPUT_SCROLL, 0, 0, scroll);
 	}
-	this->in_scroll = (int16_t) (this->in_scroll + scroll);
 	if (key != '\0') {
-		this->in_key = key;
+		uv_ui_input_push(UI_INPUT_KEY, 0, 0, (int16_t) (uint8_t) key);
 	}
 }
 
@@ -350,18 +734,6 @@ bool uv_ui_remote_get_touch(int16_t *x, int16_t *y) {
 }
 
 
-int16_t uv_ui_remote_get_scroll(void) {
-	int16_t ret = this->in_scroll;
-	this->in_scroll = 0;
-	return ret;
-}
-
-
-char uv_ui_remote_get_key(void) {
-	char ret = this->in_key;
-	this->in_key = '\0';
-	return ret;
-}
 
 
 // --- serving assets ---------------------------------------------------------
@@ -388,7 +760,7 @@ static uint16_t font_body_build(uint32_t id) {
 	const ui_font_st *font = NULL;
 
 	if (index < UI_MAX_FONT_COUNT) {
-#if CONFIG_UI_OPENGL || CONFIG_UI_X11
+#if CONFIG_UI_OPENGL || CONFIG_UI_X11 || CONFIG_UI_HEADLESS
 		font = mono ? &ui_mono_fonts[index] : &ui_fonts[index];
 #else
 		// one font table on the device; a mono request resolves to the same
@@ -420,6 +792,13 @@ static uint16_t font_body_build(uint32_t id) {
 		// the widths are the first 128 bytes of the font's metric block,
 		// whether that is the ROM one or a custom font's
 		(void) uv_ft81x_font_widths(index, &p[7]);
+#elif CONFIG_UI_HEADLESS
+		// the widths of the atlas the headless backend draws with
+		if (font->body != NULL) {
+			memcpy(&p[7], &font->body[7], UV_UI_REMOTE_FONT_WIDTHS);
+		}
+		else {
+		}
 #else
 		// no per-glyph metrics on this backend; height alone still helps
 #endif
@@ -471,7 +850,7 @@ void uv_ui_remote_asset_requested(uint8_t kind, uint32_t id) {
 	else {
 	}
 
-	if (kind == UV_UI_REMOTE_ASSET_KIND_BITMAP) {
+	if ((kind & UV_UI_REMOTE_ASSET_KIND_MASK) == UV_UI_REMOTE_ASSET_KIND_BITMAP) {
 		// A bitmap can only be answered from inside the draw that uses it: that
 		// is the one moment its file name is in reach. A screen that has
 		// settled is not going to be drawn again by itself, so a request for
@@ -490,14 +869,16 @@ void uv_ui_remote_asset_requested(uint8_t kind, uint32_t id) {
 void uv_ui_remote_asset_cancel(uint8_t kind, uint32_t id) {
 	for (uint8_t i = 0; i < CONFIG_UI_REMOTE_ASSET_REQ_MAX; i++) {
 		if (this->wanted[i].pending &&
-				(this->wanted[i].kind == kind) && (this->wanted[i].id == id)) {
+				((this->wanted[i].kind & UV_UI_REMOTE_ASSET_KIND_MASK) == kind) &&
+				(this->wanted[i].id == id)) {
 			this->wanted[i].pending = false;
 		}
 		else {
 		}
 	}
 	if (this->tx_asset.active &&
-			(this->tx_asset.kind == kind) && (this->tx_asset.id == id)) {
+			((this->tx_asset.kind & UV_UI_REMOTE_ASSET_KIND_MASK) == kind) &&
+			(this->tx_asset.id == id)) {
 		// stop mid-transfer: the sink sees a truncated asset and asks again
 		this->tx_asset.active = false;
 	}
@@ -512,7 +893,7 @@ void uv_ui_remote_asset_cancel(uint8_t kind, uint32_t id) {
 static void asset_start_next(void) {
 	// a bitmap caught while it was being drawn goes first: its name is in hand
 	if (this->pending_name != NULL) {
-		this->tx_asset.kind = UV_UI_REMOTE_ASSET_KIND_BITMAP;
+		this->tx_asset.kind = this->pending_kind;
 		this->tx_asset.id = this->pending_id;
 		this->tx_asset.name = this->pending_name;
 		this->pending_name = NULL;
@@ -530,7 +911,8 @@ static void asset_start_next(void) {
 	for (uint8_t i = 0;
 			(i < CONFIG_UI_REMOTE_ASSET_REQ_MAX) && !this->tx_asset.active; i++) {
 		if (this->wanted[i].pending &&
-				(this->wanted[i].kind == UV_UI_REMOTE_ASSET_KIND_FONT)) {
+				((this->wanted[i].kind & UV_UI_REMOTE_ASSET_KIND_MASK) ==
+						UV_UI_REMOTE_ASSET_KIND_FONT)) {
 			this->tx_asset.kind = this->wanted[i].kind;
 			this->tx_asset.id = this->wanted[i].id;
 			this->tx_asset.name = NULL;
@@ -542,88 +924,195 @@ static void asset_start_next(void) {
 		else {
 		}
 	}
+	if (this->tx_asset.active) {
+		this->tx_asset.start_tick = uv_rtos_get_tick_count();
+		this->tx_asset.eof = false;
+		uv_ui_remote_rle_enc_init(&this->tx_asset.rle);
+	}
+	else {
+	}
 }
 
 
-/// @brief: Fills the outgoing chunk buffer, if there is an asset to send and
-/// the transport has taken the last one. Runs on the UI task at a frame
-/// boundary: the provider reads external flash, which the UI task owns.
-static void asset_prepare_chunk(void) {
-	if (!this->tx_asset.ready) {
-		if (!this->tx_asset.active) {
-			asset_start_next();
-		}
-		else {
-		}
-		if (this->tx_asset.active) {
-			uint16_t n = 0;
-			uint8_t flags = 0;
-			if (this->tx_asset.offset == 0) {
-				// first chunk carries what the asset is and how long it is
-				flags |= UV_UI_REMOTE_ASSET_FLAG_START;
-				this->tx_asset.buf[0] = this->tx_asset.kind;
-				this->tx_asset.buf[1] = (uint8_t) (this->tx_asset.id & 0xFFu);
-				this->tx_asset.buf[2] = (uint8_t) ((this->tx_asset.id >> 8) & 0xFFu);
-				this->tx_asset.buf[3] = (uint8_t) ((this->tx_asset.id >> 16) & 0xFFu);
-				this->tx_asset.buf[4] = (uint8_t) ((this->tx_asset.id >> 24) & 0xFFu);
-				this->tx_asset.buf[5] = (uint8_t) (this->tx_asset.total & 0xFFu);
-				this->tx_asset.buf[6] = (uint8_t) ((this->tx_asset.total >> 8) & 0xFFu);
-				this->tx_asset.buf[7] = (uint8_t) ((this->tx_asset.total >> 16) & 0xFFu);
-				this->tx_asset.buf[8] = (uint8_t) ((this->tx_asset.total >> 24) & 0xFFu);
-				n = UV_UI_REMOTE_ASSET_HDR_LEN;
+/// @brief: Reads up to *len* bytes of the transfer in progress from its
+/// current offset into *dest*, from the font body built here or from the
+/// provider. A read shorter than *len* means the asset has run dry.
+static uint32_t asset_read(uint8_t *dest, uint32_t len) {
+	uint32_t got = 0;
+	uint8_t kind = this->tx_asset.kind & UV_UI_REMOTE_ASSET_KIND_MASK;
+	if (len == 0) {
+	}
+	else if (kind == UV_UI_REMOTE_ASSET_KIND_FONT) {
+		memcpy(dest, &this->font_body[this->tx_asset.offset], len);
+		got = len;
+	}
+	else if ((this->asset_read_callb != NULL) &&
+			(this->tx_asset.name != NULL)) {
+		got = this->asset_read_callb(kind, this->tx_asset.name,
+				this->tx_asset.offset, dest, len);
+	}
+	else {
+	}
+	this->tx_asset.offset += got;
+	return got;
+}
+
+
+/// @brief: Reads the next chunk of the transfer in progress into *c*.
+///
+/// A sink that asked for it gets the asset run-length coded. The coder works
+/// through a window of the asset rather than the whole of it, so it is read
+/// from flash a window at a time and coded on the way through, and a chunk
+/// carries as much of the asset as its coded bytes fit.
+///
+/// @return: number of asset bytes read
+static uint32_t asset_prepare_chunk(remote_ui_asset_chunk_st *c) {
+	uint16_t n = 0;
+	uint8_t flags = 0;
+	uint32_t read = 0;
+	bool done = false;
+	if (this->tx_asset.offset == 0) {
+		// first chunk carries what the asset is and how long it is
+		flags |= UV_UI_REMOTE_ASSET_FLAG_START;
+		c->buf[0] = this->tx_asset.kind;
+		c->buf[1] = (uint8_t) (this->tx_asset.id & 0xFFu);
+		c->buf[2] = (uint8_t) ((this->tx_asset.id >> 8) & 0xFFu);
+		c->buf[3] = (uint8_t) ((this->tx_asset.id >> 16) & 0xFFu);
+		c->buf[4] = (uint8_t) ((this->tx_asset.id >> 24) & 0xFFu);
+		c->buf[5] = (uint8_t) (this->tx_asset.total & 0xFFu);
+		c->buf[6] = (uint8_t) ((this->tx_asset.total >> 8) & 0xFFu);
+		c->buf[7] = (uint8_t) ((this->tx_asset.total >> 16) & 0xFFu);
+		c->buf[8] = (uint8_t) ((this->tx_asset.total >> 24) & 0xFFu);
+		n = UV_UI_REMOTE_ASSET_HDR_LEN;
+	}
+	else {
+	}
+	uint16_t end = (uint16_t) (n + UV_UI_REMOTE_ASSET_CHUNK);
+
+	if (this->tx_asset.kind & UV_UI_REMOTE_ASSET_KIND_RLE) {
+		uv_ui_remote_rle_enc_st *rle = &this->tx_asset.rle;
+		uint16_t coded = 1;
+		while (coded > 0) {
+			if (!this->tx_asset.eof) {
+				uint32_t want = this->tx_asset.total - this->tx_asset.offset;
+				if (want > uv_ui_remote_rle_enc_space(rle)) {
+					want = uv_ui_remote_rle_enc_space(rle);
+				}
+				else {
+				}
+				uint32_t got = asset_read(&rle->window[rle->len], want);
+				rle->len = (uint16_t) (rle->len + got);
+				read += got;
+				this->tx_asset.eof = (got < want) ||
+						(this->tx_asset.offset >= this->tx_asset.total);
 			}
 			else {
 			}
+			coded = uv_ui_remote_rle_encode(rle, this->tx_asset.eof,
+					&c->buf[n], (uint16_t) (end - n));
+			n = (uint16_t) (n + coded);
+		}
+		done = this->tx_asset.eof && (rle->len == 0);
+	}
+	else {
+		uint32_t left = this->tx_asset.total - this->tx_asset.offset;
+		uint32_t want = (left > UV_UI_REMOTE_ASSET_CHUNK) ?
+				UV_UI_REMOTE_ASSET_CHUNK : left;
+		read = asset_read(&c->buf[n], want);
+		n = (uint16_t) (n + read);
+		// the provider running dry ends the transfer as surely as reaching
+		// the total does, so a short read cannot leave it hanging
+		done = (read < want) || (this->tx_asset.offset >= this->tx_asset.total);
+	}
+
+	if (done) {
+		flags |= UV_UI_REMOTE_ASSET_FLAG_END;
+		this->tx_asset.active = false;
+		c->kind = this->tx_asset.kind & UV_UI_REMOTE_ASSET_KIND_MASK;
+		c->id = this->tx_asset.id;
+		c->total = this->tx_asset.offset;
+		c->start_tick = this->tx_asset.start_tick;
+	}
+	else {
+	}
+	c->len = n;
+	c->flags = flags;
+	return read;
+}
 
-			uint32_t left = this->tx_asset.total - this->tx_asset.offset;
-			uint32_t want = (left > UV_UI_REMOTE_ASSET_CHUNK) ?
-					UV_UI_REMOTE_ASSET_CHUNK : left;
-			uint32_t got = 0;
-			if (want == 0) {
+
+/// @brief: Stages asset chunks for the transport while there is room in the
+/// ring and the frame's budget lasts. Runs on the UI task at a frame boundary:
+/// the provider reads external flash, which the UI task owns.
+///
+/// Both budgets bound what a frame boundary can cost the UI task, which is
+/// drawing the next screen as soon as this returns. The byte budget also
+/// bounds what a frame boundary can put on the link ahead of the next screen.
+static void asset_stage_chunks(void) {
+	uint32_t bytes = 0;
+	uint32_t start = uv_rtos_get_tick_count();
+	bool go = true;
+	while (go) {
+		uint8_t head = this->asset_head;
+		uint32_t elapsed_ms = (uv_rtos_get_tick_count() - start) *
+				UV_RTOS_TICK_PERIOD_MS;
+		if (((uint8_t) (head - this->asset_tail) >= CONFIG_UI_REMOTE_ASSET_CHUNKS) ||
+				(bytes >= CONFIG_UI_REMOTE_ASSET_FRAME_BUDGET) ||
+				(elapsed_ms >= CONFIG_UI_REMOTE_ASSET_TIME_BUDGET_MS)) {
+			go = false;
+		}
+		else {
+			if (!this->tx_asset.active) {
+				asset_start_next();
 			}
-			else if (this->tx_asset.kind == UV_UI_REMOTE_ASSET_KIND_FONT) {
-				memcpy(&this->tx_asset.buf[n],
-						&this->font_body[this->tx_asset.offset], want);
-				got = want;
+			else {
 			}
-			else if ((this->asset_read_callb != NULL) &&
-					(this->tx_asset.name != NULL)) {
-				got = this->asset_read_callb(this->tx_asset.kind,
-						this->tx_asset.name, this->tx_asset.offset,
-						&this->tx_asset.buf[n], want);
+			if (this->tx_asset.active) {
+				bytes += asset_prepare_chunk(
+						&this->asset_ring[head % CONFIG_UI_REMOTE_ASSET_CHUNKS]);
+				// counts the header too, so that an empty answer still costs
+				// something and a run of them cannot spin here
+				bytes += UV_UI_REMOTE_ASSET_HDR_LEN;
+				this->asset_head = (uint8_t) (head + 1u);
 			}
 			else {
+				go = false;
 			}
-			n = (uint16_t) (n + got);
-			this->tx_asset.offset += got;
-
-			// the provider running dry ends the transfer as surely as reaching
-			// the total does, so a short read cannot leave it hanging
-			if ((got < want) || (this->tx_asset.offset >= this->tx_asset.total)) {
-				flags |= UV_UI_REMOTE_ASSET_FLAG_END;
-				this->tx_asset.active = false;
+		}
+	}
+}
+
+
+/// @brief: True when a finished frame is waiting for the transport to pick it
+/// up. Asset chunks hold back until it has: a screen is what the sink is
+/// looking at, an asset only what it is waiting on.
+static bool frame_waiting(void) {
+	bool ret = false;
+	if (this->tx == NO_FRAME) {
+		for (uint8_t i = 0; i < CONFIG_UI_REMOTE_FRAME_BUFFERS; i++) {
+			if (this->frame[i].state == REMOTE_UI_FRAME_READY) {
+				ret = true;
 			}
 			else {
 			}
-			this->tx_asset.len = n;
-			this->tx_asset.flags = flags;
-			this->tx_asset.ready = true;
-		}
-		else {
 		}
 	}
 	else {
 	}
+	return ret;
 }
 
 
 bool uv_ui_remote_asset_chunk_pending(const uint8_t **data, uint16_t *len,
 		uint8_t *flags) {
 	bool ret = false;
-	if (this->enabled && this->tx_asset.ready) {
-		*data = this->tx_asset.buf;
-		*len = this->tx_asset.len;
-		*flags = this->tx_asset.flags;
+	uint8_t tail = this->asset_tail;
+	if (this->enabled && (tail != this->asset_head) && !frame_waiting()) {
+		remote_ui_asset_chunk_st *c =
+				&this->asset_ring[tail % CONFIG_UI_REMOTE_ASSET_CHUNKS];
+		*data = c->buf;
+		*len = c->len;
+		*flags = c->flags;
 		ret = true;
 	}
 	else {
@@ -633,78 +1122,99 @@ bool uv_ui_remote_asset_chunk_pending(const uint8_t **data, uint16_t *len,
 
 
 void uv_ui_remote_asset_chunk_sent(void) {
-	this->tx_asset.ready = false;
+	uint8_t tail = this->asset_tail;
+	if (tail != this->asset_head) {
+		remote_ui_asset_chunk_st *c =
+				&this->asset_ring[tail % CONFIG_UI_REMOTE_ASSET_CHUNKS];
+		this->asset_stats.wire_bytes += c->len;
+		if (c->flags & UV_UI_REMOTE_ASSET_FLAG_END) {
+			uv_ui_remote_asset_stats_st *st = &this->asset_stats;
+			st->last_kind = c->kind;
+			st->last_id = c->id;
+			st->last_bytes = c->total;
+			st->last_ms = (uv_rtos_get_tick_count() - c->start_tick) *
+					UV_RTOS_TICK_PERIOD_MS;
+			st->transfers++;
+			st->total_bytes += c->total;
+		}
+		else {
+		}
+		this->asset_tail = (uint8_t) (tail + 1u);
+	}
+	else {
+	}
+}
+
+
+void uv_ui_remote_get_asset_stats(uv_ui_remote_asset_stats_st *dest) {
+	*dest = this->asset_stats;
 }
 
 
 // --- encode hooks -----------------------------------------------------------
 
 void uv_ui_remote_encode_clear(color_t c) {
-	// WAIT is included on purpose. It means the transport has just finished and
-	// we are waiting for a clean boundary to start capturing again - and a
-	// clear IS that boundary, whatever the drawing was doing when the transport
-	// finished. Resuming here is what keeps an ordinary screen from being lost
-	// to that window at all; only a screen that never clears, which is what a
-	// dialog draws, still has to wait for the swap.
-	if (this->enabled &&
-			((this->state == REMOTE_UI_IDLE) ||
-			 (this->state == REMOTE_UI_GATHER) ||
-			 (this->state == REMOTE_UI_WAIT))) {
-		this->buf_len = 0;
-		this->overflow = false;
-		ap8((uint8_t) UV_UI_REMOTE_OP_FRAME_BEGIN);
-		ap32(c);
-		this->state = REMOTE_UI_GATHER;
+	// A clear is a frame boundary whatever the drawing was doing before, so a
+	// screen skipped for want of a buffer is resumed here, and a clear in the
+	// middle of a frame simply restarts it.
+	if (this->enabled) {
+		this->skip_to_boundary = false;
+		if (this->cur != NULL) {
+			this->cur->len = 0;
+			this->overflow = false;
+		}
+		else {
+			(void) frame_open();
+		}
+		if (this->cur != NULL) {
+			ap8((uint8_t) UV_UI_REMOTE_OP_FRAME_BEGIN);
+			ap32(c);
+		}
+		else {
+		}
 	}
 }
 
 
 void uv_ui_remote_encode_frame_end(void) {
 	if (this->enabled) {
-		if (this->state == REMOTE_UI_GATHER) {
+		remote_ui_frame_st *f = this->cur;
+		if (f != NULL) {
 			ap8((uint8_t) UV_UI_REMOTE_OP_FRAME_END);
+			this->cur = NULL;
 			if (this->overflow) {
-				// frame did not fit; drop it and realign at the next clear.
-				// The sink is now behind by a screen it will never be sent.
-				this->state = REMOTE_UI_IDLE;
+				// frame did not fit; drop it. The sink is now behind by a
+				// screen it will never be sent.
+				f->state = REMOTE_UI_FRAME_FREE;
 				this->missed = true;
 			}
 			else {
-				uint32_t hash = fnv1a(this->buf, this->buf_len);
+				uint32_t hash = uv_ui_remote_frame_hash(f->buf, f->len);
 				// this screen was captured, so nothing is owed for it - even
 				// when it turns out to be the one the sink already has
 				this->missed = false;
 				if (hash == this->last_hash) {
 					// unchanged screen, nothing to send
-					this->state = REMOTE_UI_IDLE;
+					f->state = REMOTE_UI_FRAME_FREE;
 				}
 				else {
 					this->last_hash = hash;
-					this->state = REMOTE_UI_TX;
+					frame_publish(f);
 				}
 			}
 		}
-		else if (this->state == REMOTE_UI_WAIT) {
-			// previous frame finished transmitting; this dlswap is the clean
-			// boundary at which we may resume capturing the next frame. The
-			// screen just drawn went past uncaptured.
-			this->state = REMOTE_UI_IDLE;
-			this->missed = true;
-		}
-		else if (this->state == REMOTE_UI_TX) {
-			// a whole screen drawn while the transport was still draining the
-			// last one: it could not be captured and is now owed
-			this->missed = true;
-		}
 		else {
-			// IDLE: a swap with nothing drawn, so nothing was missed
+			// a swap with nothing captured: either nothing was drawn, or the
+			// screen was skipped and *missed* already says so. Either way this
+			// is the boundary to resume at.
 		}
+		this->skip_to_boundary = false;
 
 		// A frame boundary is the one moment the UI task is not drawing, so it
-		// is where an asset chunk is read out of flash. One per frame keeps the
-		// reads off the critical path and off the transport task, which shares
-		// the bus with nobody's permission.
-		asset_prepare_chunk();
+		// is where asset chunks are read out of flash. Doing it here keeps the
+		// reads off the transport task, which shares the bus with nobody's
+		// permission, and the budgets keep them off the critical path.
+		asset_stage_chunks();
 	}
 }
 
@@ -822,11 +1332,12 @@ void uv_ui_remote_encode_bitmap(uv_uimedia_st *bitmap, int16_t x, int16_t y,
 		if ((this->pending_name == NULL) && (bitmap != NULL)) {
 			for (uint8_t i = 0; i < CONFIG_UI_REMOTE_ASSET_REQ_MAX; i++) {
 				if (this->wanted[i].pending &&
-						(this->wanted[i].kind ==
+						((this->wanted[i].kind & UV_UI_REMOTE_ASSET_KIND_MASK) ==
 								UV_UI_REMOTE_ASSET_KIND_BITMAP) &&
 						(this->wanted[i].id == id)) {
 					this->pending_name = bitmap->filename;
 					this->pending_id = id;
+					this->pending_kind = this->wanted[i].kind;
 					this->wanted[i].pending = false;
 				}
 				else {
@@ -0,0 +1,309 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_ui_remote.h"
+#include "uv_ui_remote_bytes.h"
+#include <string.h>
+
+
+/// @brief: Uses counted before the palette starts over, well short of where
+/// the stamps would wrap and stop telling old entries from new ones
+#define PALETTE_USES_MAX		0xF0000000u
+
+
+/// @brief: Offset of the color field of *op* in the ARGB8888 layout, or 0 for
+/// an op without one. In the other modes the field starts at the same offset,
+/// since every op has its color after its fixed size fields.
+static uint8_t color_off(uint8_t op) {
+	uint8_t ret = 0;
+	switch (op) {
+		case UV_UI_REMOTE_OP_FRAME_BEGIN:
+		case UV_UI_REMOTE_OP_POLYGON:
+			ret = 1;
+			break;
+		case UV_UI_REMOTE_OP_LINESTRIP:
+			ret = 4;
+			break;
+		case UV_UI_REMOTE_OP_POINT:
+			ret = 7;
+			break;
+		case UV_UI_REMOTE_OP_STRING:
+			ret = 8;
+			break;
+		case UV_UI_REMOTE_OP_RRECT:
+		case UV_UI_REMOTE_OP_LINE:
+			ret = 11;
+			break;
+		case UV_UI_REMOTE_OP_BITMAP:
+			ret = 17;
+			break;
+		default:
+			break;
+	}
+	return ret;
+}
+
+
+/// @brief: True when the color of *op* goes as it is in *mode*
+static bool color_whole(uv_ui_remote_color_mode_e mode, uint8_t op) {
+	return (mode == UV_UI_REMOTE_COLOR_ARGB8888) ||
+			((mode == UV_UI_REMOTE_COLOR_PALETTE) &&
+					(op == (uint8_t) UV_UI_REMOTE_OP_FRAME_BEGIN)) ||
+			(color_off(op) == 0);
+}
+
+
+/// @brief: Returns the palette index of *color*, writing a COLOR op for it
+/// first when it is new or has not been defined in this frame yet.
+///
+/// @param frame_start: the first use of the current frame. An entry used
+/// since then has already been defined in it.
+static uint8_t palette_index(uv_ui_remote_palette_st *pal, uint32_t color,
+		uint32_t frame_start, _uv_ui_remote_writer_st *w) {
+	uint16_t i = pal->count;
+	for (uint16_t j = 0; j < pal->count; j++) {
+		if (pal->color[j] == color) {
+			i = j;
+			break;
+		}
+		else {
+		}
+	}
+	if (i == UV_UI_REMOTE_PALETTE_SIZE) {
+		// full: give up the entry unused for longest, which is one this frame
+		// has not used unless it uses more colors than there are entries
+		i = 0;
+		for (uint16_t j = 1; j < UV_UI_REMOTE_PALETTE_SIZE; j++) {
+			if (pal->stamp[j] < pal->stamp[i]) {
+				i = j;
+			}
+			else {
+			}
+		}
+		pal->color[i] = color;
+		pal->stamp[i] = 0;
+	}
+	else if (i == pal->count) {
+		pal->color[i] = color;
+		pal->stamp[i] = 0;
+		pal->count++;
+	}
+	else {
+	}
+	if (pal->stamp[i] < frame_start) {
+		uint8_t op[UV_UI_REMOTE_COLOR_LEN];
+		op[0] = (uint8_t) UV_UI_REMOTE_OP_COLOR;
+		op[1] = (uint8_t) i;
+		_uv_ui_remote_put32(&op[2], color);
+		_uv_ui_remote_wr(w, op, sizeof(op));
+	}
+	else {
+	}
+	pal->uses++;
+	pal->stamp[i] = pal->uses;
+	return (uint8_t) i;
+}
+
+
+
+uint8_t uv_ui_remote_color_len(uv_ui_remote_color_mode_e mode) {
+	uint8_t ret = 4;
+	if (mode == UV_UI_REMOTE_COLOR_RGB565) {
+		ret = 2;
+	}
+	else if (mode == UV_UI_REMOTE_COLOR_PALETTE) {
+		ret = 1;
+	}
+	else {
+	}
+	return ret;
+}
+
+
+uint16_t uv_ui_remote_rgb565(uint32_t argb) {
+	return (uint16_t) (((argb >> 8) & 0xF800u) |
+			((argb >> 5) & 0x07E0u) |
+			((argb >> 3) & 0x001Fu));
+}
+
+
+uint32_t uv_ui_remote_rgb565_argb(uint16_t c) {
+	uint32_t r = (c >> 11) & 0x1Fu;
+	uint32_t g = (c >> 5) & 0x3Fu;
+	uint32_t b = c & 0x1Fu;
+	// the top bits repeated into the bottom ones, so that full scale stays
+	// full scale
+	r = (r << 3) | (r >> 2);
+	g = (g << 2) | (g >> 4);
+	b = (b << 3) | (b >> 2);
+	return 0xFF000000u | (r << 16) | (g << 8) | b;
+}
+
+
+void uv_ui_remote_palette_init(uv_ui_remote_palette_st *this) {
+	memset(this, 0, sizeof(*this));
+}
+
+
+uint16_t uv_ui_remote_color_convert(uv_ui_remote_palette_st *palette,
+		uv_ui_remote_color_mode_e mode, const uint8_t *frame, uint16_t len,
+		uint8_t *dest, uint16_t dest_len) {
+	_uv_ui_remote_writer_st w = {
+			.dest = dest,
+			.max = dest_len,
+			.len = 0,
+			.overflow = false
+	};
+	bool ok = true;
+	uint16_t off = 0;
+	uint32_t frame_start = 0;
+	if (mode == UV_UI_REMOTE_COLOR_PALETTE) {
+		if (palette->uses >= PALETTE_USES_MAX) {
+			uv_ui_remote_palette_init(palette);
+		}
+		else {
+		}
+		frame_start = palette->uses + 1u;
+	}
+	else {
+	}
+
+	while (ok && !w.overflow && (off < len)) {
+		uint16_t op_len = uv_ui_remote_op_len(UV_UI_REMOTE_COLOR_ARGB8888,
+				&frame[off], (uint16_t) (len - off));
+		uint8_t op = frame[off];
+		if ((op_len == 0) ||
+				(op == (uint8_t) UV_UI_REMOTE_OP_FRAME_DELTA) ||
+				(op == (uint8_t) UV_UI_REMOTE_OP_COPY) ||
+				(op == (uint8_t) UV_UI_REMOTE_OP_COLOR)) {
+			// only ever given frames as captured
+			ok = false;
+		}
+		else if (color_whole(mode, op)) {
+			_uv_ui_remote_wr(&w, &frame[off], op_len);
+		}
+		else {
+			uint8_t at = color_off(op);
+			uint32_t color = _uv_ui_remote_get32(&frame[off + at]);
+			uint8_t field[2];
+			uint8_t field_len = 1;
+			if (mode == UV_UI_REMOTE_COLOR_RGB565) {
+				uint16_t c = uv_ui_remote_rgb565(color);
+				field[0] = (uint8_t) (c & 0xFFu);
+				field[1] = (uint8_t) ((c >> 8) & 0xFFu);
+				field_len = 2;
+			}
+			else {
+				// before the op, so that the op can use it
+				field[0] = palette_index(palette, color, frame_start, &w);
+			}
+			_uv_ui_remote_wr(&w, &frame[off], at);
+			_uv_ui_remote_wr(&w, field, field_len);
+			_uv_ui_remote_wr(&w, &frame[off + at + 4], (uint16_t) (op_len - at - 4));
+		}
+		off = (uint16_t) (off + op_len);
+	}
+	return (ok && !w.overflow) ? w.len : 0;
+}
+
+
+uint16_t uv_ui_remote_color_size(uv_ui_remote_color_mode_e mode,
+		const uint8_t *frame, uint16_t len) {
+	uint32_t ret = 0;
+	bool ok = true;
+	uint16_t off = 0;
+	uint8_t narrower = 4 - uv_ui_remote_color_len(mode);
+	while (ok && (off < len)) {
+		uint16_t op_len = uv_ui_remote_op_len(UV_UI_REMOTE_COLOR_ARGB8888,
+				&frame[off], (uint16_t) (len - off));
+		if (op_len == 0) {
+			ok = false;
+		}
+		else {
+			ret += color_whole(mode, frame[off]) ? op_len : (uint32_t) (op_len - narrower);
+			off = (uint16_t) (off + op_len);
+		}
+	}
+	return ok ? (uint16_t) ret : 0;
+}
+
+
+uint16_t uv_ui_remote_color_restore(uv_ui_remote_palette_st *palette,
+		uv_ui_remote_color_mode_e mode, const uint8_t *frame, uint16_t len,
+		uint8_t *dest, uint16_t dest_len) {
+	_uv_ui_remote_writer_st w = {
+			.dest = dest,
+			.max = dest_len,
+			.len = 0,
+			.overflow = false
+	};
+	bool ok = true;
+	uint16_t off = 0;
+	uint8_t cs = uv_ui_remote_color_len(mode);
+	if (mode == UV_UI_REMOTE_COLOR_PALETTE) {
+		// an index the frame never defined draws black rather than whatever
+		// the last frame left there
+		memset(palette->color, 0, sizeof(palette->color));
+	}
+	else {
+	}
+
+	while (ok && !w.overflow && (off < len)) {
+		uint16_t op_len = uv_ui_remote_op_len(mode, &frame[off], (uint16_t) (len - off));
+		uint8_t op = frame[off];
+		if ((op_len == 0) ||
+				(op == (uint8_t) UV_UI_REMOTE_OP_FRAME_DELTA) ||
+				(op == (uint8_t) UV_UI_REMOTE_OP_COPY)) {
+			ok = false;
+		}
+		else if (op == (uint8_t) UV_UI_REMOTE_OP_COLOR) {
+			palette->color[frame[off + 1]] = _uv_ui_remote_get32(&frame[off + 2]);
+		}
+		else if (color_whole(mode, op)) {
+			_uv_ui_remote_wr(&w, &frame[off], op_len);
+		}
+		else {
+			uint8_t at = color_off(op);
+			uint32_t color;
+			uint8_t field[4];
+			if (mode == UV_UI_REMOTE_COLOR_RGB565) {
+				color = uv_ui_remote_rgb565_argb(
+						(uint16_t) (frame[off + at] | (frame[off + at + 1] << 8)));
+			}
+			else {
+				color = palette->color[frame[off + at]];
+			}
+			_uv_ui_remote_put32(field, color);
+			_uv_ui_remote_wr(&w, &frame[off], at);
+			_uv_ui_remote_wr(&w, field, sizeof(field));
+			_uv_ui_remote_wr(&w, &frame[off + at + cs], (uint16_t) (op_len - at - cs));
+		}
+		off = (uint16_t) (off + op_len);
+	}
+	return (ok && !w.overflow) ? w.len : 0;
+}
@@ -0,0 +1,323 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_ui_remote.h"
+#include "uv_ui_remote_bytes.h"
+#include <string.h>
+
+
+// The delta coder is plain byte work with no UI types in it, so it is built
+// whatever the configuration: a sink needs uv_ui_remote_delta_apply() without
+// compiling the encoder, and the encoder needs the rest.
+
+
+static void wr_copy(_uv_ui_remote_writer_st *w, uint16_t first, uint16_t count) {
+	uint8_t op[UV_UI_REMOTE_COPY_LEN] = {
+			(uint8_t) UV_UI_REMOTE_OP_COPY,
+			(uint8_t) (first & 0xFFu),
+			(uint8_t) ((first >> 8) & 0xFFu),
+			(uint8_t) (count & 0xFFu),
+			(uint8_t) ((count >> 8) & 0xFFu)
+	};
+	_uv_ui_remote_wr(w, op, sizeof(op));
+}
+
+
+static uint16_t idx_op_len(const uv_ui_remote_frame_index_st *idx, uint16_t i) {
+	return (uint16_t) (idx->off[i + 1] - idx->off[i]);
+}
+
+
+/// @brief: True when op *i* of *frame* is byte for byte op *j* of *base*.
+/// The hashes rule out nearly every mismatch before the bytes are looked at.
+static bool op_equal(const uint8_t *base, const uv_ui_remote_frame_index_st *base_idx,
+		uint16_t j, const uint8_t *frame, const uv_ui_remote_frame_index_st *frame_idx,
+		uint16_t i) {
+	uint16_t len = idx_op_len(frame_idx, i);
+	return (base_idx->hash[j] == frame_idx->hash[i]) &&
+			(idx_op_len(base_idx, j) == len) &&
+			(memcmp(&base[base_idx->off[j]], &frame[frame_idx->off[i]], len) == 0);
+}
+
+
+
+uint32_t uv_ui_remote_frame_hash(const uint8_t *data, uint16_t len) {
+	uint32_t h = 2166136261u;
+	for (uint16_t i = 0; i < len; i++) {
+		h ^= data[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+
+uint16_t uv_ui_remote_op_len(uv_ui_remote_color_mode_e mode,
+		const uint8_t *data, uint16_t len) {
+	uint32_t ret = 0;
+	// the layouts in uv_ui_remote.h are for 4-byte colors
+	uint32_t cs = uv_ui_remote_color_len(mode);
+	if (len > 0) {
+		switch (data[0]) {
+			case UV_UI_REMOTE_OP_FRAME_BEGIN:
+				ret = (mode == UV_UI_REMOTE_COLOR_RGB565) ? 3 : 5;
+				break;
+			case UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP:
+			case UV_UI_REMOTE_OP_FRAME_END:
+				ret = 1;
+				break;
+			case UV_UI_REMOTE_OP_BITMAP:
+				ret = 17u + cs;
+				break;
+			case UV_UI_REMOTE_OP_POINT:
+				ret = 7u + cs;
+				break;
+			case UV_UI_REMOTE_OP_RRECT:
+			case UV_UI_REMOTE_OP_LINE:
+				ret = 11u + cs;
+				break;
+			case UV_UI_REMOTE_OP_LINESTRIP:
+				ret = (len >= (6u + cs)) ?
+						(6u + cs + 4u * _uv_ui_remote_get16(&data[4u + cs])) : 0;
+				break;
+			case UV_UI_REMOTE_OP_POLYGON:
+				ret = (len >= (3u + cs)) ?
+						(3u + cs + 4u * _uv_ui_remote_get16(&data[1u + cs])) : 0;
+				break;
+			case UV_UI_REMOTE_OP_STRING:
+				ret = (len >= (10u + cs)) ?
+						(10u + cs + _uv_ui_remote_get16(&data[8u + cs])) : 0;
+				break;
+			case UV_UI_REMOTE_OP_COLOR:
+				ret = UV_UI_REMOTE_COLOR_LEN;
+				break;
+			case UV_UI_REMOTE_OP_MASK:
+				ret = 9;
+				break;
+			case UV_UI_REMOTE_OP_FRAME_DELTA:
+				ret = UV_UI_REMOTE_FRAME_DELTA_LEN;
+				break;
+			case UV_UI_REMOTE_OP_COPY:
+				ret = UV_UI_REMOTE_COPY_LEN;
+				break;
+			default:
+				break;
+		}
+		if (ret > len) {
+			ret = 0;
+		}
+		else {
+		}
+	}
+	else {
+	}
+	return (uint16_t) ret;
+}
+
+
+bool uv_ui_remote_frame_index(uv_ui_remote_frame_index_st *idx,
+		uv_ui_remote_color_mode_e mode, const uint8_t *frame, uint16_t len) {
+	bool ret = true;
+	uint16_t off = 0;
+	idx->count = 0;
+	while (ret && (off < len)) {
+		uint16_t op_len = uv_ui_remote_op_len(mode, &frame[off], (uint16_t) (len - off));
+		if ((op_len == 0) || (idx->count >= CONFIG_UI_REMOTE_DELTA_OPS_MAX)) {
+			ret = false;
+		}
+		else {
+			idx->off[idx->count] = off;
+			idx->hash[idx->count] = uv_ui_remote_frame_hash(&frame[off], op_len);
+			idx->count++;
+			off = (uint16_t) (off + op_len);
+		}
+	}
+	idx->off[idx->count] = off;
+	return ret;
+}
+
+
+uint16_t uv_ui_remote_delta_encode(
+		const uint8_t *base, const uv_ui_remote_frame_index_st *base_idx,
+		const uint8_t *frame, const uv_ui_remote_frame_index_st *frame_idx,
+		uint8_t *dest, uint16_t dest_len) {
+	uint16_t frame_len = frame_idx->off[frame_idx->count];
+	_uv_ui_remote_writer_st w = {
+			.dest = dest,
+			// anything as long as the frame itself is no use
+			.max = (frame_len > 0) ? (uint16_t) (frame_len - 1) : 0,
+			.len = 0,
+			.overflow = false
+	};
+	if (w.max > dest_len) {
+		w.max = dest_len;
+	}
+	else {
+	}
+
+	uint8_t hdr[UV_UI_REMOTE_FRAME_DELTA_LEN];
+	hdr[0] = (uint8_t) UV_UI_REMOTE_OP_FRAME_DELTA;
+	_uv_ui_remote_put32(&hdr[1], uv_ui_remote_frame_hash(base, base_idx->off[base_idx->count]));
+	_uv_ui_remote_put32(&hdr[5], uv_ui_remote_frame_hash(frame, frame_len));
+	_uv_ui_remote_wr(&w, hdr, sizeof(hdr));
+
+	// The base op the next frame op is expected to match. Screens are drawn in
+	// the same order every time, so this is nearly always right, and the scan
+	// of the whole base is only for ops that moved.
+	uint16_t expect = 0;
+	uint16_t i = 0;
+	while ((i < frame_idx->count) && !w.overflow) {
+		uint16_t j = base_idx->count;
+		if (frame[frame_idx->off[i]] == (uint8_t) UV_UI_REMOTE_OP_FRAME_END) {
+			// never copied, so that a delta always ends with a literal one
+		}
+		else if ((expect < base_idx->count) &&
+				op_equal(base, base_idx, expect, frame, frame_idx, i)) {
+			j = expect;
+		}
+		else {
+			for (uint16_t k = 0; k < base_idx->count; k++) {
+				if (op_equal(base, base_idx, k, frame, frame_idx, i)) {
+					j = k;
+					break;
+				}
+				else {
+				}
+			}
+		}
+
+		if (j < base_idx->count) {
+			uint16_t run = 1;
+			while (((i + run) < frame_idx->count) &&
+					((j + run) < base_idx->count) &&
+					(frame[frame_idx->off[i + run]] !=
+							(uint8_t) UV_UI_REMOTE_OP_FRAME_END) &&
+					op_equal(base, base_idx, (uint16_t) (j + run),
+							frame, frame_idx, (uint16_t) (i + run))) {
+				run++;
+			}
+			uint16_t bytes = (uint16_t) (frame_idx->off[i + run] - frame_idx->off[i]);
+			if (bytes > UV_UI_REMOTE_COPY_LEN) {
+				wr_copy(&w, j, run);
+			}
+			else {
+				// a COPY would be longer than the ops it replaces
+				_uv_ui_remote_wr(&w, &frame[frame_idx->off[i]], bytes);
+			}
+			i = (uint16_t) (i + run);
+			expect = (uint16_t) (j + run);
+		}
+		else {
+			// a new or changed op goes as it is. The base op in its place was
+			// most likely the one it replaces, so the next op is expected to
+			// match the one after that.
+			_uv_ui_remote_wr(&w, &frame[frame_idx->off[i]], idx_op_len(frame_idx, i));
+			i++;
+			expect++;
+		}
+	}
+	return w.overflow ? 0 : w.len;
+}
+
+
+uint16_t uv_ui_remote_delta_apply(uv_ui_remote_color_mode_e mode,
+		const uint8_t *base, uint16_t base_len,
+		const uint8_t *delta, uint16_t delta_len,
+		uint8_t *dest, uint16_t dest_len) {
+	_uv_ui_remote_writer_st w = {
+			.dest = dest,
+			.max = dest_len,
+			.len = 0,
+			.overflow = false
+	};
+	bool ok = (delta_len >= UV_UI_REMOTE_FRAME_DELTA_LEN) &&
+			(delta[0] == (uint8_t) UV_UI_REMOTE_OP_FRAME_DELTA) &&
+			(_uv_ui_remote_get32(&delta[1]) == uv_ui_remote_frame_hash(base, base_len));
+	bool ended = false;
+	uint16_t off = UV_UI_REMOTE_FRAME_DELTA_LEN;
+	// where the last COPY left off in the base, since the next one nearly
+	// always carries on from there
+	uint16_t base_op = 0;
+	uint16_t base_off = 0;
+
+	while (ok && !ended && (off < delta_len)) {
+		uint16_t op_len = uv_ui_remote_op_len(mode, &delta[off],
+				(uint16_t) (delta_len - off));
+		uint8_t op = delta[off];
+		if ((op_len == 0) || (op == (uint8_t) UV_UI_REMOTE_OP_FRAME_DELTA)) {
+			ok = false;
+		}
+		else if (op == (uint8_t) UV_UI_REMOTE_OP_COPY) {
+			uint16_t first = _uv_ui_remote_get16(&delta[off + 1]);
+			uint16_t count = _uv_ui_remote_get16(&delta[off + 3]);
+			if (count == 0) {
+				ok = false;
+			}
+			else if (first < base_op) {
+				base_op = 0;
+				base_off = 0;
+			}
+			else {
+			}
+			uint16_t from = 0;
+			for (uint32_t k = base_op; ok && (k < (uint32_t) first + count); k++) {
+				uint16_t len = uv_ui_remote_op_len(mode, &base[base_off],
+						(uint16_t) (base_len - base_off));
+				if (len == 0) {
+					ok = false;
+				}
+				else {
+					if (k == first) {
+						from = base_off;
+					}
+					else {
+					}
+					base_off = (uint16_t) (base_off + len);
+				}
+			}
+			if (ok) {
+				base_op = (uint16_t) (first + count);
+				_uv_ui_remote_wr(&w, &base[from], (uint16_t) (base_off - from));
+			}
+			else {
+			}
+		}
+		else {
+			_uv_ui_remote_wr(&w, &delta[off], op_len);
+			ended = (op == (uint8_t) UV_UI_REMOTE_OP_FRAME_END);
+		}
+		off = (uint16_t) (off + op_len);
+	}
+
+	if (!ok || !ended || w.overflow ||
+			(uv_ui_remote_frame_hash(dest, w.len) != _uv_ui_remote_get32(&delta[5]))) {
+		w.len = 0;
+	}
+	else {
+	}
+	return w.len;
+}
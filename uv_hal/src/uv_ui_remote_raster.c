@@ -0,0 +1,700 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_ui_remote.h"
+#include "uv_ui_remote_bytes.h"
+#include "uv_utilities.h"
+#include <string.h>
+
+
+// Shapes are placed in sixteenths of a pixel, as on the FT81X, so that the
+// edges of a line at an angle land where they should. A pixel is covered
+// when its center is.
+#define SUB				16
+#define HALF			(SUB / 2)
+
+/// @brief: Edge crossings kept per row of a polygon. The polygons the UI
+/// draws cross a row a handful of times.
+#define CROSSINGS_MAX	64
+
+// the STRING op's alignment bits, as ui_align_e has them
+#define ALIGN_HCENTER	0x200
+#define ALIGN_VCENTER	0x400
+#define ALIGN_RIGHT		0x800
+
+// the BITMAP op's wrap, as uiimage_wrap_e has it
+#define WRAP_REPEAT		1
+
+// the LINESTRIP op's strip type, as uv_ui_strip_type_e has it
+#define STRIP_LINE		0
+#define STRIP_RIGHT		1
+#define STRIP_LEFT		2
+#define STRIP_ABOVE		3
+#define STRIP_BELOW		4
+
+// the glyph slots of the nordic letters in a font atlas, as
+// uv_ui_codepoint_glyph() has them
+static const struct {
+	uint16_t codepoint;
+	uint8_t glyph;
+} nordic[] = {
+		{ 0x00E4u, 0x01 },
+		{ 0x00F6u, 0x02 },
+		{ 0x00E5u, 0x03 },
+		{ 0x00C4u, 0x04 },
+		{ 0x00D6u, 0x05 },
+		{ 0x00C5u, 0x06 }
+};
+
+
+/// @brief: Vertices of a polygon: the (x:2,y:2) pairs of an op, in pixels,
+/// followed by up to four more in sixteenths
+typedef struct {
+	const uint8_t *pts;
+	uint16_t n;
+	int32_t extra[4][2];
+	uint8_t extra_n;
+} poly_st;
+
+
+static int32_t get16s(const uint8_t *src) {
+	return (int16_t) _uv_ui_remote_get16(src);
+}
+
+
+/// @brief: a / b rounded up, for a b > 0 and an a of either sign
+static int32_t ceil_div(int32_t a, int32_t b) {
+	return (a >= 0) ? ((a + b - 1) / b) : -((-a) / b);
+}
+
+
+/// @brief: The first pixel whose center is at or past *e* sixteenths
+static int32_t px_from(int32_t e) {
+	return ceil_div(e - HALF, SUB);
+}
+
+
+static uint32_t color_at(const uv_ui_remote_raster_st *this,
+		uv_ui_remote_color_mode_e mode, const uint8_t *p) {
+	uint32_t ret;
+	if (mode == UV_UI_REMOTE_COLOR_RGB565) {
+		ret = uv_ui_remote_rgb565_argb(_uv_ui_remote_get16(p));
+	}
+	else if (mode == UV_UI_REMOTE_COLOR_PALETTE) {
+		ret = this->palette[p[0]];
+	}
+	else {
+		ret = _uv_ui_remote_get32(p);
+	}
+	return ret;
+}
+
+
+/// @brief: *s* over *d* with coverage *a*. The channels are done two at a
+/// time, and the division by 255 is the exact one for these ranges.
+static inline uint32_t blend(uint32_t d, uint32_t s, uint32_t a) {
+	uint32_t inv = 255u - a;
+	// with the source alpha taken as full, the result's alpha comes out as
+	// a + da * (1 - a)
+	s |= 0xFF000000u;
+	uint32_t rb = (s & 0x00FF00FFu) * a + (d & 0x00FF00FFu) * inv + 0x00800080u;
+	uint32_t ag = ((s >> 8) & 0x00FF00FFu) * a + ((d >> 8) & 0x00FF00FFu) * inv +
+			0x00800080u;
+	rb = ((rb + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+	ag = (ag + ((ag >> 8) & 0x00FF00FFu)) & 0xFF00FF00u;
+	return rb | ag;
+}
+
+
+// The row loops. The work is done in blocks of ROW_BLOCK pixels, a trip count
+// the compiler knows, so that it turns them into vector code at -O2 as well as
+// at -O3; what is left over at the end of the row is done one at a time.
+#define ROW_BLOCK		8
+
+static void fill_row(uint32_t *restrict row, int32_t n, uint32_t color) {
+	int32_t i = 0;
+	for (; (i + ROW_BLOCK) <= n; i += ROW_BLOCK) {
+		for (int32_t k = 0; k < ROW_BLOCK; k++) {
+			row[i + k] = color;
+		}
+	}
+	for (; i < n; i++) {
+		row[i] = color;
+	}
+}
+
+
+static void blend_row(uint32_t *restrict row, int32_t n, uint32_t color) {
+	uint32_t a = color >> 24;
+	int32_t i = 0;
+	for (; (i + ROW_BLOCK) <= n; i += ROW_BLOCK) {
+		for (int32_t k = 0; k < ROW_BLOCK; k++) {
+			row[i + k] = blend(row[i + k], color, a);
+		}
+	}
+	for (; i < n; i++) {
+		row[i] = blend(row[i], color, a);
+	}
+}
+
+
+/// @brief: Fills pixels x0 <= x < x1 of row *y*, inside the mask
+static void span(uv_ui_remote_raster_st *this, int32_t y, int32_t x0, int32_t x1,
+		uint32_t color) {
+	if (x0 < this->clip_x0) {
+		x0 = this->clip_x0;
+	}
+	else {
+	}
+	if (x1 > this->clip_x1) {
+		x1 = this->clip_x1;
+	}
+	else {
+	}
+	if ((y >= this->clip_y0) && (y < this->clip_y1) && (x0 < x1)) {
+		uint32_t *row = &this->fb[(uint32_t) y * this->stride + (uint32_t) x0];
+		if ((color >> 24) == 0xFFu) {
+			fill_row(row, x1 - x0, color);
+		}
+		else if ((color >> 24) != 0u) {
+			blend_row(row, x1 - x0, color);
+		}
+		else {
+		}
+	}
+	else {
+	}
+}
+
+
+/// @brief: Rows of the clip that a shape from *y0* to *y1* sixteenths covers
+static void rows(const uv_ui_remote_raster_st *this, int32_t y0, int32_t y1,
+		int32_t *first, int32_t *end) {
+	*first = px_from(y0);
+	*end = px_from(y1);
+	if (*first < this->clip_y0) {
+		*first = this->clip_y0;
+	}
+	else {
+	}
+	if (*end > this->clip_y1) {
+		*end = this->clip_y1;
+	}
+	else {
+	}
+}
+
+
+/// @brief: A rectangle with round corners, all in sixteenths. Points and the
+/// ends of lines are ones with the radius half their size.
+static void rrect(uv_ui_remote_raster_st *this, int32_t x, int32_t y,
+		int32_t w, int32_t h, int32_t r, uint32_t color) {
+	if ((w > 0) && (h > 0)) {
+		int32_t first, end;
+		r = MIN(r, MIN(w / 2, h / 2));
+		rows(this, y, y + h, &first, &end);
+		for (int32_t py = first; py < end; py++) {
+			// each row is a row of a circle of radius r, stretched across the
+			// middle of the rectangle
+			int32_t ys = py * SUB + HALF;
+			int32_t cy = (ys < (y + r)) ? (y + r) :
+					((ys > (y + h - r)) ? (y + h - r) : ys);
+			int64_t dy = ys - cy;
+			int32_t hw = (int32_t) uv_isqrt((uint64_t) ((int64_t) r * r - dy * dy));
+			span(this, py, px_from(x + r - hw), px_from(x + w - r + hw), color);
+		}
+	}
+	else {
+	}
+}
+
+
+static void poly_vertex(const poly_st *p, uint32_t i, int32_t *x, int32_t *y) {
+	if (i < p->n) {
+		*x = get16s(&p->pts[4u * i]) * SUB;
+		*y = get16s(&p->pts[4u * i + 2u]) * SUB;
+	}
+	else {
+		*x = p->extra[i - p->n][0];
+		*y = p->extra[i - p->n][1];
+	}
+}
+
+
+/// @brief: Fills a closed polygon by the even-odd rule
+static void poly_fill(uv_ui_remote_raster_st *this, const poly_st *p, uint32_t color) {
+	uint32_t count = (uint32_t) p->n + p->extra_n;
+	if (count >= 3u) {
+		int32_t x, y;
+		int32_t miny, maxy;
+		poly_vertex(p, 0, &x, &miny);
+		maxy = miny;
+		for (uint32_t i = 1; i < count; i++) {
+			poly_vertex(p, i, &x, &y);
+			miny = MIN(miny, y);
+			maxy = MAX(maxy, y);
+		}
+		int32_t first, end;
+		rows(this, miny, maxy, &first, &end);
+		for (int32_t py = first; py < end; py++) {
+			int32_t ys = py * SUB + HALF;
+			int32_t xs[CROSSINGS_MAX];
+			uint8_t n = 0;
+			int32_t xa, ya, xb, yb;
+			poly_vertex(p, count - 1u, &xa, &ya);
+			for (uint32_t i = 0; i < count; i++) {
+				poly_vertex(p, i, &xb, &yb);
+				if (((ya <= ys) != (yb <= ys)) && (n < CROSSINGS_MAX)) {
+					int32_t xc = xa + (int32_t) ((int64_t) (ys - ya) * (xb - xa) / (yb - ya));
+					// kept in order as they come, there are only a few
+					uint8_t k = n;
+					while ((k > 0) && (xs[k - 1] > xc)) {
+						xs[k] = xs[k - 1];
+						k--;
+					}
+					xs[k] = xc;
+					n++;
+				}
+				else {
+				}
+				xa = xb;
+				ya = yb;
+			}
+			for (uint8_t k = 0; (k + 1) < n; k += 2) {
+				span(this, py, px_from(xs[k]), px_from(xs[k + 1]), color);
+			}
+		}
+	}
+	else {
+	}
+}
+
+
+/// @brief: A line *w* sixteenths wide with round ends, ends in sixteenths
+static void line(uv_ui_remote_raster_st *this, int32_t x0, int32_t y0,
+		int32_t x1, int32_t y1, int32_t w, uint32_t color) {
+	int32_t hw = w / 2;
+	int64_t dx = x1 - x0;
+	int64_t dy = y1 - y0;
+	int32_t len = (int32_t) uv_isqrt((uint64_t) (dx * dx + dy * dy));
+	if (len > 0) {
+		int32_t nx = (int32_t) (-dy * hw / len);
+		int32_t ny = (int32_t) (dx * hw / len);
+		poly_st p = {
+				.pts = NULL,
+				.n = 0,
+				.extra = {
+						{ x0 + nx, y0 + ny },
+						{ x1 + nx, y1 + ny },
+						{ x1 - nx, y1 - ny },
+						{ x0 - nx, y0 - ny }
+				},
+				.extra_n = 4
+		};
+		poly_fill(this, &p, color);
+	}
+	else {
+	}
+	rrect(this, x0 - hw, y0 - hw, 2 * hw, 2 * hw, hw, color);
+	rrect(this, x1 - hw, y1 - hw, 2 * hw, 2 * hw, hw, color);
+}
+
+
+static void linestrip(uv_ui_remote_raster_st *this, uint8_t type, uint16_t width,
+		uint32_t color, const uint8_t *pts, uint16_t count) {
+	int32_t w = MAX(width, 1) * SUB;
+	if ((type != STRIP_LINE) && (count > 0)) {
+		// the area between the strip and an edge of the screen: the strip,
+		// closed by its ends carried over to the edge
+		poly_st p = {
+				.pts = pts,
+				.n = count,
+				.extra_n = 2
+		};
+		int32_t x, y;
+		poly_vertex(&p, count - 1u, &p.extra[0][0], &p.extra[0][1]);
+		poly_vertex(&p, 0, &p.extra[1][0], &p.extra[1][1]);
+		for (uint8_t i = 0; i < 2; i++) {
+			x = p.extra[i][0];
+			y = p.extra[i][1];
+			if (type == STRIP_ABOVE) {
+				y = 0;
+			}
+			else if (type == STRIP_BELOW) {
+				y = this->height * SUB;
+			}
+			else if (type == STRIP_LEFT) {
+				x = 0;
+			}
+			else {
+				x = this->width * SUB;
+			}
+			p.extra[i][0] = x;
+			p.extra[i][1] = y;
+		}
+		poly_fill(this, &p, color);
+	}
+	else {
+	}
+	for (uint16_t i = 1; i < count; i++) {
+		line(this,
+				get16s(&pts[4u * (i - 1u)]) * SUB, get16s(&pts[4u * (i - 1u) + 2u]) * SUB,
+				get16s(&pts[4u * i]) * SUB, get16s(&pts[4u * i + 2u]) * SUB,
+				w, color);
+	}
+}
+
+
+static void bitmap(uv_ui_remote_raster_st *this, uint32_t id, int32_t x, int32_t y,
+		int32_t w, int32_t h, uint32_t wrap, uint32_t color) {
+	uv_ui_remote_image_st img;
+	if ((this->image_callb != NULL) &&
+			this->image_callb(this->user, id, &img) &&
+			(img.pixels != NULL) && (img.width > 0) && (img.height > 0)) {
+		if (wrap != WRAP_REPEAT) {
+			w = MIN(w, img.width);
+			h = MIN(h, img.height);
+		}
+		else {
+		}
+		int32_t y0 = MAX(y, this->clip_y0);
+		int32_t y1 = MIN(y + h, this->clip_y1);
+		int32_t x0 = MAX(x, this->clip_x0);
+		int32_t x1 = MIN(x + w, this->clip_x1);
+		// the color multiplies the bitmap; white leaves it as it is
+		bool tint = (color != 0xFFFFFFFFu);
+		for (int32_t py = y0; py < y1; py++) {
+			const uint32_t *src = &img.pixels[(uint32_t) ((py - y) % img.height) * img.width];
+			uint32_t *row = &this->fb[(uint32_t) py * this->stride];
+			for (int32_t px = x0; px < x1; px++) {
+				uint32_t s = src[(px - x) % img.width];
+				if (tint) {
+					uint32_t t = 0;
+					for (uint8_t sh = 0; sh < 32; sh += 8) {
+						t |= ((((s >> sh) & 0xFFu) * ((color >> sh) & 0xFFu) + 127u) / 255u) << sh;
+					}
+					s = t;
+				}
+				else {
+				}
+				uint32_t a = s >> 24;
+				if (a == 0xFFu) {
+					row[px] = s;
+				}
+				else if (a != 0u) {
+					row[px] = blend(row[px], s, a);
+				}
+				else {
+				}
+			}
+		}
+	}
+	else {
+		// the sink does not have it yet
+	}
+}
+
+
+/// @brief: The atlas slot of the next character of *str*, UTF-8 decoded
+/// within *len* bytes
+static uint8_t next_glyph(const uint8_t *str, uint16_t len, uint16_t *i) {
+	uint8_t c = str[*i];
+	uint32_t cp = '?';
+	uint8_t n = 1;
+	if (c < 0x80u) {
+		cp = c;
+	}
+	else if ((c & 0xE0u) == 0xC0u) {
+		n = 2;
+	}
+	else if ((c & 0xF0u) == 0xE0u) {
+		n = 3;
+	}
+	else if ((c & 0xF8u) == 0xF0u) {
+		n = 4;
+	}
+	else {
+	}
+	if (n > 1) {
+		if ((uint32_t) *i + n <= len) {
+			cp = c & (0x7Fu >> n);
+			for (uint8_t k = 1; k < n; k++) {
+				if ((str[*i + k] & 0xC0u) == 0x80u) {
+					cp = (cp << 6) | (str[*i + k] & 0x3Fu);
+				}
+				else {
+					// broken sequence: one byte at a time
+					cp = '?';
+					n = 1;
+					break;
+				}
+			}
+		}
+		else {
+			n = 1;
+		}
+	}
+	else {
+	}
+	*i = (uint16_t) (*i + n);
+
+	uint8_t ret = (cp < 0x80u) ? (uint8_t) cp : (uint8_t) '?';
+	for (uint8_t k = 0; k < (sizeof(nordic) / sizeof(nordic[0])); k++) {
+		if (nordic[k].codepoint == cp) {
+			ret = nordic[k].glyph;
+		}
+		else {
+		}
+	}
+	return ret;
+}
+
+
+static void glyph(uv_ui_remote_raster_st *this, const uint8_t *cell, uint16_t stride,
+		int32_t cell_w, int32_t cell_h, int32_t x, int32_t y, uint32_t color) {
+	uint32_t ca = color >> 24;
+	int32_t y0 = MAX(y, this->clip_y0);
+	int32_t y1 = MIN(y + cell_h, this->clip_y1);
+	int32_t x0 = MAX(x, this->clip_x0);
+	int32_t x1 = MIN(x + cell_w, this->clip_x1);
+	for (int32_t py = y0; py < y1; py++) {
+		const uint8_t *src = &cell[(uint32_t) (py - y) * stride];
+		uint32_t *row = &this->fb[(uint32_t) py * this->stride];
+		for (int32_t px = x0; px < x1; px++) {
+			int32_t k = px - x;
+			// 4 bits a pixel, the left one in the high nibble
+			uint32_t v = (src[k / 2] >> ((k & 1) ? 0 : 4)) & 0x0Fu;
+			if (v != 0u) {
+				row[px] = blend(row[px], color, (v * 17u * ca + 127u) / 255u);
+			}
+			else {
+			}
+		}
+	}
+}
+
+
+static void string(uv_ui_remote_raster_st *this, uint8_t font_id, int32_t x, int32_t y,
+		uint16_t align, uint32_t color, const uint8_t *str, uint16_t len) {
+	uint32_t body_len = 0;
+	const uint8_t *body = (this->font_callb != NULL) ?
+			this->font_callb(this->user, font_id, &body_len) : NULL;
+	if ((body != NULL) && (body_len >= UV_UI_REMOTE_FONT_BODY_HDR_LEN) &&
+			(body[2] & UV_UI_REMOTE_FONT_FLAG_GLYPHS)) {
+		int32_t height = _uv_ui_remote_get16(&body[0]);
+		uint16_t stride = _uv_ui_remote_get16(&body[3]);
+		int32_t cell_w = MIN(_uv_ui_remote_get16(&body[5]), stride * 2);
+		const uint8_t *widths = &body[7];
+		const uint8_t *atlas = &body[UV_UI_REMOTE_FONT_BODY_HDR_LEN];
+		uint32_t cell_len = (uint32_t) stride * (uint32_t) height;
+		if (body_len >= (UV_UI_REMOTE_FONT_BODY_HDR_LEN +
+				cell_len * UV_UI_REMOTE_FONT_WIDTHS)) {
+			if (align & ALIGN_VCENTER) {
+				int32_t lines = 1;
+				for (uint16_t i = 0; i < len; i++) {
+					lines += (str[i] == '\n') ? 1 : 0;
+				}
+				y -= lines * height / 2;
+			}
+			else {
+			}
+			uint16_t i = 0;
+			while (i < len) {
+				uint16_t end = i;
+				while ((end < len) && (str[end] != '\n')) {
+					end++;
+				}
+				int32_t lx = x;
+				if (align & (ALIGN_HCENTER | ALIGN_RIGHT)) {
+					int32_t w = 0;
+					for (uint16_t k = i; k < end; ) {
+						w += widths[next_glyph(str, end, &k) & 0x7Fu];
+					}
+					lx -= (align & ALIGN_RIGHT) ? w : (w / 2);
+				}
+				else {
+				}
+				while (i < end) {
+					uint8_t g = next_glyph(str, end, &i) & 0x7Fu;
+					glyph(this, &atlas[g * cell_len], stride, cell_w, height, lx, y, color);
+					lx += widths[g];
+				}
+				y += height;
+				// past the newline
+				i = (uint16_t) (end + 1u);
+			}
+		}
+		else {
+		}
+	}
+	else {
+		// no font, or one of metrics only: the sink has to draw these itself
+	}
+}
+
+
+static void clip_reset(uv_ui_remote_raster_st *this) {
+	this->clip_x0 = 0;
+	this->clip_y0 = 0;
+	this->clip_x1 = (int16_t) this->width;
+	this->clip_y1 = (int16_t) this->height;
+}
+
+
+
+void uv_ui_remote_raster_init(uv_ui_remote_raster_st *this, uint32_t *fb,
+		uint16_t width, uint16_t height, uint16_t stride) {
+	memset(this, 0, sizeof(*this));
+	this->fb = fb;
+	// kept within int16 so that the clip fits one
+	this->width = MIN(width, INT16_MAX);
+	this->height = MIN(height, INT16_MAX);
+	this->stride = stride;
+	clip_reset(this);
+}
+
+
+void uv_ui_remote_raster_set_assets(uv_ui_remote_raster_st *this,
+		uv_ui_remote_font_get_t font_callb, uv_ui_remote_image_get_t image_callb,
+		void *user) {
+	this->font_callb = font_callb;
+	this->image_callb = image_callb;
+	this->user = user;
+}
+
+
+/// @brief: Draws the commands of *frame* up to the end of the frame, if it
+/// ends within them, and tells in *ended_out* whether it did
+static bool draw_ops(uv_ui_remote_raster_st *this, uv_ui_remote_color_mode_e mode,
+		const uint8_t *frame, uint16_t len, bool *ended_out) {
+	bool ok = true;
+	bool ended = false;
+	uint16_t off = 0;
+	uint8_t cs = uv_ui_remote_color_len(mode);
+
+	while (ok && !ended && (off < len)) {
+		uint16_t op_len = uv_ui_remote_op_len(mode, &frame[off], (uint16_t) (len - off));
+		const uint8_t *p = &frame[off];
+		if (op_len == 0) {
+			ok = false;
+		}
+		else {
+			switch (p[0]) {
+				case UV_UI_REMOTE_OP_FRAME_BEGIN: {
+					uint32_t c = (mode == UV_UI_REMOTE_COLOR_RGB565) ?
+							uv_ui_remote_rgb565_argb(_uv_ui_remote_get16(&p[1])) : _uv_ui_remote_get32(&p[1]);
+					clip_reset(this);
+					memset(this->palette, 0, sizeof(this->palette));
+					for (uint16_t y = 0; y < this->height; y++) {
+						fill_row(&this->fb[(uint32_t) y * this->stride], this->width, c);
+					}
+					break;
+				}
+				case UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP:
+					clip_reset(this);
+					memset(this->palette, 0, sizeof(this->palette));
+					break;
+				case UV_UI_REMOTE_OP_BITMAP:
+					bitmap(this, _uv_ui_remote_get32(&p[1]), get16s(&p[5]), get16s(&p[7]),
+							get16s(&p[9]), get16s(&p[11]), _uv_ui_remote_get32(&p[13]),
+							color_at(this, mode, &p[17]));
+					break;
+				case UV_UI_REMOTE_OP_POINT: {
+					int32_t d = _uv_ui_remote_get16(&p[5]);
+					rrect(this, get16s(&p[1]) * SUB - d * HALF, get16s(&p[3]) * SUB - d * HALF,
+							d * SUB, d * SUB, d * HALF, color_at(this, mode, &p[7]));
+					break;
+				}
+				case UV_UI_REMOTE_OP_RRECT:
+					rrect(this, get16s(&p[1]) * SUB, get16s(&p[3]) * SUB,
+							_uv_ui_remote_get16(&p[5]) * SUB, _uv_ui_remote_get16(&p[7]) * SUB, _uv_ui_remote_get16(&p[9]) * SUB,
+							color_at(this, mode, &p[11]));
+					break;
+				case UV_UI_REMOTE_OP_LINE:
+					line(this, get16s(&p[1]) * SUB, get16s(&p[3]) * SUB,
+							get16s(&p[5]) * SUB, get16s(&p[7]) * SUB,
+							MAX(_uv_ui_remote_get16(&p[9]), 1) * SUB, color_at(this, mode, &p[11]));
+					break;
+				case UV_UI_REMOTE_OP_LINESTRIP:
+					linestrip(this, p[1], _uv_ui_remote_get16(&p[2]), color_at(this, mode, &p[4]),
+							&p[6 + cs], _uv_ui_remote_get16(&p[4 + cs]));
+					break;
+				case UV_UI_REMOTE_OP_POLYGON: {
+					poly_st poly = {
+							.pts = &p[3 + cs],
+							.n = _uv_ui_remote_get16(&p[1 + cs]),
+							.extra_n = 0
+					};
+					poly_fill(this, &poly, color_at(this, mode, &p[1]));
+					break;
+				}
+				case UV_UI_REMOTE_OP_STRING:
+					string(this, p[1], get16s(&p[2]), get16s(&p[4]), _uv_ui_remote_get16(&p[6]),
+							color_at(this, mode, &p[8]), &p[10 + cs], _uv_ui_remote_get16(&p[8 + cs]));
+					break;
+				case UV_UI_REMOTE_OP_MASK: {
+					int32_t x = get16s(&p[1]);
+					int32_t y = get16s(&p[3]);
+					this->clip_x0 = (int16_t) MAX(x, 0);
+					this->clip_y0 = (int16_t) MAX(y, 0);
+					this->clip_x1 = (int16_t) MIN(x + get16s(&p[5]), this->width);
+					this->clip_y1 = (int16_t) MIN(y + get16s(&p[7]), this->height);
+					break;
+				}
+				case UV_UI_REMOTE_OP_COLOR:
+					this->palette[p[1]] = _uv_ui_remote_get32(&p[2]);
+					break;
+				case UV_UI_REMOTE_OP_FRAME_END:
+					ended = true;
+					break;
+				default:
+					// a delta frame is rebuilt before it is drawn
+					ok = false;
+					break;
+			}
+			off = (uint16_t) (off + op_len);
+		}
+	}
+	*ended_out = ended;
+	return ok;
+}
+
+
+bool uv_ui_remote_raster_frame(uv_ui_remote_raster_st *this,
+		uv_ui_remote_color_mode_e mode, const uint8_t *frame, uint16_t len) {
+	bool ended;
+	bool ok = draw_ops(this, mode, frame, len, &ended);
+	return ok && ended;
+}
+
+
+bool uv_ui_remote_raster_ops(uv_ui_remote_raster_st *this,
+		uv_ui_remote_color_mode_e mode, const uint8_t *ops, uint16_t len) {
+	bool ended;
+	return draw_ops(this, mode, ops, len, &ended);
+}
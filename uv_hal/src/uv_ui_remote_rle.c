@@ -0,0 +1,175 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_ui_remote.h"
+#include <string.h>
+
+
+// A sink decodes the asset chunks with uv_ui_remote_rle_decode() as they
+// arrive and never builds the encoder, so none of this is under
+// CONFIG_UI_REMOTE.
+
+
+#define RLE_LITERAL_MAX		128
+#define RLE_RUN_MIN			2
+#define RLE_RUN_MAX			(0x7F + RLE_RUN_MIN)
+// A run of two costs as much as a literal of two, and splits the literal it
+// sits in, so runs only start from three
+#define RLE_RUN_WORTH		3
+
+
+/// @brief: Length of the run of equal bytes at the start of *data*
+static uint16_t run_len(const uint8_t *data, uint16_t len) {
+	uint16_t ret = 1;
+	while ((ret < len) && (ret < RLE_RUN_MAX) && (data[ret] == data[0])) {
+		ret++;
+	}
+	return ret;
+}
+
+
+
+void uv_ui_remote_rle_enc_init(uv_ui_remote_rle_enc_st *this) {
+	this->len = 0;
+}
+
+
+uint16_t uv_ui_remote_rle_enc_space(const uv_ui_remote_rle_enc_st *this) {
+	return (uint16_t) (sizeof(this->window) - this->len);
+}
+
+
+uint16_t uv_ui_remote_rle_encode(uv_ui_remote_rle_enc_st *this, bool last,
+		uint8_t *dest, uint16_t dest_len) {
+	uint16_t ret = 0;
+	uint16_t pos = 0;
+	bool go = true;
+	while (go) {
+		uint16_t avail = (uint16_t) (this->len - pos);
+		const uint8_t *p = &this->window[pos];
+		if ((avail == 0) ||
+				(!last && (avail < UV_UI_REMOTE_RLE_LOOKAHEAD)) ||
+				((dest_len - ret) < 2)) {
+			go = false;
+		}
+		else {
+			uint16_t run = run_len(p, avail);
+			if (run >= RLE_RUN_WORTH) {
+				dest[ret++] = (uint8_t) (0x80u + run - RLE_RUN_MIN);
+				dest[ret++] = p[0];
+				pos = (uint16_t) (pos + run);
+			}
+			else {
+				// a literal runs up to where a run worth coding starts
+				uint16_t max = (uint16_t) (dest_len - ret - 1);
+				if (max > RLE_LITERAL_MAX) {
+					max = RLE_LITERAL_MAX;
+				}
+				else {
+				}
+				if (max > avail) {
+					max = avail;
+				}
+				else {
+				}
+				uint16_t n = 1;
+				while ((n < max) &&
+						!(((n + 2u) < avail) &&
+						(p[n] == p[n + 1]) && (p[n] == p[n + 2]))) {
+					n++;
+				}
+				dest[ret++] = (uint8_t) (n - 1u);
+				memcpy(&dest[ret], p, n);
+				ret = (uint16_t) (ret + n);
+				pos = (uint16_t) (pos + n);
+			}
+		}
+	}
+	memmove(this->window, &this->window[pos], (size_t) (this->len - pos));
+	this->len = (uint16_t) (this->len - pos);
+	return ret;
+}
+
+
+void uv_ui_remote_rle_dec_init(uv_ui_remote_rle_dec_st *this) {
+	this->left = 0;
+	this->run = false;
+}
+
+
+uint32_t uv_ui_remote_rle_decode(uv_ui_remote_rle_dec_st *this,
+		const uint8_t *src, uint16_t len, uint8_t *dest, uint32_t dest_len) {
+	uint32_t ret = 0;
+	uint16_t i = 0;
+	while (i < len) {
+		if (this->left == 0) {
+			// control byte
+			uint8_t c = src[i++];
+			if (c & 0x80u) {
+				this->run = true;
+				this->left = (uint8_t) (c - 0x80u + RLE_RUN_MIN);
+			}
+			else {
+				this->run = false;
+				this->left = (uint8_t) (c + 1u);
+			}
+		}
+		else if (this->run) {
+			// the value byte, then the whole run at once
+			uint8_t value = src[i++];
+			uint32_t n = this->left;
+			if ((ret + n) > dest_len) {
+				n = (dest_len > ret) ? (dest_len - ret) : 0;
+			}
+			else {
+			}
+			memset(&dest[ret], value, n);
+			ret += n;
+			this->left = 0;
+		}
+		else {
+			uint32_t n = this->left;
+			if (n > (uint32_t) (len - i)) {
+				n = (uint32_t) (len - i);
+			}
+			else {
+			}
+			uint32_t out = n;
+			if ((ret + out) > dest_len) {
+				out = (dest_len > ret) ? (dest_len - ret) : 0;
+			}
+			else {
+			}
+			memcpy(&dest[ret], &src[i], out);
+			ret += out;
+			i = (uint16_t) (i + n);
+			this->left = (uint8_t) (this->left - n);
+		}
+	}
+	return ret;
+}
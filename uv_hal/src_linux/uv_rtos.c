@@ -247,7 +247,7 @@ void vApplicationMallocFailedHook(void) {
 /* FreeRTOS application idle hook */
 void vApplicationIdleHook(void) {
 	if (this->idle_task) {
-		this->idle_task(__uv_get_user_ptr());
+		UV_CPUTIME_STEP(CPUTIME_IDLE_TASK, this->idle_task(__uv_get_user_ptr()));
 	}
 	else {
 		// wait for 1 tick step time to reduce the processor power consumption of the idle task
@@ -382,6 +382,9 @@ void uv_init_arg(void *device, int argc, char *argv[]) {
 void uv_init(void *device) {
 	uv_set_application_ptr(device);
 	uv_mutex_init(&halmutex);
+#if CONFIG_CPUTIME
+	uv_cputime_init();
+#endif
 
 #if CONFIG_CAN
 	_uv_can_init();
@@ -482,19 +485,25 @@ void hal_task(void *nullptr) {
 
 	while (true) {
 		_uv_rtos_halmutex_lock();
+#if CONFIG_CPUTIME
+		uint32_t step_start = uv_cputime_begin();
+#endif
 
 #if CONFIG_CAN
-		_uv_can_hal_step(step_ms);
+		UV_CPUTIME_STEP(CPUTIME_HAL_CAN, _uv_can_hal_step(step_ms));
 #endif
 
 #if CONFIG_TERMINAL_CAN
-		_uv_stdout_hal_step(step_ms);
+		UV_CPUTIME_STEP(CPUTIME_HAL_STDOUT, _uv_stdout_hal_step(step_ms));
 #endif
 
 #if CONFIG_CANOPEN
-		_uv_canopen_step(step_ms);
+		UV_CPUTIME_STEP(CPUTIME_HAL_CANOPEN, _uv_canopen_step(step_ms));
 #endif
 
+#if CONFIG_CPUTIME
+		uv_cputime_end(CPUTIME_HAL_STEP, step_start);
+#endif
 		_uv_rtos_halmutex_unlock();
 
 		uv_rtos_task_delay(step_ms);
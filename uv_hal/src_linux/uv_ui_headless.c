@@ -0,0 +1,851 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "uv_ui_common.h"
+#include "uv_utilities.h"
+#include "ui/uv_uifont.h"
+#include "uv_ui.h"
+#include "lodepng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CONFIG_UI && CONFIG_UI_HEADLESS
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "ui/embedded_font.h"
+#include "ui/embedded_mono_font.h"
+
+/// @file: Headless UI backend. Draws into an ARGB8888 framebuffer in memory,
+/// so that the UI runs, and can be looked at afterwards, on a build server or
+/// any other machine without a display.
+///
+/// The drawing is done by the reference remote UI sink: every call is coded as
+/// the command the remote UI would send for it and drawn straight away, so this
+/// backend draws exactly what a remote sink built on that code draws. The fonts
+/// are the ones the OpenGL backend uses, rendered with FreeType into the 4 bits
+/// per pixel glyph atlas the sink reads.
+
+#if !defined(PRINT)
+#define PRINT(...) printf(__VA_ARGS__)
+#endif
+
+#define DEFAULT_FONT	"LiberationSans-Regular.ttf"
+#define MONO_FONT		"LiberationMono-Regular.ttf"
+
+#define PNG_ENV			"UV_UI_HEADLESS_PNG"
+
+// the longest command a call is coded into
+#define OP_MAX_LEN		UINT16_MAX
+#define STRING_HDR_LEN	14
+#define STRIP_HDR_LEN	10
+#define POLYGON_HDR_LEN	7
+
+
+ui_font_st ui_fonts[UI_MAX_FONT_COUNT];
+ui_font_st ui_mono_fonts[UI_MAX_FONT_COUNT];
+static const uint8_t font_sizes[UI_MAX_FONT_COUNT] = {
+		13,
+		16,
+		19,
+		21,
+		25,
+		30,
+		40,
+		58,
+		70
+};
+
+// The non-ASCII glyphs baked into each font, in the slots the UI and the
+// remote sink both map them to
+static const struct {
+	uint8_t slot;
+	uint32_t codepoint;
+} font_extra_glyphs[] = {
+		{ UV_UI_GLYPH_a_UML, 0x00E4 },
+		{ UV_UI_GLYPH_o_UML, 0x00F6 },
+		{ UV_UI_GLYPH_a_RING, 0x00E5 },
+		{ UV_UI_GLYPH_A_UML, 0x00C4 },
+		{ UV_UI_GLYPH_O_UML, 0x00D6 },
+		{ UV_UI_GLYPH_A_RING, 0x00C5 },
+};
+#define FONT_EXTRA_COUNT	(sizeof(font_extra_glyphs) / sizeof(font_extra_glyphs[0]))
+#define FONT_GLYPH_COUNT	(UV_UI_REMOTE_FONT_WIDTHS + FONT_EXTRA_COUNT)
+
+
+/// @brief: A linked list member for the uimedia files that are loaded with
+/// *uv_uimedia_load* functions. *id* is what the bitmap is drawn by.
+typedef struct {
+	char filename[128];
+	uint32_t id;
+	// ARGB8888, width pixels a row
+	uint32_t *pixels;
+	uint16_t width;
+	uint16_t height;
+	// pointer to the next uimedia_ll_st
+	void *next_ptr;
+} uimedia_ll_st;
+
+
+/// @brief: The main uv_ui structure that holds the state of the ui drawn
+typedef struct {
+	uint32_t *fb;
+	uv_ui_remote_raster_st raster;
+	// the command being coded
+	uint8_t *ops;
+	uint32_t ops_size;
+	uint16_t ops_len;
+	// the mask in effect, set again after the screen is cleared
+	int16_t mask_x;
+	int16_t mask_y;
+	int16_t mask_w;
+	int16_t mask_h;
+
+	bool pressed;
+	int16_t x;
+	int16_t y;
+	uint8_t brightness;
+	bool refresh;
+
+	uimedia_ll_st *uimediall;
+	uint32_t media_count;
+	// the directory every frame is written into, or NULL
+	const char *png_dir;
+	uint32_t frames;
+} ui_st;
+
+static ui_st _ui = {
+		.fb = NULL,
+		.ops = NULL,
+		.uimediall = NULL,
+		.brightness = 50
+};
+
+#ifdef this
+#undef this
+#endif
+#define this (&_ui)
+
+
+
+static void ops_begin(uint8_t op) {
+	this->ops_len = 0;
+	if (this->ops_size == 0) {
+		this->ops_size = 256;
+		this->ops = malloc(this->ops_size);
+	}
+	else {
+	}
+	this->ops[this->ops_len++] = op;
+}
+
+/// @brief: Makes room for *len* more bytes of the command being coded
+static void ops_reserve(uint32_t len) {
+	if ((this->ops_len + len) > this->ops_size) {
+		while ((this->ops_len + len) > this->ops_size) {
+			this->ops_size *= 2;
+		}
+		this->ops = realloc(this->ops, this->ops_size);
+	}
+	else {
+	}
+}
+
+static void put8(uint8_t v) {
+	ops_reserve(1);
+	this->ops[this->ops_len++] = v;
+}
+
+static void put16(uint16_t v) {
+	put8((uint8_t) (v & 0xFFu));
+	put8((uint8_t) ((v >> 8) & 0xFFu));
+}
+
+static void put32(uint32_t v) {
+	put16((uint16_t) (v & 0xFFFFu));
+	put16((uint16_t) (v >> 16));
+}
+
+static void ops_draw(void) {
+	uv_ui_remote_raster_ops(&this->raster, UV_UI_REMOTE_COLOR_ARGB8888,
+			this->ops, this->ops_len);
+}
+
+static void put_points(const uv_ui_linestrip_point_st *points, uint16_t count) {
+	put16(count);
+	ops_reserve(4u * count);
+	for (uint16_t i = 0; i < count; i++) {
+		put16((uint16_t) points[i].x);
+		put16((uint16_t) points[i].y);
+	}
+}
+
+
+static uint8_t font_id(const ui_font_st *font) {
+	uint8_t ret = UV_UI_REMOTE_FONT_UNKNOWN;
+	for (uint8_t i = 0; i < UI_MAX_FONT_COUNT; i++) {
+		if (font == &ui_fonts[i]) {
+			ret = i;
+		}
+		else if (font == &ui_mono_fonts[i]) {
+			ret = (uint8_t) (i | 0x80u);
+		}
+		else {
+		}
+	}
+	return ret;
+}
+
+
+static const uint8_t *font_get(void *user, uint8_t id, uint32_t *len) {
+	const uint8_t *ret = NULL;
+	uint8_t index = (uint8_t) (id & 0x7Fu);
+	if (index < UI_MAX_FONT_COUNT) {
+		const ui_font_st *font = (id & 0x80u) ?
+				&ui_mono_fonts[index] : &ui_fonts[index];
+		ret = font->body;
+		*len = font->body_len;
+	}
+	else {
+	}
+	return ret;
+}
+
+
+static bool image_get(void *user, uint32_t id, uv_ui_remote_image_st *dest) {
+	uimedia_ll_st *m = this->uimediall;
+	while ((m != NULL) && (m->id != id)) {
+		m = m->next_ptr;
+	}
+	if (m != NULL) {
+		dest->pixels = m->pixels;
+		dest->width = m->width;
+		dest->height = m->height;
+	}
+	else {
+	}
+	return (m != NULL);
+}
+
+
+
+void uv_ui_headless_set_touch(bool pressed, int16_t x, int16_t y) {
+	if (pressed) {
+		uv_ui_input_push(UI_INPUT_TOUCH, x, y, 0);
+	}
+	else if (this->pressed) {
+		uv_ui_input_push(UI_INPUT_RELEASE, x, y, 0);
+	}
+	else {
+	}
+	this->pressed = pressed;
+	this->x = x;
+	this->y = y;
+}
+
+
+void uv_ui_headless_scroll(int16_t notches) {
+	uv_ui_input_push(UI_INPUT_SCROLL, 0, 0, notches);
+}
+
+
+void uv_ui_headless_key_press(char key) {
+	uv_ui_input_push(UI_INPUT_KEY, 0, 0, (int16_t) (uint8_t) key);
+}
+
+
+const uint32_t *uv_ui_headless_get_framebuffer(uint32_t *frames) {
+	if (frames != NULL) {
+		*frames = this->frames;
+	}
+	else {
+	}
+	return this->fb;
+}
+
+
+bool uv_ui_headless_save_png(const char *filename) {
+	bool ret = false;
+	uint32_t count = (uint32_t) CONFIG_FT81X_HSIZE * CONFIG_FT81X_VSIZE;
+	uint8_t *rgba = (this->fb != NULL) ? malloc(count * 4u) : NULL;
+	if (rgba != NULL) {
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t c = this->fb[i];
+			rgba[4 * i] = (uint8_t) (c >> 16);
+			rgba[4 * i + 1] = (uint8_t) (c >> 8);
+			rgba[4 * i + 2] = (uint8_t) c;
+			rgba[4 * i + 3] = (uint8_t) (c >> 24);
+		}
+		ret = (lodepng_encode32_file(filename, rgba,
+				CONFIG_FT81X_HSIZE, CONFIG_FT81X_VSIZE) == 0);
+		free(rgba);
+	}
+	else {
+	}
+	return ret;
+}
+
+
+
+void uv_ui_confwindow_exec(const uv_uistyle_st *style) {
+	// there is nobody to fill it in: the settings come from the command line
+	(void) style;
+	PRINT("The configuration window is not available in the headless UI\n");
+}
+
+
+
+void uv_ui_set_backlight(uint8_t percent) {
+	this->brightness = percent;
+}
+
+
+
+uint8_t uv_ui_get_backlight(void) {
+	return this->brightness;
+}
+
+
+bool uv_ui_get_refresh_request(void) {
+	bool ret = this->refresh;
+	this->refresh = false;
+	return ret;
+}
+
+
+bool uv_ui_frame_preserved_impl(void) {
+	// nothing touches the framebuffer between the frames
+	return true;
+}
+
+
+bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
+	*x = this->x;
+	*y = this->y;
+	return this->pressed;
+}
+
+
+void uv_ui_input_poll_impl(void) {
+	// the input is pushed as it is set
+}
+
+
+const char *uv_ui_get_clipboard(void) {
+	return "";
+}
+
+
+
+void uv_ui_clear_impl(color_t c) {
+	ops_begin(UV_UI_REMOTE_OP_FRAME_BEGIN);
+	put32(c);
+	ops_draw();
+	// the sink forgets the mask when it clears, the UI does not
+	uv_ui_set_mask_impl(this->mask_x, this->mask_y, this->mask_w, this->mask_h);
+}
+
+
+
+void uv_ui_draw_bitmap_ext_impl(uv_uimedia_st *bitmap, int16_t x, int16_t y,
+		int16_t w, int16_t h, uint32_t wrap, color_t c) {
+	if ((bitmap != NULL) && (bitmap->surface_ptr != NULL)) {
+		ops_begin(UV_UI_REMOTE_OP_BITMAP);
+		put32(((uimedia_ll_st *) bitmap->surface_ptr)->id);
+		put16((uint16_t) x);
+		put16((uint16_t) y);
+		put16((uint16_t) w);
+		put16((uint16_t) h);
+		put32(wrap);
+		put32(c);
+		ops_draw();
+	}
+	else {
+	}
+}
+
+
+
+void uv_ui_draw_point_impl(int16_t x, int16_t y, color_t color, uint16_t diameter) {
+	ops_begin(UV_UI_REMOTE_OP_POINT);
+	put16((uint16_t) x);
+	put16((uint16_t) y);
+	put16(diameter);
+	put32(color);
+	ops_draw();
+}
+
+
+
+void uv_ui_draw_rrect_impl(const int16_t x, const int16_t y,
+		const uint16_t width, const uint16_t height,
+		const uint16_t radius, const color_t color) {
+	ops_begin(UV_UI_REMOTE_OP_RRECT);
+	put16((uint16_t) x);
+	put16((uint16_t) y);
+	put16(width);
+	put16(height);
+	put16(radius);
+	put32(color);
+	ops_draw();
+}
+
+
+
+void uv_ui_draw_line_impl(const int16_t start_x, const int16_t start_y,
+		const int16_t end_x, const int16_t end_y,
+		const uint16_t width, const color_t color) {
+	ops_begin(UV_UI_REMOTE_OP_LINE);
+	put16((uint16_t) start_x);
+	put16((uint16_t) start_y);
+	put16((uint16_t) end_x);
+	put16((uint16_t) end_y);
+	put16(width);
+	put32(color);
+	ops_draw();
+}
+
+
+
+void uv_ui_draw_linestrip_impl(const uv_ui_linestrip_point_st *points,
+		const uint16_t point_count, const uint16_t line_width, const color_t color,
+		const uv_ui_strip_type_e type) {
+	// a strip longer than one command takes is drawn in pieces that share
+	// their end points
+	const uint16_t max = (OP_MAX_LEN - STRIP_HDR_LEN) / 4;
+	uint16_t i = 0;
+	do {
+		uint16_t n = MIN((uint16_t) (point_count - i), max);
+		ops_begin(UV_UI_REMOTE_OP_LINESTRIP);
+		put8((uint8_t) type);
+		put16(line_width);
+		put32(color);
+		put_points(&points[i], n);
+		ops_draw();
+		i = (uint16_t) (i + ((n > 1) ? (n - 1) : n));
+	} while ((i + 1) < point_count);
+}
+
+
+
+void uv_ui_draw_polygon_impl(const uv_ui_linestrip_point_st *points,
+		const uint16_t point_count, const color_t color) {
+	ops_begin(UV_UI_REMOTE_OP_POLYGON);
+	put32(color);
+	put_points(points, MIN(point_count, (OP_MAX_LEN - POLYGON_HDR_LEN) / 4));
+	ops_draw();
+}
+
+
+
+void uv_ui_draw_string_impl(char *str, ui_font_st *font,
+		int16_t x, int16_t y, ui_align_e align, color_t color) {
+	if (str != NULL) {
+		// the sink decodes the UTF-8 itself
+		uint16_t len = (uint16_t) MIN(strlen(str), OP_MAX_LEN - STRING_HDR_LEN);
+		ops_begin(UV_UI_REMOTE_OP_STRING);
+		put8(font_id(font));
+		put16((uint16_t) x);
+		put16((uint16_t) y);
+		put16((uint16_t) align);
+		put32(color);
+		put16(len);
+		ops_reserve(len);
+		memcpy(&this->ops[this->ops_len], str, len);
+		this->ops_len = (uint16_t) (this->ops_len + len);
+		ops_draw();
+	}
+	else {
+	}
+}
+
+
+
+void uv_ui_force_mask(int16_t x, int16_t y, int16_t width, int16_t height) {
+#if CONFIG_UI_WINDOW_CACHE
+	// bypasses the recorded uv_ui_set_mask
+	uv_ui_record_spoil();
+#endif
+	uv_ui_set_mask_impl(x, y, width, height);
+}
+
+
+void uv_ui_set_mask_impl(int16_t x, int16_t y, int16_t width, int16_t height) {
+	this->mask_x = x;
+	this->mask_y = y;
+	this->mask_w = width;
+	this->mask_h = height;
+	ops_begin(UV_UI_REMOTE_OP_MASK);
+	put16((uint16_t) x);
+	put16((uint16_t) y);
+	put16((uint16_t) width);
+	put16((uint16_t) height);
+	ops_draw();
+}
+
+
+
+int16_t uv_ui_get_string_width(char *str, ui_font_st *font) {
+	int32_t ret = 0;
+	if ((str != NULL) && (font->body != NULL)) {
+		const uint8_t *widths = &font->body[7];
+		const char *s = str;
+		int32_t w = 0;
+		while (*s != '\0') {
+			if (*s == '\n') {
+				ret = MAX(ret, w);
+				w = 0;
+				s++;
+			}
+			else {
+				uint8_t g = uv_ui_codepoint_glyph(uv_ui_utf8_next(&s), true);
+				w += widths[g & 0x7Fu];
+			}
+		}
+		ret = MAX(ret, w);
+	}
+	else {
+	}
+	return (int16_t) MIN(ret, INT16_MAX);
+}
+
+
+
+static uimedia_ll_st *uimedia_find(const char *filename) {
+	uimedia_ll_st *ret = NULL;
+	if ((filename != NULL) && (strlen(filename) != 0)) {
+		ret = this->uimediall;
+		while ((ret != NULL) && (strcmp(ret->filename, filename) != 0)) {
+			ret = ret->next_ptr;
+		}
+	}
+	else {
+	}
+	return ret;
+}
+
+
+/// @brief: Takes the RGBA bytes lodepng decoded *image* into as the ARGB8888
+/// pixels of a new list member
+static uimedia_ll_st *uimedia_add(const char *filename, uint8_t *image,
+		unsigned width, unsigned height) {
+	uimedia_ll_st *ret = malloc(sizeof(uimedia_ll_st));
+	uint32_t *pixels = (uint32_t *) image;
+	for (uint32_t i = 0; i < (width * height); i++) {
+		const uint8_t *p = &image[4 * i];
+		pixels[i] = ((uint32_t) p[3] << 24) | ((uint32_t) p[0] << 16) |
+				((uint32_t) p[1] << 8) | p[2];
+	}
+	strncpy(ret->filename, filename, sizeof(ret->filename) - 1);
+	ret->filename[sizeof(ret->filename) - 1] = '\0';
+	ret->id = this->media_count++;
+	ret->pixels = pixels;
+	ret->width = (uint16_t) width;
+	ret->height = (uint16_t) height;
+	ret->next_ptr = this->uimediall;
+	this->uimediall = ret;
+	return ret;
+}
+
+
+static uint32_t uimedia_set(uv_uimedia_st *bitmap, uimedia_ll_st *media) {
+	uint32_t ret = 0;
+	memset(bitmap, 0, sizeof(*bitmap));
+	bitmap->filename = "";
+	bitmap->visible = true;
+	bitmap->type = UV_UIMEDIA_IMAGE;
+	if (media != NULL) {
+		bitmap->filename = media->filename;
+		bitmap->surface_ptr = media;
+		bitmap->width = media->width;
+		bitmap->height = media->height;
+		bitmap->size = (uint32_t) media->width * media->height * 4u;
+		ret = bitmap->size;
+	}
+	else {
+	}
+	return ret;
+}
+
+
+uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename) {
+	uimedia_ll_st *media = uimedia_find(filename);
+	if ((media == NULL) && (filename != NULL) && (strlen(filename) != 0)) {
+		unsigned char *image = NULL;
+		unsigned width, height;
+		if (lodepng_decode32_file(&image, &width, &height, filename)) {
+			PRINT("Loading bitmap '%s' failed\n", filename);
+		}
+		else {
+			media = uimedia_add(filename, image, width, height);
+		}
+	}
+	else {
+	}
+	return uimedia_set(bitmap, media);
+}
+
+
+uint32_t uv_uimedia_newbitmapexmem_mem(uv_uimedia_st *bitmap,
+		const char *name, const uint8_t *data, uint32_t datalen) {
+	uimedia_ll_st *media = uimedia_find(name);
+	if ((media == NULL) && (name != NULL) && (strlen(name) != 0) &&
+			(data != NULL) && (datalen != 0)) {
+		unsigned char *image = NULL;
+		unsigned width, height;
+		if (lodepng_decode32(&image, &width, &height, data, datalen)) {
+			PRINT("Loading embedded bitmap '%s' failed\n", name);
+		}
+		else {
+			media = uimedia_add(name, image, width, height);
+		}
+	}
+	else {
+	}
+	return uimedia_set(bitmap, media);
+}
+
+
+void uv_uimedia_newbitmapexmem_async(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename) {
+	// loading takes nothing from the display here
+	uv_uimedia_newbitmapexmem(bitmap, exmem, filename);
+}
+
+
+void uv_uimedia_free(uv_uimedia_st *bitmap) {
+#if CONFIG_UI_REMOTE
+	// abandon any transfer of an image that is going away
+	uv_ui_remote_asset_cancel(UV_UI_REMOTE_ASSET_KIND_BITMAP,
+			uv_ui_remote_bitmap_id(bitmap));
+#endif
+	memset(bitmap, 0, sizeof(*bitmap));
+}
+
+
+void uv_ui_touchscreen_calibrate(ui_transfmat_st *transform_matrix) {
+
+}
+
+
+void uv_ui_touchscreen_set_transform_matrix(ui_transfmat_st *transform_matrix) {
+
+}
+
+
+void uv_ui_dlswap_impl(void) {
+	this->frames++;
+	if (this->png_dir != NULL) {
+		char name[256];
+		snprintf(name, sizeof(name), "%s/frame_%05u.png",
+				this->png_dir, (unsigned int) this->frames);
+		if (!uv_ui_headless_save_png(name)) {
+			PRINT("Could not write '%s'\n", name);
+		}
+		else {
+		}
+	}
+	else {
+	}
+}
+
+
+
+/// @brief: Renders the currently sized *face* into a font body: every glyph
+/// slot in a cell as wide as the widest glyph, placed on a common baseline
+static void font_body_build(ui_font_st *font, FT_Face face) {
+	uint32_t cp[FONT_GLYPH_COUNT];
+	uint8_t slot[FONT_GLYPH_COUNT];
+	for (uint32_t c = 0; c < UV_UI_REMOTE_FONT_WIDTHS; c++) {
+		cp[c] = c;
+		slot[c] = (uint8_t) c;
+	}
+	for (uint32_t j = 0; j < FONT_EXTRA_COUNT; j++) {
+		cp[UV_UI_REMOTE_FONT_WIDTHS + j] = font_extra_glyphs[j].codepoint;
+		slot[UV_UI_REMOTE_FONT_WIDTHS + j] = font_extra_glyphs[j].slot;
+	}
+	int32_t height = (int32_t) (face->size->metrics.height / 64);
+	int32_t ascent = (int32_t) (face->size->metrics.ascender / 64);
+
+	// pass 1: the cell width
+	int32_t width = 1;
+	for (uint32_t i = 0; i < FONT_GLYPH_COUNT; i++) {
+		if ((cp[i] >= ' ') && !FT_Load_Char(face, cp[i], FT_LOAD_RENDER)) {
+			FT_GlyphSlot g = face->glyph;
+			width = MAX(width, (int32_t) (g->advance.x / 64));
+			width = MAX(width, g->bitmap_left + (int32_t) g->bitmap.width);
+		}
+		else {
+		}
+	}
+	uint16_t stride = (uint16_t) ((width + 1) / 2);
+	uint32_t cell_len = (uint32_t) stride * (uint32_t) height;
+	font->body_len = UV_UI_REMOTE_FONT_BODY_HDR_LEN +
+			cell_len * UV_UI_REMOTE_FONT_WIDTHS;
+	font->body = calloc(font->body_len, 1);
+	uint8_t *p = font->body;
+	p[0] = (uint8_t) (height & 0xFF);
+	p[1] = (uint8_t) (height >> 8);
+	p[2] = UV_UI_REMOTE_FONT_FLAG_GLYPHS;
+	p[3] = (uint8_t) (stride & 0xFFu);
+	p[4] = (uint8_t) (stride >> 8);
+	p[5] = (uint8_t) (width & 0xFF);
+	p[6] = (uint8_t) (width >> 8);
+	uint8_t *atlas = &p[UV_UI_REMOTE_FONT_BODY_HDR_LEN];
+
+	// pass 2: the glyphs, 4 bits a pixel, the left one in the high nibble
+	for (uint32_t i = 0; i < FONT_GLYPH_COUNT; i++) {
+		if ((cp[i] >= ' ') && !FT_Load_Char(face, cp[i], FT_LOAD_RENDER)) {
+			FT_GlyphSlot g = face->glyph;
+			p[7 + slot[i]] = (uint8_t) MIN(g->advance.x / 64, UINT8_MAX);
+			uint8_t *cell = &atlas[slot[i] * cell_len];
+			for (int32_t y = 0; y < (int32_t) g->bitmap.rows; y++) {
+				int32_t cy = ascent - g->bitmap_top + y;
+				for (int32_t x = 0; x < (int32_t) g->bitmap.width; x++) {
+					int32_t cx = g->bitmap_left + x;
+					if ((cy >= 0) && (cy < height) && (cx >= 0) && (cx < width)) {
+						uint8_t v = g->bitmap.buffer[y * g->bitmap.pitch + x] >> 4;
+						cell[cy * stride + cx / 2] |= (cx & 1) ? v : (uint8_t) (v << 4);
+					}
+					else {
+					}
+				}
+			}
+		}
+		else {
+		}
+	}
+	font->char_height = (uint16_t) height;
+}
+
+
+/// @brief: Loads all UI_MAX_FONT_COUNT sizes of the TTF at *path* into *fonts*,
+/// or of the one in *mem* when the file is not there
+static void load_font_face(FT_Library ft, const char *path, ui_font_st *fonts,
+		const unsigned char *mem, unsigned int mem_len) {
+	FT_Face face;
+	FT_Error fterr = FT_New_Face(ft, path, 0, &face);
+	if (fterr) {
+		fterr = FT_New_Memory_Face(ft, mem, mem_len, 0, &face);
+	}
+	else {
+	}
+	if (fterr) {
+		PRINT("Could not load font '%s'\n", path);
+	}
+	else {
+		for (uint32_t i = 0; i < UI_MAX_FONT_COUNT; i++) {
+			FT_Set_Pixel_Sizes(face, 0, font_sizes[i]);
+			font_body_build(&fonts[i], face);
+		}
+		FT_Done_Face(face);
+	}
+}
+
+
+static void free_fonts(void) {
+	ui_font_st *arrays[2] = { ui_fonts, ui_mono_fonts };
+	for (uint32_t a = 0; a < 2; a++) {
+		for (uint32_t i = 0; i < UI_MAX_FONT_COUNT; i++) {
+			free(arrays[a][i].body);
+			arrays[a][i].body = NULL;
+			arrays[a][i].body_len = 0;
+			// strings are laid out by the height even without the glyphs
+			arrays[a][i].char_height = font_sizes[i];
+		}
+	}
+}
+
+
+
+bool uv_ui_init(void) {
+	if (this->fb == NULL) {
+		this->fb = malloc((size_t) CONFIG_FT81X_HSIZE * CONFIG_FT81X_VSIZE *
+				sizeof(uint32_t));
+		uv_ui_remote_raster_init(&this->raster, this->fb,
+				CONFIG_FT81X_HSIZE, CONFIG_FT81X_VSIZE, CONFIG_FT81X_HSIZE);
+		uv_ui_remote_raster_set_assets(&this->raster, &font_get, &image_get, NULL);
+
+		free_fonts();
+		FT_Library ft;
+		if (FT_Init_FreeType(&ft)) {
+			PRINT("Could not init Freetype\n");
+		}
+		else {
+			load_font_face(ft, "fonts/" DEFAULT_FONT, ui_fonts,
+					embedded_font_ttf, embedded_font_ttf_len);
+			load_font_face(ft, "fonts/" MONO_FONT, ui_mono_fonts,
+					embedded_mono_font_ttf, embedded_mono_font_ttf_len);
+			FT_Done_FreeType(ft);
+		}
+
+		this->png_dir = getenv(PNG_ENV);
+		PRINT("Headless UI started, %ix%i\n", CONFIG_FT81X_HSIZE, CONFIG_FT81X_VSIZE);
+	}
+	else {
+	}
+	this->pressed = false;
+	this->x = 0;
+	this->y = 0;
+	this->frames = 0;
+	this->mask_x = 0;
+	this->mask_y = 0;
+	this->mask_w = CONFIG_FT81X_HSIZE;
+	this->mask_h = CONFIG_FT81X_VSIZE;
+	// the first frame is drawn whole
+	this->refresh = true;
+	uv_ui_clear_impl(C(0xFF000000));
+
+	return false;
+}
+
+
+
+void uv_ui_destroy(void) {
+	free_fonts();
+	while (this->uimediall != NULL) {
+		uimedia_ll_st *m = this->uimediall;
+		this->uimediall = m->next_ptr;
+		free(m->pixels);
+		free(m);
+	}
+	this->media_count = 0;
+	free(this->ops);
+	this->ops = NULL;
+	this->ops_size = 0;
+	free(this->fb);
+	this->fb = NULL;
+}
+
+
+
+#endif
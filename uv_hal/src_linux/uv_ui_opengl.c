@@ -57,6 +57,12 @@
 #define CONFIG_UI_NAME		"Window"
 #endif
 
+/// @brief: The number of strings whose layout is kept, in all fonts and
+/// alignments. The strings drawn least recently make room for new ones.
+#if !defined(CONFIG_UI_OPENGL_TEXT_CACHE)
+#define CONFIG_UI_OPENGL_TEXT_CACHE		256
+#endif
+
 #define DEFAULT_FONT	"LiberationSans-Regular.ttf"
 #define MONO_FONT		"LiberationMono-Regular.ttf"
 
@@ -80,7 +86,6 @@ static void resize_callback(GLFWwindow* window,
 static void load_fonts(void);
 static void free_fonts(void);
 static GLint get_uniform(GLuint shader_program, const char *name);
-static GLint get_attrib(GLuint program, const char *name);
 
 ui_font_st ui_fonts[UI_MAX_FONT_COUNT] = {};
 ui_font_st ui_mono_fonts[UI_MAX_FONT_COUNT] = {};
@@ -140,6 +145,36 @@ typedef struct {
 } ft_char_st;
 
 
+/// @brief: A string laid out into glyph instances, see uv_ui_draw_string_impl
+typedef struct {
+	uint32_t hash;
+	ui_font_st *font;
+	ui_align_e align;
+	// a copy of the string, to tell apart strings with the same hash. NULL
+	// when the entry is free.
+	char *str;
+	// the width of the string in window pixels
+	int16_t width;
+	// glyph instances in the buffer
+	uint32_t count;
+	GLuint vbo;
+	// the value of the lookup clock when this was last used
+	uint32_t used;
+} text_layout_st;
+
+// floats in a glyph instance: its rectangle and its rectangle in the atlas
+#define TEXT_INSTANCE_FLOATS	8
+
+
+/// @brief: A vertex of the shapes batched into one draw call: pixel
+/// coordinates in the glOrtho space of the fixed function pipeline, and color
+typedef struct {
+	GLfloat x;
+	GLfloat y;
+	GLubyte rgba[4];
+} batch_vertex_st;
+
+
 
 /// @brief: The main uv_ui structure that holds the state of the ui drawn
 typedef struct {
@@ -148,9 +183,6 @@ typedef struct {
 	bool pressed;
 	int32_t x;
 	int32_t y;
-	// accumulated mouse-wheel notches since the last uv_ui_get_scroll() (positive
-	// = scrolled up / away from the user)
-	int32_t scroll;
 	double scalex;
 	double scaley;
 	double scale;
@@ -159,16 +191,61 @@ typedef struct {
 	int32_t xoffset;
 	int32_t yoffset;
 	uimedia_ll_st *uimediall;
-	uv_ring_buffer_st key_press;
-	char key_press_buffer[20];
 	uint8_t brightness;
 
 	GLFWwindow* window;
-	unsigned int text_shader_program;
-	unsigned int text_vbo;
+
+	// Strings are drawn as one instance of a quad per glyph. The instances
+	// of each string are laid out once and kept in a buffer of their own,
+	// in a cache of the strings drawn most recently.
+	struct {
+		unsigned int program;
+		GLint uniform_tex;
+		GLint uniform_color;
+		GLint uniform_origin;
+		GLint uniform_viewport;
+		// the two triangles of a unit quad, instanced for each glyph
+		GLuint vao;
+		GLuint quad_vbo;
+		text_layout_st layouts[CONFIG_UI_OPENGL_TEXT_CACHE];
+		// counts lookups, the age of the layouts for the LRU eviction
+		uint32_t clock;
+	} text;
 
 	unsigned int bitmap_shader_program;
 
+	// Rectangles, points, lines, strips and polygons are collected here as
+	// triangles and drawn with one glDrawArrays when something that changes the
+	// GL state comes along: a mask, a bitmap, a string or the end of the frame.
+	struct {
+		batch_vertex_st *verts;
+		uint32_t count;
+		uint32_t size;
+		unsigned int vbo;
+		// the triangle fan being added, see batch_fan_vertex
+		GLubyte rgba[4];
+		uint32_t fan_count;
+		batch_vertex_st fan_first;
+		batch_vertex_st fan_prev;
+	} batch;
+
+	// the time and the GL calls spent on frames, printed once a second when the
+	// UV_UI_STATS environment variable is set
+	struct {
+		bool enabled;
+		uint32_t frames;
+		uint32_t draw_calls;
+		uint32_t vertices;
+		// strings that were not in the layout cache
+		uint32_t layouts;
+		double frame_time;
+		// set by the first drawing call of a frame, so that the time spent
+		// waiting between frames is not counted
+		bool drawing;
+		double frame_start;
+		double print_time;
+	} stats;
+
 	// configuration window that is shown when setting the settings
 	struct {
 		bool terminate;
@@ -570,6 +647,12 @@ bool uv_ui_get_refresh_request(void) {
 }
 
 
+bool uv_ui_frame_preserved_impl(void) {
+	// the back buffer is cleared after every swap
+	return false;
+}
+
+
 void uv_ui_set_backlight(uint8_t percent) {
 	this->brightness = percent;
 }
@@ -598,11 +681,9 @@ bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
 }
 
 
-int16_t uv_ui_get_scroll(void) {
-	// return and clear the accumulated wheel notches (filled by scroll_callback)
-	int16_t ret = (int16_t) this->scroll;
-	this->scroll = 0;
-	return ret;
+void uv_ui_input_poll_impl(void) {
+	// the callbacks push the events
+	glfwPollEvents();
 }
 
 
@@ -615,20 +696,6 @@ const char *uv_ui_get_clipboard(void) {
 }
 
 
-char uv_ui_peek_key_press(void) {
-	char ret = '\0';
-	uv_ring_buffer_peek(&this->key_press, &ret);
-	return ret;
-}
-
-
-char uv_ui_get_key_press(void) {
-	char ret = '\0';
-	uv_ring_buffer_pop(&this->key_press, &ret);
-	return ret;
-}
-
-
 typedef struct {
 	double r;
 	double g;
@@ -647,7 +714,166 @@ static glc_st c_to_glc(color_t color) {
 }
 
 
+// cos and sin of every whole degree from 0 to 360, for the corners of rounded
+// rectangles and the edges of points
+static GLfloat unit_cos[361];
+static GLfloat unit_sin[361];
+
+static void init_unit_circle(void) {
+	for (int i = 0; i <= 360; i++) {
+		unit_cos[i] = cosf(M_PI * i / 180);
+		unit_sin[i] = sinf(M_PI * i / 180);
+	}
+}
+
+
+/// @brief: Marks the frame started, if it was not yet
+static void stats_frame_begin(void) {
+	if (!this->stats.drawing) {
+		this->stats.drawing = true;
+		this->stats.frame_start = glfwGetTime();
+	}
+	else {
+	}
+}
+
+
+/// @brief: Draws the batched triangles, if any
+static void batch_flush(void) {
+	if (this->batch.count != 0) {
+		// a bitmap leaves its vertex array bound, and the fixed function
+		// vertex arrays would otherwise be stored into it
+		glBindVertexArray(0);
+		glUseProgram(0);
+		glBindBuffer(GL_ARRAY_BUFFER, this->batch.vbo);
+		glBufferData(GL_ARRAY_BUFFER, this->batch.count * sizeof(batch_vertex_st),
+				this->batch.verts, GL_STREAM_DRAW);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(2, GL_FLOAT, sizeof(batch_vertex_st),
+				(void*) offsetof(batch_vertex_st, x));
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(batch_vertex_st),
+				(void*) offsetof(batch_vertex_st, rgba));
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei) this->batch.count);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		this->stats.draw_calls++;
+		this->stats.vertices += this->batch.count;
+		this->batch.count = 0;
+	}
+}
+
+
+/// @brief: Returns room for *count* more vertices in the batch, or NULL if
+/// there is no memory for them
+static batch_vertex_st *batch_reserve(uint32_t count) {
+	batch_vertex_st *ret = NULL;
+	stats_frame_begin();
+	if (this->batch.count + count > this->batch.size) {
+		uint32_t size = MAX(this->batch.size * 2, this->batch.count + count);
+		size = MAX(size, 1024);
+		batch_vertex_st *verts = realloc(this->batch.verts, size * sizeof(batch_vertex_st));
+		if (verts != NULL) {
+			this->batch.verts = verts;
+			this->batch.size = size;
+		}
+		else {
+			printf("ERROR: out of memory for %u vertices\n", size);
+		}
+	}
+	if (this->batch.count + count <= this->batch.size) {
+		ret = &this->batch.verts[this->batch.count];
+		this->batch.count += count;
+	}
+	return ret;
+}
+
+
+static void batch_set_color(color_t col) {
+	color_st c = uv_uic(col);
+	this->batch.rgba[0] = c.r;
+	this->batch.rgba[1] = c.g;
+	this->batch.rgba[2] = c.b;
+	this->batch.rgba[3] = c.a;
+}
+
+
+static void batch_vertex(batch_vertex_st *v, GLfloat x, GLfloat y) {
+	v->x = x;
+	v->y = y;
+	memcpy(v->rgba, this->batch.rgba, sizeof(v->rgba));
+}
+
+
+/// @brief: Adds a triangle in the current color
+static void batch_triangle(GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1,
+		GLfloat x2, GLfloat y2) {
+	batch_vertex_st *v = batch_reserve(3);
+	if (v != NULL) {
+		batch_vertex(&v[0], x0, y0);
+		batch_vertex(&v[1], x1, y1);
+		batch_vertex(&v[2], x2, y2);
+	}
+}
+
+
+/// @brief: Adds a quad, with the corners given in order around it
+static void batch_quad(GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1,
+		GLfloat x2, GLfloat y2, GLfloat x3, GLfloat y3) {
+	batch_triangle(x0, y0, x1, y1, x2, y2);
+	batch_triangle(x0, y0, x2, y2, x3, y3);
+}
+
+
+/// @brief: Adds a line *width* pixels wide as a quad, which is what glLineWidth
+/// would have drawn without the ends being squared
+static void batch_line(GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1, uint16_t width) {
+	GLfloat dx = x1 - x0;
+	GLfloat dy = y1 - y0;
+	GLfloat len = sqrtf(dx * dx + dy * dy);
+	if (len > 0) {
+		GLfloat half = MAX(width, 1) / 2.0f;
+		GLfloat nx = -dy / len * half;
+		GLfloat ny = dx / len * half;
+		batch_quad(x0 + nx, y0 + ny, x1 + nx, y1 + ny,
+				x1 - nx, y1 - ny, x0 - nx, y0 - ny);
+	}
+}
+
+
+/// @brief: Starts a triangle fan in *col*. The vertices given to
+/// batch_fan_vertex after this are added as GL_TRIANGLE_FAN would draw them.
+static void batch_fan_begin(color_t col) {
+	batch_set_color(col);
+	this->batch.fan_count = 0;
+}
+
+
+static void batch_fan_vertex(GLfloat x, GLfloat y) {
+	batch_vertex_st v;
+	batch_vertex(&v, x, y);
+	if (this->batch.fan_count == 0) {
+		this->batch.fan_first = v;
+	}
+	else if (this->batch.fan_count >= 2) {
+		batch_vertex_st *t = batch_reserve(3);
+		if (t != NULL) {
+			t[0] = this->batch.fan_first;
+			t[1] = this->batch.fan_prev;
+			t[2] = v;
+		}
+	}
+	else {
+	}
+	this->batch.fan_prev = v;
+	this->batch.fan_count++;
+}
+
+
 void uv_ui_clear_impl(color_t col) {
+	stats_frame_begin();
+	batch_flush();
 	glc_st c = c_to_glc(col);
     // disable any active scissor box so the whole framebuffer is cleared, not
     // just the last mask rectangle left over from the previous frame
@@ -675,6 +901,8 @@ void uv_ui_draw_bitmap_ext_impl(uv_uimedia_st *bitmap, int16_t x, int16_t y,
 		printf("ERROR: load bitmap with uv_ui_media_loadbitmapexmem before drawing it.\n");
 	}
 	else {
+		stats_frame_begin();
+		batch_flush();
 		glUseProgram(this->bitmap_shader_program);
 
 		// blend colour: the texture's RGBA is multiplied by this ARGB value,
@@ -726,6 +954,8 @@ void uv_ui_draw_bitmap_ext_impl(uv_uimedia_st *bitmap, int16_t x, int16_t y,
 
 		glBindVertexArray(media->vao);
 		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+		this->stats.draw_calls++;
+		this->stats.vertices += 6;
 
 
 		glUseProgram(0);
@@ -737,18 +967,14 @@ void uv_ui_draw_bitmap_ext_impl(uv_uimedia_st *bitmap, int16_t x, int16_t y,
 
 
 void uv_ui_draw_point_impl(int16_t x, int16_t y, color_t col, uint16_t diameter) {
+	batch_fan_begin(col);
 
-	color_st c = uv_uic(col);
-    glColor4ub(c.r, c.g, c.b, c.a);
-    glBegin(GL_TRIANGLE_FAN);
-
-    double r = diameter / 2;
-    glVertex2i(x, y); // Center
+	GLfloat r = diameter / 2;
+	batch_fan_vertex(x, y); // Center
 	int resolution = MAX(this->height / 50 * diameter / 100, 30);
-    for(int i = 0; i <= 360; i += MAX(360 / resolution, 1))
-            glVertex2f(r * cosf(M_PI * i / 180.0) + (double) x,
-            		r * sinf(M_PI * i / 180.0) + (double) y);
-    glEnd();
+	for (int i = 0; i <= 360; i += MAX(360 / resolution, 1)) {
+		batch_fan_vertex(r * unit_cos[i] + x, r * unit_sin[i] + y);
+	}
 }
 
 
@@ -759,38 +985,31 @@ void uv_ui_draw_point_impl(int16_t x, int16_t y, color_t col, uint16_t diameter)
 void uv_ui_draw_rrect_impl(const int16_t x, const int16_t y,
 		const uint16_t w, const uint16_t h,
 		const uint16_t radius, const color_t col) {
-	color_st c = uv_uic(col);
-	glColor4ub(c.r, c.g, c.b, c.a);
-
 	if (radius == 0) {
-		glBegin(GL_TRIANGLE_FAN);
-		glVertex2i(x, y);
-		glVertex2i(x + w, y);
-		glVertex2i(x + w, y + h);
-		glVertex2i(x, y + h);
-		glEnd();
+		batch_set_color(col);
+		batch_quad(x, y, x + w, y, x + w, y + h, x, y + h);
 	}
 	else {
-		glBegin(GL_TRIANGLE_FAN);
-		glVertex2i(x + w, y + radius);
+		batch_fan_begin(col);
+		batch_fan_vertex(x + w, y + radius);
 		int resolution = MAX(this->height / 50, 3);
-		for (int i = 0; i < 90; i += MAX(90 / resolution, 1)) {
-			glVertex2f((float) x + w - radius + radius * cosf(M_PI * i / 180),
-					(float) y + radius - radius * sinf(M_PI * i / 180));
+		int step = MAX(90 / resolution, 1);
+		for (int i = 0; i < 90; i += step) {
+			batch_fan_vertex((float) x + w - radius + radius * unit_cos[i],
+					(float) y + radius - radius * unit_sin[i]);
 		}
-		for (int i = 0; i < 90; i += MAX(90 / resolution, 1)) {
-			glVertex2f((float) x + radius + radius * cosf(M_PI / 2 + M_PI * i / 180),
-					(float) y + radius - radius * sinf(M_PI / 2 + M_PI * i / 180));
+		for (int i = 0; i < 90; i += step) {
+			batch_fan_vertex((float) x + radius + radius * unit_cos[90 + i],
+					(float) y + radius - radius * unit_sin[90 + i]);
 		}
-		for (int i = 0; i < 90; i += MAX(90 / resolution, 1)) {
-			glVertex2f((float) x + radius + radius * cosf(M_PI + M_PI * i / 180),
-					(float) y + h - radius - radius * sinf(M_PI + M_PI * i / 180));
+		for (int i = 0; i < 90; i += step) {
+			batch_fan_vertex((float) x + radius + radius * unit_cos[180 + i],
+					(float) y + h - radius - radius * unit_sin[180 + i]);
 		}
-		for (int i = 0; i < 90; i += MAX(90 / resolution, 1)) {
-			glVertex2f((float) x + w - radius + radius * cosf(M_PI / 2 * 3 + M_PI * i / 180),
-					(float) y + h - radius - radius * sinf(M_PI / 2  *3 + M_PI * i / 180));
+		for (int i = 0; i < 90; i += step) {
+			batch_fan_vertex((float) x + w - radius + radius * unit_cos[270 + i],
+					(float) y + h - radius - radius * unit_sin[270 + i]);
 		}
-		glEnd();
 	}
 }
 
@@ -799,13 +1018,8 @@ void uv_ui_draw_rrect_impl(const int16_t x, const int16_t y,
 void uv_ui_draw_line_impl(const int16_t start_x, const int16_t start_y,
 		const int16_t end_x, const int16_t end_y,
 		const uint16_t width, const color_t color) {
-	color_st c = uv_uic(color);
-	glColor4ub(c.r, c.g, c.b, c.a);
-	glLineWidth(width);
-	glBegin(GL_LINES);
-	glVertex2i(start_x, start_y);
-	glVertex2i(end_x, end_y);
-	glEnd();
+	batch_set_color(color);
+	batch_line(start_x, start_y, end_x, end_y, width);
 }
 
 
@@ -814,44 +1028,54 @@ void uv_ui_draw_linestrip_impl(const uv_ui_linestrip_point_st *points,
 		const uint16_t point_count, const uint16_t line_width, const color_t color,
 		const uv_ui_strip_type_e type) {
 	if (point_count) {
-		color_st c = uv_uic(color);
-		glColor4ub(c.r, c.g, c.b, c.a);
-		glLineWidth(line_width);
+		batch_set_color(color);
 
 		if (type == UI_STRIP_TYPE_LINE) {
-			glBegin(GL_LINE_STRIP);
-			for (uint16_t i = 0; i < point_count; i++) {
-				glVertex2i(points[i].x, points[i].y);
+			for (uint16_t i = 1; i < point_count; i++) {
+				batch_line(points[i - 1].x, points[i - 1].y,
+						points[i].x, points[i].y, line_width);
 			}
-			glEnd();
 		}
 		else {
 			// Edge strips fill the area between the polyline and one screen
 			// edge. Emulate the FT81X EDGE_STRIP primitives with a quad strip
 			// pairing every point with its projection onto that edge. Unlike a
-			// single GL_POLYGON (which only fills convex shapes correctly), a
+			// single polygon (which only fills convex shapes correctly), a
 			// quad strip fills correctly even when the polyline is concave -
 			// e.g. a pie sector whose apex dips back to the centre.
-			glBegin(GL_QUAD_STRIP);
+			GLfloat ex = 0;
+			GLfloat ey = 0;
 			for (uint16_t i = 0; i < point_count; i++) {
-				glVertex2i(points[i].x, points[i].y);
+				GLfloat px = points[i].x;
+				GLfloat py = points[i].y;
+				GLfloat qx;
+				GLfloat qy;
 				if (type == UI_STRIP_TYPE_ABOVE) {
-					glVertex2i(points[i].x, 0);
+					qx = px;
+					qy = 0;
 				}
 				else if (type == UI_STRIP_TYPE_BELOW) {
-					glVertex2i(points[i].x, CONFIG_FT81X_VSIZE);
+					qx = px;
+					qy = CONFIG_FT81X_VSIZE;
 				}
 				else if (type == UI_STRIP_TYPE_LEFT) {
-					glVertex2i(0, points[i].y);
+					qx = 0;
+					qy = py;
 				}
 				else if (type == UI_STRIP_TYPE_RIGHT) {
-					glVertex2i(CONFIG_FT81X_HSIZE, points[i].y);
+					qx = CONFIG_FT81X_HSIZE;
+					qy = py;
 				}
 				else {
-					glVertex2i(points[i].x, points[i].y);
+					qx = px;
+					qy = py;
+				}
+				if (i != 0) {
+					batch_quad(points[i - 1].x, points[i - 1].y, ex, ey, qx, qy, px, py);
 				}
+				ex = qx;
+				ey = qy;
 			}
-			glEnd();
 		}
 	}
 }
@@ -864,194 +1088,280 @@ void uv_ui_touchscreen_calibrate(ui_transfmat_st *transform_matrix) {
 
 
 
-// Appends the triangle vertices for one line of *str* to *verts* (4 floats per
-// vertex: clip-space x, y and atlas texture s, t), starting from pen position
-// (x, y) in application space. Advances *vcount* by the number of vertices added
-// (6 per drawn glyph). All glyphs come from the font's single atlas texture, so
-// the whole batch is later drawn in one glDrawArrays call (see uv_ui_draw_string_impl).
-static void append_line_verts(char *str, ui_font_st *font,
-		int16_t x, int16_t y, GLfloat *verts, size_t *vcount) {
-	// coordinates are in application space, and since uv_ui uses fixed window size,
-	// we resize these accordingly
-	float fx = x * this->scalex;
-	float fy = y * this->scaley;
+/// @brief: Returns the hash of a string, the key of its cached layouts
+static uint32_t text_hash(const char *str) {
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (const char *p = str; *p != '\0'; p++) {
+		hash ^= (uint8_t) *p;
+		hash *= 16777619u;
+	}
+	return hash;
+}
 
-	float sx = 2.0f / this->width;
-	float sy = 2.0f / this->height;
-	float aw = (font->atlas_w > 0) ? (float) font->atlas_w : 1.0f;
-	float ah = (font->atlas_h > 0) ? (float) font->atlas_h : 1.0f;
 
-	/* Translate the UTF-8 line into single-byte font glyph slots so the Nordic
-	 * letters map to their loaded glyphs (see uv_ui_str_to_glyphs). */
-	// the simulator always loads the Nordic glyphs from FreeType, so they are
-	// available (nordic_glyphs = true)
-	char glyphs[strlen(str) + 1];
-	uv_ui_str_to_glyphs(str, glyphs, sizeof(glyphs), true);
+/// @brief: Returns the width of the string in window pixels, walking it
+static int16_t text_width(const char *str, ui_font_st *font) {
+	int16_t ret = 0;
+	int line_width = 0;
+	const char *p = str;
+	while (*p != '\0') {
+		uint32_t cp = uv_ui_utf8_next(&p);
+		if (cp == '\n' ||
+				cp == '\r') {
+			line_width = 0;
+		}
+		else {
+			uint8_t glyph = uv_ui_codepoint_glyph(cp, true);
+			line_width += font->ft_char[glyph].advance / 64;
+			if (line_width > ret) {
+				ret = line_width;
+			}
+		}
+	}
+	return ret;
+}
 
-	for (char *p = glyphs; *p; p++) {
-		unsigned char g = (unsigned char) *p;
 
-		/* Calculate the vertex and texture coordinates */
-		float x2 = (fx + font->ft_char[g].bearing_x) * sx - 1.0f;
-		float y2 = (fy - font->ft_char[g].bearing_y) * sy - 1.0f +
-				(font->ft_char['H'].size_y * sy);
-		float w = (font->ft_char[g].size_x) * sx;
-		float h = (font->ft_char[g].size_y) * sy;
+/// @brief: Returns the cached layout of *str* in *font* and *align*, or NULL.
+/// A layout in any alignment is accepted when *any_align* is set, for asking
+/// the width.
+static text_layout_st *text_cache_find(const char *str, uint32_t hash,
+		ui_font_st *font, ui_align_e align, bool any_align) {
+	text_layout_st *ret = NULL;
+	for (uint32_t i = 0; i < CONFIG_UI_OPENGL_TEXT_CACHE; i++) {
+		text_layout_st *l = &this->text.layouts[i];
+		if ((l->str != NULL) &&
+				(l->hash == hash) &&
+				(l->font == font) &&
+				(any_align || (l->align == align)) &&
+				(strcmp(l->str, str) == 0)) {
+			l->used = ++this->text.clock;
+			ret = l;
+			break;
+		}
+	}
+	return ret;
+}
 
-		// texture coordinates of this glyph's rectangle within the atlas
-		float u0 = font->ft_char[g].atlas_x / aw;
-		float v0 = font->ft_char[g].atlas_y / ah;
-		float u1 = (font->ft_char[g].atlas_x + font->ft_char[g].size_x) / aw;
-		float v1 = (font->ft_char[g].atlas_y + font->ft_char[g].size_y) / ah;
+
+static void text_layout_free(text_layout_st *l) {
+	if (l->str != NULL) {
+		free(l->str);
+		l->str = NULL;
+		glDeleteBuffers(1, &l->vbo);
+		l->vbo = 0;
+	}
+	else {
+	}
+}
+
+
+/// @brief: Empties the layout cache. The layouts are positions in the font
+/// atlases, which are rebuilt when the window is resized.
+static void text_cache_clear(void) {
+	for (uint32_t i = 0; i < CONFIG_UI_OPENGL_TEXT_CACHE; i++) {
+		text_layout_free(&this->text.layouts[i]);
+	}
+}
+
+
+/// @brief: Appends the glyph instances of one line of *glyphs* to *inst*,
+/// starting from the pen position (*dx*, *dy*) in window pixels from the origin
+/// of the string. Each instance is the glyph's rectangle (x, y, width, height)
+/// followed by its rectangle in the atlas (u0, v0, u1, v1).
+static void append_line_glyphs(const char *glyphs, ui_font_st *font,
+		float dx, float dy, GLfloat *inst, uint32_t *count) {
+	float aw = (font->atlas_w > 0) ? (float) font->atlas_w : 1.0f;
+	float ah = (font->atlas_h > 0) ? (float) font->atlas_h : 1.0f;
+
+	for (const char *p = glyphs; *p; p++) {
+		unsigned char g = (unsigned char) *p;
 
 		// skip zero-area glyphs (e.g. space) so they add no geometry
 		if ((font->ft_char[g].size_x > 0) && (font->ft_char[g].size_y > 0)) {
-			// two triangles (TL,TR,BL) and (TR,BR,BL)
-			const GLfloat quad[6][4] = {
-					{ x2,     -y2,     u0, v0 },
-					{ x2 + w, -y2,     u1, v0 },
-					{ x2,     -y2 - h, u0, v1 },
-					{ x2 + w, -y2,     u1, v0 },
-					{ x2 + w, -y2 - h, u1, v1 },
-					{ x2,     -y2 - h, u0, v1 },
-			};
-			GLfloat *dst = &verts[*vcount * 4];
-			memcpy(dst, quad, sizeof(quad));
-			*vcount += 6;
+			GLfloat *dst = &inst[*count * TEXT_INSTANCE_FLOATS];
+			dst[0] = dx + font->ft_char[g].bearing_x;
+			dst[1] = dy - font->ft_char[g].bearing_y + font->ft_char['H'].size_y;
+			dst[2] = font->ft_char[g].size_x;
+			dst[3] = font->ft_char[g].size_y;
+			dst[4] = font->ft_char[g].atlas_x / aw;
+			dst[5] = font->ft_char[g].atlas_y / ah;
+			dst[6] = (font->ft_char[g].atlas_x + font->ft_char[g].size_x) / aw;
+			dst[7] = (font->ft_char[g].atlas_y + font->ft_char[g].size_y) / ah;
+			(*count)++;
 		}
 
 		/* Advance the cursor to the start of the next character */
-		fx += (font->ft_char[g].advance / 64);
+		dx += (font->ft_char[g].advance / 64);
 	}
 }
 
-void uv_ui_draw_string_impl(char *str, ui_font_st *font,
-		int16_t x, int16_t y, ui_align_e align, color_t color) {
-	if ((str == NULL) || (font == NULL)) {
-		return;
-	}
-	size_t len = strlen(str);
-	if (len == 0) {
-		return;
-	}
 
-	// The text shader program is created once at start-up and never rebuilt, so
-	// its attribute/uniform locations are stable; look them up only on the first
-	// call rather than for every string (the -2 sentinel means "not yet queried").
-	static GLint uniform_tex = -2;
-	static GLint uniform_color = -1;
-	static GLint attribute_coord = -1;
-	if (uniform_tex == -2) {
-		uniform_tex = get_uniform(this->text_shader_program, "tex");
-		uniform_color = get_uniform(this->text_shader_program, "color");
-		attribute_coord = get_attrib(this->text_shader_program, "coord");
-		if (uniform_tex == -1 || uniform_color == -1 || attribute_coord == -1) {
-			printf("ERROR loading OPENGL text shader program\n");
+/// @brief: Lays *str* out and stores it in the cache, in place of the layout
+/// used least recently. Returns NULL if there was no memory for it.
+static text_layout_st *text_cache_add(const char *str, uint32_t hash,
+		ui_font_st *font, ui_align_e align) {
+	text_layout_st *l = &this->text.layouts[0];
+	for (uint32_t i = 1; i < CONFIG_UI_OPENGL_TEXT_CACHE; i++) {
+		if (l->str == NULL) {
+			break;
+		}
+		else if ((this->text.layouts[i].str == NULL) ||
+				(this->text.layouts[i].used < l->used)) {
+			l = &this->text.layouts[i];
+		}
+		else {
 		}
 	}
+	text_layout_free(l);
 
-	// working copy so each line can be null-terminated in place
-	char *s = malloc(len + 2);
-	if (s == NULL) {
-		return;
+	size_t len = strlen(str);
+	// at most one glyph instance per byte
+	char *lines = malloc(len + 1);
+	GLfloat *inst = malloc((len + 1) * TEXT_INSTANCE_FLOATS * sizeof(GLfloat));
+	l->str = malloc(len + 1);
+	if ((lines == NULL) || (inst == NULL) || (l->str == NULL)) {
+		free(l->str);
+		l->str = NULL;
+		l = NULL;
 	}
-	memcpy(s, str, len + 1);
-
-	// count the lines once (the original re-ran strlen() every loop iteration,
-	// which is O(n^2) over the string length)
-	uint16_t line_count = 1;
-	for (size_t i = 0; i < len; i++) {
-		if (str[i] == '\n') {
-			line_count++;
+	else {
+		memcpy(l->str, str, len + 1);
+		l->hash = hash;
+		l->font = font;
+		l->align = align;
+		l->width = text_width(str, font);
+		l->used = ++this->text.clock;
+		l->count = 0;
+
+		// count the lines once
+		uint16_t line_count = 1;
+		for (size_t i = 0; i < len; i++) {
+			if (str[i] == '\n') {
+				line_count++;
+			}
+		}
+		// the offsets are in application pixels until scaled for each glyph
+		int16_t y = 0;
+		if (align & VALIGN_CENTER) {
+			// reduce the y by the number of line counts
+			y -= (line_count * font->char_height / 2);
 		}
-	}
-	if (align & VALIGN_CENTER) {
-		// reduce the y by the number of line counts
-		y -= (line_count * font->char_height / 2);
-	}
 
-	// Accumulate every glyph of the whole (possibly multi-line) string into a
-	// single vertex batch, then submit it with one texture bind and one draw call.
-	// Upper bound: 6 vertices per byte, 4 floats each (glyph count <= byte count).
-	GLfloat *verts = malloc((size_t) len * 6 * 4 * sizeof(GLfloat));
-	if (verts == NULL) {
-		free(s);
-		return;
-	}
-	size_t vcount = 0;
-
-	char *last_s = s;
-	for (size_t i = 0; i <= len; i++) {
-		if (s[i] == '\r' || s[i] == '\n' || s[i] == '\0') {
-			char sep = s[i];
-			s[i] = '\0';
-
-			// lay out one line at a time (kept identical to the original: empty
-			// lines are skipped and do not advance the baseline)
-			if (last_s[0] != '\0') {
-				int16_t lx = x;
-				int32_t str_width = uv_ui_get_string_width(last_s, font);
-				if (align & HALIGN_CENTER) {
-					lx -= str_width / 2;
-				}
-				else if (align & HALIGN_RIGHT) {
-					lx -= str_width;
+		// working copy so each line can be null-terminated in place
+		char *s = lines;
+		memcpy(s, str, len + 1);
+		char *last_s = s;
+		for (size_t i = 0; i <= len; i++) {
+			if (s[i] == '\r' || s[i] == '\n' || s[i] == '\0') {
+				char sep = s[i];
+				s[i] = '\0';
+
+				// lay out one line at a time: empty lines are skipped and do
+				// not advance the baseline
+				if (last_s[0] != '\0') {
+					int16_t lx = 0;
+					int32_t str_width = text_width(last_s, font) / this->scalex;
+					if (align & HALIGN_CENTER) {
+						lx -= str_width / 2;
+					}
+					else if (align & HALIGN_RIGHT) {
+						lx -= str_width;
+					}
+					else {
+						// left-aligned: the pen starts at x
+					}
+					/* Translate the UTF-8 line into single-byte font glyph
+					 * slots so the Nordic letters map to their loaded glyphs
+					 * (see uv_ui_str_to_glyphs). */
+					// the simulator always loads the Nordic glyphs from
+					// FreeType, so they are available (nordic_glyphs = true)
+					char line_glyphs[strlen(last_s) + 1];
+					uv_ui_str_to_glyphs(last_s, line_glyphs,
+							sizeof(line_glyphs), true);
+					append_line_glyphs(line_glyphs, font, lx * this->scalex,
+							y * this->scaley, inst, &l->count);
+					y += font->char_height;
 				}
-				else {
-					// left-aligned: the pen starts at x
+				last_s = &s[i + 1];
+				if (sep == '\0') {
+					break;
 				}
-				append_line_verts(last_s, font, lx, y, verts, &vcount);
-				y += font->char_height;
-			}
-			last_s = &s[i + 1];
-			if (sep == '\0') {
-				break;
 			}
 		}
+
+		glGenBuffers(1, &l->vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, l->vbo);
+		glBufferData(GL_ARRAY_BUFFER,
+				MAX(l->count, 1) * TEXT_INSTANCE_FLOATS * sizeof(GLfloat), inst,
+				GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	free(inst);
+	free(lines);
+	return l;
+}
+
+
+void uv_ui_draw_string_impl(char *str, ui_font_st *font,
+		int16_t x, int16_t y, ui_align_e align, color_t color) {
+	if ((str == NULL) || (font == NULL) || (str[0] == '\0')) {
+		return;
 	}
 
-	if (vcount > 0) {
-		glUseProgram(this->text_shader_program);
+	uint32_t hash = text_hash(str);
+	text_layout_st *l = text_cache_find(str, hash, font, align, false);
+	if (l == NULL) {
+		l = text_cache_add(str, hash, font, align);
+		this->stats.layouts++;
+	}
+	else {
+	}
+
+	if ((l != NULL) && (l->count > 0)) {
+		stats_frame_begin();
+		batch_flush();
+		glUseProgram(this->text.program);
 
 		color_st col = uv_uic(color);
-		GLfloat c[4] = { col.r / 255.0f, col.g / 255.0f,
-				col.b / 255.0f, col.a / 255.0f };
-		glUniform4fv(uniform_color, 1, c);
+		glUniform4f(this->text.uniform_color, col.r / 255.0f, col.g / 255.0f,
+				col.b / 255.0f, col.a / 255.0f);
+		// coordinates are in application space, and since uv_ui uses fixed
+		// window size, we resize these accordingly
+		glUniform2f(this->text.uniform_origin, x * this->scalex, y * this->scaley);
+		glUniform2f(this->text.uniform_viewport, this->width, this->height);
 
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, font->atlas_tex);
-		glUniform1i(uniform_tex, 0);
-
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glEnableVertexAttribArray(attribute_coord);
-		glBindBuffer(GL_ARRAY_BUFFER, this->text_vbo);
-		glBufferData(GL_ARRAY_BUFFER, vcount * 4 * sizeof(GLfloat), verts,
-				GL_DYNAMIC_DRAW);
-		glVertexAttribPointer(attribute_coord, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
-		glDrawArrays(GL_TRIANGLES, 0, (GLsizei) vcount);
+		glUniform1i(this->text.uniform_tex, 0);
+
+		glBindVertexArray(this->text.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, l->vbo);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE,
+				TEXT_INSTANCE_FLOATS * sizeof(GLfloat), (void*) 0);
+		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE,
+				TEXT_INSTANCE_FLOATS * sizeof(GLfloat), (void*) (4 * sizeof(GLfloat)));
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei) l->count);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+		this->stats.draw_calls++;
+		this->stats.vertices += l->count * 6;
 
-		glDisableVertexAttribArray(attribute_coord);
 		glUseProgram(0);
 	}
-
-	free(verts);
-	free(s);
 }
 
 
 void uv_ui_draw_polygon_impl(const uv_ui_linestrip_point_st *points,
 		const uint16_t point_count, const color_t color) {
 	if (point_count >= 3) {
-		color_st c = uv_uic(color);
-		glColor4ub(c.r, c.g, c.b, c.a);
 		// a triangle fan fills a convex polygon (apex = first point) exactly,
 		// with true straight edges between the perimeter points
-		glBegin(GL_TRIANGLE_FAN);
+		batch_fan_begin(color);
 		for (uint16_t i = 0; i < point_count; i++) {
-			glVertex2i(points[i].x, points[i].y);
+			batch_fan_vertex(points[i].x, points[i].y);
 		}
-		glEnd();
 	}
 }
 
@@ -1069,6 +1379,7 @@ void uv_ui_set_mask_impl(int16_t x, int16_t y, int16_t width, int16_t height) {
 	int32_t sw = (int32_t) (width * this->scalex);
 	int32_t sh = (int32_t) (height * this->scaley);
 	int32_t sy = (int32_t) (this->height - (int32_t)(y + height) * this->scaley);
+	batch_flush();
 	glEnable(GL_SCISSOR_TEST);
 	glScissor(sx, sy, sw, sh);
 }
@@ -1076,6 +1387,11 @@ void uv_ui_set_mask_impl(int16_t x, int16_t y, int16_t width, int16_t height) {
 
 
 void uv_ui_force_mask(int16_t x, int16_t y, int16_t width, int16_t height) {
+#if CONFIG_UI_WINDOW_CACHE
+	// bypasses the recorded uv_ui_set_mask
+	uv_ui_record_spoil();
+#endif
+	batch_flush();
 	// stencil test is used for masking objects
 	glEnable(GL_STENCIL_TEST);
 	glClearStencil(0);
@@ -1106,23 +1422,10 @@ void uv_ui_force_mask(int16_t x, int16_t y, int16_t width, int16_t height) {
 
 int16_t uv_ui_get_string_width(char *str, ui_font_st *font) {
 	int16_t ret = 0;
-	int line_width = 0;
 	if (str) {
-		const char *p = str;
-		while (*p != '\0') {
-			uint32_t cp = uv_ui_utf8_next(&p);
-			if (cp == '\n' ||
-					cp == '\r') {
-				line_width = 0;
-			}
-			else {
-				uint8_t glyph = uv_ui_codepoint_glyph(cp, true);
-				line_width += font->ft_char[glyph].advance / 64;
-				if (line_width > ret) {
-					ret = line_width;
-				}
-			}
-		}
+		// a string drawn already has its width stored with its layout
+		text_layout_st *l = text_cache_find(str, text_hash(str), font, 0, true);
+		ret = (l != NULL) ? l->width : text_width(str, font);
 	}
 
 	return (ret / this->scalex);
@@ -1244,6 +1547,13 @@ uint32_t uv_uimedia_newbitmapexmem_mem(uv_uimedia_st *bitmap,
 }
 
 
+void uv_uimedia_newbitmapexmem_async(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename) {
+	// loading takes nothing from the display here
+	uv_uimedia_newbitmapexmem(bitmap, exmem, filename);
+}
+
+
 void uv_uimedia_free(uv_uimedia_st *bitmap) {
 #if CONFIG_UI_REMOTE
 	// abandon any transfer of an image that is going away
@@ -1263,17 +1573,34 @@ void uv_ui_touchscreen_set_transform_matrix(ui_transfmat_st *transform_matrix) {
 void uv_ui_dlswap_impl(void) {
 	if (this->window) {
 		if (!glfwWindowShouldClose(this->window)) {
-
-
-		    double time1 = glfwGetTime();
+			batch_flush();
+			// the time the frame took to draw, from its first drawing call
+			double time1 = glfwGetTime();
+			if (this->stats.drawing) {
+				this->stats.frame_time += time1 - this->stats.frame_start;
+				this->stats.drawing = false;
+			}
+			else {
+			}
+			this->stats.frames++;
+			if (this->stats.enabled &&
+					(time1 - this->stats.print_time >= 1.0)) {
+				printf("ui: %u frames, %.2f ms, %u draw calls, %u vertices, "
+						"%u strings laid out per frame\n",
+						this->stats.frames,
+						this->stats.frame_time * 1000 / this->stats.frames,
+						this->stats.draw_calls / this->stats.frames,
+						this->stats.vertices / this->stats.frames,
+						this->stats.layouts / this->stats.frames);
+				this->stats.frames = 0;
+				this->stats.layouts = 0;
+				this->stats.frame_time = 0;
+				this->stats.draw_calls = 0;
+				this->stats.vertices = 0;
+				this->stats.print_time = time1;
+			}
 			// Swap front and back buffers
 			glfwSwapBuffers(this->window);
-		    double time2 = glfwGetTime();
-		    double fps = (time2 - time1);
-		    if (fps != 0) {
-		    	fps = 1 / fps;
-		    }
-//		    printf("fps %f\n", fps);
 
 			glClearStencil(1);
 		    // clear the full back buffer, not just the last mask rectangle
@@ -1371,33 +1698,35 @@ static void key_callback(GLFWwindow* window,
 			// shift/caps/layout are applied correctly by GLFW.
 			return;
 		}
-		taskENTER_CRITICAL();
-		uv_ring_buffer_push(&this->key_press, &c);
-		taskEXIT_CRITICAL();
+		uv_ui_input_push(UI_INPUT_KEY, 0, 0, (int16_t) (uint8_t) c);
 	}
 }
 
 static void char_callback(GLFWwindow* window, unsigned int codepoint) {
 	if (codepoint < 0x80) {
-		char c = (char) codepoint;
-		taskENTER_CRITICAL();
-		uv_ring_buffer_push(&this->key_press, &c);
-		taskEXIT_CRITICAL();
+		uv_ui_input_push(UI_INPUT_KEY, 0, 0, (int16_t) codepoint);
 	}
 }
 
 static void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
 	this->x = (int) xpos / this->scalex;
 	this->y = (int) ypos / this->scaley;
+	if (this->pressed) {
+		uv_ui_input_push(UI_INPUT_TOUCH, (int16_t) this->x, (int16_t) this->y, 0);
+	}
 }
 
 static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
 	this->pressed = (action == GLFW_PRESS);
+	uv_ui_input_push(this->pressed ? UI_INPUT_TOUCH : UI_INPUT_RELEASE,
+			(int16_t) this->x, (int16_t) this->y, 0);
 }
 
 static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
-	// accumulate vertical wheel notches; drained by uv_ui_get_scroll()
-	this->scroll += (int32_t) yoffset;
+	// vertical wheel notches, positive away from the user
+	if ((int16_t) yoffset != 0) {
+		uv_ui_input_push(UI_INPUT_SCROLL, 0, 0, (int16_t) yoffset);
+	}
 }
 
 
@@ -1599,6 +1928,7 @@ static void load_fonts(void) {
 }
 
 static void free_fonts(void) {
+	text_cache_clear();
 	ui_font_st *arrays[2] = { ui_fonts, ui_mono_fonts };
 	for (uint32_t a = 0; a < 2; a++) {
 		for (uint32_t i = 0; i < UI_MAX_FONT_COUNT; i++) {
@@ -1619,20 +1949,37 @@ static void free_fonts(void) {
 // A matching file under shaders/ still takes precedence, allowing per-project
 // overrides during development.
 static const char *const text_shader_vs_src =
-		"attribute vec4 coord;\n"
-		"varying vec2 texpos;\n"
+		"#version 330 core\n"
+		"// a corner of the unit quad, and the glyph instance it is drawn for\n"
+		"layout (location = 0) in vec2 corner;\n"
+		"layout (location = 1) in vec4 rect;\n"
+		"layout (location = 2) in vec4 atlas;\n"
 		"\n"
-		"void main(void) {\n"
-		"  gl_Position = vec4(coord.xy, 0, 1);\n"
-		"  texpos = coord.zw;\n"
+		"// the string's origin and the window size, in window pixels\n"
+		"uniform vec2 origin;\n"
+		"uniform vec2 viewport;\n"
+		"\n"
+		"out vec2 texpos;\n"
+		"\n"
+		"void main()\n"
+		"{\n"
+		"    vec2 p = origin + rect.xy + corner * rect.zw;\n"
+		"    gl_Position = vec4(p.x * 2.0 / viewport.x - 1.0,\n"
+		"            1.0 - p.y * 2.0 / viewport.y, 0.0, 1.0);\n"
+		"    texpos = mix(atlas.xy, atlas.zw, corner);\n"
 		"}\n";
 static const char *const text_shader_fs_src =
-		"varying vec2 texpos;\n"
+		"#version 330 core\n"
+		"out vec4 FragColor;\n"
+		"\n"
+		"in vec2 texpos;\n"
+		"\n"
 		"uniform sampler2D tex;\n"
 		"uniform vec4 color;\n"
 		"\n"
-		"void main(void) {\n"
-		"  gl_FragColor = vec4(1, 1, 1, texture2D(tex, texpos).a) * color;\n"
+		"void main()\n"
+		"{\n"
+		"    FragColor = vec4(1, 1, 1, texture(tex, texpos).a) * color;\n"
 		"}\n";
 static const char *const bitmap_shader_vs_src =
 		"#version 330 core\n"
@@ -1744,15 +2091,6 @@ static GLint get_uniform(GLuint shader_program, const char *name) {
 }
 
 
-static GLint get_attrib(GLuint shader_program, const char *name) {
-	GLint attribute = glGetAttribLocation(shader_program, name);
-	if (attribute == -1) {
-		printf("ERROR: Could not bind attribute %s\n", name);
-	}
-	return attribute;
-}
-
-
 bool uv_ui_init(void) {
 	bool ret = true;
 	this->refresh = false;
@@ -1767,19 +2105,20 @@ bool uv_ui_init(void) {
 	this->yoffset = 0;
 	this->width = CONFIG_FT81X_HSIZE;
 	this->height = CONFIG_FT81X_VSIZE;
-	this->text_shader_program = 0;
-	this->text_vbo = 0;
+	memset(&this->text, 0, sizeof(this->text));
+	this->batch.verts = NULL;
+	this->batch.count = 0;
+	this->batch.size = 0;
+	this->batch.vbo = 0;
+	memset(&this->stats, 0, sizeof(this->stats));
+	this->stats.enabled = (getenv("UV_UI_STATS") != NULL);
+	init_unit_circle();
 
 	// initialize the font sizes
 	for (uint32_t i = 0; i < UI_MAX_FONT_COUNT; i++) {
 		ui_fonts[i].char_height = font_sizes[i];
 		ui_mono_fonts[i].char_height = font_sizes[i];
 	}
-	// initialize the key press buffer
-	uv_ring_buffer_init(&this->key_press, this->key_press_buffer,
-			sizeof(this->key_press_buffer) / sizeof(this->key_press_buffer[0]),
-			sizeof(this->key_press_buffer[0]));
-
 	printf("Initializing GLFW\n");
 	fflush(stdout);
 	if (!glfwInit()) {
@@ -1844,11 +2183,34 @@ bool uv_ui_init(void) {
 
 				load_fonts();
 
-				this->text_shader_program = load_shader_program(
-						"shaders/text_shader.vs", text_shader_vs_src,
-						"shaders/text_shader.ts", text_shader_fs_src);
-				// Create the vertex buffer object
-				glGenBuffers(1, &this->text_vbo);
+				this->text.program = load_shader_program(
+						"shaders/text_glyph_shader.vs", text_shader_vs_src,
+						"shaders/text_glyph_shader.ts", text_shader_fs_src);
+				this->text.uniform_tex = get_uniform(this->text.program, "tex");
+				this->text.uniform_color = get_uniform(this->text.program, "color");
+				this->text.uniform_origin = get_uniform(this->text.program, "origin");
+				this->text.uniform_viewport = get_uniform(this->text.program, "viewport");
+				// the unit quad every glyph is an instance of. The instance
+				// attributes are pointed to each string's own buffer as it is drawn.
+				static const GLfloat quad[6][2] = {
+						{ 0, 0 }, { 1, 0 }, { 0, 1 },
+						{ 1, 0 }, { 1, 1 }, { 0, 1 }
+				};
+				glGenVertexArrays(1, &this->text.vao);
+				glBindVertexArray(this->text.vao);
+				glGenBuffers(1, &this->text.quad_vbo);
+				glBindBuffer(GL_ARRAY_BUFFER, this->text.quad_vbo);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+				glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*) 0);
+				glEnableVertexAttribArray(0);
+				glEnableVertexAttribArray(1);
+				glVertexAttribDivisor(1, 1);
+				glEnableVertexAttribArray(2);
+				glVertexAttribDivisor(2, 1);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				glBindVertexArray(0);
+				glGenBuffers(1, &this->batch.vbo);
+				this->stats.print_time = glfwGetTime();
 
 				this->bitmap_shader_program = load_shader_program(
 						"shaders/bitmap_shader.vs", bitmap_shader_vs_src,
@@ -1874,6 +2236,10 @@ bool uv_ui_init(void) {
 
 void uv_ui_destroy(void) {
 	free_fonts();
+	free(this->batch.verts);
+	this->batch.verts = NULL;
+	this->batch.size = 0;
+	this->batch.count = 0;
 
 	if (this->uimediall != NULL) {
 		uimedia_ll_st *m = this->uimediall;
@@ -98,14 +98,12 @@ typedef struct {
 	bool pressed;
 	int32_t x;
 	int32_t y;
-	// accumulated mouse-wheel notches since the last uv_ui_get_scroll()
-	int32_t scroll;
 	double scalex;
 	double scaley;
 	uimedia_ll_st *uimediall;
-	uv_ring_buffer_st key_press;
-	char key_press_buffer[20];
 	uint8_t brightness;
+	// set when the window lost its contents and has to be drawn whole
+	bool refresh;
 
 	// configuration window that is shown when setting the settings
 	struct {
@@ -283,13 +281,22 @@ uint8_t uv_ui_get_backlight(void) {
 
 
 bool uv_ui_get_refresh_request(void) {
-	return false;
+	bool ret = this->refresh;
+	this->refresh = false;
+	return ret;
 }
 
 
-bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
-	bool ret;
+bool uv_ui_frame_preserved_impl(void) {
+	// each frame is drawn into a group painted over the window, so what a
+	// frame does not draw stays as it was
+	return true;
+}
+
 
+/// @brief: Handles the X events waiting, pushing the input into the UI
+/// input queue
+static void pump_events(void) {
 	while (XPending(cairo_xlib_surface_get_display(this->surface))) {
 		XEvent e;
 		XNextEvent(cairo_xlib_surface_get_display(this->surface), &e);
@@ -300,15 +307,15 @@ bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
 				this->pressed = true;
 				this->x = (int16_t) e.xbutton.x;
 				this->y = (int16_t) e.xbutton.y;
-//				printf("%i %i\n", this->x, this->y);
+				uv_ui_input_push(UI_INPUT_TOUCH, this->x, this->y, 0);
 			}
 			else if (e.xbutton.button == 4) {
 				// mouse wheel up
-				this->scroll += 1;
+				uv_ui_input_push(UI_INPUT_SCROLL, 0, 0, 1);
 			}
 			else if (e.xbutton.button == 5) {
 				// mouse wheel down
-				this->scroll -= 1;
+				uv_ui_input_push(UI_INPUT_SCROLL, 0, 0, -1);
 			}
 			else {
 				// other buttons unused
@@ -319,12 +326,14 @@ bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
 				this->pressed = false;
 				this->x = (int16_t) e.xbutton.x;
 				this->y = (int16_t) e.xbutton.y;
+				uv_ui_input_push(UI_INPUT_RELEASE, this->x, this->y, 0);
 			}
 			break;
 		case MotionNotify:
 			this->pressed = true;
 			this->x = (int16_t) e.xmotion.x;
 			this->y = (int16_t) e.xmotion.y;
+			uv_ui_input_push(UI_INPUT_TOUCH, this->x, this->y, 0);
 			break;
 		case KeyPress: {
 			int count = 0;
@@ -337,7 +346,7 @@ bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
 				printf("BufferOverflow\n");
 			}
 			for (uint32_t i = 0; i < count; i++) {
-				uv_ring_buffer_push(&this->key_press, &buf[i]);
+				uv_ui_input_push(UI_INPUT_KEY, 0, 0, (int16_t) (uint8_t) buf[i]);
 			}
 
 			break;
@@ -351,8 +360,13 @@ bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
 			ch = CONFIG_FT81X_VSIZE;
 			this->scalex = (double) ww / (double) cw,
 			this->scaley = (double) wh / (double) ch;
+			this->refresh = true;
 			break;
 		}
+		case Expose:
+			// uncovered: X does not keep what was drawn there
+			this->refresh = true;
+			break;
 		case 65:
 			// unknown event 65
 			break;
@@ -361,6 +375,13 @@ bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
 			break;
 		}
 	}
+}
+
+
+bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
+	bool ret;
+
+	pump_events();
 
 	ret = this->pressed;
 	*x = this->x;
@@ -370,10 +391,8 @@ bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
 }
 
 
-int16_t uv_ui_get_scroll(void) {
-	int16_t ret = (int16_t) this->scroll;
-	this->scroll = 0;
-	return ret;
+void uv_ui_input_poll_impl(void) {
+	pump_events();
 }
 
 
@@ -385,20 +404,6 @@ const char *uv_ui_get_clipboard(void) {
 }
 
 
-char uv_ui_peek_key_press(void) {
-	char ret = '\0';
-	uv_ring_buffer_peek(&this->key_press, &ret);
-	return ret;
-}
-
-
-char uv_ui_get_key_press(void) {
-	char ret = '\0';
-	uv_ring_buffer_pop(&this->key_press, &ret);
-	return ret;
-}
-
-
 
 void uv_ui_clear_impl(color_t col) {
 	color_st c = uv_uic(col);
@@ -651,6 +656,10 @@ void uv_ui_draw_string_impl(char *str, ui_font_st *font,
 
 
 void uv_ui_force_mask(int16_t x, int16_t y, int16_t width, int16_t height) {
+#if CONFIG_UI_WINDOW_CACHE
+	// bypasses the recorded uv_ui_set_mask
+	uv_ui_record_spoil();
+#endif
 	uv_ui_set_mask_impl(x, y, width, height);
 }
 
@@ -753,6 +762,13 @@ uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
 }
 
 
+void uv_uimedia_newbitmapexmem_async(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename) {
+	// loading takes nothing from the display here
+	uv_uimedia_newbitmapexmem(bitmap, exmem, filename);
+}
+
+
 void uv_uimedia_free(uv_uimedia_st *bitmap) {
 	memset(bitmap, 0, sizeof(*bitmap));
 }
@@ -809,7 +825,7 @@ bool uv_ui_init(void) {
 	da = XCreateSimpleWindow(dsp, DefaultRootWindow(dsp), 0, 0,
 			CONFIG_FT81X_HSIZE, CONFIG_FT81X_VSIZE, 0, 0, 0);
 	XSelectInput(dsp, da, ButtonPressMask | ButtonReleaseMask |
-			Button1MotionMask | KeyPressMask | ResizeRedirectMask);
+			Button1MotionMask | KeyPressMask | ResizeRedirectMask | ExposureMask);
 	XStoreName(dsp, da, uv_projname);
 	XMapWindow(dsp, da);
 
@@ -841,11 +857,6 @@ bool uv_ui_init(void) {
 		ui_fonts[i].char_height = font_sizes[i];
 		ui_mono_fonts[i].char_height = font_sizes[i];
 	}
-	// initialize the key press buffer
-	uv_ring_buffer_init(&this->key_press, this->key_press_buffer,
-			sizeof(this->key_press_buffer) / sizeof(this->key_press_buffer[0]),
-			sizeof(this->key_press_buffer[0]));
-
 	return false;
 }
 
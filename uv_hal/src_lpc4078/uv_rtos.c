@@ -250,7 +250,7 @@ void vApplicationMallocFailedHook(void)
 void vApplicationIdleHook(void)
 {
 	if (this->idle_task) {
-		this->idle_task(__uv_get_user_ptr());
+		UV_CPUTIME_STEP(CPUTIME_IDLE_TASK, this->idle_task(__uv_get_user_ptr()));
 
 	}
 }
@@ -283,6 +283,9 @@ void vApplicationTickHook(void) {
 void uv_init(void *device) {
 	uv_set_application_ptr(device);
 	uv_mutex_init(&halmutex);
+#if CONFIG_CPUTIME
+	uv_cputime_init();
+#endif
 
 #if CONFIG_UV_BOOTLOADER
 	// if uv_bootloader is used, remap vector table to point to the new location
@@ -403,19 +406,25 @@ void hal_task(void *nullptr) {
 		uv_ts_step(&ts);
 
 		_uv_rtos_halmutex_lock();
+#if CONFIG_CPUTIME
+		uint32_t step_start = uv_cputime_begin();
+#endif
 
 #if CONFIG_CAN
-		_uv_can_hal_step(uv_ts_get_step_ms(&ts));
+		UV_CPUTIME_STEP(CPUTIME_HAL_CAN, _uv_can_hal_step(uv_ts_get_step_ms(&ts)));
 #endif
 
 #if CONFIG_UART
-		_uv_uart_hal_step(uv_ts_get_step_ms(&ts));
+		UV_CPUTIME_STEP(CPUTIME_HAL_UART, _uv_uart_hal_step(uv_ts_get_step_ms(&ts)));
 #endif
 
 #if CONFIG_TERMINAL_CAN
-		_uv_stdout_hal_step(uv_ts_get_step_ms(&ts));
+		UV_CPUTIME_STEP(CPUTIME_HAL_STDOUT, _uv_stdout_hal_step(uv_ts_get_step_ms(&ts)));
 #endif
 
+#if CONFIG_CPUTIME
+		uv_cputime_end(CPUTIME_HAL_STEP, step_start);
+#endif
 		_uv_rtos_halmutex_unlock();
 
 		uv_rtos_task_delay(step_ms);
@@ -435,7 +444,7 @@ void canopen_task(void *nullptr) {
 #if CONFIG_CANOPEN
 		uv_ts_step(&ts);
 
-		_uv_canopen_step(uv_ts_get_step_ms(&ts));
+		UV_CPUTIME_STEP(CPUTIME_HAL_CANOPEN, _uv_canopen_step(uv_ts_get_step_ms(&ts)));
 #endif
 		uv_rtos_task_delay(step_ms);
 	}
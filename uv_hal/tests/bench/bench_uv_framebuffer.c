@@ -0,0 +1,118 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_bench.h"
+#include "uv_framebuffer.h"
+
+/// @file: Fills and copies of an 800x480 framebuffer, the size of the
+/// LPC4078 panels, next to the pixel at a time fills uv_lcd used before.
+///
+/// A full screen clear and a panel half the screen wide are what the UI
+/// draws most; the panel is filled a row at a time since it is narrower than
+/// the framebuffer.
+
+
+#define FB_W		800
+#define FB_H		480
+
+static uint16_t fb16[FB_H][FB_W];
+static uint32_t fb32[FB_H][FB_W];
+static uint16_t image[FB_H / 2][FB_W / 2];
+
+
+BENCH(framebuffer, clear16_scalar) {
+	uv_bench_set_bytes(b, sizeof(fb16));
+	for (uint32_t i = 0; i < b->n; i++) {
+		for (uint32_t y = 0; y < FB_H; y++) {
+			uv_fb_fill16_scalar(fb16[y], (uint16_t) i, FB_W);
+		}
+		UV_BENCH_KEEP(fb16[FB_H - 1][FB_W - 1]);
+	}
+}
+
+
+BENCH(framebuffer, clear16) {
+	uv_bench_set_bytes(b, sizeof(fb16));
+	for (uint32_t i = 0; i < b->n; i++) {
+		uv_fb_fill_rect16(&fb16[0][0], FB_W, FB_W, FB_H, (uint16_t) i);
+		UV_BENCH_KEEP(fb16[FB_H - 1][FB_W - 1]);
+	}
+}
+
+
+BENCH(framebuffer, panel16_scalar) {
+	uv_bench_set_bytes(b, sizeof(fb16) / 4);
+	for (uint32_t i = 0; i < b->n; i++) {
+		for (uint32_t y = FB_H / 4; y < (FB_H * 3 / 4); y++) {
+			uv_fb_fill16_scalar(&fb16[y][FB_W / 4 + 1], (uint16_t) i, FB_W / 2);
+		}
+		UV_BENCH_KEEP(fb16[FB_H / 2][FB_W / 2]);
+	}
+}
+
+
+BENCH(framebuffer, panel16) {
+	uv_bench_set_bytes(b, sizeof(fb16) / 4);
+	for (uint32_t i = 0; i < b->n; i++) {
+		// a pixel off the word alignment, as most panels are
+		uv_fb_fill_rect16(&fb16[FB_H / 4][FB_W / 4 + 1], FB_W,
+				FB_W / 2, FB_H / 2, (uint16_t) i);
+		UV_BENCH_KEEP(fb16[FB_H / 2][FB_W / 2]);
+	}
+}
+
+
+BENCH(framebuffer, clear32_scalar) {
+	uv_bench_set_bytes(b, sizeof(fb32));
+	for (uint32_t i = 0; i < b->n; i++) {
+		for (uint32_t y = 0; y < FB_H; y++) {
+			uv_fb_fill32_scalar(fb32[y], i, FB_W);
+		}
+		UV_BENCH_KEEP(fb32[FB_H - 1][FB_W - 1]);
+	}
+}
+
+
+BENCH(framebuffer, clear32) {
+	uv_bench_set_bytes(b, sizeof(fb32));
+	for (uint32_t i = 0; i < b->n; i++) {
+		uv_fb_fill_rect32(&fb32[0][0], FB_W, FB_W, FB_H, i);
+		UV_BENCH_KEEP(fb32[FB_H - 1][FB_W - 1]);
+	}
+}
+
+
+BENCH(framebuffer, blit16_quarter_screen) {
+	uv_bench_set_bytes(b, sizeof(image));
+	for (uint32_t i = 0; i < b->n; i++) {
+		image[0][0] = (uint16_t) i;
+		uv_fb_blit(&fb16[FB_H / 4][FB_W / 4], sizeof(fb16[0]),
+				image, sizeof(image[0]), sizeof(image[0]), FB_H / 2);
+		UV_BENCH_KEEP(fb16[FB_H / 4][FB_W / 4]);
+	}
+}
@@ -0,0 +1,249 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_bench.h"
+#include "uv_remote_stream.h"
+
+#include <string.h>
+
+/// @file: Throughput of the REMOTE framer.
+///
+/// On the desktop sink one MQTT payload carries a whole REMOTE_PACK_MAX_LEN of
+/// messages and remote_stream_feed() is the loop every one of them goes through,
+/// so these feed full payloads the way the sink does.
+
+
+static uint32_t message_count;
+
+static void count_callb(void *user, remote_msg_types_e type,
+		const uint8_t *data, uint8_t len) {
+	message_count++;
+	UV_BENCH_KEEP(data[len - 1]);
+}
+
+
+/// @brief: Packs CAN messages of mixed length into *pack* until it is full,
+/// the way the device packs forwarded frames into one publish
+static void pack_can(remote_pack_st *pack) {
+	remote_pack_clear(pack);
+	for (uint32_t i = 0; ; i++) {
+		uv_can_msg_st msg = {
+				.id = 0x180 + (i % 0x7F),
+				.type = CAN_STD,
+				.data_length = (uint8_t) (i % 9)
+		};
+		for (uint8_t j = 0; j < 8; j++) {
+			msg.data_8bit[j] = (uint8_t) (i + j);
+		}
+		uint8_t frame[REMOTE_MSG_TYPE_CAN_MAX_LEN];
+		remote_can_msg_encode(&msg, frame);
+		if (!remote_pack_append(pack, frame, REMOTE_MSG_TYPE_CAN_LEN(msg.data_length))) {
+			break;
+		}
+	}
+}
+
+
+BENCH(remote_stream, feed_packed_can_payload) {
+	static remote_pack_st pack;
+	static remote_stream_st stream;
+	pack_can(&pack);
+	remote_stream_reset(&stream);
+	uv_bench_set_bytes(b, pack.len);
+
+	message_count = 0;
+	for (uint32_t i = 0; i < b->n; i++) {
+		remote_stream_feed(&stream, pack.buf, pack.len, &count_callb, NULL);
+	}
+	uv_bench_report(b, "msgs/payload", (double) message_count / b->n);
+}
+
+
+BENCH(remote_stream, feed_packed_can_payload_in_16_byte_chunks) {
+	static remote_pack_st pack;
+	static remote_stream_st stream;
+	pack_can(&pack);
+	remote_stream_reset(&stream);
+	uv_bench_set_bytes(b, pack.len);
+
+	for (uint32_t i = 0; i < b->n; i++) {
+		for (uint16_t j = 0; j < pack.len; j += 16) {
+			uint16_t len = ((pack.len - j) < 16) ? (pack.len - j) : 16;
+			remote_stream_feed(&stream, &pack.buf[j], len, &count_callb, NULL);
+		}
+	}
+}
+
+
+BENCH(remote_stream, feed_ui_chunks) {
+	static uint8_t payload[REMOTE_PACK_MAX_LEN * 4];
+	static remote_stream_st stream;
+	uint16_t len = 0;
+	while ((len + REMOTE_UI_MSG_MAX_LEN) <= sizeof(payload)) {
+		payload[len] = REMOTE_MSG_START_BYTE;
+		payload[len + 1] = REMOTE_MSG_TYPE_UI;
+		payload[len + 2] = REMOTE_UI_CHUNK_MAX_LEN;
+		payload[len + 3] = 0;
+		for (uint16_t j = 0; j < REMOTE_UI_CHUNK_MAX_LEN; j++) {
+			payload[len + 4 + j] = (uint8_t) j;
+		}
+		len += REMOTE_UI_MSG_MAX_LEN;
+	}
+	remote_stream_reset(&stream);
+	uv_bench_set_bytes(b, len);
+
+	for (uint32_t i = 0; i < b->n; i++) {
+		remote_stream_feed(&stream, payload, len, &count_callb, NULL);
+	}
+}
+
+
+BENCH(remote_stream, hunt_through_garbage) {
+	// what the framer sees after a resync in the middle of a large UI chunk
+	static uint8_t payload[1024];
+	static remote_stream_st stream;
+	for (uint16_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = (uint8_t) ((i * 7) % REMOTE_MSG_START_BYTE);
+	}
+	remote_stream_reset(&stream);
+	uv_bench_set_bytes(b, sizeof(payload));
+
+	for (uint32_t i = 0; i < b->n; i++) {
+		remote_stream_feed(&stream, payload, sizeof(payload), &count_callb, NULL);
+	}
+}
+
+
+/// @brief: Bus traffic the way a forwarding device sees it: a set of PDOs and
+/// J1939 broadcasts cycling, each with a slowly changing value in it
+static void next_bus_frame(uint32_t i, uv_can_msg_st *msg) {
+	memset(msg, 0, sizeof(*msg));
+	if ((i % 3) == 0) {
+		msg->id = 0x18FEE000 + ((i / 3) % 4) * 0x100;
+		msg->type = CAN_EXT;
+	}
+	else {
+		msg->id = 0x181 + (i % 12);
+		msg->type = CAN_STD;
+	}
+	msg->data_length = 8;
+	msg->data_8bit[0] = (uint8_t) (i / 12);
+	msg->data_8bit[1] = 0x12;
+	msg->data_8bit[2] = (uint8_t) ((i / 200) & 0xFF);
+	msg->data_8bit[6] = 0xAA;
+}
+
+
+/// @brief: Fills one REMOTE_PACK_MAX_LEN payload with CAN_BATCH messages
+/// and returns the number of frames in it
+static uint32_t pack_batches(remote_pack_st *pack, remote_can_batch_st *batch,
+		uint32_t *frame_index) {
+	uint32_t frames = 0;
+	remote_pack_clear(pack);
+	remote_can_batch_clear(batch);
+	remote_can_batch_set_max_len(batch, REMOTE_PACK_MAX_LEN);
+	while (true) {
+		uv_can_msg_st msg;
+		next_bus_frame(*frame_index, &msg);
+		if (remote_can_batch_append(batch, &msg, *frame_index)) {
+			(*frame_index)++;
+		}
+		else if (remote_pack_append(pack, remote_can_batch_get_msg(batch),
+				remote_can_batch_get_len(batch))) {
+			frames += remote_can_batch_get_count(batch);
+			remote_can_batch_clear(batch);
+			// fill what is left of the payload rather than leaving it unused
+			remote_can_batch_set_max_len(batch, REMOTE_PACK_MAX_LEN - pack->len);
+		}
+		else {
+			break;
+		}
+	}
+	return frames;
+}
+
+
+BENCH(remote_can_batch, frames_per_payload) {
+	static remote_pack_st pack;
+	static remote_can_batch_st batch;
+	uint32_t frame_index = 0;
+	uint32_t frames = 0;
+	for (uint32_t i = 0; i < b->n; i++) {
+		frames += pack_batches(&pack, &batch, &frame_index);
+	}
+	uv_bench_set_bytes(b, REMOTE_PACK_MAX_LEN);
+
+	// the same traffic as plain CAN messages
+	uint32_t plain = 0;
+	remote_pack_clear(&pack);
+	for (uint32_t i = 0; ; i++) {
+		uv_can_msg_st msg;
+		uint8_t frame[REMOTE_MSG_TYPE_CAN_MAX_LEN];
+		next_bus_frame(i, &msg);
+		remote_can_msg_encode(&msg, frame);
+		if (!remote_pack_append(&pack, frame, REMOTE_MSG_TYPE_CAN_LEN(msg.data_length))) {
+			break;
+		}
+		plain++;
+	}
+	uv_bench_report(b, "batch_frames/payload", (double) frames / b->n);
+	uv_bench_report(b, "can_frames/payload", plain);
+}
+
+
+static uint32_t decoded_count;
+
+static void count_decoded(void *user, const uv_can_msg_st *msg, uint32_t time_ms) {
+	decoded_count++;
+	UV_BENCH_KEEP(msg->data_8bit[0]);
+}
+
+static void decode_callb(void *user, remote_msg_types_e type,
+		const uint8_t *data, uint8_t len) {
+	if (type == REMOTE_MSG_TYPE_CAN_BATCH) {
+		remote_can_batch_decode(data, len, &count_decoded, NULL);
+	}
+}
+
+
+BENCH(remote_can_batch, feed_and_decode_payload) {
+	static remote_pack_st pack;
+	static remote_can_batch_st batch;
+	static remote_stream_st stream;
+	uint32_t frame_index = 0;
+	uint32_t frames = pack_batches(&pack, &batch, &frame_index);
+	remote_stream_reset(&stream);
+	uv_bench_set_bytes(b, pack.len);
+
+	decoded_count = 0;
+	for (uint32_t i = 0; i < b->n; i++) {
+		remote_stream_feed(&stream, pack.buf, pack.len, &decode_callb, NULL);
+	}
+	uv_bench_report(b, "frames/payload", (double) decoded_count / b->n);
+	UV_BENCH_KEEP(frames);
+}
@@ -0,0 +1,358 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_bench.h"
+#include "uv_ui_remote.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/// @file: Size of the remote UI command stream in each color mode.
+///
+/// The screens here are written op by op the way the encoder captures the
+/// usual uv_hal screens - a settings list, a dashboard of gauges and a dialog
+/// over it - since the tests build without the UI. Each benchmark times the
+/// palette mode rewrite of its screen, which is the one with real work in it,
+/// and reports the frame in every mode, the one a sink decoding every mode is
+/// sent, and what the palette mode delta frame is when one value on the
+/// screen changes.
+///
+/// The ui_remote_raster ones draw the same screens the way a sink does, with
+/// the reference rasterizer into an 800 x 480 framebuffer, from a made up font
+/// of 16 pixel glyphs and 32 x 32 pixel bitmaps.
+
+
+#define FRAME_MAX		4096
+
+#define C_BG			0xFF202020u
+#define C_BAR			0xFF303848u
+#define C_BUTTON		0xFF404040u
+#define C_SELECTED		0xFF0060C0u
+#define C_TEXT			0xFFFFFFFFu
+#define C_VALUE			0xFFC0C0C0u
+#define C_LINE			0xFF505050u
+#define C_ALERT			0xFFE04020u
+#define C_OK			0xFF40C040u
+#define C_SHADOW		0x80000000u
+
+
+typedef struct {
+	uint8_t data[FRAME_MAX];
+	uint16_t len;
+} frame_st;
+
+
+static void put8(frame_st *f, uint8_t v) {
+	f->data[f->len++] = v;
+}
+
+static void put16(frame_st *f, int32_t v) {
+	put8(f, (uint8_t) (v & 0xFF));
+	put8(f, (uint8_t) ((v >> 8) & 0xFF));
+}
+
+static void put32(frame_st *f, uint32_t v) {
+	put16(f, (int32_t) (v & 0xFFFF));
+	put16(f, (int32_t) (v >> 16));
+}
+
+static void rrect(frame_st *f, int16_t x, int16_t y, uint16_t w, uint16_t h,
+		uint32_t color) {
+	put8(f, UV_UI_REMOTE_OP_RRECT);
+	put16(f, x);
+	put16(f, y);
+	put16(f, w);
+	put16(f, h);
+	put16(f, 4);
+	put32(f, color);
+}
+
+static void line(frame_st *f, int16_t x1, int16_t y1, int16_t x2, int16_t y2,
+		uint32_t color) {
+	put8(f, UV_UI_REMOTE_OP_LINE);
+	put16(f, x1);
+	put16(f, y1);
+	put16(f, x2);
+	put16(f, y2);
+	put16(f, 2);
+	put32(f, color);
+}
+
+static void string(frame_st *f, int16_t x, int16_t y, const char *str,
+		uint32_t color) {
+	uint16_t len = (uint16_t) strlen(str);
+	put8(f, UV_UI_REMOTE_OP_STRING);
+	put8(f, 3);
+	put16(f, x);
+	put16(f, y);
+	put16(f, 0);
+	put32(f, color);
+	put16(f, len);
+	memcpy(&f->data[f->len], str, len);
+	f->len = (uint16_t) (f->len + len);
+}
+
+static void bitmap(frame_st *f, uint32_t id, int16_t x, int16_t y) {
+	put8(f, UV_UI_REMOTE_OP_BITMAP);
+	put32(f, id);
+	put16(f, x);
+	put16(f, y);
+	put16(f, 32);
+	put16(f, 32);
+	put32(f, 0);
+	put32(f, C_TEXT);
+}
+
+
+/// @brief: A settings list: title bar, ten rows of a label and a value with
+/// a separator, one row selected, and a scroll bar. *tick* changes the value
+/// on the first row.
+static void settings_list(frame_st *f, uint32_t tick) {
+	f->len = 0;
+	put8(f, UV_UI_REMOTE_OP_FRAME_BEGIN);
+	put32(f, C_BG);
+	rrect(f, 0, 0, 800, 48, C_BAR);
+	string(f, 16, 12, "Settings", C_TEXT);
+	bitmap(f, 0x1001, 760, 8);
+	for (int16_t i = 0; i < 10; i++) {
+		char str[24];
+		int16_t y = (int16_t) (56 + i * 42);
+		rrect(f, 8, y, 770, 40, (i == 3) ? C_SELECTED : C_BUTTON);
+		snprintf(str, sizeof(str), "Parameter %d", i);
+		string(f, 20, (int16_t) (y + 10), str, C_TEXT);
+		snprintf(str, sizeof(str), "%u", (unsigned) ((i == 0) ? tick : (i * 17u)));
+		string(f, 600, (int16_t) (y + 10), str, C_VALUE);
+		line(f, 8, (int16_t) (y + 41), 778, (int16_t) (y + 41), C_LINE);
+	}
+	rrect(f, 784, 56, 8, 120, C_VALUE);
+	put8(f, UV_UI_REMOTE_OP_FRAME_END);
+}
+
+
+/// @brief: A dashboard: four gauges of a scale, a needle and a value, a bar
+/// graph and a row of status icons. *tick* moves the first needle.
+static void dashboard(frame_st *f, uint32_t tick) {
+	f->len = 0;
+	put8(f, UV_UI_REMOTE_OP_FRAME_BEGIN);
+	put32(f, C_BG);
+	for (int16_t g = 0; g < 4; g++) {
+		char str[16];
+		int16_t cx = (int16_t) (100 + g * 200);
+		uint32_t value = (g == 0) ? (tick % 100u) : (uint32_t) (g * 23);
+		put8(f, UV_UI_REMOTE_OP_LINESTRIP);
+		put8(f, 0);
+		put16(f, 4);
+		put32(f, C_LINE);
+		put16(f, 16);
+		for (int16_t p = 0; p < 16; p++) {
+			put16(f, cx - 80 + p * 10);
+			put16(f, 200 - ((p < 8) ? p : (15 - p)) * 10);
+		}
+		line(f, cx, 200, (int16_t) (cx - 70 + value * 14 / 10), 140,
+				(value > 80) ? C_ALERT : C_OK);
+		snprintf(str, sizeof(str), "%u", (unsigned) value);
+		string(f, (int16_t) (cx - 10), 220, str, C_TEXT);
+		string(f, (int16_t) (cx - 30), 250, "Pressure", C_VALUE);
+	}
+	put8(f, UV_UI_REMOTE_OP_POLYGON);
+	put32(f, C_SELECTED);
+	put16(f, 4);
+	put16(f, 20); put16(f, 440);
+	put16(f, 420); put16(f, 440);
+	put16(f, 420); put16(f, 400);
+	put16(f, 20); put16(f, 400);
+	for (int16_t i = 0; i < 6; i++) {
+		bitmap(f, 0x2000u + (uint32_t) i, (int16_t) (440 + i * 56), 400);
+	}
+	put8(f, UV_UI_REMOTE_OP_FRAME_END);
+}
+
+
+/// @brief: A dialog drawn over the screen without clearing it, the way the
+/// exec loop dialogs draw. *tick* changes the text of its second line.
+static void dialog(frame_st *f, uint32_t tick) {
+	char str[32];
+	f->len = 0;
+	put8(f, UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP);
+	rrect(f, 0, 0, 800, 480, C_SHADOW);
+	rrect(f, 150, 100, 500, 280, C_BUTTON);
+	rrect(f, 150, 100, 500, 40, C_BAR);
+	string(f, 170, 110, "Save changes?", C_TEXT);
+	string(f, 170, 160, "The parameters were modified.", C_VALUE);
+	snprintf(str, sizeof(str), "%u changes in total.", (unsigned) tick);
+	string(f, 170, 190, str, C_VALUE);
+	rrect(f, 170, 310, 200, 50, C_OK);
+	string(f, 240, 325, "Save", C_TEXT);
+	rrect(f, 430, 310, 200, 50, C_ALERT);
+	string(f, 490, 325, "Discard", C_TEXT);
+	put8(f, UV_UI_REMOTE_OP_FRAME_END);
+}
+
+
+/// @brief: Times the palette mode rewrite of the screen drawn by *draw* and
+/// reports its size in each mode, and the delta frame of a one value change
+static void frame_sizes(uv_bench_st *b, void (*draw)(frame_st *f, uint32_t tick)) {
+	static frame_st screen, next, coded, base;
+	static uv_ui_remote_palette_st pal;
+	static uv_ui_remote_frame_index_st base_idx, idx;
+	static uint8_t delta[FRAME_MAX];
+	uint16_t len[UV_UI_REMOTE_COLOR_MODE_COUNT];
+
+	uv_bench_pause(b);
+	draw(&screen, 10);
+	draw(&next, 11);
+	uv_ui_remote_palette_init(&pal);
+	uv_bench_set_bytes(b, screen.len);
+	uv_bench_resume(b);
+
+	for (uint32_t i = 0; i < b->n; i++) {
+		coded.len = uv_ui_remote_color_convert(&pal, UV_UI_REMOTE_COLOR_PALETTE,
+				screen.data, screen.len, coded.data, sizeof(coded.data));
+		UV_BENCH_KEEP(coded.len);
+	}
+
+	uv_bench_pause(b);
+	for (uv_ui_remote_color_mode_e mode = UV_UI_REMOTE_COLOR_ARGB8888;
+			mode < UV_UI_REMOTE_COLOR_MODE_COUNT; mode++) {
+		len[mode] = uv_ui_remote_color_convert(&pal, mode, screen.data, screen.len,
+				coded.data, sizeof(coded.data));
+	}
+	base = coded;
+	coded.len = uv_ui_remote_color_convert(&pal, UV_UI_REMOTE_COLOR_PALETTE,
+			next.data, next.len, coded.data, sizeof(coded.data));
+	(void) uv_ui_remote_frame_index(&base_idx, UV_UI_REMOTE_COLOR_PALETTE,
+			base.data, base.len);
+	(void) uv_ui_remote_frame_index(&idx, UV_UI_REMOTE_COLOR_PALETTE,
+			coded.data, coded.len);
+	uint16_t delta_len = uv_ui_remote_delta_encode(base.data, &base_idx,
+			coded.data, &idx, delta, sizeof(delta));
+	uv_bench_report(b, "argb8888", len[UV_UI_REMOTE_COLOR_ARGB8888]);
+	uv_bench_report(b, "rgb565", len[UV_UI_REMOTE_COLOR_RGB565]);
+	uv_bench_report(b, "palette", len[UV_UI_REMOTE_COLOR_PALETTE]);
+	// what a sink that decodes both is sent: RGB565 unless the palette mode
+	// is smaller
+	uv_bench_report(b, "sent", ((len[UV_UI_REMOTE_COLOR_PALETTE] != 0) &&
+			(len[UV_UI_REMOTE_COLOR_PALETTE] < len[UV_UI_REMOTE_COLOR_RGB565])) ?
+			len[UV_UI_REMOTE_COLOR_PALETTE] : len[UV_UI_REMOTE_COLOR_RGB565]);
+	uv_bench_report(b, "palette_delta", delta_len);
+	uv_bench_resume(b);
+}
+
+
+BENCH(ui_remote_frames, settings_list) {
+	frame_sizes(b, &settings_list);
+}
+
+
+BENCH(ui_remote_frames, dashboard) {
+	frame_sizes(b, &dashboard);
+}
+
+
+BENCH(ui_remote_frames, dialog) {
+	frame_sizes(b, &dialog);
+}
+
+
+#define FB_W			800
+#define FB_H			480
+#define FONT_H			16
+#define FONT_STRIDE		6
+#define IMAGE_SIZE		32
+
+static uint32_t fb[FB_W * FB_H];
+static uint8_t font[UV_UI_REMOTE_FONT_BODY_HDR_LEN +
+		FONT_STRIDE * FONT_H * UV_UI_REMOTE_FONT_WIDTHS];
+static uint32_t image[IMAGE_SIZE * IMAGE_SIZE];
+
+static const uint8_t *font_get(void *user, uint8_t font_id, uint32_t *len) {
+	*len = sizeof(font);
+	return font;
+}
+
+static bool image_get(void *user, uint32_t id, uv_ui_remote_image_st *dest) {
+	dest->pixels = image;
+	dest->width = IMAGE_SIZE;
+	dest->height = IMAGE_SIZE;
+	return true;
+}
+
+
+/// @brief: Times drawing the screen drawn by *draw*, as it comes in ARGB8888
+static void raster(uv_bench_st *b, void (*draw)(frame_st *f, uint32_t tick)) {
+	static frame_st screen;
+	static uv_ui_remote_raster_st r;
+
+	uv_bench_pause(b);
+	// glyphs about half covered with an antialiased edge, icons with a
+	// transparent border
+	font[0] = FONT_H;
+	font[2] = UV_UI_REMOTE_FONT_FLAG_GLYPHS;
+	font[3] = FONT_STRIDE;
+	font[5] = FONT_STRIDE * 2;
+	memset(&font[7], 10, UV_UI_REMOTE_FONT_WIDTHS);
+	for (uint32_t i = UV_UI_REMOTE_FONT_BODY_HDR_LEN; i < sizeof(font); i++) {
+		static const uint8_t row[FONT_STRIDE] = { 0x00, 0x4F, 0xFF, 0xF8, 0x00, 0x00 };
+		font[i] = row[(i - UV_UI_REMOTE_FONT_BODY_HDR_LEN) % FONT_STRIDE];
+	}
+	for (uint32_t y = 0; y < IMAGE_SIZE; y++) {
+		for (uint32_t x = 0; x < IMAGE_SIZE; x++) {
+			bool edge = (x < 2) || (y < 2) || (x >= (IMAGE_SIZE - 2)) ||
+					(y >= (IMAGE_SIZE - 2));
+			image[y * IMAGE_SIZE + x] = edge ? 0x00000000u : (0xFF000000u | (x * 8u << 8) | y * 8u);
+		}
+	}
+	uv_ui_remote_raster_init(&r, fb, FB_W, FB_H, FB_W);
+	uv_ui_remote_raster_set_assets(&r, &font_get, &image_get, NULL);
+	draw(&screen, 10);
+	uv_bench_set_bytes(b, screen.len);
+	uv_bench_resume(b);
+
+	bool ok = true;
+	for (uint32_t i = 0; i < b->n; i++) {
+		ok = ok && uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+				screen.data, screen.len);
+		UV_BENCH_KEEP(fb[i % (FB_W * FB_H)]);
+	}
+	uv_bench_report(b, "drawn", ok ? 1 : 0);
+}
+
+
+BENCH(ui_remote_raster, settings_list) {
+	raster(b, &settings_list);
+}
+
+
+BENCH(ui_remote_raster, dashboard) {
+	raster(b, &dashboard);
+}
+
+
+BENCH(ui_remote_raster, dialog) {
+	raster(b, &dialog);
+}
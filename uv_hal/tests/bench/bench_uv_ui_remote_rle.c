@@ -0,0 +1,250 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_bench.h"
+#include "uv_ui_remote.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/// @file: Ratio and speed of the run-length code of remote UI assets, on the
+/// fonts the host UI embeds.
+///
+/// The assets worth compressing are font bodies: the metric header followed by
+/// the 4 bits per pixel glyph atlas (UV_UI_REMOTE_FONT_FLAG_GLYPHS). These
+/// benchmarks build exactly that from embedded_font.h and
+/// embedded_mono_font.h at every UI font size, rendering the glyphs with
+/// FreeType the way the simulator does, and code the lot chunk by chunk the
+/// way the source does. Built without FreeType they code the TTF files
+/// themselves instead, which is a much less flattering load.
+
+#include "ui/embedded_font.h"
+#include "ui/embedded_mono_font.h"
+
+#if UV_BENCH_FREETYPE
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#endif
+
+
+// the sizes uv_ui_opengl.c loads its fonts in
+static const uint8_t font_sizes[] = { 13, 16, 19, 21, 25, 30, 40, 58, 70 };
+
+#define ASSETS_MAX		(4 * 1024 * 1024)
+
+
+typedef struct {
+	uint8_t *data;
+	uint32_t len;
+	// where each font's body starts
+	uint32_t off[sizeof(font_sizes) + 1];
+	uint8_t count;
+} assets_st;
+
+
+#if UV_BENCH_FREETYPE
+/// @brief: Appends one font body to *a*: the header and widths, then a 4 bits
+/// per pixel atlas of 128 fixed size cells, one per glyph slot
+static void font_body(assets_st *a, FT_Face face, uint8_t size) {
+	FT_Set_Pixel_Sizes(face, 0, size);
+	uint16_t height = (uint16_t) (face->size->metrics.height / 64);
+	uint16_t ascent = (uint16_t) (face->size->metrics.ascender / 64);
+	uint16_t width = 0;
+	for (uint16_t c = 32; c < 128; c++) {
+		if (!FT_Load_Char(face, c, FT_LOAD_DEFAULT)) {
+			uint16_t w = (uint16_t) (face->glyph->advance.x / 64);
+			width = (w > width) ? w : width;
+		}
+	}
+	uint16_t stride = (uint16_t) ((width + 1) / 2);
+	uint8_t *p = &a->data[a->len];
+	uint32_t len = UV_UI_REMOTE_FONT_BODY_HDR_LEN + (uint32_t) stride * height * 128;
+	memset(p, 0, len);
+	p[0] = (uint8_t) (height & 0xFF);
+	p[1] = (uint8_t) (height >> 8);
+	p[2] = UV_UI_REMOTE_FONT_FLAG_GLYPHS;
+	p[3] = (uint8_t) (stride & 0xFF);
+	p[4] = (uint8_t) (stride >> 8);
+	p[5] = (uint8_t) (width & 0xFF);
+	p[6] = (uint8_t) (width >> 8);
+	uint8_t *atlas = &p[UV_UI_REMOTE_FONT_BODY_HDR_LEN];
+
+	for (uint16_t c = 32; c < 128; c++) {
+		if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+			continue;
+		}
+		FT_GlyphSlot g = face->glyph;
+		p[7 + c] = (uint8_t) (g->advance.x / 64);
+		uint8_t *cell = &atlas[(uint32_t) c * stride * height];
+		for (uint32_t y = 0; y < g->bitmap.rows; y++) {
+			int32_t cy = ascent - g->bitmap_top + (int32_t) y;
+			for (uint32_t x = 0; x < g->bitmap.width; x++) {
+				int32_t cx = g->bitmap_left + (int32_t) x;
+				if ((cy >= 0) && (cy < height) && (cx >= 0) && (cx < width)) {
+					uint8_t v = g->bitmap.buffer[y * g->bitmap.pitch + x] >> 4;
+					cell[cy * stride + cx / 2] |= (cx & 1) ? v : (uint8_t) (v << 4);
+				}
+			}
+		}
+	}
+	a->len += len;
+}
+#endif
+
+
+static void assets_build(assets_st *a, const unsigned char *ttf, uint32_t ttf_len) {
+	a->data = malloc(ASSETS_MAX);
+	a->len = 0;
+	a->count = 0;
+#if UV_BENCH_FREETYPE
+	FT_Library ft;
+	FT_Face face;
+	FT_Init_FreeType(&ft);
+	FT_New_Memory_Face(ft, ttf, (FT_Long) ttf_len, 0, &face);
+	for (uint8_t i = 0; i < sizeof(font_sizes); i++) {
+		a->off[a->count++] = a->len;
+		font_body(a, face, font_sizes[i]);
+	}
+	FT_Done_Face(face);
+	FT_Done_FreeType(ft);
+#else
+	a->off[a->count++] = 0;
+	memcpy(a->data, ttf, ttf_len);
+	a->len = ttf_len;
+#endif
+	a->off[a->count] = a->len;
+}
+
+
+/// @brief: Codes *len* bytes as the source does: the window refilled as it
+/// empties, the output cut into asset chunks. Returns the coded length.
+static uint32_t code(const uint8_t *src, uint32_t len, uint8_t *dest) {
+	static uv_ui_remote_rle_enc_st enc;
+	uv_ui_remote_rle_enc_init(&enc);
+	uint32_t off = 0;
+	uint32_t out = 0;
+	bool more = true;
+	while (more) {
+		uint16_t n = 0;
+		bool fill_more = true;
+		while (fill_more) {
+			uint32_t want = len - off;
+			if (want > uv_ui_remote_rle_enc_space(&enc)) {
+				want = uv_ui_remote_rle_enc_space(&enc);
+			}
+			memcpy(&enc.window[enc.len], &src[off], want);
+			enc.len += want;
+			off += want;
+			uint16_t coded = uv_ui_remote_rle_encode(&enc, off == len,
+					&dest[out + n], (uint16_t) (UV_UI_REMOTE_ASSET_CHUNK - n));
+			n += coded;
+			fill_more = (coded > 0) ||
+					((off < len) && (uv_ui_remote_rle_enc_space(&enc) > 0));
+		}
+		out += n;
+		more = (off < len) || (enc.len > 0);
+	}
+	return out;
+}
+
+
+static double ratio(const assets_st *a, uint8_t font, uint8_t *coded) {
+	uint32_t len = a->off[font + 1] - a->off[font];
+	return (double) code(&a->data[a->off[font]], len, coded) / len;
+}
+
+
+static void bench_code(uv_bench_st *b, const unsigned char *ttf, uint32_t ttf_len) {
+	static assets_st a;
+	uv_bench_pause(b);
+	uint8_t *coded = malloc(2 * ASSETS_MAX);
+	assets_build(&a, ttf, ttf_len);
+	uv_bench_set_bytes(b, a.len);
+	uv_bench_resume(b);
+
+	uint32_t len = 0;
+	for (uint32_t i = 0; i < b->n; i++) {
+		len = code(a.data, a.len, coded);
+		UV_BENCH_KEEP(coded[len - 1]);
+	}
+	uv_bench_pause(b);
+	uv_bench_report(b, "ratio", (double) len / a.len);
+	uv_bench_report(b, "kB", a.len / 1024.0);
+	uv_bench_report(b, "ratio_first", ratio(&a, 0, coded));
+	uv_bench_report(b, "ratio_last", ratio(&a, (uint8_t) (a.count - 1), coded));
+	free(coded);
+	free(a.data);
+	uv_bench_resume(b);
+}
+
+
+static void bench_decode(uv_bench_st *b, const unsigned char *ttf, uint32_t ttf_len) {
+	static assets_st a;
+	uint8_t *coded = malloc(2 * ASSETS_MAX);
+	uint8_t *decoded = malloc(ASSETS_MAX);
+	uv_bench_pause(b);
+	assets_build(&a, ttf, ttf_len);
+	uint32_t len = code(a.data, a.len, coded);
+	uv_bench_set_bytes(b, a.len);
+	uv_bench_resume(b);
+
+	for (uint32_t i = 0; i < b->n; i++) {
+		// a chunk at a time, as the sink gets them
+		uv_ui_remote_rle_dec_st dec;
+		uv_ui_remote_rle_dec_init(&dec);
+		uint32_t out = 0;
+		for (uint32_t j = 0; j < len; j += UV_UI_REMOTE_ASSET_CHUNK) {
+			uint16_t n = (uint16_t) (((len - j) < UV_UI_REMOTE_ASSET_CHUNK) ?
+					(len - j) : UV_UI_REMOTE_ASSET_CHUNK);
+			out += uv_ui_remote_rle_decode(&dec, &coded[j], n,
+					&decoded[out], a.len - out);
+		}
+		UV_BENCH_KEEP(decoded[out - 1]);
+	}
+	uv_bench_pause(b);
+	uv_bench_report(b, "ok", memcmp(decoded, a.data, a.len) == 0);
+	free(decoded);
+	free(coded);
+	free(a.data);
+	uv_bench_resume(b);
+}
+
+
+BENCH(ui_remote_rle, code_font_atlases) {
+	bench_code(b, embedded_font_ttf, embedded_font_ttf_len);
+}
+
+
+BENCH(ui_remote_rle, code_mono_font_atlases) {
+	bench_code(b, embedded_mono_font_ttf, embedded_mono_font_ttf_len);
+}
+
+
+BENCH(ui_remote_rle, decode_font_atlases) {
+	bench_decode(b, embedded_font_ttf, embedded_font_ttf_len);
+}
@@ -0,0 +1,934 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "uibench.h"
+#include "uv_ui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/// @file: The UI frame benchmark. Builds the screens a device typically shows
+/// out of the widgets in src/ui, steps each of them with a scripted touch for a
+/// fixed number of frames, and reports what a frame costs.
+///
+/// Every screen is run twice. The first run is left alone and gives the time a
+/// frame takes. The second run wraps the draw and step callback of every object
+/// on the screen, and gives the time each kind of widget spends in them and the
+/// drawing calls it makes. A callback's time excludes the callbacks it calls in
+/// turn, so the figures of a window and of its children add up instead of
+/// counting the children twice.
+///
+/// The output is one line per figure in fixed columns, so that the output of
+/// two commits can be compared with diff. The call counts are exact and repeat
+/// from run to run; the times only compare on the same machine.
+///
+///		./uv_hal_uibench [screen filter] [frames]
+
+
+#define STEP_MS				20
+#define FRAMES_DEFAULT		500
+
+/// @brief: How many objects and kinds of widget one screen may have
+#define OBJ_SLOTS			512
+#define KIND_COUNT			64
+#define NAME_COUNT			32
+
+
+/// @brief: One stretch of the touch script: the screen is touched at (x, y),
+/// moving (dx, dy) a frame, or left alone, for *frames* frames. A screen's
+/// script repeats for as long as the screen runs.
+typedef struct {
+	uint16_t frames;
+	bool pressed;
+	int16_t x;
+	int16_t y;
+	int16_t dx;
+	int16_t dy;
+} touch_seg_st;
+
+
+typedef struct {
+	const char *name;
+	/// @brief: What the screen's root is reported as, when it is not one of
+	/// the widgets the screen named
+	const char *root_name;
+	void (*build)(void);
+	void (*run)(void);
+	const touch_seg_st *script;
+	uint16_t script_len;
+} screen_st;
+
+
+/// @brief: What one kind of callback cost, summed over the frames measured
+typedef struct {
+	uint64_t calls;
+	uint64_t prims;
+	uint64_t ns;
+} cost_st;
+
+
+typedef struct {
+	const char *name;
+	cost_st draw;
+	cost_st step;
+} widget_name_st;
+
+
+/// @brief: A draw callback seen, and the widget it draws
+typedef struct {
+	void (*draw)(void *, const uv_bounding_box_st *);
+	uint8_t name;
+} widget_kind_st;
+
+
+/// @brief: An object wrapped, with the callbacks it had
+typedef struct {
+	uv_uiobject_st *obj;
+	void (*draw)(void *, const uv_bounding_box_st *);
+	uv_uiobject_ret_e (*step)(void *, uint16_t);
+	uint8_t name;
+} obj_st;
+
+
+typedef struct {
+	const screen_st *screen;
+	uint32_t frames;
+	bool instrument;
+	bool done;
+	uint32_t touches;
+	uint64_t frame_start;
+	uint64_t frame_ns;
+	uint64_t frame_max_ns;
+	/// @brief: The most transitions the display stepped in one frame
+	uint16_t transitions_max;
+	uint64_t prims[UIBENCH_PRIM_COUNT];
+
+	widget_name_st names[NAME_COUNT];
+	uint8_t name_count;
+	widget_kind_st kinds[KIND_COUNT];
+	uint8_t kind_count;
+	obj_st objs[OBJ_SLOTS];
+	// the callback running, and the time its callees took
+	cost_st *current;
+	uint64_t nested_ns;
+} bench_st;
+
+static bench_st bench;
+
+static const char *const prim_names[UIBENCH_PRIM_COUNT] = {
+		"clear",
+		"mask",
+		"rrect",
+		"point",
+		"line",
+		"linestrip",
+		"polygon",
+		"string",
+		"bitmap",
+		"string_width"
+};
+
+#define UNATTRIBUTED		0
+
+
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+
+static uint8_t name_index(const char *name) {
+	uint8_t ret = UNATTRIBUTED;
+	for (uint8_t i = 0; i < bench.name_count; i++) {
+		if (strcmp(bench.names[i].name, name) == 0) {
+			ret = i;
+			break;
+		}
+	}
+	if ((ret == UNATTRIBUTED) && (bench.name_count < NAME_COUNT)) {
+		ret = bench.name_count++;
+		bench.names[ret].name = name;
+	}
+	return ret;
+}
+
+
+static uint8_t kind_name(void (*draw)(void *, const uv_bounding_box_st *),
+		const char *root_name) {
+	uint8_t ret = UNATTRIBUTED;
+	bool found = false;
+	for (uint8_t i = 0; i < bench.kind_count; i++) {
+		if (bench.kinds[i].draw == draw) {
+			ret = bench.kinds[i].name;
+			found = true;
+			break;
+		}
+	}
+	if (!found && (root_name != NULL) && (bench.kind_count < KIND_COUNT)) {
+		ret = name_index(root_name);
+		bench.kinds[bench.kind_count].draw = draw;
+		bench.kinds[bench.kind_count].name = ret;
+		bench.kind_count++;
+	}
+	else {
+	}
+	return ret;
+}
+
+
+/// @brief: Tells the benchmark that every object drawn the way *obj* is drawn
+/// is a *name*. Called by the screens for the widgets they build.
+static void uibench_name(void *obj, const char *name) {
+	(void) kind_name(((uv_uiobject_st*) obj)->vrtl_draw, name);
+}
+
+
+static obj_st *obj_find(const void *obj) {
+	uint32_t i = (uint32_t) (((uintptr_t) obj >> 3) % OBJ_SLOTS);
+	while ((bench.objs[i].obj != NULL) && (bench.objs[i].obj != obj)) {
+		i = (i + 1) % OBJ_SLOTS;
+	}
+	return &bench.objs[i];
+}
+
+
+static void enter(cost_st *cost, cost_st **saved_cost, uint64_t *saved_nested) {
+	*saved_cost = bench.current;
+	*saved_nested = bench.nested_ns;
+	bench.current = cost;
+	bench.nested_ns = 0;
+}
+
+
+static void leave(uint64_t ns, cost_st *saved_cost, uint64_t saved_nested) {
+	if (!bench.done) {
+		bench.current->calls++;
+		bench.current->ns += ns - bench.nested_ns;
+	}
+	else {
+	}
+	bench.current = saved_cost;
+	bench.nested_ns = saved_nested + ns;
+}
+
+
+static void draw_shim(void *me, const uv_bounding_box_st *pbb) {
+	obj_st *o = obj_find(me);
+	cost_st *saved_cost;
+	uint64_t saved_nested;
+	enter(&bench.names[o->name].draw, &saved_cost, &saved_nested);
+	uint64_t start = now_ns();
+	o->draw(me, pbb);
+	leave(now_ns() - start, saved_cost, saved_nested);
+}
+
+
+static uv_uiobject_ret_e step_shim(void *me, uint16_t step_ms) {
+	obj_st *o = obj_find(me);
+	cost_st *saved_cost;
+	uint64_t saved_nested;
+	enter(&bench.names[o->name].step, &saved_cost, &saved_nested);
+	uint64_t start = now_ns();
+	uv_uiobject_ret_e ret = o->step(me, step_ms);
+	leave(now_ns() - start, saved_cost, saved_nested);
+	return ret;
+}
+
+
+/// @brief: Wraps the callbacks of *obj* and of everything in it. Run every
+/// frame: objects come and go, and clearing a window puts its own draw
+/// callback back in place of the wrapper.
+///
+/// @note: The root's draw callback is wrapped too, even though uv_uidisplay
+/// tells its own from a dialog's by it. The counting backend keeps nothing
+/// between frames, so the display draws every frame whole either way.
+static void wrap(uv_uiobject_st *obj, const char *root_name) {
+	obj_st *o = obj_find(obj);
+	if (o->obj == NULL) {
+		o->obj = obj;
+		o->draw = NULL;
+		o->step = NULL;
+	}
+	else {
+	}
+	if ((obj->vrtl_draw != NULL) && (obj->vrtl_draw != &draw_shim)) {
+		o->draw = obj->vrtl_draw;
+		o->name = kind_name(o->draw, root_name);
+		obj->vrtl_draw = &draw_shim;
+	}
+	else {
+	}
+	if ((obj->step_callb != NULL) && (obj->step_callb != &step_shim)) {
+		o->step = obj->step_callb;
+		obj->step_callb = &step_shim;
+	}
+	else {
+	}
+	if (obj->is_window) {
+		uv_uiwindow_st *w = (uv_uiwindow_st*) obj;
+		for (uint16_t i = 0; i < w->objects_count; i++) {
+			wrap(w->objects[i], NULL);
+		}
+	}
+	else {
+	}
+}
+
+
+void uibench_count(uibench_prim_e prim) {
+	if (!bench.done) {
+		bench.prims[prim]++;
+		bench.current->prims++;
+	}
+	else {
+	}
+}
+
+
+bool uibench_touch(int16_t *x, int16_t *y) {
+	uint64_t now = now_ns();
+	if (bench.done) {
+	}
+	else if (bench.touches >= bench.frames) {
+		bench.done = true;
+	}
+	else {
+	}
+	if ((bench.touches > 0) && (bench.touches <= bench.frames)) {
+		uint64_t ns = now - bench.frame_start;
+		bench.frame_ns += ns;
+		bench.frame_max_ns = MAX(bench.frame_max_ns, ns);
+		bench.transitions_max = MAX(bench.transitions_max,
+				uv_uitransition_get_active_count());
+	}
+	else {
+	}
+
+	if (bench.instrument && !bench.done) {
+		// the display being stepped has just made itself the one refreshes go
+		// to, which is how a screen built inside a widget is found
+		void *root;
+		uv_uidirty_st *dirty;
+		_uv_ui_get_dirty(&root, &dirty);
+		wrap(root, bench.screen->root_name);
+	}
+	else {
+	}
+
+	// find where the script is at
+	const screen_st *s = bench.screen;
+	uint32_t len = 0;
+	for (uint16_t i = 0; i < s->script_len; i++) {
+		len += s->script[i].frames;
+	}
+	uint32_t t = bench.touches % len;
+	uint16_t seg = 0;
+	while (t >= s->script[seg].frames) {
+		t -= s->script[seg].frames;
+		seg++;
+	}
+	*x = (int16_t) (s->script[seg].x + (s->script[seg].dx * (int32_t) t));
+	*y = (int16_t) (s->script[seg].y + (s->script[seg].dy * (int32_t) t));
+
+	bench.touches++;
+	bench.frame_start = now_ns();
+	return s->script[seg].pressed;
+}
+
+
+
+/// @brief: The display the screens other than the keyboard are built on
+static uv_uidisplay_st display;
+static uv_uiobject_st *display_objects[16];
+
+
+static void run_display(void) {
+	while (!bench.done) {
+		uv_uidisplay_step(&display, STEP_MS);
+	}
+}
+
+
+
+/// @brief: A settings page: a long list scrolled in a window, with entries
+/// picked from it
+static uv_uiwindow_st list_window;
+static uv_uiobject_st *list_window_objects[2];
+static uv_uilist_st list;
+static uv_uilist_entry_st list_entries[40];
+static char list_texts[40][24];
+static uv_uilabel_st list_title;
+
+static void list_build(void) {
+	uv_uidisplay_init(&display, display_objects, &uv_uistyles[0]);
+	uibench_name(&display, "uidisplay");
+	uv_uilabel_init(&list_title, &font28, ALIGN_CENTER_LEFT,
+			uv_uistyles[0].text_color, "Settings");
+	uibench_name(&list_title, "uilabel");
+	uv_uidisplay_addxy(&display, &list_title, 20, 0, LCD_W_PX - 40, 60);
+	uv_uiwindow_init(&list_window, list_window_objects, &uv_uistyles[0]);
+	uibench_name(&list_window, "uiwindow");
+	uv_uidisplay_addxy(&display, &list_window, 0, 60, LCD_W_PX, LCD_H_PX - 60);
+	uv_uilist_init(&list, list_entries,
+			sizeof(list_entries) / sizeof(list_entries[0]), &uv_uistyles[0]);
+	uibench_name(&list, "uilist");
+	uv_uiwindow_addxy(&list_window, &list, 0, 0, LCD_W_PX - 20, 0);
+	for (uint16_t i = 0; i < sizeof(list_entries) / sizeof(list_entries[0]); i++) {
+		snprintf(list_texts[i], sizeof(list_texts[i]), "Parameter %u", i);
+		uv_uilist_entry_st e;
+		uv_uilist_entry_init(&e, list_texts[i]);
+		uv_uilist_push_back(&list, &e);
+	}
+	uv_uiwindow_set_contentbb(&list_window, LCD_W_PX,
+			uv_uilist_get_count(&list) * CONFIG_UI_LIST_ENTRY_HEIGHT);
+}
+
+static const touch_seg_st list_script[] = {
+		{ 10, false, 0, 0, 0, 0 },
+		// scroll down a page and back
+		{ 30, true, 400, 400, 0, -8 },
+		{ 10, false, 0, 0, 0, 0 },
+		{ 30, true, 400, 160, 0, 8 },
+		{ 10, false, 0, 0, 0, 0 },
+		// pick an entry
+		{ 4, true, 200, 180, 0, 0 },
+		{ 10, false, 0, 0, 0, 0 },
+		{ 4, true, 200, 300, 0, 0 },
+		{ 10, false, 0, 0, 0, 0 }
+};
+
+
+
+/// @brief: A fault log of 5000 rows given to a list as a data source, dragged
+/// through a few pages at a time
+#define LOG_ROWS			5000
+static uv_uilist_st log_list;
+static uv_uilist_entry_st log_entries[1];
+static uv_uilist_entry_st log_row_entry;
+static char log_row_text[32];
+
+static uint16_t log_count(void *source_ptr) {
+	return LOG_ROWS;
+}
+
+static void *log_row(void *source_ptr, uint16_t index) {
+	snprintf(log_row_text, sizeof(log_row_text), "Fault %u: overcurrent", index);
+	uv_uilist_entry_init(&log_row_entry, log_row_text);
+	return &log_row_entry;
+}
+
+static void log_build(void) {
+	uv_uidisplay_init(&display, display_objects, &uv_uistyles[0]);
+	uibench_name(&display, "uidisplay");
+	uv_uilist_init(&log_list, log_entries,
+			sizeof(log_entries) / sizeof(log_entries[0]), &uv_uistyles[0]);
+	uibench_name(&log_list, "uilist");
+	uv_uilist_set_source(&log_list, &log_count, &log_row, NULL);
+	uv_uidisplay_addxy(&display, &log_list, 0, 0, LCD_W_PX, LCD_H_PX);
+}
+
+static const touch_seg_st log_script[] = {
+		{ 10, false, 0, 0, 0, 0 },
+		// fling down a few pages and back up
+		{ 60, true, 400, 400, 0, -40 },
+		{ 10, false, 0, 0, 0, 0 },
+		{ 60, true, 400, 80, 0, 40 },
+		{ 10, false, 0, 0, 0, 0 },
+		// pick a row
+		{ 4, true, 200, 180, 0, 0 },
+		{ 10, false, 0, 0, 0, 0 }
+};
+
+
+
+/// @brief: A live graph: the current value moves every frame, and a point is
+/// dragged to a new place now and then
+static uv_uigraph_st graph;
+static uv_uigraph_point_st graph_points[64];
+static uint32_t graph_step_count;
+
+static bool graph_point_moved(int16_t point, int16_t x, int16_t y) {
+	return true;
+}
+
+static uv_uiobject_ret_e graph_step(void *user_ptr, const uint16_t step_ms) {
+	graph_step_count++;
+	int16_t x = (int16_t) ((graph_step_count * 7) % 640);
+	int16_t y = (int16_t) (50 + ((int32_t) (graph_step_count % 40) - 20));
+	uv_uigraph_set_current_val(&graph, x, y);
+	return UIOBJECT_RETURN_ALIVE;
+}
+
+static void graph_build(void) {
+	uv_uidisplay_init(&display, display_objects, &uv_uistyles[0]);
+	uibench_name(&display, "uidisplay");
+	for (uint16_t i = 0; i < sizeof(graph_points) / sizeof(graph_points[0]); i++) {
+		uv_uigraph_point_init(&graph_points[i], (int16_t) (i * 10),
+				(int16_t) (50 + ((i * 37) % 41) - 20), true);
+	}
+	uv_uigraph_init(&graph, graph_points,
+			sizeof(graph_points) / sizeof(graph_points[0]),
+			0, 640, 0, 100, &uv_uistyles[0]);
+	uibench_name(&graph, "uigraph");
+	uv_uigraph_set_title(&graph, "Pressure curve");
+	uv_uigraph_set_xunit(&graph, "mA");
+	uv_uigraph_set_yunit(&graph, "%");
+	uv_uigraph_set_grid(&graph, 80, 20);
+	uv_uigraph_set_editable(&graph, &graph_point_moved);
+	uv_uidisplay_addxy(&display, &graph, 0, 0, LCD_W_PX, LCD_H_PX);
+	graph_step_count = 0;
+	uv_uiwindow_set_stepcallback(&display, &graph_step, NULL);
+}
+
+static const touch_seg_st graph_script[] = {
+		{ 20, false, 0, 0, 0, 0 },
+		{ 20, true, 400, 240, 3, -2 },
+		{ 20, false, 0, 0, 0, 0 },
+		{ 4, true, 200, 300, 0, 0 },
+		{ 20, false, 0, 0, 0, 0 }
+};
+
+
+
+/// @brief: Two live signals sampled at 1 kHz on a 50 Hz screen, 20 samples a
+/// frame each, with 20000 samples of history. The chart is dragged back in
+/// the history and clicked back to live.
+#define CHART_SAMPLES		20000
+#define CHART_SPP			10
+static uv_uichart_st chart;
+static uv_uichart_trace_st chart_traces[2];
+static int16_t chart_samples[2][CHART_SAMPLES];
+static uv_uichart_column_st chart_columns[2][CHART_SAMPLES / CHART_SPP];
+static uv_ui_linestrip_point_st chart_strip[LCD_W_PX * 2];
+static uint32_t chart_sample_count;
+
+static uv_uiobject_ret_e chart_step(void *user_ptr, const uint16_t step_ms) {
+	for (uint16_t i = 0; i < 20; i++) {
+		chart_sample_count++;
+		int16_t saw = (int16_t) ((chart_sample_count % 400) - 200);
+		uv_uichart_push(&chart, 0, saw);
+		uv_uichart_push(&chart, 1, (int16_t) (((chart_sample_count * 7919) % 97) - 48));
+	}
+	return UIOBJECT_RETURN_ALIVE;
+}
+
+static void chart_build(void) {
+	uv_uidisplay_init(&display, display_objects, &uv_uistyles[0]);
+	uibench_name(&display, "uidisplay");
+	for (uint16_t i = 0; i < 2; i++) {
+		uv_uichart_trace_init(&chart_traces[i], chart_samples[i], CHART_SAMPLES,
+				chart_columns[i], CHART_SAMPLES / CHART_SPP,
+				(i == 0) ? C(0xFF40A0FF) : C(0xFFFFA040));
+	}
+	uv_uichart_init(&chart, chart_traces, 2, chart_strip,
+			sizeof(chart_strip) / sizeof(chart_strip[0]), CHART_SPP,
+			-LCD_W_PX * CHART_SPP / 1000, 0, -250, 250, &uv_uistyles[0]);
+	uibench_name(&chart, "uichart");
+	uv_uigraph_set_title(&chart, "Boom pressure");
+	uv_uigraph_set_xunit(&chart, "s");
+	uv_uigraph_set_grid(&chart, 1, 50);
+	uv_uichart_set_autoscale(&chart, true);
+	uv_uidisplay_addxy(&display, &chart, 0, 0, LCD_W_PX, LCD_H_PX);
+	chart_sample_count = 0;
+	uv_uiwindow_set_stepcallback(&display, &chart_step, NULL);
+}
+
+static const touch_seg_st chart_script[] = {
+		{ 100, false, 0, 0, 0, 0 },
+		// drag back in history and return to live
+		{ 30, true, 200, 240, 10, 0 },
+		{ 40, false, 0, 0, 0, 0 },
+		{ 4, true, 400, 240, 0, 0 },
+		{ 40, false, 0, 0, 0, 0 }
+};
+
+
+
+/// @brief: A tree of settings groups, opened one at a time, each holding a
+/// few widgets of its own
+#define TREE_COUNT			8
+static uv_uitreeview_st tree;
+static uv_uitreeobject_st *tree_array[TREE_COUNT];
+static uv_uitreeobject_st tree_objs[TREE_COUNT];
+static uv_uiobject_st *tree_obj_objects[TREE_COUNT][6];
+static uv_uibutton_st tree_buttons[TREE_COUNT][3];
+static uv_uilabel_st tree_labels[TREE_COUNT][3];
+static const char *const tree_names[TREE_COUNT] = {
+		"Engine", "Hydraulics", "Boom", "Head",
+		"Feeding", "Measuring", "Display", "About"
+};
+
+static void tree_show(uv_uitreeobject_st *obj) {
+	uint16_t i = (uint16_t) (obj - tree_objs);
+	// built the first time the group is opened
+	bool empty = (((uv_uiwindow_st*) obj)->objects_count == 0);
+	for (uint16_t k = 0; empty && (k < 3); k++) {
+		uv_uilabel_init(&tree_labels[i][k], &font20, ALIGN_CENTER_LEFT,
+				uv_uistyles[0].text_color, "Setting");
+		uv_uitreeobject_addxy(obj, &tree_labels[i][k], 10, 40 * k, 300, 40);
+		uv_uibutton_init(&tree_buttons[i][k], "Set", &uv_uistyles[0]);
+		uv_uitreeobject_addxy(obj, &tree_buttons[i][k], 320, 40 * k, 200, 36);
+	}
+}
+
+// A closed uitreeobject is disabled, and a disabled object is offered no
+// touches, so the groups are opened the way an application opens one
+static uint32_t tree_step_count;
+
+static uv_uiobject_ret_e tree_step(void *user_ptr, const uint16_t step_ms) {
+	if ((tree_step_count % 40) == 0) {
+		uv_uitreeview_open(&tree, &tree_objs[(tree_step_count / 40) % TREE_COUNT]);
+	}
+	else {
+	}
+	tree_step_count++;
+	return UIOBJECT_RETURN_ALIVE;
+}
+
+static void tree_build(void) {
+	uv_uidisplay_init(&display, display_objects, &uv_uistyles[0]);
+	uibench_name(&display, "uidisplay");
+	uv_uitreeview_init(&tree, tree_array, &uv_uistyles[0]);
+	uibench_name(&tree, "uitreeview");
+	uv_uidisplay_addxy(&display, &tree, 0, 0, LCD_W_PX, LCD_H_PX);
+	for (uint16_t i = 0; i < TREE_COUNT; i++) {
+		uv_uitreeobject_init(&tree_objs[i], tree_obj_objects[i],
+				tree_names[i], &tree_show, &uv_uistyles[0]);
+		uv_uitreeview_add(&tree, &tree_objs[i], 120, false);
+	}
+	uibench_name(&tree_objs[0], "uitreeobject");
+	// the widgets of a group only exist once it is opened
+	uv_uilabel_init(&tree_labels[0][0], &font20, ALIGN_CENTER_LEFT,
+			uv_uistyles[0].text_color, "");
+	uibench_name(&tree_labels[0][0], "uilabel");
+	uv_uibutton_init(&tree_buttons[0][0], "", &uv_uistyles[0]);
+	uibench_name(&tree_buttons[0][0], "uibutton");
+	tree_step_count = 0;
+	uv_uiwindow_set_stepcallback(&display, &tree_step, NULL);
+}
+
+static const touch_seg_st tree_script[] = {
+		{ 15, false, 0, 0, 0, 0 },
+		// press a button of the group open, and close the group below it
+		{ 4, true, 400, 60, 0, 0 },
+		{ 15, false, 0, 0, 0, 0 },
+		{ 4, true, 400, 180, 0, 0 },
+		{ 15, false, 0, 0, 0, 0 },
+		{ 20, true, 400, 400, 0, -6 },
+		{ 15, false, 0, 0, 0, 0 }
+};
+
+
+
+/// @brief: A tab window whose tab contents are built again whenever the tab
+/// changes, the way the applications do it
+#define TAB_COUNT			4
+static uv_uitabwindow_st tabs;
+static uv_uiobject_st *tabs_objects[12];
+static uv_uibutton_st tab_buttons[8];
+static uv_uilabel_st tab_labels[2];
+static char *tab_names[TAB_COUNT] = {
+		"Work", "Settings", "Diagnostics", "Log"
+};
+
+static void tab_fill(void) {
+	uv_uitabwindow_clear(&tabs);
+	uv_bounding_box_st bb = uv_uitabwindow_get_contentbb(&tabs);
+	uv_uilabel_init(&tab_labels[0], &font28, ALIGN_CENTER_LEFT,
+			uv_uistyles[0].text_color, tab_names[uv_uitabwindow_tab(&tabs)]);
+	uv_uitabwindow_addxy(&tabs, &tab_labels[0], 20, bb.y, 400, 50);
+	uv_uilabel_init(&tab_labels[1], &font20, ALIGN_CENTER_LEFT,
+			uv_uistyles[0].text_color, "Tap a button to run it");
+	uv_uitabwindow_addxy(&tabs, &tab_labels[1], 20, bb.y + 50, 400, 40);
+	for (uint16_t i = 0; i < 8; i++) {
+		uv_uibutton_init(&tab_buttons[i], tab_names[i % TAB_COUNT], &uv_uistyles[0]);
+		uv_uitabwindow_addxy(&tabs, &tab_buttons[i], 20 + 190 * (i % 4),
+				bb.y + 110 + 110 * (i / 4), 170, 90);
+	}
+}
+
+static uv_uiobject_ret_e tabs_step(void *user_ptr, const uint16_t step_ms) {
+	if (uv_uitabwindow_tab_changed(&tabs)) {
+		tab_fill();
+	}
+	else {
+	}
+	return UIOBJECT_RETURN_ALIVE;
+}
+
+static void tabs_build(void) {
+	uv_uidisplay_init(&display, display_objects, &uv_uistyles[0]);
+	uibench_name(&display, "uidisplay");
+	uv_uitabwindow_init(&tabs, TAB_COUNT, &uv_uistyles[0], tabs_objects, tab_names);
+	uibench_name(&tabs, "uitabwindow");
+	uv_uidisplay_addxy(&display, &tabs, 0, 0, LCD_W_PX, LCD_H_PX);
+	tab_fill();
+	uibench_name(&tab_labels[0], "uilabel");
+	uibench_name(&tab_buttons[0], "uibutton");
+	uv_uiwindow_set_stepcallback(&display, &tabs_step, NULL);
+}
+
+static const touch_seg_st tabs_script[] = {
+		{ 10, false, 0, 0, 0, 0 },
+		{ 4, true, 300, 20, 0, 0 },
+		{ 10, false, 0, 0, 0, 0 },
+		{ 4, true, 100, 200, 0, 0 },
+		{ 10, false, 0, 0, 0, 0 },
+		{ 4, true, 500, 20, 0, 0 },
+		{ 10, false, 0, 0, 0, 0 },
+		{ 4, true, 700, 20, 0, 0 },
+		{ 10, false, 0, 0, 0, 0 },
+		{ 4, true, 100, 20, 0, 0 },
+		{ 10, false, 0, 0, 0, 0 }
+};
+
+
+
+/// @brief: A panel of alarm labels fading in and out, each with a color
+/// transition attached to it that the display steps
+#define FADE_COUNT			16
+static uv_uilabel_st fade_labels[FADE_COUNT];
+static uv_uicolortransition_st fades[FADE_COUNT];
+static char fade_texts[FADE_COUNT][12];
+
+static void fade_turn(void *me, uv_uitransition_state_e last_state) {
+	// back and forth for good
+	if (uv_uitransition_get_state(me) == UITRANSITION_FINISH) {
+		uv_uitransition_reverseplay(me);
+	}
+	else if (uv_uitransition_get_state(me) == UITRANSITION_INIT) {
+		uv_uitransition_play(me);
+	}
+	else {
+	}
+}
+
+static void fade_build(void) {
+	uv_uidisplay_init(&display, display_objects, &uv_uistyles[0]);
+	uibench_name(&display, "uidisplay");
+	for (uint16_t i = 0; i < FADE_COUNT; i++) {
+		snprintf(fade_texts[i], sizeof(fade_texts[i]), "Alarm %u", i);
+		uv_uilabel_init(&fade_labels[i], &font20, ALIGN_CENTER,
+				uv_uistyles[0].text_color, fade_texts[i]);
+		uv_uidisplay_addxy(&display, &fade_labels[i], 200 * (i % 4),
+				120 * (i / 4), 200, 120);
+		uv_uicolortransition_init(&fades[i], UITRANSITION_EASING_INOUT_QUAD,
+				400, C(0xFF202020), C(0xFFFF4040), &fade_labels[i].color);
+		uv_uitransition_set_state_change_callback(&fades[i], &fade_turn);
+		uv_uitransition_attach(&fades[i], &fade_labels[i]);
+		uv_uitransition_play(&fades[i]);
+		// each at a different phase
+		uv_uitransition_set_position((uv_uitransition_st*) &fades[i], 25 * i);
+	}
+	uibench_name(&fade_labels[0], "uilabel");
+}
+
+static void fade_run(void) {
+	run_display();
+	// the transitions would go on refreshing the next screen's display
+	for (uint16_t i = 0; i < FADE_COUNT; i++) {
+		uv_uitransition_attach(&fades[i], NULL);
+	}
+}
+
+static const touch_seg_st fade_script[] = {
+		{ 1, false, 0, 0, 0, 0 }
+};
+
+
+
+/// @brief: The on-screen keyboard, typing a word and entering it. The
+/// keyboard runs its own loop, stepping a display it builds itself.
+///
+/// The key centres follow the layout in uv_uikeyboard.c: the character lines
+/// start at a quarter of the screen height, 12 keys fit a line and each line is
+/// indented by half a key more than the one above.
+#define KEY_W				(LCD_W_PX / 12)
+#define KEY_H				(LCD_HPPT(750) / 5)
+#define KEY_X(indent, k)	((KEY_W / 2) * (indent) + KEY_W * (k) + KEY_W / 2)
+#define KEY_Y(line)			(LCD_HPPT(250) - 1 + KEY_H * (line) + KEY_H / 2)
+#define KEY_TAP(indent, line, k) \
+		{ 3, true, KEY_X(indent, k), KEY_Y(line), 0, 0 }, \
+		{ 6, false, 0, 0, 0, 0 }
+
+static char keyboard_buffer[32];
+
+static void keyboard_run(void) {
+	while (!bench.done) {
+		keyboard_buffer[0] = '\0';
+		(void) uv_uikeyboard_show("Name", keyboard_buffer,
+				sizeof(keyboard_buffer), &uv_uistyles[0]);
+	}
+}
+
+static const touch_seg_st keyboard_script[] = {
+		{ 10, false, 0, 0, 0, 0 },
+		// h, e, l, l, o
+		KEY_TAP(2, 2, 5),
+		KEY_TAP(1, 1, 2),
+		KEY_TAP(2, 2, 8),
+		KEY_TAP(2, 2, 8),
+		KEY_TAP(1, 1, 8),
+		// enter, right of the second line
+		KEY_TAP(1, 1, 10)
+};
+
+
+
+#define SCREEN(name, root, run) \
+		{ #name, root, name##_build, run, name##_script, \
+				sizeof(name##_script) / sizeof(name##_script[0]) }
+
+static void keyboard_build(void) {
+}
+
+static const screen_st screens[] = {
+		SCREEN(list, "uidisplay", &run_display),
+		SCREEN(log, "uidisplay", &run_display),
+		SCREEN(graph, "uidisplay", &run_display),
+		SCREEN(chart, "uidisplay", &run_display),
+		SCREEN(tree, "uidisplay", &run_display),
+		SCREEN(tabs, "uidisplay", &run_display),
+		SCREEN(fade, "uidisplay", &fade_run),
+		SCREEN(keyboard, "uikeyboard", &keyboard_run)
+};
+
+
+
+static void run(const screen_st *s, uint32_t frames, bool instrument) {
+	memset(&bench, 0, sizeof(bench));
+	bench.screen = s;
+	bench.frames = frames;
+	bench.instrument = instrument;
+	// whatever is drawn outside every callback wrapped
+	bench.names[UNATTRIBUTED].name = "unattributed";
+	bench.name_count = 1;
+	bench.current = &bench.names[UNATTRIBUTED].draw;
+	s->build();
+	s->run();
+}
+
+
+static void print_row(const char *screen, const char *item, const char *kind,
+		double calls, double prims, double ns) {
+	char name[96];
+	char c[16];
+	char p[16];
+	char t[16];
+	snprintf(name, sizeof(name), "%s.%s%s%s", screen, item,
+			(kind != NULL) ? "." : "", (kind != NULL) ? kind : "");
+	snprintf(c, sizeof(c), (calls < 0) ? "-" : "%.2f", calls);
+	snprintf(p, sizeof(p), (prims < 0) ? "-" : "%.2f", prims);
+	snprintf(t, sizeof(t), (ns < 0) ? "-" : "%.1f", ns);
+	printf("%-48s %12s %12s %14s\n", name, c, p, t);
+}
+
+
+int main(int argc, char *argv[]) {
+	const char *filter = (argc > 1) ? argv[1] : NULL;
+	uint32_t frames = (argc > 2) ? (uint32_t) strtoul(argv[2], NULL, 10) : FRAMES_DEFAULT;
+	if (frames == 0) {
+		frames = FRAMES_DEFAULT;
+	}
+	else {
+	}
+	uv_ui_init();
+
+	printf("%-48s %12s %12s %14s\n", "# screen.item", "calls/frame",
+			"prims/frame", "ns/frame");
+	for (uint16_t i = 0; i < sizeof(screens) / sizeof(screens[0]); i++) {
+		const screen_st *s = &screens[i];
+		if ((filter != NULL) && (strstr(s->name, filter) == NULL)) {
+			continue;
+		}
+		else {
+		}
+		double n = (double) frames;
+
+		uv_ui_input_reset_latency();
+		run(s, frames, false);
+		uint64_t prims = 0;
+		for (uint8_t p = 0; p < UIBENCH_PRIM_COUNT; p++) {
+			prims += bench.prims[p];
+		}
+		print_row(s->name, "frame", NULL, 1.0, (double) prims / n,
+				(double) bench.frame_ns / n);
+		print_row(s->name, "frame", "max", -1.0, -1.0, (double) bench.frame_max_ns);
+		if (bench.transitions_max != 0) {
+			print_row(s->name, "transitions", "active",
+					(double) bench.transitions_max, -1.0, -1.0);
+		}
+		else {
+		}
+		// from the scripted touch to the frame answering it, for the touches
+		// that changed the screen
+		for (uint8_t l = 0; l < UI_LATENCY_COUNT; l++) {
+			const uv_ui_latency_st *lat = uv_ui_input_get_latency(l);
+			const char *item = (l == UI_LATENCY_DRAW) ? "input.draw" : "input.swap";
+			if (lat->count != 0) {
+				print_row(s->name, item, "p50", -1.0, -1.0,
+						1000.0 * uv_ui_latency_percentile(lat, 500));
+				print_row(s->name, item, "p99", -1.0, -1.0,
+						1000.0 * uv_ui_latency_percentile(lat, 990));
+			}
+			else {
+			}
+		}
+		for (uint8_t p = 0; p < UIBENCH_PRIM_COUNT; p++) {
+			char item[32];
+			snprintf(item, sizeof(item), "draw.%s", prim_names[p]);
+			print_row(s->name, item, NULL, (double) bench.prims[p] / n, -1.0, -1.0);
+		}
+
+		run(s, frames, true);
+		uint64_t attributed = 0;
+		for (uint8_t k = 1; k < bench.name_count; k++) {
+			const widget_name_st *w = &bench.names[k];
+			char item[48];
+			snprintf(item, sizeof(item), "widget.%s", w->name);
+			print_row(s->name, item, "draw", (double) w->draw.calls / n,
+					(double) w->draw.prims / n, (double) w->draw.ns / n);
+			print_row(s->name, item, "step", (double) w->step.calls / n,
+					(double) w->step.prims / n, (double) w->step.ns / n);
+			attributed += w->draw.ns + w->step.ns;
+		}
+		// the rest of the frame: touch handling, the application's own step
+		// and everything the display does around its children
+		print_row(s->name, "widget.unattributed", NULL, -1.0,
+				(double) bench.names[UNATTRIBUTED].draw.prims / n,
+				(double) ((bench.frame_ns > attributed) ?
+						(bench.frame_ns - attributed) : 0) / n);
+	}
+	uv_ui_destroy();
+	return 0;
+}
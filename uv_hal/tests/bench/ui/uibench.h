@@ -0,0 +1,69 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_TESTS_BENCH_UI_UIBENCH_H_
+#define UV_HAL_TESTS_BENCH_UI_UIBENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// @file: The UI frame benchmark, between the screens it drives (uibench.c)
+/// and the counting backend the UI draws into (uibench_backend.c).
+///
+/// The backend draws nothing. Every drawing call is only counted, by the kind
+/// of primitive and by the widget whose callback made it, so the benchmark
+/// measures what the widgets cost the CPU and how much they ask of the display,
+/// not how fast some display happens to be.
+
+
+/// @brief: The drawing primitives counted, in the order they are reported
+typedef enum {
+	UIBENCH_CLEAR = 0,
+	UIBENCH_MASK,
+	UIBENCH_RRECT,
+	UIBENCH_POINT,
+	UIBENCH_LINE,
+	UIBENCH_LINESTRIP,
+	UIBENCH_POLYGON,
+	UIBENCH_STRING,
+	UIBENCH_BITMAP,
+	UIBENCH_STRING_WIDTH,
+	UIBENCH_PRIM_COUNT
+} uibench_prim_e;
+
+
+/// @brief: Counts one drawing call. Called by the backend.
+void uibench_count(uibench_prim_e prim);
+
+/// @brief: Returns the scripted touch of the frame starting. The display polls
+/// the input once a step, so this is also where the benchmark tells one frame
+/// from the next.
+bool uibench_touch(int16_t *x, int16_t *y);
+
+
+#endif /* UV_HAL_TESTS_BENCH_UI_UIBENCH_H_ */
@@ -0,0 +1,261 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "uibench.h"
+#include "uv_ui_common.h"
+#include "uv_utilities.h"
+#include "ui/uv_uifont.h"
+#include "uv_ui.h"
+#include <string.h>
+
+
+/// @file: The counting UI backend of the UI frame benchmark. Implements the
+/// backend interface of uv_ui_common.h without a display: every drawing call is
+/// handed to uibench_count() and dropped.
+///
+/// The display it stands in for is the FT81X. It keeps nothing between frames,
+/// so every refresh draws the whole screen, and its fonts only need a height.
+/// String widths are estimated at half the height a character, which puts the
+/// text about where the real fonts would.
+
+
+ui_font_st ui_fonts[UI_MAX_FONT_COUNT];
+ui_font_st ui_mono_fonts[UI_MAX_FONT_COUNT];
+static const uint8_t font_sizes[UI_MAX_FONT_COUNT] = {
+		13,
+		16,
+		19,
+		21,
+		25,
+		30,
+		40,
+		58,
+		70
+};
+
+static uint8_t backlight = 100;
+
+
+
+void uv_ui_confwindow_exec(const uv_uistyle_st *style) {
+	(void) style;
+}
+
+
+void uv_ui_set_backlight(uint8_t percent) {
+	backlight = percent;
+}
+
+
+uint8_t uv_ui_get_backlight(void) {
+	return backlight;
+}
+
+
+bool uv_ui_get_refresh_request(void) {
+	return false;
+}
+
+
+bool uv_ui_frame_preserved_impl(void) {
+	return false;
+}
+
+
+// the scripted touch of the frame being stepped
+static bool touched = false;
+static int16_t touch_x = 0;
+static int16_t touch_y = 0;
+
+
+bool uv_ui_get_touch_impl(int16_t *x, int16_t *y) {
+	*x = touch_x;
+	*y = touch_y;
+	return touched;
+}
+
+
+void uv_ui_input_poll_impl(void) {
+	bool t = uibench_touch(&touch_x, &touch_y);
+	if (t) {
+		uv_ui_input_push(UI_INPUT_TOUCH, touch_x, touch_y, 0);
+	}
+	else if (touched) {
+		uv_ui_input_push(UI_INPUT_RELEASE, touch_x, touch_y, 0);
+	}
+	else {
+	}
+	touched = t;
+}
+
+
+const char *uv_ui_get_clipboard(void) {
+	return "";
+}
+
+
+void uv_ui_clear_impl(color_t c) {
+	uibench_count(UIBENCH_CLEAR);
+}
+
+
+void uv_ui_dlswap_impl(void) {
+}
+
+
+void uv_ui_draw_bitmap_ext_impl(uv_uimedia_st *bitmap, int16_t x, int16_t y,
+		int16_t w, int16_t h, uint32_t wrap, color_t c) {
+	uibench_count(UIBENCH_BITMAP);
+}
+
+
+void uv_ui_draw_point_impl(int16_t x, int16_t y, color_t color, uint16_t diameter) {
+	uibench_count(UIBENCH_POINT);
+}
+
+
+void uv_ui_draw_rrect_impl(const int16_t x, const int16_t y,
+		const uint16_t width, const uint16_t height,
+		const uint16_t radius, const color_t color) {
+	uibench_count(UIBENCH_RRECT);
+}
+
+
+void uv_ui_draw_line_impl(const int16_t start_x, const int16_t start_y,
+		const int16_t end_x, const int16_t end_y,
+		const uint16_t width, const color_t color) {
+	uibench_count(UIBENCH_LINE);
+}
+
+
+void uv_ui_draw_linestrip_impl(const uv_ui_linestrip_point_st *points,
+		const uint16_t point_count, const uint16_t line_width, const color_t color,
+		const uv_ui_strip_type_e type) {
+	uibench_count(UIBENCH_LINESTRIP);
+}
+
+
+void uv_ui_draw_polygon_impl(const uv_ui_linestrip_point_st *points,
+		const uint16_t point_count, const color_t color) {
+	uibench_count(UIBENCH_POLYGON);
+}
+
+
+void uv_ui_draw_string_impl(char *str, ui_font_st *font,
+		int16_t x, int16_t y, ui_align_e align, color_t color) {
+	uibench_count(UIBENCH_STRING);
+}
+
+
+void uv_ui_force_mask(int16_t x, int16_t y, int16_t width, int16_t height) {
+	uv_ui_set_mask(x, y, width, height);
+}
+
+
+void uv_ui_set_mask_impl(int16_t x, int16_t y, int16_t width, int16_t height) {
+	uibench_count(UIBENCH_MASK);
+}
+
+
+int16_t uv_ui_get_string_width(char *str, ui_font_st *font) {
+	int32_t ret = 0;
+	uibench_count(UIBENCH_STRING_WIDTH);
+	if (str != NULL) {
+		const char *s = str;
+		int32_t w = 0;
+		while (*s != '\0') {
+			if (*s == '\n') {
+				ret = MAX(ret, w);
+				w = 0;
+				s++;
+			}
+			else {
+				(void) uv_ui_utf8_next(&s);
+				w += font->char_height / 2;
+			}
+		}
+		ret = MAX(ret, w);
+	}
+	else {
+	}
+	return (int16_t) MIN(ret, INT16_MAX);
+}
+
+
+uint32_t uv_uimedia_newbitmapexmem(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename) {
+	// there are no files to load
+	memset(bitmap, 0, sizeof(*bitmap));
+	return 0;
+}
+
+
+uint32_t uv_uimedia_newbitmapexmem_mem(uv_uimedia_st *bitmap,
+		const char *name, const uint8_t *data, uint32_t datalen) {
+	memset(bitmap, 0, sizeof(*bitmap));
+	return 0;
+}
+
+
+void uv_uimedia_newbitmapexmem_async(uv_uimedia_st *bitmap,
+		uv_w25q128_st *exmem, const char *filename) {
+	uv_uimedia_newbitmapexmem(bitmap, exmem, filename);
+}
+
+
+void uv_uimedia_free(uv_uimedia_st *bitmap) {
+	memset(bitmap, 0, sizeof(*bitmap));
+}
+
+
+void uv_ui_touchscreen_calibrate(ui_transfmat_st *transform_matrix) {
+}
+
+
+void uv_ui_touchscreen_set_transform_matrix(ui_transfmat_st *transform_matrix) {
+}
+
+
+bool uv_ui_init(void) {
+	for (uint8_t i = 0; i < UI_MAX_FONT_COUNT; i++) {
+		ui_fonts[i].char_height = font_sizes[i];
+		ui_mono_fonts[i].char_height = font_sizes[i];
+	}
+	return false;
+}
+
+
+void uv_ui_destroy(void) {
+}
+
+
+void uv_rtos_task_delay(unsigned int ms) {
+	// the dialogs wait for their next step here, and there is no other task
+	// to give the time to
+}
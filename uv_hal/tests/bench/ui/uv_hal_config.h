@@ -0,0 +1,75 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_TESTS_BENCH_UI_UV_HAL_CONFIG_H_
+#define UV_HAL_TESTS_BENCH_UI_UV_HAL_CONFIG_H_
+
+/// @file: uv_hal configuration of the UI frame benchmark.
+///
+/// The configuration of the tests, with the UI framework switched on in the
+/// settings a typical 800 x 480 display uses. Only bench/ui is built with it;
+/// the tests and the other benchmarks never see the UI.
+
+#include "../../config/uv_hal_config.h"
+
+
+#define CONFIG_UI									1
+#define CONFIG_UI_TOUCHSCREEN						1
+#define CONFIG_FT81X_HSIZE							800
+#define CONFIG_FT81X_VSIZE							480
+
+#define CONFIG_UI_RADIUS							4
+#define CONFIG_UI_CLICK_THRESHOLD					10
+#define CONFIG_UI_DISABLED_OBJECT_BRIGHTNESS		-50
+#define CONFIG_UI_WINDOW_SCROLLBAR_WIDTH			10
+#define CONFIG_UI_BUTTON_LONGPRESS_DELAY_MS			500
+#define CONFIG_UI_DIGITEDIT_INCDEC_BUTTON_WIDTH		40
+#define CONFIG_UI_GRAPH_LINE_WIDTH					2
+#define CONFIG_UI_LISTBUTTON_BAR_HEIGHT				10
+#define CONFIG_UI_LIST_ENTRY_HEIGHT					40
+#define CONFIG_UI_PROGRESSAR_HEIGHT					10
+#define CONFIG_UI_PROGRESSBAR_HEIGHT				10
+#define CONFIG_UI_PROGRESSBAR_SPACE					2
+#define CONFIG_UI_PROGRESSBAR_WIDTH					10
+#define CONFIG_UI_SLIDER_INC_DEC_WIDTH				30
+#define CONFIG_UI_SLIDER_WIDTH						20
+#define CONFIG_UI_TABWINDOW_HEADER_HEIGHT			40
+#define CONFIG_UI_TABWINDOW_HEADER_MIN_WIDTH		60
+#define CONFIG_UI_TREEVIEW_ARROW_FONT				font16
+#define CONFIG_UI_TREEVIEW_ITEM_HEIGHT				40
+
+#define CONFIG_UI_STYLES_COUNT						1
+#define CONFIG_UI_STYLE_BG_C_1						C(0xFF373A44)
+#define CONFIG_UI_STYLE_FG_C_1						C(0xFF945DD2)
+#define CONFIG_UI_STYLE_FONT_1						font16
+#define CONFIG_UI_STYLE_TEXT_COLOR_1				C(0xFFFFFFFF)
+#define CONFIG_UI_STYLE_WINDOW_C_1					C(0xFF040404)
+#define CONFIG_UI_STYLE_DISPLAY_C_1					C(0xFF151516)
+
+
+#endif /* UV_HAL_TESTS_BENCH_UI_UV_HAL_CONFIG_H_ */
@@ -0,0 +1,165 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/// @brief: The maximum number of benchmarks the runner can hold
+#define UV_BENCH_MAX_COUNT		128
+
+/// @brief: A single timed call has to last at least this long before its result
+/// is trusted. Shorter calls are repeated with more iterations.
+#define UV_BENCH_MIN_TIME_NS	200000000ULL
+
+
+typedef struct {
+	const char *suite;
+	const char *name;
+	uv_bench_fn_t fn;
+} uv_bench_case_st;
+
+
+static uv_bench_case_st benches[UV_BENCH_MAX_COUNT];
+static unsigned int bench_count = 0;
+
+
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+
+
+void uv_bench_register(const char *suite, const char *name, uv_bench_fn_t fn) {
+	if (bench_count >= UV_BENCH_MAX_COUNT) {
+		fprintf(stderr,
+				"uv_bench: benchmark table full (%u), raise UV_BENCH_MAX_COUNT\n",
+				(unsigned int) UV_BENCH_MAX_COUNT);
+		exit(2);
+	}
+	else {
+		benches[bench_count].suite = suite;
+		benches[bench_count].name = name;
+		benches[bench_count].fn = fn;
+		bench_count++;
+	}
+}
+
+
+
+void uv_bench_report(uv_bench_st *b, const char *name, double value) {
+	for (uint8_t i = 0; i < b->counter_count; i++) {
+		if (strcmp(b->counters[i].name, name) == 0) {
+			b->counters[i].value = value;
+			return;
+		}
+	}
+	if (b->counter_count < UV_BENCH_COUNTER_COUNT) {
+		b->counters[b->counter_count].name = name;
+		b->counters[b->counter_count].value = value;
+		b->counter_count++;
+	}
+}
+
+
+
+void uv_bench_pause(uv_bench_st *b) {
+	b->pause_start_ns = now_ns();
+}
+
+
+
+void uv_bench_resume(uv_bench_st *b) {
+	b->excluded_ns += now_ns() - b->pause_start_ns;
+}
+
+
+
+int main(int argc, char **argv) {
+	const char *pattern = (argc > 1) ? argv[1] : NULL;
+
+	// one line per benchmark, whitespace separated, so that two runs can be
+	// compared with diff or joined on the first column
+	printf("%-56s %12s %14s %10s  %s\n",
+			"# benchmark", "iterations", "ns/op", "MB/s", "counters");
+
+	for (unsigned int i = 0; i < bench_count; i++) {
+		char full_name[256];
+		snprintf(full_name, sizeof(full_name), "%s.%s",
+				benches[i].suite, benches[i].name);
+		if ((pattern != NULL) && (strstr(full_name, pattern) == NULL)) {
+			continue;
+		}
+
+		uv_bench_st b;
+		uint64_t elapsed = 0;
+		uint32_t n = 1;
+		while (true) {
+			memset(&b, 0, sizeof(b));
+			b.n = n;
+			uint64_t start = now_ns();
+			benches[i].fn(&b);
+			elapsed = now_ns() - start - b.excluded_ns;
+			if ((elapsed >= UV_BENCH_MIN_TIME_NS) ||
+					(n >= (UINT32_MAX / 4))) {
+				break;
+			}
+			// aim a little past the minimum so the next round is the last
+			uint64_t next = (elapsed == 0) ? (uint64_t) n * 100 :
+					(uint64_t) n * UV_BENCH_MIN_TIME_NS * 6 / 5 / elapsed + 1;
+			if (next > (uint64_t) n * 100) {
+				next = (uint64_t) n * 100;
+			}
+			if (next > (UINT32_MAX / 4)) {
+				next = UINT32_MAX / 4;
+			}
+			n = (uint32_t) next;
+		}
+
+		double ns_per_op = (double) elapsed / (double) b.n;
+		printf("%-56s %12u %14.1f ", full_name, b.n, ns_per_op);
+		if (b.bytes != 0) {
+			printf("%10.1f ", (double) b.bytes * 1000.0 / ns_per_op);
+		}
+		else {
+			printf("%10s ", "-");
+		}
+		for (uint8_t c = 0; c < b.counter_count; c++) {
+			printf(" %s=%.2f", b.counters[c].name, b.counters[c].value);
+		}
+		printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef UV_HAL_TESTS_UV_BENCH_H_
+#define UV_HAL_TESTS_UV_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// @file: A minimal host-side benchmark runner, the timing counterpart of
+/// uv_test.h.
+///
+/// Benchmarks register themselves the same way test cases do. The runner calls
+/// a benchmark body with a growing iteration count until one call takes long
+/// enough to time reliably, and reports the time per iteration.
+///
+/// Host timings say nothing absolute about a Cortex-M. What they are good for
+/// is comparing two versions of the same code on the same machine, so the
+/// output is one line per benchmark in a fixed column layout that diffs
+/// cleanly between two runs.
+///
+/// @example:
+///		BENCH(remote_stream, feed_can_payloads) {
+///			uv_bench_set_bytes(b, sizeof(payload));
+///			for (uint32_t i = 0; i < b->n; i++) {
+///				remote_stream_feed(&stream, payload, sizeof(payload), NULL, NULL);
+///			}
+///		}
+
+
+/// @brief: Maximum number of extra counters one benchmark can report
+#define UV_BENCH_COUNTER_COUNT		4
+
+
+typedef struct {
+	/// @brief: How many iterations the body should run
+	uint32_t n;
+	/// @brief: Bytes processed per iteration, for the throughput column.
+	/// 0 if the benchmark doesn't process a byte stream.
+	uint64_t bytes;
+	struct {
+		const char *name;
+		double value;
+	} counters[UV_BENCH_COUNTER_COUNT];
+	uint8_t counter_count;
+	/// @brief: Time spent in setup, excluded from the result
+	uint64_t excluded_ns;
+	uint64_t pause_start_ns;
+} uv_bench_st;
+
+
+typedef void (*uv_bench_fn_t)(uv_bench_st *b);
+
+
+/// @brief: Registers a benchmark. Called automatically by the BENCH macro.
+void uv_bench_register(const char *suite, const char *name, uv_bench_fn_t fn);
+
+
+/// @brief: Sets how many bytes one iteration processes
+static inline void uv_bench_set_bytes(uv_bench_st *b, uint64_t bytes) {
+	b->bytes = bytes;
+}
+
+
+/// @brief: Reports an extra figure with the result, for example the number of
+/// messages that fit one payload. Reported as is, not divided by anything.
+void uv_bench_report(uv_bench_st *b, const char *name, double value);
+
+
+/// @brief: Stops the clock, for setup work inside the body that should not
+/// count towards the result
+void uv_bench_pause(uv_bench_st *b);
+
+/// @brief: Restarts the clock stopped with uv_bench_pause
+void uv_bench_resume(uv_bench_st *b);
+
+
+/// @brief: Keeps the compiler from optimising away a result that is never used
+#define UV_BENCH_KEEP(x_) \
+	__asm__ volatile("" : : "g"(x_) : "memory")
+
+
+/// @brief: Defines a benchmark and registers it to the runner. The body sees
+/// the benchmark state as *b*.
+#define BENCH(suite_, name_) \
+	static void uv_bench_body_##suite_##_##name_(uv_bench_st *b); \
+	static void __attribute__((constructor)) \
+			uv_bench_reg_##suite_##_##name_(void) { \
+		uv_bench_register(#suite_, #name_, \
+				&uv_bench_body_##suite_##_##name_); \
+	} \
+	static void uv_bench_body_##suite_##_##name_(uv_bench_st *b)
+
+
+#endif /* UV_HAL_TESTS_UV_BENCH_H_ */
@@ -63,6 +63,10 @@
 #define CONFIG_JSON									1
 #define CONFIG_YAML									1
 
+/* The CPU time statistics are under test, and with them their CANopen objects.
+ * The clock is the host's monotonic clock. */
+#define CONFIG_CPUTIME								1
+
 /* The CANopen SDO server and client are under test. CAN is configured only far
  * enough for the headers to be well formed and for the protocol code to compile;
  * no hardware is touched. uv_can_send() is stubbed in stubs/canopen_stubs.c,
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_cputime.h"
+#include "uv_canopen.h"
+#include "canopen/canopen_obj_dict.h"
+#include <time.h>
+
+/// @file: Tests for the CPU time statistics of the HAL and application steps.
+///
+/// The statistics are checked with times given to them directly. The clock
+/// is the host's monotonic one and is only checked against a sleep, loosely,
+/// since the host can always take longer than asked.
+
+
+TEST(cputime, keeps_the_min_avg_and_max) {
+	uv_cputime_st t;
+	uv_cputime_reset(&t);
+	TEST_ASSERT_EQ(t.count, 0);
+	TEST_ASSERT_EQ(t.min_ns, UINT32_MAX);
+	uv_cputime_add(&t, 3000);
+	uv_cputime_add(&t, 1000);
+	uv_cputime_add(&t, 5000);
+	TEST_ASSERT_EQ(t.count, 3);
+	TEST_ASSERT_EQ(t.min_ns, 1000);
+	TEST_ASSERT_EQ(t.avg_ns, 3000);
+	TEST_ASSERT_EQ(t.max_ns, 5000);
+}
+
+
+TEST(cputime, buckets_double_from_one_microsecond) {
+	TEST_ASSERT_EQ(uv_cputime_bucket(0), 0);
+	TEST_ASSERT_EQ(uv_cputime_bucket(999), 0);
+	TEST_ASSERT_EQ(uv_cputime_bucket(1000), 1);
+	TEST_ASSERT_EQ(uv_cputime_bucket(1999), 1);
+	TEST_ASSERT_EQ(uv_cputime_bucket(2000), 2);
+	TEST_ASSERT_EQ(uv_cputime_bucket(3999), 2);
+	TEST_ASSERT_EQ(uv_cputime_bucket(16383999), CPUTIME_HIST_BUCKETS - 2);
+	TEST_ASSERT_EQ(uv_cputime_bucket(16384000), CPUTIME_HIST_BUCKETS - 1);
+	TEST_ASSERT_EQ(uv_cputime_bucket(UINT32_MAX), CPUTIME_HIST_BUCKETS - 1);
+
+	// every time is below the upper edge of its bucket
+	bool below = true;
+	for (uint32_t us = 0; us < 20000; us += 7) {
+		uint8_t b = uv_cputime_bucket(us * 1000);
+		if (us >= uv_cputime_bucket_us(b)) {
+			below = false;
+		}
+		if ((b != 0) && (us < uv_cputime_bucket_us(b - 1))) {
+			below = false;
+		}
+	}
+	TEST_ASSERT_TRUE(below);
+}
+
+
+TEST(cputime, the_histogram_counts_every_time) {
+	uv_cputime_st t;
+	uv_cputime_reset(&t);
+	uv_cputime_add(&t, 500);
+	uv_cputime_add(&t, 1500);
+	uv_cputime_add(&t, 1600);
+	uv_cputime_add(&t, 100000000);
+	TEST_ASSERT_EQ(t.hist[0], 1);
+	TEST_ASSERT_EQ(t.hist[1], 2);
+	TEST_ASSERT_EQ(t.hist[CPUTIME_HIST_BUCKETS - 1], 1);
+	uint32_t sum = 0;
+	for (uint8_t i = 0; i < CPUTIME_HIST_BUCKETS; i++) {
+		sum += t.hist[i];
+	}
+	TEST_ASSERT_EQ(sum, t.count);
+}
+
+
+TEST(cputime, the_average_survives_the_sum_overflowing) {
+	uv_cputime_st t;
+	uv_cputime_reset(&t);
+	// 4.29 s in all after the first 2150
+	for (uint32_t i = 0; i < 10000; i++) {
+		uv_cputime_add(&t, 2000000);
+	}
+	TEST_ASSERT_EQ(t.count, 10000);
+	TEST_ASSERT_EQ(t.avg_ns, 2000000);
+
+	// a single time longer than the sum can hold alone
+	uv_cputime_add(&t, UINT32_MAX);
+	TEST_ASSERT_EQ(t.avg_ns, UINT32_MAX);
+	TEST_ASSERT_EQ(t.max_ns, UINT32_MAX);
+}
+
+
+TEST(cputime, the_clock_measures_a_sleep) {
+	uv_cputime_init();
+	uint32_t start = uv_cputime_begin();
+	struct timespec ts = { .tv_sec = 0, .tv_nsec = 2000000 };
+	nanosleep(&ts, NULL);
+	uv_cputime_end(CPUTIME_APP, start);
+	const uv_cputime_st *t = uv_cputime_get(CPUTIME_APP);
+	TEST_ASSERT_EQ(t->count, 1);
+	TEST_ASSERT_RANGE(t->max_ns, 2000000, 1000000000);
+	TEST_ASSERT_EQ(uv_cputime_get(CPUTIME_HAL_STEP)->count, 0);
+
+	uv_cputime_reset_all();
+	TEST_ASSERT_EQ(t->count, 0);
+}
+
+
+TEST(cputime, the_slots_are_canopen_arrays) {
+	uv_cputime_reset_all();
+	uv_cputime_add(uv_cputime_get(CPUTIME_HAL_CAN), 1234);
+
+	const canopen_object_st *obj = _uv_canopen_obj_dict_get(
+			CONFIG_CANOPEN_CPUTIME_INDEX + CPUTIME_HAL_CAN, 2);
+	TEST_ASSERT_NOT_NULL(obj);
+	TEST_ASSERT_EQ(obj->array_max_size, CPUTIME_OBJ_LEN);
+	TEST_ASSERT_EQ(obj->permissions, CANOPEN_RO);
+	// sub-index 2 is the minimum
+	TEST_ASSERT_EQ(((uint32_t *) obj->data_ptr)[1], 1234);
+
+	// the last application slot is the last object
+	TEST_ASSERT_NOT_NULL(_uv_canopen_obj_dict_get(
+			CONFIG_CANOPEN_CPUTIME_INDEX + CPUTIME_COUNT - 1, 1));
+	TEST_ASSERT_NULL(_uv_canopen_obj_dict_get(
+			CONFIG_CANOPEN_CPUTIME_INDEX + CPUTIME_COUNT, 1));
+	uv_cputime_reset_all();
+}
@@ -0,0 +1,138 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_framebuffer.h"
+#include <string.h>
+
+/// @file: Tests for the framebuffer fills and copies.
+///
+/// Every fast fill is checked against the pixel at a time one, from every
+/// alignment the pixels can start at and over lengths around the word size,
+/// including that not one pixel outside the span is touched.
+
+
+#define PIXELS		96
+#define GUARD		0xA5A5A5A5u
+
+
+TEST(framebuffer, fill16_matches_the_scalar_fill) {
+	uint16_t fast[PIXELS];
+	uint16_t ref[PIXELS];
+	bool same = true;
+	for (uint32_t start = 0; start < 8; start++) {
+		for (uint32_t len = 0; len < (PIXELS - 16); len++) {
+			memset(fast, 0xA5, sizeof(fast));
+			memset(ref, 0xA5, sizeof(ref));
+			uv_fb_fill16(&fast[start], 0x1234, len);
+			uv_fb_fill16_scalar(&ref[start], 0x1234, len);
+			if (memcmp(fast, ref, sizeof(fast)) != 0) {
+				same = false;
+			}
+		}
+	}
+	TEST_ASSERT_TRUE(same);
+}
+
+
+TEST(framebuffer, fill32_matches_the_scalar_fill) {
+	uint32_t fast[PIXELS];
+	uint32_t ref[PIXELS];
+	bool same = true;
+	for (uint32_t start = 0; start < 4; start++) {
+		for (uint32_t len = 0; len < (PIXELS - 8); len++) {
+			for (uint32_t i = 0; i < PIXELS; i++) {
+				fast[i] = GUARD;
+				ref[i] = GUARD;
+			}
+			uv_fb_fill32(&fast[start], 0x00FF8040, len);
+			uv_fb_fill32_scalar(&ref[start], 0x00FF8040, len);
+			if (memcmp(fast, ref, sizeof(fast)) != 0) {
+				same = false;
+			}
+		}
+	}
+	TEST_ASSERT_TRUE(same);
+}
+
+
+TEST(framebuffer, a_rectangle_leaves_the_rest_of_its_rows_alone) {
+	uint16_t fb[10][12];
+	memset(fb, 0, sizeof(fb));
+	uv_fb_fill_rect16(&fb[2][3], 12, 5, 4, 0xBEEF);
+	uint32_t filled = 0;
+	bool inside = true;
+	for (uint32_t y = 0; y < 10; y++) {
+		for (uint32_t x = 0; x < 12; x++) {
+			bool in = (x >= 3) && (x < 8) && (y >= 2) && (y < 6);
+			if (fb[y][x] == 0xBEEF) {
+				filled++;
+				if (!in) {
+					inside = false;
+				}
+			}
+		}
+	}
+	TEST_ASSERT_EQ(filled, 20);
+	TEST_ASSERT_TRUE(inside);
+}
+
+
+TEST(framebuffer, a_full_width_rectangle_is_one_span) {
+	uint32_t fb[6][7];
+	for (uint32_t i = 0; i < 6 * 7; i++) {
+		((uint32_t *) fb)[i] = GUARD;
+	}
+	uv_fb_fill_rect32(&fb[1][0], 7, 7, 4, 0x123456);
+	TEST_ASSERT_EQ(fb[0][6], GUARD);
+	TEST_ASSERT_EQ(fb[1][0], 0x123456);
+	TEST_ASSERT_EQ(fb[4][6], 0x123456);
+	TEST_ASSERT_EQ(fb[5][0], GUARD);
+}
+
+
+TEST(framebuffer, blit_copies_rows_between_strides) {
+	uint16_t img[3][4];
+	uint16_t fb[5][8];
+	for (uint16_t i = 0; i < 12; i++) {
+		((uint16_t *) img)[i] = i + 1;
+	}
+	memset(fb, 0, sizeof(fb));
+	uv_fb_blit(&fb[1][2], sizeof(fb[0]), img, sizeof(img[0]), sizeof(img[0]), 3);
+	TEST_ASSERT_EQ(fb[1][2], 1);
+	TEST_ASSERT_EQ(fb[1][5], 4);
+	TEST_ASSERT_EQ(fb[1][6], 0);
+	TEST_ASSERT_EQ(fb[2][2], 5);
+	TEST_ASSERT_EQ(fb[3][5], 12);
+	TEST_ASSERT_EQ(fb[4][2], 0);
+
+	// rows that follow each other in both end up the same
+	uint16_t copy[3][4];
+	uv_fb_blit(copy, sizeof(copy[0]), img, sizeof(img[0]), sizeof(img[0]), 3);
+	TEST_ASSERT_TRUE(memcmp(copy, img, sizeof(img)) == 0);
+}
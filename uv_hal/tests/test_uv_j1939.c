@@ -0,0 +1,318 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_j1939.h"
+
+#include <string.h>
+
+/// @file: Tests for the J1939 PGN dispatch table.
+///
+/// The dispatcher sits in the CAN receive callback of every device talking to
+/// an engine or a J1939 joystick, so it is tested with the frames such a node
+/// actually puts on the bus: single frame PGN's addressed by PDU1 and PDU2
+/// format identifiers, and BAM transport protocol transfers split into TP.CM
+/// and TP.DT frames.
+
+
+#define DM1_ID(sa)		(0x18FECA00UL | (sa))
+#define TP_CM_ID(sa)	(0x18ECFF00UL | (sa))
+#define TP_DT_ID(sa)	(0x18EBFF00UL | (sa))
+
+
+typedef struct {
+	uint32_t count;
+	uint16_t pgn;
+	uint8_t source_address;
+	const uint8_t *data;
+	uint16_t data_len;
+	uint8_t copy[64];
+} handler_log_st;
+
+static handler_log_st log_a;
+static handler_log_st log_b;
+
+
+static void log_call(handler_log_st *log, uint16_t pgn, uint8_t sa,
+		const uint8_t *data, uint16_t data_len) {
+	log->count++;
+	log->pgn = pgn;
+	log->source_address = sa;
+	log->data = data;
+	log->data_len = data_len;
+	memcpy(log->copy, data, (data_len < sizeof(log->copy)) ? data_len : sizeof(log->copy));
+}
+
+static void handler_a(void *user_ptr, uint16_t pgn, uint8_t sa,
+		const uint8_t *data, uint16_t data_len) {
+	log_call(&log_a, pgn, sa, data, data_len);
+}
+
+static void handler_b(void *user_ptr, uint16_t pgn, uint8_t sa,
+		const uint8_t *data, uint16_t data_len) {
+	log_call(&log_b, pgn, sa, data, data_len);
+}
+
+
+static uv_j1939_dispatch_st dispatch;
+static uv_j1939_handler_st handlers[8];
+static uint8_t tp_buffer[32];
+
+
+static void setup(void) {
+	memset(&log_a, 0, sizeof(log_a));
+	memset(&log_b, 0, sizeof(log_b));
+	uv_j1939_dispatch_init(&dispatch, handlers,
+			sizeof(handlers) / sizeof(handlers[0]), tp_buffer, sizeof(tp_buffer));
+}
+
+
+static uv_can_msg_st ext_msg(uint32_t id, uint8_t len, const uint8_t *data) {
+	uv_can_msg_st msg = { .id = id, .type = CAN_EXT, .data_length = len };
+	memcpy(msg.data_8bit, data, len);
+	return msg;
+}
+
+
+static void send_bam(uint8_t sa, uint16_t pgn, const uint8_t *data, uint16_t len) {
+	uint8_t packets = (len + 6) / 7;
+	uint8_t cm[8] = { UV_J1939_TP_CM_BAM, len & 0xFF, len >> 8, packets,
+			0xFF, pgn & 0xFF, pgn >> 8, 0 };
+	uv_can_msg_st msg = ext_msg(TP_CM_ID(sa), 8, cm);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+	for (uint8_t i = 0; i < packets; i++) {
+		uint8_t dt[8];
+		memset(dt, 0xFF, sizeof(dt));
+		dt[0] = i + 1;
+		memcpy(&dt[1], &data[i * 7], (len - i * 7 < 7) ? len - i * 7 : 7);
+		msg = ext_msg(TP_DT_ID(sa), 8, dt);
+		uv_j1939_dispatch_rx(&dispatch, &msg);
+	}
+}
+
+
+TEST(j1939_dispatch, calls_the_handler_of_a_single_frame_pgn_with_the_frame_payload) {
+	setup();
+	TEST_ASSERT_EQ(uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1,
+			UV_J1939_SA_ANY, &handler_a), ERR_NONE);
+
+	uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	uv_can_msg_st msg = ext_msg(DM1_ID(0x00), 8, data);
+	TEST_ASSERT_TRUE(uv_j1939_dispatch_rx(&dispatch, &msg));
+
+	TEST_ASSERT_EQ(log_a.count, 1);
+	TEST_ASSERT_EQ(log_a.pgn, UV_J1939_PGN_DM1);
+	TEST_ASSERT_EQ(log_a.data_len, 8);
+	// no copy: the handler sees the received message itself
+	TEST_ASSERT_TRUE(log_a.data == msg.data_8bit);
+}
+
+
+TEST(j1939_dispatch, does_not_consume_unregistered_or_standard_frames) {
+	setup();
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, UV_J1939_SA_ANY, &handler_a);
+
+	uint8_t data[8] = { 0 };
+	uv_can_msg_st msg = ext_msg(0x18FEE500, 8, data);
+	TEST_ASSERT_FALSE(uv_j1939_dispatch_rx(&dispatch, &msg));
+
+	msg = ext_msg(DM1_ID(0), 8, data);
+	msg.type = CAN_STD;
+	TEST_ASSERT_FALSE(uv_j1939_dispatch_rx(&dispatch, &msg));
+	TEST_ASSERT_EQ(log_a.count, 0);
+}
+
+
+TEST(j1939_dispatch, filters_by_source_address) {
+	setup();
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, 0x21, &handler_a);
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, UV_J1939_SA_ANY, &handler_b);
+
+	uint8_t data[8] = { 0 };
+	uv_can_msg_st msg = ext_msg(DM1_ID(0x21), 8, data);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+	TEST_ASSERT_EQ(log_a.count, 1);
+	TEST_ASSERT_EQ(log_b.count, 1);
+
+	msg = ext_msg(DM1_ID(0x22), 8, data);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+	TEST_ASSERT_EQ(log_a.count, 1);
+	TEST_ASSERT_EQ(log_b.count, 2);
+	TEST_ASSERT_EQ(log_b.source_address, 0x22);
+}
+
+
+TEST(j1939_dispatch, ignores_the_destination_address_of_pdu1_pgns) {
+	setup();
+	// proprietary A, PDU1 format
+	uv_j1939_dispatch_add(&dispatch, 0xEF00, UV_J1939_SA_ANY, &handler_a);
+
+	uint8_t data[8] = { 0 };
+	uv_can_msg_st msg = ext_msg(0x18EF2A05, 8, data);
+	TEST_ASSERT_TRUE(uv_j1939_dispatch_rx(&dispatch, &msg));
+	TEST_ASSERT_EQ(log_a.count, 1);
+	TEST_ASSERT_EQ(log_a.pgn, 0xEF00);
+}
+
+
+TEST(j1939_dispatch, finds_handlers_among_many_pgns) {
+	setup();
+	// registered out of order, the table keeps itself sorted
+	uint16_t pgns[] = { 0xFEF1, 0xF004, 0xFECA, 0xFEE5, 0xFEEE, 0xF003 };
+	for (uint8_t i = 0; i < sizeof(pgns) / sizeof(pgns[0]); i++) {
+		TEST_ASSERT_EQ(uv_j1939_dispatch_add(&dispatch, pgns[i],
+				UV_J1939_SA_ANY, (pgns[i] == 0xFEE5) ? &handler_a : &handler_b), ERR_NONE);
+	}
+	TEST_ASSERT_EQ(uv_j1939_dispatch_get_count(&dispatch), 6);
+
+	uint8_t data[8] = { 0 };
+	uv_can_msg_st msg = ext_msg(0x18FEE500, 8, data);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+	TEST_ASSERT_EQ(log_a.count, 1);
+	TEST_ASSERT_EQ(log_b.count, 0);
+
+	for (uint8_t i = 0; i < sizeof(pgns) / sizeof(pgns[0]); i++) {
+		msg = ext_msg(0x18000000 | ((uint32_t) pgns[i] << 8), 8, data);
+		TEST_ASSERT_TRUE(uv_j1939_dispatch_rx(&dispatch, &msg));
+	}
+	TEST_ASSERT_EQ(log_a.count, 2);
+	TEST_ASSERT_EQ(log_b.count, 5);
+}
+
+
+TEST(j1939_dispatch, reports_a_full_table) {
+	setup();
+	for (uint16_t i = 0; i < sizeof(handlers) / sizeof(handlers[0]); i++) {
+		TEST_ASSERT_EQ(uv_j1939_dispatch_add(&dispatch, 0xFF00 + i,
+				UV_J1939_SA_ANY, &handler_a), ERR_NONE);
+	}
+	TEST_ASSERT_EQ(uv_j1939_dispatch_add(&dispatch, 0xFEFE,
+			UV_J1939_SA_ANY, &handler_a), ERR_BUFFER_OVERFLOW);
+}
+
+
+TEST(j1939_dispatch, removed_handlers_are_no_longer_called) {
+	setup();
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, UV_J1939_SA_ANY, &handler_a);
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, UV_J1939_SA_ANY, &handler_b);
+	TEST_ASSERT_EQ(uv_j1939_dispatch_remove(&dispatch, UV_J1939_PGN_DM1,
+			UV_J1939_SA_ANY, &handler_a), ERR_NONE);
+	TEST_ASSERT_EQ(uv_j1939_dispatch_remove(&dispatch, UV_J1939_PGN_DM1,
+			UV_J1939_SA_ANY, &handler_a), ERR_INVALID_DATA);
+
+	uint8_t data[8] = { 0 };
+	uv_can_msg_st msg = ext_msg(DM1_ID(0), 8, data);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+	TEST_ASSERT_EQ(log_a.count, 0);
+	TEST_ASSERT_EQ(log_b.count, 1);
+}
+
+
+TEST(j1939_dispatch, reassembles_a_bam_transfer_into_the_same_handler) {
+	setup();
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, UV_J1939_SA_ANY, &handler_a);
+
+	uint8_t payload[18];
+	for (uint8_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = 0x40 + i;
+	}
+	send_bam(0x00, UV_J1939_PGN_DM1, payload, sizeof(payload));
+
+	TEST_ASSERT_EQ(log_a.count, 1);
+	TEST_ASSERT_EQ(log_a.pgn, UV_J1939_PGN_DM1);
+	TEST_ASSERT_EQ(log_a.data_len, sizeof(payload));
+	TEST_ASSERT_EQ(memcmp(log_a.copy, payload, sizeof(payload)), 0);
+	TEST_ASSERT_TRUE(log_a.data == tp_buffer);
+}
+
+
+TEST(j1939_dispatch, ignores_bam_transfers_nobody_listens_to) {
+	setup();
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, 0x10, &handler_a);
+
+	uint8_t payload[10] = { 0 };
+	send_bam(0x11, UV_J1939_PGN_DM1, payload, sizeof(payload));
+	send_bam(0x10, 0xFEE5, payload, sizeof(payload));
+	TEST_ASSERT_EQ(log_a.count, 0);
+}
+
+
+TEST(j1939_dispatch, drops_a_bam_transfer_too_long_for_the_buffer) {
+	setup();
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, UV_J1939_SA_ANY, &handler_a);
+
+	uint8_t payload[sizeof(tp_buffer) + 1] = { 0 };
+	send_bam(0x00, UV_J1939_PGN_DM1, payload, sizeof(payload));
+	TEST_ASSERT_EQ(log_a.count, 0);
+}
+
+
+TEST(j1939_dispatch, drops_a_bam_transfer_with_a_lost_packet) {
+	setup();
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, UV_J1939_SA_ANY, &handler_a);
+
+	uint8_t cm[8] = { UV_J1939_TP_CM_BAM, 14, 0, 2, 0xFF, 0xCA, 0xFE, 0 };
+	uv_can_msg_st msg = ext_msg(TP_CM_ID(0), 8, cm);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+	uint8_t dt[8] = { 2, 1, 2, 3, 4, 5, 6, 7 };
+	msg = ext_msg(TP_DT_ID(0), 8, dt);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+	TEST_ASSERT_EQ(log_a.count, 0);
+
+	// and the next transfer goes through normally
+	uint8_t payload[9] = { 9, 8, 7, 6, 5, 4, 3, 2, 1 };
+	send_bam(0x00, UV_J1939_PGN_DM1, payload, sizeof(payload));
+	TEST_ASSERT_EQ(log_a.count, 1);
+	TEST_ASSERT_EQ(memcmp(log_a.copy, payload, sizeof(payload)), 0);
+}
+
+
+TEST(j1939_dispatch, keeps_a_transfer_while_other_sources_send_data) {
+	setup();
+	uv_j1939_dispatch_add(&dispatch, UV_J1939_PGN_DM1, UV_J1939_SA_ANY, &handler_a);
+
+	uint8_t cm[8] = { UV_J1939_TP_CM_BAM, 10, 0, 2, 0xFF, 0xCA, 0xFE, 0 };
+	uv_can_msg_st msg = ext_msg(TP_CM_ID(0x05), 8, cm);
+	TEST_ASSERT_TRUE(uv_j1939_dispatch_rx(&dispatch, &msg));
+
+	uint8_t other[8] = { 1, 0, 0, 0, 0, 0, 0, 0 };
+	msg = ext_msg(TP_DT_ID(0x06), 8, other);
+	TEST_ASSERT_FALSE(uv_j1939_dispatch_rx(&dispatch, &msg));
+
+	uint8_t dt1[8] = { 1, 1, 2, 3, 4, 5, 6, 7 };
+	uint8_t dt2[8] = { 2, 8, 9, 10, 0xFF, 0xFF, 0xFF, 0xFF };
+	msg = ext_msg(TP_DT_ID(0x05), 8, dt1);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+	msg = ext_msg(TP_DT_ID(0x05), 8, dt2);
+	uv_j1939_dispatch_rx(&dispatch, &msg);
+
+	TEST_ASSERT_EQ(log_a.count, 1);
+	TEST_ASSERT_EQ(log_a.source_address, 0x05);
+	TEST_ASSERT_EQ(log_a.data_len, 10);
+	TEST_ASSERT_EQ(log_a.copy[9], 10);
+}
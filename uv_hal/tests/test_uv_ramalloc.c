@@ -0,0 +1,306 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_ramalloc.h"
+#include <string.h>
+
+/// @file: Tests for the allocator of memory outside the CPU.
+///
+/// The memory here is a plain array, so that a compaction can be checked to
+/// have carried every block's contents along to where its owner is told it
+/// went.
+
+
+#define MEM_SIZE		256
+
+static uint8_t mem[MEM_SIZE];
+static uint32_t moved_bytes;
+static uint32_t overlaps;
+
+
+/// @brief: An owner that remembers where its block is
+typedef struct {
+	uint32_t addr;
+	bool evicted;
+} owner_st;
+
+
+static void move(uint32_t dest, uint32_t src, uint32_t len) {
+	if ((dest + len) > src) {
+		overlaps++;
+	}
+	memcpy(&mem[dest], &mem[src], len);
+	moved_bytes += len;
+}
+
+
+static void moved(void *owner, uint32_t addr) {
+	((owner_st *) owner)->addr = addr;
+}
+
+
+static void evict(void *owner) {
+	((owner_st *) owner)->evicted = true;
+}
+
+
+static void setup(uv_ramalloc_st *r, uv_ramalloc_block_st *blocks, uint16_t len) {
+	memset(mem, 0, sizeof(mem));
+	moved_bytes = 0;
+	overlaps = 0;
+	uv_ramalloc_init(r, blocks, len, 0, MEM_SIZE);
+	uv_ramalloc_set_callbacks(r, &move, &moved, &evict);
+}
+
+
+/// @brief: Allocates *size* bytes for *o* and fills them with *fill*
+static void put(uv_ramalloc_st *r, owner_st *o, uint32_t size,
+		uint8_t fill, uv_ramalloc_flags_e flags) {
+	memset(o, 0, sizeof(*o));
+	o->addr = uv_ramalloc_alloc(r, size, o, flags);
+	if (o->addr != UV_RAMALLOC_NONE) {
+		memset(&mem[o->addr], fill, size);
+	}
+}
+
+
+static bool filled(const owner_st *o, uint32_t size, uint8_t fill) {
+	bool ret = true;
+	for (uint32_t i = 0; i < size; i++) {
+		if (mem[o->addr + i] != fill) {
+			ret = false;
+			break;
+		}
+	}
+	return ret;
+}
+
+
+TEST(ramalloc, blocks_are_aligned_and_do_not_overlap) {
+	uv_ramalloc_block_st blocks[8];
+	uv_ramalloc_st r;
+	setup(&r, blocks, 8);
+	owner_st a, b, c;
+	put(&r, &a, 5, 1, 0);
+	put(&r, &b, 7, 2, 0);
+	put(&r, &c, 4, 3, 0);
+	TEST_ASSERT_EQ(a.addr, 0);
+	TEST_ASSERT_EQ(b.addr, 8);
+	TEST_ASSERT_EQ(c.addr, 16);
+	TEST_ASSERT_TRUE(uv_ramalloc_get_owner(&r, 8) == &b);
+	TEST_ASSERT_TRUE(uv_ramalloc_get_owner(&r, 4) == NULL);
+
+	uv_ramalloc_stats_st s;
+	uv_ramalloc_get_stats(&r, &s);
+	TEST_ASSERT_EQ(s.used, 20);
+	TEST_ASSERT_EQ(s.free, MEM_SIZE - 20);
+	TEST_ASSERT_EQ(s.blocks, 3);
+	TEST_ASSERT_EQ(s.holes, 1);
+	TEST_ASSERT_EQ(s.fragmentation, 0);
+}
+
+
+TEST(ramalloc, freed_blocks_merge_with_their_neighbours) {
+	uv_ramalloc_block_st blocks[8];
+	uv_ramalloc_st r;
+	setup(&r, blocks, 8);
+	owner_st a, b, c, d;
+	put(&r, &a, 16, 1, 0);
+	put(&r, &b, 16, 2, 0);
+	put(&r, &c, 16, 3, 0);
+	put(&r, &d, 16, 4, 0);
+
+	uv_ramalloc_free(&r, a.addr);
+	uv_ramalloc_free(&r, c.addr);
+	uv_ramalloc_stats_st s;
+	uv_ramalloc_get_stats(&r, &s);
+	TEST_ASSERT_EQ(s.holes, 3);
+	TEST_ASSERT_EQ(s.largest_free, MEM_SIZE - 64);
+	TEST_ASSERT_TRUE(s.fragmentation > 0);
+
+	// the block between the two holes joins them into one
+	uv_ramalloc_free(&r, b.addr);
+	uv_ramalloc_get_stats(&r, &s);
+	TEST_ASSERT_EQ(s.holes, 2);
+	TEST_ASSERT_EQ(s.blocks, 1);
+	TEST_ASSERT_EQ(s.used, 16);
+
+	// and a hole is filled again from its lowest address
+	owner_st e;
+	put(&r, &e, 40, 5, 0);
+	TEST_ASSERT_EQ(e.addr, 0);
+}
+
+
+TEST(ramalloc, a_block_that_fits_no_hole_compacts_the_memory) {
+	uv_ramalloc_block_st blocks[16];
+	uv_ramalloc_st r;
+	setup(&r, blocks, 16);
+	owner_st o[8];
+	for (uint8_t i = 0; i < 8; i++) {
+		put(&r, &o[i], 32, i + 1, 0);
+	}
+	// every other block freed leaves 128 bytes free in holes of 32
+	for (uint8_t i = 0; i < 8; i += 2) {
+		uv_ramalloc_free(&r, o[i].addr);
+	}
+	owner_st big;
+	put(&r, &big, 100, 0xAA, 0);
+	TEST_ASSERT_TRUE(big.addr != UV_RAMALLOC_NONE);
+	TEST_ASSERT_TRUE(moved_bytes > 0);
+	TEST_ASSERT_EQ(overlaps, 0);
+	for (uint8_t i = 1; i < 8; i += 2) {
+		TEST_ASSERT_TRUE(uv_ramalloc_get_owner(&r, o[i].addr) == &o[i]);
+		TEST_ASSERT_TRUE(filled(&o[i], 32, i + 1));
+	}
+	TEST_ASSERT_TRUE(filled(&big, 100, 0xAA));
+}
+
+
+TEST(ramalloc, pinned_blocks_stay_where_they_are) {
+	uv_ramalloc_block_st blocks[16];
+	uv_ramalloc_st r;
+	setup(&r, blocks, 16);
+	owner_st a, font, b;
+	put(&r, &a, 32, 1, 0);
+	put(&r, &font, 32, 2, UV_RAMALLOC_PINNED);
+	put(&r, &b, 64, 3, 0);
+	uv_ramalloc_free(&r, a.addr);
+
+	TEST_ASSERT_EQ(uv_ramalloc_compact(&r), 0);
+	TEST_ASSERT_EQ(font.addr, 32);
+	TEST_ASSERT_EQ(b.addr, 64);
+
+	// a block moves down to the pinned one, never past it
+	owner_st c;
+	put(&r, &c, 16, 4, 0);
+	TEST_ASSERT_EQ(c.addr, 0);
+	uv_ramalloc_free(&r, b.addr);
+	owner_st d;
+	put(&r, &d, 8, 5, 0);
+	TEST_ASSERT_EQ(d.addr, 16);
+	owner_st e, f;
+	put(&r, &e, 32, 6, 0);
+	put(&r, &f, 32, 7, 0);
+	TEST_ASSERT_EQ(e.addr, 64);
+	uv_ramalloc_free(&r, e.addr);
+	TEST_ASSERT_EQ(uv_ramalloc_compact(&r), 32);
+	TEST_ASSERT_EQ(font.addr, 32);
+	TEST_ASSERT_EQ(f.addr, 64);
+	TEST_ASSERT_TRUE(filled(&font, 32, 2));
+	TEST_ASSERT_TRUE(filled(&f, 32, 7));
+	TEST_ASSERT_EQ(overlaps, 0);
+}
+
+
+TEST(ramalloc, the_free_memory_ends_up_at_the_tail) {
+	uv_ramalloc_block_st blocks[8];
+	uv_ramalloc_st r;
+	setup(&r, blocks, 8);
+	owner_st a, b;
+	put(&r, &a, 64, 1, 0);
+	put(&r, &b, 64, 2, 0);
+	uint32_t addr;
+	TEST_ASSERT_EQ(uv_ramalloc_get_tail(&r, &addr), MEM_SIZE - 128);
+	TEST_ASSERT_EQ(addr, 128);
+
+	uv_ramalloc_free(&r, a.addr);
+	uv_ramalloc_compact(&r);
+	TEST_ASSERT_EQ(uv_ramalloc_get_tail(&r, &addr), MEM_SIZE - 64);
+	TEST_ASSERT_EQ(addr, 64);
+	TEST_ASSERT_EQ(b.addr, 0);
+
+	// memory written before its size was known is claimed where it is
+	owner_st c = { 0 };
+	TEST_ASSERT_EQ(uv_ramalloc_alloc_at(&r, addr, 30, &c, 0), 64);
+	TEST_ASSERT_TRUE(uv_ramalloc_get_owner(&r, 64) == &c);
+	TEST_ASSERT_EQ(uv_ramalloc_get_tail(&r, &addr), MEM_SIZE - 96);
+	TEST_ASSERT_EQ(uv_ramalloc_alloc_at(&r, 80, 4, &c, 0), UV_RAMALLOC_NONE);
+}
+
+
+TEST(ramalloc, the_least_recently_used_block_is_evicted_first) {
+	uv_ramalloc_block_st blocks[8];
+	uv_ramalloc_st r;
+	setup(&r, blocks, 8);
+	owner_st a, b, c, font;
+	put(&r, &font, 64, 9, UV_RAMALLOC_PINNED);
+	put(&r, &a, 64, 1, UV_RAMALLOC_EVICTABLE);
+	put(&r, &b, 64, 2, UV_RAMALLOC_EVICTABLE);
+	put(&r, &c, 64, 3, UV_RAMALLOC_EVICTABLE);
+
+	uv_ramalloc_touch(&r, a.addr);
+	owner_st d;
+	put(&r, &d, 64, 4, UV_RAMALLOC_EVICTABLE);
+	TEST_ASSERT_TRUE(d.addr != UV_RAMALLOC_NONE);
+	TEST_ASSERT_TRUE(b.evicted);
+	TEST_ASSERT_FALSE(a.evicted);
+	TEST_ASSERT_FALSE(c.evicted);
+
+	// making room for a big block evicts as many as it takes, but never the
+	// pinned one
+	owner_st e;
+	put(&r, &e, 192, 5, 0);
+	TEST_ASSERT_TRUE(e.addr != UV_RAMALLOC_NONE);
+	TEST_ASSERT_FALSE(font.evicted);
+	TEST_ASSERT_TRUE(filled(&font, 64, 9));
+	TEST_ASSERT_TRUE(filled(&e, 192, 5));
+
+	uv_ramalloc_stats_st s;
+	uv_ramalloc_get_stats(&r, &s);
+	TEST_ASSERT_EQ(s.evictions, 4);
+	TEST_ASSERT_EQ(s.free, 0);
+
+	// nothing evictable is left
+	owner_st f;
+	put(&r, &f, 4, 6, 0);
+	TEST_ASSERT_EQ(f.addr, UV_RAMALLOC_NONE);
+}
+
+
+TEST(ramalloc, a_full_table_is_compacted_to_make_room) {
+	uv_ramalloc_block_st blocks[4];
+	uv_ramalloc_st r;
+	setup(&r, blocks, 4);
+	owner_st a, b, c;
+	put(&r, &a, 16, 1, 0);
+	put(&r, &b, 16, 2, 0);
+	put(&r, &c, 16, 3, 0);
+	uv_ramalloc_free(&r, a.addr);
+	// the hole and the free block after c take the table up, so nothing can
+	// be split off either of them without first moving b and c down
+	owner_st d;
+	put(&r, &d, 8, 4, 0);
+	TEST_ASSERT_EQ(d.addr, 32);
+	TEST_ASSERT_EQ(b.addr, 0);
+	TEST_ASSERT_EQ(c.addr, 16);
+	TEST_ASSERT_TRUE(filled(&b, 16, 2));
+	TEST_ASSERT_TRUE(filled(&c, 16, 3));
+	TEST_ASSERT_EQ(overlaps, 0);
+}
@@ -0,0 +1,478 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_remote_stream.h"
+
+#include <string.h>
+
+/// @file: Tests for the REMOTE framer and packer.
+///
+/// The framer's contract is that the messages it delivers depend only on the
+/// bytes fed, never on how they were split into calls: a device feeds it from
+/// a byte pipe a few bytes at a time, the sink a whole MQTT payload at once.
+/// Most of these tests therefore feed the same stream in every chunk size and
+/// compare what comes out.
+
+
+#define LOG_MAX_MSGS		64
+#define LOG_MAX_BYTES		4096
+
+
+typedef struct {
+	uint32_t count;
+	remote_msg_types_e types[LOG_MAX_MSGS];
+	uint8_t lens[LOG_MAX_MSGS];
+	uint8_t bytes[LOG_MAX_BYTES];
+	uint16_t byte_len;
+} frame_log_st;
+
+
+static void log_callb(void *user, remote_msg_types_e type,
+		const uint8_t *data, uint8_t len) {
+	frame_log_st *log = user;
+	if (log->count < LOG_MAX_MSGS &&
+			(log->byte_len + len) <= LOG_MAX_BYTES) {
+		log->types[log->count] = type;
+		log->lens[log->count] = len;
+		memcpy(&log->bytes[log->byte_len], data, len);
+		log->byte_len += len;
+	}
+	log->count++;
+}
+
+
+/// @brief: Feeds *data* through a fresh framer in *chunk* sized pieces
+static void feed_chunked(frame_log_st *log, const uint8_t *data,
+		uint16_t len, uint16_t chunk) {
+	remote_stream_st stream;
+	remote_stream_reset(&stream);
+	memset(log, 0, sizeof(*log));
+	for (uint16_t i = 0; i < len; i += chunk) {
+		uint16_t n = ((len - i) < chunk) ? (len - i) : chunk;
+		remote_stream_feed(&stream, &data[i], n, &log_callb, log);
+	}
+}
+
+
+static uint16_t append_can(uint8_t *dest, uint32_t id, uv_can_msg_types_e type,
+		uint8_t dlc) {
+	uv_can_msg_st msg = { .id = id, .type = type, .data_length = dlc };
+	for (uint8_t i = 0; i < 8; i++) {
+		msg.data_8bit[i] = (uint8_t) (id + i);
+	}
+	remote_can_msg_encode(&msg, dest);
+	return REMOTE_MSG_TYPE_CAN_LEN(dlc);
+}
+
+
+static uint16_t append_ui(uint8_t *dest, uint8_t chunk_len, uint8_t seed) {
+	dest[0] = REMOTE_MSG_START_BYTE;
+	dest[1] = REMOTE_MSG_TYPE_UI;
+	dest[2] = chunk_len;
+	dest[3] = REMOTE_UI_FLAG_FRAME_START;
+	for (uint8_t i = 0; i < chunk_len; i++) {
+		// the start byte inside a payload must not confuse the framer
+		dest[4 + i] = (i % 5 == 0) ? REMOTE_MSG_START_BYTE : (uint8_t) (seed + i);
+	}
+	return REMOTE_UI_MSG_LEN(chunk_len);
+}
+
+
+static uint16_t append_fixed(uint8_t *dest, remote_msg_types_e type, uint8_t len) {
+	dest[0] = REMOTE_MSG_START_BYTE;
+	dest[1] = type;
+	for (uint8_t i = 2; i < len; i++) {
+		dest[i] = (uint8_t) (0x10 + i);
+	}
+	return len;
+}
+
+
+/// @brief: A stream of every kind of message with garbage between some of them
+static uint16_t build_mixed_stream(uint8_t *dest) {
+	uint16_t len = 0;
+	len += append_can(&dest[len], 0x181, CAN_STD, 8);
+	dest[len++] = 0x00;
+	dest[len++] = 0x42;
+	len += append_can(&dest[len], 0x18FECA00, CAN_EXT, 0);
+	len += append_ui(&dest[len], REMOTE_UI_CHUNK_MAX_LEN, 1);
+	len += append_fixed(&dest[len], REMOTE_MSG_TYPE_RXCLEAR, REMOTE_MSG_TYPE_RXCLEAR_LEN);
+	len += append_fixed(&dest[len], REMOTE_MSG_TYPE_IOT_CTRL, REMOTE_MSG_TYPE_IOT_CTRL_LEN);
+	dest[len++] = 0x12;
+	len += append_ui(&dest[len], 3, 7);
+	len += append_fixed(&dest[len], REMOTE_MSG_TYPE_UI_INPUT, REMOTE_MSG_TYPE_UI_INPUT_LEN);
+	len += append_can(&dest[len], 0x701, CAN_STD, 1);
+	len += append_ui(&dest[len], 0, 0);
+	len += append_can(&dest[len], 0x7FF, CAN_STD, 5);
+	return len;
+}
+
+
+TEST(remote_stream, delivers_the_same_messages_for_every_chunk_size) {
+	static uint8_t stream[1024];
+	static frame_log_st whole;
+	static frame_log_st chunked;
+	uint16_t len = build_mixed_stream(stream);
+
+	feed_chunked(&whole, stream, len, len);
+	TEST_ASSERT_EQ(whole.count, 10);
+
+	for (uint16_t chunk = 1; chunk < len; chunk++) {
+		feed_chunked(&chunked, stream, len, chunk);
+		TEST_ASSERT_EQ(chunked.count, whole.count);
+		TEST_ASSERT_EQ(chunked.byte_len, whole.byte_len);
+		TEST_ASSERT_EQ(memcmp(chunked.types, whole.types, sizeof(whole.types)), 0);
+		TEST_ASSERT_EQ(memcmp(chunked.lens, whole.lens, sizeof(whole.lens)), 0);
+		TEST_ASSERT_EQ(memcmp(chunked.bytes, whole.bytes, whole.byte_len), 0);
+	}
+}
+
+
+TEST(remote_stream, hands_over_each_message_whole_with_its_header) {
+	uint8_t stream[64];
+	frame_log_st log;
+	uint16_t len = append_can(stream, 0x123, CAN_STD, 3);
+	len += append_ui(&stream[len], 4, 9);
+
+	feed_chunked(&log, stream, len, len);
+	TEST_ASSERT_EQ(log.count, 2);
+	TEST_ASSERT_EQ(log.types[0], REMOTE_MSG_TYPE_CAN);
+	TEST_ASSERT_EQ(log.lens[0], REMOTE_MSG_TYPE_CAN_LEN(3));
+	TEST_ASSERT_EQ(log.types[1], REMOTE_MSG_TYPE_UI);
+	TEST_ASSERT_EQ(log.lens[1], REMOTE_UI_MSG_LEN(4));
+	TEST_ASSERT_EQ(memcmp(log.bytes, stream, len), 0);
+}
+
+
+TEST(remote_stream, decodes_forwarded_can_frames) {
+	uint8_t stream[64];
+	frame_log_st log;
+	uint16_t len = append_can(stream, 0x18FEE500, CAN_EXT, 8);
+
+	feed_chunked(&log, stream, len, 3);
+	TEST_ASSERT_EQ(log.count, 1);
+	uv_can_msg_st msg;
+	remote_can_msg_decode(log.bytes, &msg);
+	TEST_ASSERT_EQ(msg.id, 0x18FEE500);
+	TEST_ASSERT_EQ(msg.type, CAN_EXT);
+	TEST_ASSERT_EQ(msg.data_length, 8);
+	TEST_ASSERT_EQ(msg.data_8bit[7], (uint8_t) (0x18FEE500 + 7));
+}
+
+
+TEST(remote_stream, resynchronises_after_an_impossible_can_length) {
+	uint8_t stream[64];
+	frame_log_st log;
+	uint16_t len = 0;
+	stream[len++] = REMOTE_MSG_START_BYTE;
+	stream[len++] = REMOTE_MSG_TYPE_CAN;
+	stream[len++] = 9;
+	len += append_can(&stream[len], 0x201, CAN_STD, 2);
+
+	for (uint16_t chunk = 1; chunk <= len; chunk++) {
+		feed_chunked(&log, stream, len, chunk);
+		TEST_ASSERT_EQ(log.count, 1);
+		TEST_ASSERT_EQ(log.lens[0], REMOTE_MSG_TYPE_CAN_LEN(2));
+	}
+}
+
+
+TEST(remote_stream, resynchronises_after_an_oversized_ui_chunk) {
+	uint8_t stream[64];
+	frame_log_st log;
+	uint16_t len = 0;
+	stream[len++] = REMOTE_MSG_START_BYTE;
+	stream[len++] = REMOTE_MSG_TYPE_UI;
+	stream[len++] = REMOTE_UI_CHUNK_MAX_LEN + 1;
+	len += append_fixed(&stream[len], REMOTE_MSG_TYPE_CLOSE, REMOTE_MSG_TYPE_CLOSE_LEN);
+
+	for (uint16_t chunk = 1; chunk <= len; chunk++) {
+		feed_chunked(&log, stream, len, chunk);
+		TEST_ASSERT_EQ(log.count, 1);
+		TEST_ASSERT_EQ(log.types[0], REMOTE_MSG_TYPE_CLOSE);
+	}
+}
+
+
+TEST(remote_stream, skips_an_unknown_type) {
+	uint8_t stream[64];
+	frame_log_st log;
+	uint16_t len = 0;
+	stream[len++] = REMOTE_MSG_START_BYTE;
+	stream[len++] = REMOTE_MSG_TYPE_COUNT;
+	len += append_fixed(&stream[len], REMOTE_MSG_TYPE_RXDONE, REMOTE_MSG_TYPE_RXDONE_LEN);
+
+	for (uint16_t chunk = 1; chunk <= len; chunk++) {
+		feed_chunked(&log, stream, len, chunk);
+		TEST_ASSERT_EQ(log.count, 1);
+		TEST_ASSERT_EQ(log.types[0], REMOTE_MSG_TYPE_RXDONE);
+	}
+}
+
+
+TEST(remote_stream, reset_discards_a_partial_message) {
+	uint8_t stream[64];
+	frame_log_st log;
+	memset(&log, 0, sizeof(log));
+	uint16_t len = append_can(stream, 0x181, CAN_STD, 8);
+	remote_stream_st s;
+	remote_stream_reset(&s);
+
+	remote_stream_feed(&s, stream, 6, &log_callb, &log);
+	remote_stream_reset(&s);
+	remote_stream_feed(&s, &stream[6], len - 6, &log_callb, &log);
+	TEST_ASSERT_EQ(log.count, 0);
+
+	remote_stream_feed(&s, stream, len, &log_callb, &log);
+	TEST_ASSERT_EQ(log.count, 1);
+}
+
+
+TEST(remote_pack, never_splits_a_message_across_payloads) {
+	static remote_pack_st pack;
+	uint8_t frame[REMOTE_MSG_TYPE_CAN_MAX_LEN];
+	remote_pack_clear(&pack);
+	uv_can_msg_st msg = { .id = 0x181, .type = CAN_STD, .data_length = 8 };
+	remote_can_msg_encode(&msg, frame);
+
+	uint16_t count = 0;
+	while (remote_pack_append(&pack, frame, sizeof(frame))) {
+		count++;
+	}
+	TEST_ASSERT_EQ(count, REMOTE_PACK_MAX_LEN / sizeof(frame));
+	TEST_ASSERT_EQ(pack.len, count * sizeof(frame));
+}
+
+
+/* ---------------------------------------------------------------------------
+ * CAN batches
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+	uint32_t count;
+	uv_can_msg_st msgs[64];
+	uint32_t times[64];
+} batch_log_st;
+
+
+static void batch_callb(void *user, const uv_can_msg_st *msg, uint32_t time_ms) {
+	batch_log_st *log = user;
+	if (log->count < 64) {
+		log->msgs[log->count] = *msg;
+		log->times[log->count] = time_ms;
+	}
+	log->count++;
+}
+
+
+static void assert_same_msg(const uv_can_msg_st *a, const uv_can_msg_st *b) {
+	TEST_ASSERT_EQ(a->id, b->id);
+	TEST_ASSERT_EQ(a->type, b->type);
+	TEST_ASSERT_EQ(a->data_length, b->data_length);
+	TEST_ASSERT_EQ(memcmp(a->data_8bit, b->data_8bit, a->data_length), 0);
+}
+
+
+TEST(remote_can_batch, round_trips_mixed_frames) {
+	static remote_can_batch_st batch;
+	static batch_log_st log;
+	uv_can_msg_st sent[6] = {
+			{ .id = 0x181, .type = CAN_STD, .data_length = 8,
+					.data_8bit = { 1, 2, 3, 4, 5, 6, 7, 8 } },
+			{ .id = 0x18FECA00, .type = CAN_EXT, .data_length = 8,
+					.data_8bit = { 0xFF, 0, 0, 0, 0, 0, 0, 0xFF } },
+			{ .id = 0x701, .type = CAN_STD, .data_length = 1,
+					.data_8bit = { 5 } },
+			// repeats of bulk ids go XOR coded
+			{ .id = 0x181, .type = CAN_STD, .data_length = 8,
+					.data_8bit = { 1, 2, 3, 4, 5, 6, 7, 9 } },
+			{ .id = 0x18FECA00, .type = CAN_EXT, .data_length = 4,
+					.data_8bit = { 0xFF, 0, 1, 0 } },
+			// same id, other type: a different frame altogether
+			{ .id = 0x181, .type = CAN_EXT, .data_length = 0 }
+	};
+	uint32_t times[6] = { 1000, 1000, 1003, 1010, 1200, 70000 };
+
+	remote_can_batch_clear(&batch);
+	for (uint8_t i = 0; i < 6; i++) {
+		TEST_ASSERT_TRUE(remote_can_batch_append(&batch, &sent[i], times[i]));
+	}
+	TEST_ASSERT_EQ(remote_can_batch_get_count(&batch), 6);
+
+	memset(&log, 0, sizeof(log));
+	TEST_ASSERT_TRUE(remote_can_batch_decode(remote_can_batch_get_msg(&batch),
+			remote_can_batch_get_len(&batch), &batch_callb, &log));
+	TEST_ASSERT_EQ(log.count, 6);
+	for (uint8_t i = 0; i < 6; i++) {
+		assert_same_msg(&log.msgs[i], &sent[i]);
+		TEST_ASSERT_EQ(log.times[i], times[i] - times[0]);
+	}
+}
+
+
+TEST(remote_can_batch, codes_a_repeated_bulk_frame_in_a_few_bytes) {
+	static remote_can_batch_st batch;
+	uv_can_msg_st msg = { .id = 0x281, .type = CAN_STD, .data_length = 8,
+			.data_8bit = { 10, 20, 30, 40, 50, 60, 70, 80 } };
+	remote_can_batch_clear(&batch);
+	remote_can_batch_append(&batch, &msg, 0);
+	uint8_t first = remote_can_batch_get_len(&batch);
+	msg.data_8bit[0]++;
+	remote_can_batch_append(&batch, &msg, 10);
+	// header, id delta, time delta, mask and the one changed byte
+	TEST_ASSERT_EQ(remote_can_batch_get_len(&batch) - first, 5);
+}
+
+
+TEST(remote_can_batch, fits_far_more_frames_than_plain_can_messages) {
+	static remote_can_batch_st batch;
+	remote_can_batch_clear(&batch);
+	// ten PDOs cycling every 10 ms, a counter ticking in each
+	uint32_t frames = 0;
+	while (true) {
+		uv_can_msg_st msg = { .id = 0x181 + (frames % 10), .type = CAN_STD,
+				.data_length = 8 };
+		msg.data_8bit[0] = (uint8_t) (frames / 10);
+		msg.data_8bit[4] = 0x40;
+		if (!remote_can_batch_append(&batch, &msg, frames)) {
+			break;
+		}
+		frames++;
+	}
+	uint32_t plain = REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN / REMOTE_MSG_TYPE_CAN_LEN(8);
+	TEST_ASSERT_TRUE(frames >= plain * 2);
+}
+
+
+TEST(remote_can_batch, refuses_frames_that_do_not_fit) {
+	static remote_can_batch_st batch;
+	remote_can_batch_clear(&batch);
+	uint32_t i = 0;
+	while (true) {
+		uv_can_msg_st msg = { .id = 0x18000000 + i * 0x10000, .type = CAN_EXT,
+				.data_length = 8 };
+		if (!remote_can_batch_append(&batch, &msg, i)) {
+			break;
+		}
+		i++;
+	}
+	TEST_ASSERT_TRUE(remote_can_batch_get_len(&batch) <= REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN);
+	TEST_ASSERT_EQ(remote_can_batch_get_count(&batch), i);
+}
+
+
+TEST(remote_can_batch, goes_through_the_framer_in_any_chunk_size) {
+	static remote_can_batch_st batch;
+	static frame_log_st log;
+	static batch_log_st decoded;
+	remote_can_batch_clear(&batch);
+	for (uint32_t i = 0; i < 30; i++) {
+		uv_can_msg_st msg = { .id = 0x200 + (i % 4), .type = CAN_STD,
+				.data_length = 8, .data_8bit = { (uint8_t) i } };
+		remote_can_batch_append(&batch, &msg, i * 5);
+	}
+	uint8_t len = remote_can_batch_get_len(&batch);
+
+	for (uint16_t chunk = 1; chunk <= len; chunk++) {
+		feed_chunked(&log, remote_can_batch_get_msg(&batch), len, chunk);
+		TEST_ASSERT_EQ(log.count, 1);
+		TEST_ASSERT_EQ(log.types[0], REMOTE_MSG_TYPE_CAN_BATCH);
+		memset(&decoded, 0, sizeof(decoded));
+		TEST_ASSERT_TRUE(remote_can_batch_decode(log.bytes, log.lens[0],
+				&batch_callb, &decoded));
+		TEST_ASSERT_EQ(decoded.count, 30);
+		TEST_ASSERT_EQ(decoded.msgs[29].data_8bit[0], 29);
+	}
+}
+
+
+TEST(remote_can_batch, rejects_a_truncated_batch) {
+	static remote_can_batch_st batch;
+	static batch_log_st log;
+	uv_can_msg_st msg = { .id = 0x181, .type = CAN_STD, .data_length = 8 };
+	remote_can_batch_clear(&batch);
+	remote_can_batch_append(&batch, &msg, 0);
+	remote_can_batch_append(&batch, &msg, 0);
+
+	uint8_t buf[REMOTE_MSG_TYPE_CAN_BATCH_MAX_LEN];
+	memcpy(buf, remote_can_batch_get_msg(&batch), remote_can_batch_get_len(&batch));
+	// claim one byte less than the frames take
+	buf[2]--;
+	memset(&log, 0, sizeof(log));
+	TEST_ASSERT_FALSE(remote_can_batch_decode(buf, REMOTE_MSG_TYPE_CAN_BATCH_LEN(buf[2]),
+			&batch_callb, &log));
+	TEST_ASSERT_EQ(log.count, 1);
+}
+
+
+TEST(remote_can_batch, codes_mostly_empty_payloads_against_zeros) {
+	static remote_can_batch_st batch;
+	static batch_log_st log;
+	// an NMT command is not bulk class, so it never has a reference frame
+	uv_can_msg_st msg = { .id = 0x000, .type = CAN_STD, .data_length = 8,
+			.data_8bit = { 0x01, 0, 0, 0, 0, 0, 0, 0 } };
+	remote_can_batch_clear(&batch);
+	remote_can_batch_append(&batch, &msg, 0);
+	// header, id delta, time delta, mask and the one non-zero byte
+	TEST_ASSERT_EQ(remote_can_batch_get_len(&batch), REMOTE_MSG_TYPE_CAN_BATCH_LEN(5));
+
+	memset(&log, 0, sizeof(log));
+	TEST_ASSERT_TRUE(remote_can_batch_decode(remote_can_batch_get_msg(&batch),
+			remote_can_batch_get_len(&batch), &batch_callb, &log));
+	TEST_ASSERT_EQ(log.count, 1);
+	assert_same_msg(&log.msgs[0], &msg);
+}
+
+
+TEST(remote_can_batch, rejects_an_xor_mask_past_the_data_length) {
+	static batch_log_st log;
+	uint8_t buf[] = { REMOTE_MSG_START_BYTE, REMOTE_MSG_TYPE_CAN_BATCH, 5,
+			REMOTE_CAN_BATCH_HDR_XOR | 1, 0x02, 0x00, 0x02, 0x01 };
+	memset(&log, 0, sizeof(log));
+	TEST_ASSERT_FALSE(remote_can_batch_decode(buf, sizeof(buf), &batch_callb, &log));
+	TEST_ASSERT_EQ(log.count, 0);
+}
+
+
+TEST(remote_can_batch, limits_itself_to_the_room_left_in_a_payload) {
+	static remote_can_batch_st batch;
+	remote_can_batch_clear(&batch);
+	remote_can_batch_set_max_len(&batch, 40);
+	uint32_t i = 0;
+	while (true) {
+		uv_can_msg_st msg = { .id = 0x300 + i * 0x10, .type = CAN_STD,
+				.data_length = 8, .data_8bit = { 1, 2, 3, 4, 5, 6, 7, 8 } };
+		if (!remote_can_batch_append(&batch, &msg, i)) {
+			break;
+		}
+		i++;
+	}
+	TEST_ASSERT_TRUE(remote_can_batch_get_len(&batch) <= 40);
+	TEST_ASSERT_TRUE(i > 0);
+}
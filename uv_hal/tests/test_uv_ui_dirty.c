@@ -0,0 +1,201 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_ui_dirty.h"
+
+/// @file: Tests for the set of areas a display redraws.
+///
+/// Whatever is merged, every area added stays covered by one in the set:
+/// an area missing from it is a part of the screen that is not redrawn.
+
+
+/// @brief: Returns true if the set holds exactly the area given
+static bool has(const uv_uidirty_st *dirty,
+		int16_t x, int16_t y, int16_t width, int16_t height) {
+	bool ret = false;
+	for (uint8_t i = 0; i < dirty->count; i++) {
+		const uv_uidirty_rect_st *r = &dirty->rect[i];
+		if ((r->x == x) && (r->y == y) &&
+				(r->width == width) && (r->height == height)) {
+			ret = true;
+		}
+		else {
+		}
+	}
+	return ret;
+}
+
+
+/// @brief: Returns true if one area in the set covers the area given
+static bool covered(const uv_uidirty_st *dirty,
+		int16_t x, int16_t y, int16_t width, int16_t height) {
+	bool ret = false;
+	for (uint8_t i = 0; i < dirty->count; i++) {
+		const uv_uidirty_rect_st *r = &dirty->rect[i];
+		if ((r->x <= x) && (r->y <= y) &&
+				((r->x + r->width) >= (x + width)) &&
+				((r->y + r->height) >= (y + height))) {
+			ret = true;
+		}
+		else {
+		}
+	}
+	return ret;
+}
+
+
+TEST(ui_dirty, areas_of_no_size_are_ignored) {
+	uv_uidirty_st d;
+	uv_uidirty_clear(&d);
+	uv_uidirty_add(&d, 10, 10, 0, 20);
+	uv_uidirty_add(&d, 10, 10, 20, 0);
+	uv_uidirty_add(&d, 10, 10, -5, 20);
+	TEST_ASSERT_EQ(d.count, 0);
+}
+
+
+TEST(ui_dirty, areas_apart_are_kept_apart) {
+	uv_uidirty_st d;
+	uv_uidirty_clear(&d);
+	uv_uidirty_add(&d, 0, 0, 10, 10);
+	// a one pixel gap
+	uv_uidirty_add(&d, 11, 0, 10, 10);
+	uv_uidirty_add(&d, 0, 11, 10, 10);
+	TEST_ASSERT_EQ(d.count, 3);
+	TEST_ASSERT_TRUE(has(&d, 0, 0, 10, 10));
+	TEST_ASSERT_TRUE(has(&d, 11, 0, 10, 10));
+	TEST_ASSERT_TRUE(has(&d, 0, 11, 10, 10));
+}
+
+
+TEST(ui_dirty, overlapping_and_touching_areas_merge) {
+	uv_uidirty_st d;
+	uv_uidirty_clear(&d);
+	uv_uidirty_add(&d, 0, 0, 10, 10);
+	uv_uidirty_add(&d, 5, 5, 10, 10);
+	TEST_ASSERT_EQ(d.count, 1);
+	TEST_ASSERT_TRUE(has(&d, 0, 0, 15, 15));
+
+	// edge to edge
+	uv_uidirty_add(&d, 15, 0, 5, 15);
+	TEST_ASSERT_EQ(d.count, 1);
+	TEST_ASSERT_TRUE(has(&d, 0, 0, 20, 15));
+
+	// inside one already there
+	uv_uidirty_add(&d, 2, 2, 3, 3);
+	TEST_ASSERT_EQ(d.count, 1);
+	TEST_ASSERT_TRUE(has(&d, 0, 0, 20, 15));
+}
+
+
+TEST(ui_dirty, a_grown_area_takes_in_the_ones_it_reaches) {
+	uv_uidirty_st d;
+	uv_uidirty_clear(&d);
+	uv_uidirty_add(&d, 0, 0, 10, 10);
+	uv_uidirty_add(&d, 30, 0, 10, 10);
+	TEST_ASSERT_EQ(d.count, 2);
+	// reaches the first, and merged with it, the second
+	uv_uidirty_add(&d, 10, 0, 20, 10);
+	TEST_ASSERT_EQ(d.count, 1);
+	TEST_ASSERT_TRUE(has(&d, 0, 0, 40, 10));
+}
+
+
+TEST(ui_dirty, a_full_set_merges_with_the_area_growing_least) {
+	uv_uidirty_st d;
+	uv_uidirty_clear(&d);
+	for (uint8_t i = 0; i < CONFIG_UI_DIRTY_RECTS; i++) {
+		uv_uidirty_add(&d, (int16_t) (i * 100), 0, 10, 10);
+	}
+	TEST_ASSERT_EQ(d.count, CONFIG_UI_DIRTY_RECTS);
+
+	// closest to the last one
+	int16_t last = (CONFIG_UI_DIRTY_RECTS - 1) * 100;
+	uv_uidirty_add(&d, last + 20, 0, 10, 10);
+	TEST_ASSERT_EQ(d.count, CONFIG_UI_DIRTY_RECTS);
+	TEST_ASSERT_TRUE(has(&d, last, 0, 30, 10));
+	for (uint8_t i = 0; i < CONFIG_UI_DIRTY_RECTS - 1; i++) {
+		TEST_ASSERT_TRUE(has(&d, (int16_t) (i * 100), 0, 10, 10));
+	}
+}
+
+
+TEST(ui_dirty, a_merge_in_a_full_set_takes_in_what_it_reaches) {
+	uv_uidirty_st d;
+	uv_uidirty_clear(&d);
+	uv_uidirty_add(&d, 0, 0, 10, 10);
+	uv_uidirty_add(&d, 20, 0, 10, 10);
+	for (uint8_t i = 2; i < CONFIG_UI_DIRTY_RECTS; i++) {
+		uv_uidirty_add(&d, (int16_t) (i * 200), 200, 10, 10);
+	}
+	TEST_ASSERT_EQ(d.count, CONFIG_UI_DIRTY_RECTS);
+
+	// below both of the first two: merged with either, it reaches the other
+	uv_uidirty_add(&d, 8, 20, 14, 10);
+	TEST_ASSERT_EQ(d.count, CONFIG_UI_DIRTY_RECTS - 1);
+	TEST_ASSERT_TRUE(has(&d, 0, 0, 30, 30));
+}
+
+
+TEST(ui_dirty, every_area_added_stays_covered) {
+	uv_uidirty_st d;
+	uv_uidirty_clear(&d);
+	int16_t added[64][4];
+	uint32_t seed = 12345;
+	bool ok = true;
+	for (uint8_t i = 0; i < 64; i++) {
+		seed = seed * 1103515245u + 12345u;
+		added[i][0] = (int16_t) ((seed >> 8) % 800);
+		added[i][1] = (int16_t) ((seed >> 18) % 480);
+		seed = seed * 1103515245u + 12345u;
+		added[i][2] = (int16_t) (1 + (seed >> 8) % 60);
+		added[i][3] = (int16_t) (1 + (seed >> 18) % 60);
+		uv_uidirty_add(&d, added[i][0], added[i][1], added[i][2], added[i][3]);
+		if (d.count > CONFIG_UI_DIRTY_RECTS) {
+			ok = false;
+		}
+		else {
+		}
+		for (uint8_t j = 0; j <= i; j++) {
+			if (!covered(&d, added[j][0], added[j][1], added[j][2], added[j][3])) {
+				ok = false;
+			}
+			else {
+			}
+		}
+	}
+	TEST_ASSERT_TRUE(ok);
+
+	// nothing in the set touches anything else in it
+	for (uint8_t i = 0; i < d.count; i++) {
+		for (uint8_t j = i + 1; j < d.count; j++) {
+			TEST_ASSERT_FALSE(uv_uidirty_near(&d.rect[i], &d.rect[j], 1));
+		}
+	}
+}
@@ -0,0 +1,174 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_ui_input.h"
+
+/// @file: Tests for the UI input queue and the latency histogram.
+///
+/// The display takes the events out in the order they happened, so a release
+/// is never seen before the touch it ends and a key never overtakes a click.
+
+
+static uv_ui_input_event_st ev(uint8_t type, uint32_t t, int16_t x, int16_t y) {
+	uv_ui_input_event_st e = {
+			.time_us = t,
+			.x = x,
+			.y = y,
+			.value = 0,
+			.type = type
+	};
+	return e;
+}
+
+
+TEST(ui_input, events_come_out_in_order) {
+	uv_ui_input_event_st buf[8];
+	uv_ui_input_queue_st q;
+	uv_ui_input_queue_init(&q, buf, 8);
+	uv_ui_input_event_st e = ev(UI_INPUT_TOUCH, 10, 1, 2);
+	uv_ui_input_queue_push(&q, &e);
+	e = ev(UI_INPUT_RELEASE, 20, 1, 2);
+	uv_ui_input_queue_push(&q, &e);
+	e = ev(UI_INPUT_SCROLL, 30, 0, 0);
+	uv_ui_input_queue_push(&q, &e);
+	TEST_ASSERT_EQ(uv_ui_input_queue_count(&q), 3);
+	TEST_ASSERT_EQ(uv_ui_input_queue_peek(&q)->type, UI_INPUT_TOUCH);
+
+	uv_ui_input_event_st out;
+	TEST_ASSERT_TRUE(uv_ui_input_queue_pop(&q, &out));
+	TEST_ASSERT_EQ(out.type, UI_INPUT_TOUCH);
+	TEST_ASSERT_TRUE(uv_ui_input_queue_pop(&q, &out));
+	TEST_ASSERT_EQ(out.type, UI_INPUT_RELEASE);
+	TEST_ASSERT_EQ(out.time_us, 20);
+	TEST_ASSERT_TRUE(uv_ui_input_queue_pop(&q, &out));
+	TEST_ASSERT_EQ(out.type, UI_INPUT_SCROLL);
+	TEST_ASSERT_FALSE(uv_ui_input_queue_pop(&q, &out));
+	TEST_ASSERT_TRUE(uv_ui_input_queue_peek(&q) == NULL);
+}
+
+
+TEST(ui_input, a_moving_touch_keeps_its_first_time_and_last_position) {
+	uv_ui_input_event_st buf[4];
+	uv_ui_input_queue_st q;
+	uv_ui_input_queue_init(&q, buf, 4);
+	for (int16_t i = 0; i < 100; i++) {
+		uv_ui_input_event_st e = ev(UI_INPUT_TOUCH, 100 + i, i, -i);
+		TEST_ASSERT_TRUE(uv_ui_input_queue_push(&q, &e));
+	}
+	TEST_ASSERT_EQ(uv_ui_input_queue_count(&q), 1);
+	uv_ui_input_event_st out;
+	uv_ui_input_queue_pop(&q, &out);
+	TEST_ASSERT_EQ(out.time_us, 100);
+	TEST_ASSERT_EQ(out.x, 99);
+	TEST_ASSERT_EQ(out.y, -99);
+}
+
+
+TEST(ui_input, a_tap_between_two_steps_is_not_merged_away) {
+	uv_ui_input_event_st buf[4];
+	uv_ui_input_queue_st q;
+	uv_ui_input_queue_init(&q, buf, 4);
+	uv_ui_input_event_st e = ev(UI_INPUT_TOUCH, 1, 5, 5);
+	uv_ui_input_queue_push(&q, &e);
+	e = ev(UI_INPUT_RELEASE, 2, 5, 5);
+	uv_ui_input_queue_push(&q, &e);
+	e = ev(UI_INPUT_TOUCH, 3, 50, 50);
+	uv_ui_input_queue_push(&q, &e);
+	e = ev(UI_INPUT_RELEASE, 4, 50, 50);
+	uv_ui_input_queue_push(&q, &e);
+	TEST_ASSERT_EQ(uv_ui_input_queue_count(&q), 4);
+	uv_ui_input_event_st out;
+	uv_ui_input_queue_pop(&q, &out);
+	TEST_ASSERT_EQ(out.x, 5);
+}
+
+
+TEST(ui_input, a_full_queue_drops_and_counts_the_newest) {
+	uv_ui_input_event_st buf[3];
+	uv_ui_input_queue_st q;
+	uv_ui_input_queue_init(&q, buf, 3);
+	for (uint32_t i = 0; i < 5; i++) {
+		uv_ui_input_event_st e = ev(UI_INPUT_SCROLL, i, 0, 0);
+		TEST_ASSERT_EQ(uv_ui_input_queue_push(&q, &e), i < 3);
+	}
+	TEST_ASSERT_EQ(q.dropped, 2);
+	uv_ui_input_event_st out;
+	// wraps around the end of the buffer
+	uv_ui_input_queue_pop(&q, &out);
+	uv_ui_input_event_st e = ev(UI_INPUT_KEY, 9, 0, 0);
+	TEST_ASSERT_TRUE(uv_ui_input_queue_push(&q, &e));
+	for (uint32_t i = 1; i < 3; i++) {
+		uv_ui_input_queue_pop(&q, &out);
+		TEST_ASSERT_EQ(out.time_us, i);
+	}
+	uv_ui_input_queue_pop(&q, &out);
+	TEST_ASSERT_EQ(out.time_us, 9);
+}
+
+
+TEST(ui_input, latency_percentiles_are_within_a_quarter) {
+	uv_ui_latency_st l;
+	uv_ui_latency_reset(&l);
+	TEST_ASSERT_EQ(uv_ui_latency_percentile(&l, 500), 0);
+	for (uint32_t i = 1; i <= 1000; i++) {
+		uv_ui_latency_add(&l, i * 100);
+	}
+	uint32_t p50 = uv_ui_latency_percentile(&l, 500);
+	uint32_t p99 = uv_ui_latency_percentile(&l, 990);
+	TEST_ASSERT_TRUE(p50 >= 50000 && p50 <= 50000 * 5 / 4);
+	TEST_ASSERT_TRUE(p99 >= 99000 && p99 <= 100000);
+	TEST_ASSERT_EQ(uv_ui_latency_percentile(&l, 1000), 100000);
+	TEST_ASSERT_EQ(l.max_us, 100000);
+}
+
+
+TEST(ui_input, small_latencies_are_exact) {
+	uv_ui_latency_st l;
+	uv_ui_latency_reset(&l);
+	for (uint32_t i = 0; i < 8; i++) {
+		uv_ui_latency_add(&l, i);
+	}
+	TEST_ASSERT_EQ(uv_ui_latency_percentile(&l, 0), 0);
+	TEST_ASSERT_EQ(uv_ui_latency_percentile(&l, 500), 3);
+	TEST_ASSERT_EQ(uv_ui_latency_percentile(&l, 1000), 7);
+}
+
+
+TEST(ui_input, a_full_bucket_halves_the_histogram) {
+	uv_ui_latency_st l;
+	uv_ui_latency_reset(&l);
+	for (uint32_t i = 0; i < 100000; i++) {
+		uv_ui_latency_add(&l, 1000);
+	}
+	uv_ui_latency_add(&l, UINT32_MAX);
+	TEST_ASSERT_TRUE(l.bucket[UI_LATENCY_BUCKETS - 1] == 1);
+	uint32_t p = uv_ui_latency_percentile(&l, 500);
+	TEST_ASSERT_TRUE(p >= 1000 && p < 1250);
+	TEST_ASSERT_EQ(uv_ui_latency_percentile(&l, 1000), UINT32_MAX);
+}
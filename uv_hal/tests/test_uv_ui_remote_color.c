@@ -0,0 +1,390 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_ui_remote.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/// @file: Tests for the remote UI color modes.
+///
+/// A frame that restores to anything other than what the encoder captured
+/// shows the sink colors the device never drew, so the tests here run frames
+/// through both ends and compare what comes out.
+
+
+#define FRAME_MAX		8192
+#define ARGB			UV_UI_REMOTE_COLOR_ARGB8888
+#define RGB565			UV_UI_REMOTE_COLOR_RGB565
+#define PALETTE			UV_UI_REMOTE_COLOR_PALETTE
+
+
+typedef struct {
+	uint8_t data[FRAME_MAX];
+	uint16_t len;
+} frame_st;
+
+
+static void put8(frame_st *f, uint8_t v) {
+	f->data[f->len++] = v;
+}
+
+static void put16(frame_st *f, uint16_t v) {
+	put8(f, (uint8_t) (v & 0xFF));
+	put8(f, (uint8_t) (v >> 8));
+}
+
+static void put32(frame_st *f, uint32_t v) {
+	put16(f, (uint16_t) (v & 0xFFFF));
+	put16(f, (uint16_t) (v >> 16));
+}
+
+static void begin(frame_st *f, uint32_t color) {
+	f->len = 0;
+	put8(f, UV_UI_REMOTE_OP_FRAME_BEGIN);
+	put32(f, color);
+}
+
+static void rrect(frame_st *f, int16_t y, uint32_t color) {
+	put8(f, UV_UI_REMOTE_OP_RRECT);
+	put16(f, 10);
+	put16(f, (uint16_t) y);
+	put16(f, 100);
+	put16(f, 40);
+	put16(f, 4);
+	put32(f, color);
+}
+
+static void string(frame_st *f, int16_t y, const char *str, uint32_t color) {
+	uint16_t len = (uint16_t) strlen(str);
+	put8(f, UV_UI_REMOTE_OP_STRING);
+	put8(f, 3);
+	put16(f, 20);
+	put16(f, (uint16_t) y);
+	put16(f, 0);
+	put32(f, color);
+	put16(f, len);
+	memcpy(&f->data[f->len], str, len);
+	f->len += len;
+}
+
+/// @brief: One of each op that carries a color, all in *color*
+static void every_op(frame_st *f, uint32_t color) {
+	put8(f, UV_UI_REMOTE_OP_BITMAP);
+	put32(f, 0x12345678);
+	for (uint8_t i = 0; i < 4; i++) {
+		put16(f, (uint16_t) (i * 10));
+	}
+	put32(f, 0);
+	put32(f, color);
+	put8(f, UV_UI_REMOTE_OP_POINT);
+	put16(f, 1);
+	put16(f, 2);
+	put16(f, 3);
+	put32(f, color);
+	rrect(f, 50, color);
+	put8(f, UV_UI_REMOTE_OP_LINE);
+	for (uint8_t i = 0; i < 5; i++) {
+		put16(f, i);
+	}
+	put32(f, color);
+	put8(f, UV_UI_REMOTE_OP_LINESTRIP);
+	put8(f, 1);
+	put16(f, 2);
+	put32(f, color);
+	put16(f, 2);
+	put32(f, 0x00050006);
+	put32(f, 0x00070008);
+	put8(f, UV_UI_REMOTE_OP_POLYGON);
+	put32(f, color);
+	put16(f, 3);
+	put32(f, 1);
+	put32(f, 2);
+	put32(f, 3);
+	string(f, 60, "abc", color);
+	put8(f, UV_UI_REMOTE_OP_MASK);
+	put32(f, 0x00100010);
+	put32(f, 0x00200020);
+}
+
+static void end(frame_st *f) {
+	put8(f, UV_UI_REMOTE_OP_FRAME_END);
+}
+
+
+/// @brief: A settings style screen: a button and two labels per row in a
+/// handful of colors, with the first row highlighted when *row0* is set
+static void screen(frame_st *f, bool row0) {
+	begin(f, 0xFF202020);
+	for (int16_t i = 0; i < 12; i++) {
+		char label[24];
+		rrect(f, (int16_t) (10 + i * 40), (row0 && (i == 0)) ? 0xFF0060C0 : 0xFF404040);
+		snprintf(label, sizeof(label), "Parameter %d", i);
+		string(f, (int16_t) (20 + i * 40), label, 0xFFFFFFFF);
+		string(f, (int16_t) (20 + i * 40), "42", 0xFFC0C0C0);
+	}
+	end(f);
+}
+
+
+/// @brief: Converts *frame* into *mode*, restores it and returns the
+/// converted length. *restored* gets the restored frame.
+static uint16_t round_trip(uv_ui_remote_palette_st *pal, uv_ui_remote_color_mode_e mode,
+		const frame_st *frame, frame_st *coded, frame_st *restored) {
+	static uv_ui_remote_palette_st sink;
+	coded->len = uv_ui_remote_color_convert(pal, mode, frame->data, frame->len,
+			coded->data, sizeof(coded->data));
+	TEST_ASSERT_NE(coded->len, 0);
+	restored->len = uv_ui_remote_color_restore(&sink, mode, coded->data, coded->len,
+			restored->data, sizeof(restored->data));
+	TEST_ASSERT_EQ(restored->len, frame->len);
+	return coded->len;
+}
+
+
+
+TEST(ui_remote_color, rgb565_keeps_the_top_bits_and_full_scale) {
+	TEST_ASSERT_EQ(uv_ui_remote_rgb565(0xFFFFFFFF), 0xFFFF);
+	TEST_ASSERT_EQ(uv_ui_remote_rgb565(0xFF000000), 0x0000);
+	TEST_ASSERT_EQ(uv_ui_remote_rgb565(0xFFFF0000), 0xF800);
+	TEST_ASSERT_EQ(uv_ui_remote_rgb565(0xFF00FF00), 0x07E0);
+	TEST_ASSERT_EQ(uv_ui_remote_rgb565(0xFF0000FF), 0x001F);
+	TEST_ASSERT_EQ(uv_ui_remote_rgb565_argb(0xFFFF), 0xFFFFFFFF);
+	TEST_ASSERT_EQ(uv_ui_remote_rgb565_argb(0xF800), 0xFFFF0000);
+	// every color comes back within a step of 5 or 6 bits
+	for (uint32_t c = 0; c < 0x1000000; c += 0x010305) {
+		uint32_t back = uv_ui_remote_rgb565_argb(uv_ui_remote_rgb565(c));
+		TEST_ASSERT_NEAR((back >> 16) & 0xFF, (c >> 16) & 0xFF, 8);
+		TEST_ASSERT_NEAR((back >> 8) & 0xFF, (c >> 8) & 0xFF, 4);
+		TEST_ASSERT_NEAR(back & 0xFF, c & 0xFF, 8);
+	}
+}
+
+
+TEST(ui_remote_color, op_len_follows_the_color_width) {
+	static frame_st f;
+	f.len = 0;
+	every_op(&f, 0xFF112233);
+	end(&f);
+	for (uv_ui_remote_color_mode_e mode = ARGB; mode < UV_UI_REMOTE_COLOR_MODE_COUNT; mode++) {
+		static uv_ui_remote_palette_st pal;
+		static frame_st coded;
+		uv_ui_remote_frame_index_st idx;
+		uv_ui_remote_palette_init(&pal);
+		coded.len = uv_ui_remote_color_convert(&pal, mode, f.data, f.len,
+				coded.data, sizeof(coded.data));
+		TEST_ASSERT_NE(coded.len, 0);
+		// the same ops, plus one COLOR in the palette mode
+		TEST_ASSERT_TRUE(uv_ui_remote_frame_index(&idx, mode, coded.data, coded.len));
+		TEST_ASSERT_EQ(idx.count, (mode == PALETTE) ? 10 : 9);
+		TEST_ASSERT_EQ(coded.len, f.len - 7 * (4 - uv_ui_remote_color_len(mode)) +
+				((mode == PALETTE) ? UV_UI_REMOTE_COLOR_LEN : 0));
+	}
+}
+
+
+TEST(ui_remote_color, every_mode_restores_the_frame) {
+	static uv_ui_remote_palette_st pal;
+	static frame_st f, coded, restored;
+	f.len = 0;
+	begin(&f, 0x80123456);
+	every_op(&f, 0xFF336699);
+	every_op(&f, 0x40FF8800);
+	end(&f);
+
+	uv_ui_remote_palette_init(&pal);
+	round_trip(&pal, ARGB, &f, &coded, &restored);
+	TEST_ASSERT_TRUE(memcmp(coded.data, f.data, f.len) == 0);
+	TEST_ASSERT_TRUE(memcmp(restored.data, f.data, f.len) == 0);
+
+	// lossless, alpha included
+	uv_ui_remote_palette_init(&pal);
+	round_trip(&pal, PALETTE, &f, &coded, &restored);
+	TEST_ASSERT_TRUE(memcmp(restored.data, f.data, f.len) == 0);
+
+	// the same frame with its colors through 5-6-5 and opaque, apart from
+	// FRAME_BEGIN's, which the restored frame has as 0xFF123456 too
+	static frame_st expect;
+	expect.len = 0;
+	begin(&expect, uv_ui_remote_rgb565_argb(uv_ui_remote_rgb565(0x80123456)));
+	every_op(&expect, uv_ui_remote_rgb565_argb(uv_ui_remote_rgb565(0xFF336699)));
+	every_op(&expect, uv_ui_remote_rgb565_argb(uv_ui_remote_rgb565(0x40FF8800)));
+	end(&expect);
+	round_trip(&pal, RGB565, &f, &coded, &restored);
+	TEST_ASSERT_TRUE(memcmp(restored.data, expect.data, expect.len) == 0);
+}
+
+
+TEST(ui_remote_color, an_unchanged_screen_codes_to_the_same_bytes) {
+	// which is what keeps delta frames working in the palette mode
+	static uv_ui_remote_palette_st pal;
+	static frame_st a, b, first, again, restored;
+	uv_ui_remote_palette_init(&pal);
+	screen(&a, false);
+	screen(&b, true);
+	round_trip(&pal, PALETTE, &a, &first, &restored);
+	round_trip(&pal, PALETTE, &b, &again, &restored);
+	round_trip(&pal, PALETTE, &a, &again, &restored);
+	TEST_ASSERT_EQ(again.len, first.len);
+	TEST_ASSERT_TRUE(memcmp(again.data, first.data, first.len) == 0);
+}
+
+
+TEST(ui_remote_color, each_frame_defines_the_colors_it_uses) {
+	static uv_ui_remote_palette_st pal;
+	static frame_st f, coded, restored;
+	uv_ui_remote_palette_init(&pal);
+	screen(&f, false);
+	for (uint8_t i = 0; i < 3; i++) {
+		round_trip(&pal, PALETTE, &f, &coded, &restored);
+		TEST_ASSERT_TRUE(memcmp(restored.data, f.data, f.len) == 0);
+		// three colors, each defined once, before its first use
+		uint16_t colors = 0;
+		for (uint16_t off = 0; off < coded.len;
+				off += uv_ui_remote_op_len(PALETTE, &coded.data[off], coded.len - off)) {
+			if (coded.data[off] == UV_UI_REMOTE_OP_COLOR) {
+				colors++;
+			}
+		}
+		TEST_ASSERT_EQ(colors, 3);
+	}
+	TEST_ASSERT_EQ(pal.count, 3);
+}
+
+
+TEST(ui_remote_color, more_colors_than_entries_still_restore) {
+	static uv_ui_remote_palette_st pal;
+	static frame_st f, coded, restored;
+	uv_ui_remote_palette_init(&pal);
+	// 300 distinct colors, then the first ones again after they were evicted
+	f.len = 0;
+	begin(&f, 0xFF000000);
+	for (uint16_t i = 0; i < 300; i++) {
+		rrect(&f, (int16_t) i, 0xFF000000u + i);
+	}
+	for (uint16_t i = 0; i < 20; i++) {
+		rrect(&f, (int16_t) i, 0xFF000000u + i);
+	}
+	end(&f);
+	for (uint8_t i = 0; i < 2; i++) {
+		round_trip(&pal, PALETTE, &f, &coded, &restored);
+		TEST_ASSERT_TRUE(memcmp(restored.data, f.data, f.len) == 0);
+		TEST_ASSERT_EQ(pal.count, UV_UI_REMOTE_PALETTE_SIZE);
+	}
+}
+
+
+TEST(ui_remote_color, a_frame_that_grows_past_the_buffer_is_refused) {
+	// a new color for every op grows the palette mode frame by two bytes an op
+	static uv_ui_remote_palette_st pal;
+	static frame_st f;
+	uint8_t dest[70];
+	uv_ui_remote_palette_init(&pal);
+	f.len = 0;
+	begin(&f, 0xFF000000);
+	for (uint16_t i = 0; i < 4; i++) {
+		rrect(&f, (int16_t) i, 0xFF000000u + i);
+	}
+	end(&f);
+	TEST_ASSERT_TRUE(f.len <= sizeof(dest));
+	TEST_ASSERT_EQ(uv_ui_remote_color_convert(&pal, PALETTE, f.data, f.len,
+			dest, sizeof(dest)), 0);
+	TEST_ASSERT_NE(uv_ui_remote_color_convert(&pal, RGB565, f.data, f.len,
+			dest, sizeof(dest)), 0);
+}
+
+
+TEST(ui_remote_color, size_is_the_length_the_fixed_width_modes_code_to) {
+	static uv_ui_remote_palette_st pal;
+	static frame_st f;
+	uint8_t dest[FRAME_MAX];
+	uv_ui_remote_palette_init(&pal);
+	f.len = 0;
+	begin(&f, 0xFF000000);
+	every_op(&f, 0x80FF8040);
+	end(&f);
+	TEST_ASSERT_EQ(uv_ui_remote_color_size(ARGB, f.data, f.len), f.len);
+	TEST_ASSERT_EQ(uv_ui_remote_color_size(RGB565, f.data, f.len),
+			uv_ui_remote_color_convert(&pal, RGB565, f.data, f.len, dest, sizeof(dest)));
+	TEST_ASSERT_EQ(uv_ui_remote_color_size(RGB565, f.data, f.len - 2), 0);
+
+	// the palette mode takes a COLOR op on top, which one op of the color
+	// does not win back
+	uint16_t palette = uv_ui_remote_color_convert(&pal, PALETTE, f.data, f.len,
+			dest, sizeof(dest));
+	TEST_ASSERT_TRUE(palette > uv_ui_remote_color_size(RGB565, f.data, f.len));
+}
+
+
+TEST(ui_remote_color, malformed_frames_are_refused) {
+	static uv_ui_remote_palette_st pal;
+	static frame_st f, coded;
+	uint8_t dest[FRAME_MAX];
+	uv_ui_remote_palette_init(&pal);
+	screen(&f, false);
+	TEST_ASSERT_EQ(uv_ui_remote_color_convert(&pal, PALETTE, f.data, f.len - 2,
+			dest, sizeof(dest)), 0);
+	coded.len = uv_ui_remote_color_convert(&pal, PALETTE, f.data, f.len,
+			coded.data, sizeof(coded.data));
+	TEST_ASSERT_EQ(uv_ui_remote_color_restore(&pal, PALETTE, coded.data, coded.len - 3,
+			dest, sizeof(dest)), 0);
+	// a captured frame never holds COLOR ops, nor a coded one deltas
+	TEST_ASSERT_EQ(uv_ui_remote_color_convert(&pal, PALETTE, coded.data, coded.len,
+			dest, sizeof(dest)), 0);
+	uint8_t copy[] = { UV_UI_REMOTE_OP_COPY, 0, 0, 1, 0 };
+	TEST_ASSERT_EQ(uv_ui_remote_color_restore(&pal, PALETTE, copy, sizeof(copy),
+			dest, sizeof(dest)), 0);
+}
+
+
+TEST(ui_remote_color, delta_frames_work_in_every_mode) {
+	static frame_st a, b;
+	screen(&a, false);
+	screen(&b, true);
+	for (uv_ui_remote_color_mode_e mode = ARGB; mode < UV_UI_REMOTE_COLOR_MODE_COUNT; mode++) {
+		static uv_ui_remote_palette_st pal;
+		static uv_ui_remote_frame_index_st base_idx, frame_idx;
+		static frame_st base, frame, delta, rebuilt;
+		uv_ui_remote_palette_init(&pal);
+		base.len = uv_ui_remote_color_convert(&pal, mode, a.data, a.len,
+				base.data, sizeof(base.data));
+		frame.len = uv_ui_remote_color_convert(&pal, mode, b.data, b.len,
+				frame.data, sizeof(frame.data));
+		TEST_ASSERT_TRUE(uv_ui_remote_frame_index(&base_idx, mode, base.data, base.len));
+		TEST_ASSERT_TRUE(uv_ui_remote_frame_index(&frame_idx, mode, frame.data, frame.len));
+		delta.len = uv_ui_remote_delta_encode(base.data, &base_idx,
+				frame.data, &frame_idx, delta.data, sizeof(delta.data));
+		// one op changed: a COLOR in the palette mode, and the rrect
+		TEST_ASSERT_RANGE(delta.len, 1, 48);
+		rebuilt.len = uv_ui_remote_delta_apply(mode, base.data, base.len,
+				delta.data, delta.len, rebuilt.data, sizeof(rebuilt.data));
+		TEST_ASSERT_EQ(rebuilt.len, frame.len);
+		TEST_ASSERT_TRUE(memcmp(rebuilt.data, frame.data, frame.len) == 0);
+	}
+}
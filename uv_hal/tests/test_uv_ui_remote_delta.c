@@ -0,0 +1,301 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_ui_remote.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/// @file: Tests for the remote UI delta frames.
+///
+/// A delta that rebuilds to anything other than the frame the encoder captured
+/// shows the sink a screen the device never drew, so every test here rebuilds
+/// the frame with the sink side and compares it byte for byte.
+
+
+#define FRAME_MAX		2048
+#define ARGB			UV_UI_REMOTE_COLOR_ARGB8888
+
+
+typedef struct {
+	uint8_t data[FRAME_MAX];
+	uint16_t len;
+	uv_ui_remote_frame_index_st idx;
+} frame_st;
+
+
+static void put8(frame_st *f, uint8_t v) {
+	f->data[f->len++] = v;
+}
+
+static void put16(frame_st *f, uint16_t v) {
+	put8(f, (uint8_t) (v & 0xFF));
+	put8(f, (uint8_t) (v >> 8));
+}
+
+static void put32(frame_st *f, uint32_t v) {
+	put16(f, (uint16_t) (v & 0xFFFF));
+	put16(f, (uint16_t) (v >> 16));
+}
+
+static void begin(frame_st *f, uint32_t color) {
+	f->len = 0;
+	put8(f, UV_UI_REMOTE_OP_FRAME_BEGIN);
+	put32(f, color);
+}
+
+static void rrect(frame_st *f, int16_t x, int16_t y, uint32_t color) {
+	put8(f, UV_UI_REMOTE_OP_RRECT);
+	put16(f, (uint16_t) x);
+	put16(f, (uint16_t) y);
+	put16(f, 100);
+	put16(f, 40);
+	put16(f, 4);
+	put32(f, color);
+}
+
+static void string(frame_st *f, int16_t x, int16_t y, const char *str) {
+	uint16_t len = (uint16_t) strlen(str);
+	put8(f, UV_UI_REMOTE_OP_STRING);
+	put8(f, 3);
+	put16(f, (uint16_t) x);
+	put16(f, (uint16_t) y);
+	put16(f, 0);
+	put32(f, 0xFFFFFFFF);
+	put16(f, len);
+	memcpy(&f->data[f->len], str, len);
+	f->len += len;
+}
+
+static void end(frame_st *f) {
+	put8(f, UV_UI_REMOTE_OP_FRAME_END);
+	TEST_ASSERT_TRUE(uv_ui_remote_frame_index(&f->idx, ARGB, f->data, f->len));
+}
+
+
+/// @brief: A settings style screen: a button and a label per row, with
+/// *value* shown in the first one
+static void screen(frame_st *f, const char *value) {
+	begin(f, 0xFF202020);
+	for (int16_t i = 0; i < 12; i++) {
+		char label[24];
+		rrect(f, 10, (int16_t) (10 + i * 40), 0xFF404040);
+		snprintf(label, sizeof(label), "Parameter %d", i);
+		string(f, 20, (int16_t) (20 + i * 40), label);
+		string(f, 300, (int16_t) (20 + i * 40), (i == 0) ? value : "42");
+	}
+	end(f);
+}
+
+
+/// @brief: Encodes *frame* against *base*, rebuilds it from the delta and
+/// checks that it came back unchanged. Returns the delta length.
+static uint16_t round_trip(const frame_st *base, const frame_st *frame) {
+	uint8_t delta[FRAME_MAX];
+	uint8_t rebuilt[FRAME_MAX];
+	uint16_t len = uv_ui_remote_delta_encode(base->data, &base->idx,
+			frame->data, &frame->idx, delta, sizeof(delta));
+	TEST_ASSERT_NE(len, 0);
+	TEST_ASSERT_EQ(delta[0], UV_UI_REMOTE_OP_FRAME_DELTA);
+	TEST_ASSERT_EQ(delta[len - 1], UV_UI_REMOTE_OP_FRAME_END);
+	uint16_t rebuilt_len = uv_ui_remote_delta_apply(ARGB, base->data, base->len,
+			delta, len, rebuilt, sizeof(rebuilt));
+	TEST_ASSERT_EQ(rebuilt_len, frame->len);
+	TEST_ASSERT_TRUE(memcmp(rebuilt, frame->data, frame->len) == 0);
+	return len;
+}
+
+
+
+TEST(ui_remote_delta, op_len_covers_every_opcode) {
+	frame_st f = { .len = 0 };
+	string(&f, 0, 0, "abc");
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, f.data, f.len), 17);
+	rrect(&f, 0, 0, 0);
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, &f.data[17], 15), 15);
+
+	uint8_t strip[18] = { UV_UI_REMOTE_OP_LINESTRIP, 0, 1, 0, 0, 0, 0, 0, 2, 0 };
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, strip, sizeof(strip)), 18);
+	uint8_t poly[15] = { UV_UI_REMOTE_OP_POLYGON, 0, 0, 0, 0, 2, 0 };
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, poly, sizeof(poly)), 15);
+
+	uint8_t op = UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP;
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, &op, 1), 1);
+	op = UV_UI_REMOTE_OP_FRAME_END;
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, &op, 1), 1);
+}
+
+
+TEST(ui_remote_delta, op_len_rejects_unknown_and_truncated_ops) {
+	frame_st f = { .len = 0 };
+	string(&f, 0, 0, "abcdef");
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, f.data, (uint16_t) (f.len - 1)), 0);
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, f.data, 5), 0);
+	uint8_t unknown = 0x7F;
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, &unknown, 1), 0);
+	TEST_ASSERT_EQ(uv_ui_remote_op_len(ARGB, &unknown, 0), 0);
+}
+
+
+TEST(ui_remote_delta, index_rejects_a_malformed_frame) {
+	frame_st f;
+	screen(&f, "1");
+	TEST_ASSERT_EQ(f.idx.count, 38);
+	TEST_ASSERT_EQ(f.idx.off[f.idx.count], f.len);
+	TEST_ASSERT_FALSE(uv_ui_remote_frame_index(&f.idx, ARGB, f.data, (uint16_t) (f.len - 2)));
+}
+
+
+TEST(ui_remote_delta, a_changed_value_costs_an_order_of_magnitude_less) {
+	frame_st base, frame;
+	screen(&base, "12.5 bar");
+	screen(&frame, "12.6 bar");
+	uint16_t len = round_trip(&base, &frame);
+	TEST_ASSERT_TRUE(len * 10 < frame.len);
+}
+
+
+TEST(ui_remote_delta, an_identical_frame_is_all_copies) {
+	frame_st base, frame;
+	screen(&base, "1");
+	screen(&frame, "1");
+	TEST_ASSERT_EQ(round_trip(&base, &frame),
+			UV_UI_REMOTE_FRAME_DELTA_LEN + UV_UI_REMOTE_COPY_LEN + 1);
+}
+
+
+TEST(ui_remote_delta, inserted_and_removed_ops_round_trip) {
+	frame_st base, frame;
+	screen(&base, "1");
+
+	// a dialog box drawn in the middle of the list, with one row dropped
+	begin(&frame, 0xFF202020);
+	for (int16_t i = 0; i < 12; i++) {
+		char label[24];
+		if (i == 5) {
+			rrect(&frame, 50, 50, 0xFFFF0000);
+			string(&frame, 60, 60, "Warning");
+			continue;
+		}
+		rrect(&frame, 10, (int16_t) (10 + i * 40), 0xFF404040);
+		snprintf(label, sizeof(label), "Parameter %d", i);
+		string(&frame, 20, (int16_t) (20 + i * 40), label);
+		string(&frame, 300, (int16_t) (20 + i * 40), (i == 0) ? "1" : "42");
+	}
+	end(&frame);
+	TEST_ASSERT_TRUE(round_trip(&base, &frame) * 4 < frame.len);
+}
+
+
+TEST(ui_remote_delta, reordered_ops_round_trip) {
+	frame_st base, frame;
+	begin(&base, 0);
+	for (int16_t i = 0; i < 10; i++) {
+		rrect(&base, i, i, 0xFF000000);
+	}
+	end(&base);
+	begin(&frame, 0);
+	for (int16_t i = 9; i >= 0; i--) {
+		rrect(&frame, i, i, 0xFF000000);
+	}
+	end(&frame);
+	round_trip(&base, &frame);
+}
+
+
+TEST(ui_remote_delta, an_unrelated_frame_is_sent_whole) {
+	frame_st base, frame;
+	uint8_t delta[FRAME_MAX];
+	begin(&base, 0);
+	string(&base, 0, 0, "one");
+	end(&base);
+	begin(&frame, 1);
+	string(&frame, 0, 0, "two");
+	end(&frame);
+	TEST_ASSERT_EQ(uv_ui_remote_delta_encode(base.data, &base.idx,
+			frame.data, &frame.idx, delta, sizeof(delta)), 0);
+}
+
+
+TEST(ui_remote_delta, a_delta_does_not_fit_a_short_buffer) {
+	frame_st base, frame;
+	uint8_t delta[FRAME_MAX];
+	screen(&base, "1");
+	screen(&frame, "2");
+	TEST_ASSERT_EQ(uv_ui_remote_delta_encode(base.data, &base.idx,
+			frame.data, &frame.idx, delta, 20), 0);
+}
+
+
+TEST(ui_remote_delta, apply_refuses_the_wrong_base) {
+	frame_st base, other, frame;
+	uint8_t delta[FRAME_MAX];
+	uint8_t rebuilt[FRAME_MAX];
+	screen(&base, "1");
+	screen(&other, "3");
+	screen(&frame, "2");
+	uint16_t len = uv_ui_remote_delta_encode(base.data, &base.idx,
+			frame.data, &frame.idx, delta, sizeof(delta));
+	TEST_ASSERT_NE(len, 0);
+	TEST_ASSERT_EQ(uv_ui_remote_delta_apply(ARGB, other.data, other.len,
+			delta, len, rebuilt, sizeof(rebuilt)), 0);
+}
+
+
+TEST(ui_remote_delta, apply_refuses_malformed_deltas) {
+	frame_st base, frame;
+	uint8_t delta[FRAME_MAX];
+	uint8_t rebuilt[FRAME_MAX];
+	screen(&base, "1");
+	screen(&frame, "2");
+	uint16_t len = uv_ui_remote_delta_encode(base.data, &base.idx,
+			frame.data, &frame.idx, delta, sizeof(delta));
+
+	// no FRAME_END
+	TEST_ASSERT_EQ(uv_ui_remote_delta_apply(ARGB, base.data, base.len,
+			delta, (uint16_t) (len - 1), rebuilt, sizeof(rebuilt)), 0);
+	// too small a destination
+	TEST_ASSERT_EQ(uv_ui_remote_delta_apply(ARGB, base.data, base.len,
+			delta, len, rebuilt, (uint16_t) (frame.len - 1)), 0);
+
+	// a COPY past the end of the base
+	uint8_t bad[] = {
+			UV_UI_REMOTE_OP_FRAME_DELTA, 0, 0, 0, 0, 0, 0, 0, 0,
+			UV_UI_REMOTE_OP_COPY, 30, 0, 20, 0,
+			UV_UI_REMOTE_OP_FRAME_END
+	};
+	uint32_t hash = uv_ui_remote_frame_hash(base.data, base.len);
+	memcpy(&bad[1], &hash, 4);
+	TEST_ASSERT_EQ(uv_ui_remote_delta_apply(ARGB, base.data, base.len,
+			bad, sizeof(bad), rebuilt, sizeof(rebuilt)), 0);
+	// and an empty one
+	bad[12] = 0;
+	TEST_ASSERT_EQ(uv_ui_remote_delta_apply(ARGB, base.data, base.len,
+			bad, sizeof(bad), rebuilt, sizeof(rebuilt)), 0);
+}
@@ -0,0 +1,586 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_ui_remote.h"
+
+#include <string.h>
+
+/// @file: Tests for the reference remote UI sink.
+///
+/// The sink is what a customer's display is built from, so a shape landing a
+/// pixel off here lands a pixel off on every one of them. These draw hand built
+/// frames into a small framebuffer and count what ended up where.
+
+
+#define FRAME_MAX		1024
+#define W				64
+#define H				48
+// pixels either side of the framebuffer that nothing may touch
+#define GUARD			256
+#define GUARD_VALUE		0xDEADBEEFu
+
+#define BLACK			0xFF000000u
+#define WHITE			0xFFFFFFFFu
+
+
+typedef struct {
+	uint8_t data[FRAME_MAX];
+	uint16_t len;
+} frame_st;
+
+static uint32_t mem[GUARD + W * H + GUARD];
+static uint32_t *const fb = &mem[GUARD];
+
+
+static void put8(frame_st *f, uint8_t v) {
+	f->data[f->len++] = v;
+}
+
+static void put16(frame_st *f, int32_t v) {
+	put8(f, (uint8_t) (v & 0xFF));
+	put8(f, (uint8_t) ((v >> 8) & 0xFF));
+}
+
+static void put32(frame_st *f, uint32_t v) {
+	put16(f, (int32_t) (v & 0xFFFF));
+	put16(f, (int32_t) (v >> 16));
+}
+
+static void begin(frame_st *f, uint32_t color) {
+	f->len = 0;
+	put8(f, UV_UI_REMOTE_OP_FRAME_BEGIN);
+	put32(f, color);
+}
+
+static void end(frame_st *f) {
+	put8(f, UV_UI_REMOTE_OP_FRAME_END);
+}
+
+static void rrect(frame_st *f, int32_t x, int32_t y, int32_t w, int32_t h,
+		int32_t r, uint32_t color) {
+	put8(f, UV_UI_REMOTE_OP_RRECT);
+	put16(f, x);
+	put16(f, y);
+	put16(f, w);
+	put16(f, h);
+	put16(f, r);
+	put32(f, color);
+}
+
+static void line(frame_st *f, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+		int32_t width, uint32_t color) {
+	put8(f, UV_UI_REMOTE_OP_LINE);
+	put16(f, x0);
+	put16(f, y0);
+	put16(f, x1);
+	put16(f, y1);
+	put16(f, width);
+	put32(f, color);
+}
+
+static void mask(frame_st *f, int32_t x, int32_t y, int32_t w, int32_t h) {
+	put8(f, UV_UI_REMOTE_OP_MASK);
+	put16(f, x);
+	put16(f, y);
+	put16(f, w);
+	put16(f, h);
+}
+
+static void string(frame_st *f, int32_t x, int32_t y, uint16_t align,
+		const char *str, uint32_t color) {
+	uint16_t len = (uint16_t) strlen(str);
+	put8(f, UV_UI_REMOTE_OP_STRING);
+	put8(f, 0);
+	put16(f, x);
+	put16(f, y);
+	put16(f, align);
+	put32(f, color);
+	put16(f, len);
+	memcpy(&f->data[f->len], str, len);
+	f->len += len;
+}
+
+static void bitmap(frame_st *f, int32_t x, int32_t y, int32_t w, int32_t h,
+		uint32_t wrap, uint32_t color) {
+	put8(f, UV_UI_REMOTE_OP_BITMAP);
+	put32(f, 7);
+	put16(f, x);
+	put16(f, y);
+	put16(f, w);
+	put16(f, h);
+	put32(f, wrap);
+	put32(f, color);
+}
+
+
+// A font of 8 x 8 cells advancing 6 pixels: 'A' fills its whole cell, 'a'
+// the left half, and the slot of 'ä' the whole cell at half intensity.
+#define FONT_H			8
+#define FONT_STRIDE		4
+#define FONT_ADVANCE	6
+static uint8_t font[UV_UI_REMOTE_FONT_BODY_HDR_LEN +
+		FONT_STRIDE * FONT_H * UV_UI_REMOTE_FONT_WIDTHS];
+
+static const uint8_t *font_get(void *user, uint8_t font_id, uint32_t *len) {
+	*len = sizeof(font);
+	return font;
+}
+
+static uint8_t *font_cell(uint8_t glyph) {
+	return &font[UV_UI_REMOTE_FONT_BODY_HDR_LEN + glyph * FONT_STRIDE * FONT_H];
+}
+
+// 2 x 2 bitmap: red, green / blue, transparent
+static const uint32_t image_pixels[4] = {
+		0xFFFF0000u, 0xFF00FF00u,
+		0xFF0000FFu, 0x00000000u
+};
+
+static bool image_get(void *user, uint32_t id, uv_ui_remote_image_st *dest) {
+	dest->pixels = image_pixels;
+	dest->width = 2;
+	dest->height = 2;
+	return (id == 7);
+}
+
+
+static void setup(uv_ui_remote_raster_st *r) {
+	for (uint32_t i = 0; i < (sizeof(mem) / sizeof(mem[0])); i++) {
+		mem[i] = GUARD_VALUE;
+	}
+	memset(font, 0, sizeof(font));
+	font[0] = FONT_H;
+	font[2] = UV_UI_REMOTE_FONT_FLAG_GLYPHS;
+	font[3] = FONT_STRIDE;
+	font[5] = 8;
+	memset(&font[7], FONT_ADVANCE, UV_UI_REMOTE_FONT_WIDTHS);
+	memset(font_cell('A'), 0xFF, FONT_STRIDE * FONT_H);
+	for (uint8_t y = 0; y < FONT_H; y++) {
+		memset(&font_cell('a')[y * FONT_STRIDE], 0xFF, FONT_STRIDE / 2);
+	}
+	memset(font_cell(1), 0x88, FONT_STRIDE * FONT_H);
+
+	uv_ui_remote_raster_init(r, fb, W, H, W);
+	uv_ui_remote_raster_set_assets(r, &font_get, &image_get, NULL);
+}
+
+static uint32_t px(int32_t x, int32_t y) {
+	return fb[y * W + x];
+}
+
+static uint32_t count(uint32_t color) {
+	uint32_t ret = 0;
+	for (uint32_t i = 0; i < (W * H); i++) {
+		ret += (fb[i] == color) ? 1 : 0;
+	}
+	return ret;
+}
+
+static bool guards_intact(void) {
+	bool ret = true;
+	for (uint32_t i = 0; i < GUARD; i++) {
+		if ((mem[i] != GUARD_VALUE) || (mem[GUARD + W * H + i] != GUARD_VALUE)) {
+			ret = false;
+		}
+	}
+	return ret;
+}
+
+
+TEST(ui_remote_raster, clears_to_the_frame_color) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, 0xFF102030u);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(count(0xFF102030u), W * H);
+	TEST_ASSERT_TRUE(guards_intact());
+}
+
+
+TEST(ui_remote_raster, a_rectangle_covers_exactly_its_pixels) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	rrect(&f, 10, 5, 20, 8, 0, WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(count(WHITE), 20 * 8);
+	TEST_ASSERT_EQ(px(10, 5), WHITE);
+	TEST_ASSERT_EQ(px(29, 12), WHITE);
+	TEST_ASSERT_EQ(px(9, 5), BLACK);
+	TEST_ASSERT_EQ(px(30, 12), BLACK);
+	TEST_ASSERT_EQ(px(10, 13), BLACK);
+}
+
+
+TEST(ui_remote_raster, round_corners_leave_the_corners_clear) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	// radius past half the size is taken as half: a circle of radius 10
+	rrect(&f, 0, 0, 20, 20, 50, WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(px(0, 0), BLACK);
+	TEST_ASSERT_EQ(px(19, 19), BLACK);
+	TEST_ASSERT_EQ(px(10, 10), WHITE);
+	TEST_ASSERT_EQ(px(0, 10), WHITE);
+	TEST_ASSERT_RANGE(count(WHITE), 314 - 15, 314 + 15);
+}
+
+
+TEST(ui_remote_raster, points_and_lines_have_their_size) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	put8(&f, UV_UI_REMOTE_OP_POINT);
+	put16(&f, 32);
+	put16(&f, 24);
+	put16(&f, 20);
+	put32(&f, WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_RANGE(count(WHITE), 314 - 15, 314 + 15);
+	TEST_ASSERT_EQ(px(32, 24), WHITE);
+
+	// a horizontal line 4 wide and 40 long, with round ends 2 past either end
+	begin(&f, BLACK);
+	line(&f, 10, 20, 50, 20, 4, WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_RANGE(count(WHITE), 40 * 4 + 8, 40 * 4 + 16);
+	TEST_ASSERT_EQ(px(30, 18), WHITE);
+	TEST_ASSERT_EQ(px(30, 21), WHITE);
+	TEST_ASSERT_EQ(px(30, 17), BLACK);
+	TEST_ASSERT_EQ(px(30, 22), BLACK);
+
+	// a diagonal one covers about as much
+	begin(&f, BLACK);
+	line(&f, 10, 10, 40, 40, 4, WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_RANGE(count(WHITE), 170 - 16, 170 + 16);
+	TEST_ASSERT_EQ(px(25, 25), WHITE);
+	TEST_ASSERT_EQ(px(30, 20), BLACK);
+}
+
+
+TEST(ui_remote_raster, polygons_fill_by_the_even_odd_rule) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	put8(&f, UV_UI_REMOTE_OP_POLYGON);
+	put32(&f, WHITE);
+	put16(&f, 3);
+	put16(&f, 0);
+	put16(&f, 0);
+	put16(&f, 40);
+	put16(&f, 0);
+	put16(&f, 0);
+	put16(&f, 40);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_RANGE(count(WHITE), 800 - 40, 800 + 40);
+	TEST_ASSERT_EQ(px(5, 5), WHITE);
+	TEST_ASSERT_EQ(px(30, 30), BLACK);
+
+	// a five pointed star leaves its middle empty
+	static const int16_t star[5][2] = {
+			{ 32, 2 }, { 44, 44 }, { 10, 18 }, { 54, 18 }, { 20, 44 }
+	};
+	begin(&f, BLACK);
+	put8(&f, UV_UI_REMOTE_OP_POLYGON);
+	put32(&f, WHITE);
+	put16(&f, 5);
+	for (uint8_t i = 0; i < 5; i++) {
+		put16(&f, star[i][0]);
+		put16(&f, star[i][1]);
+	}
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(px(32, 26), BLACK);
+	TEST_ASSERT_EQ(px(32, 8), WHITE);
+}
+
+
+TEST(ui_remote_raster, the_mask_clips_and_a_new_frame_clears_it) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	mask(&f, 10, 10, 10, 10);
+	rrect(&f, 0, 0, W, H, 0, WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(count(WHITE), 100);
+	TEST_ASSERT_EQ(px(10, 10), WHITE);
+	TEST_ASSERT_EQ(px(20, 20), BLACK);
+
+	// drawing over what is there, without the last frame's mask
+	f.len = 0;
+	put8(&f, UV_UI_REMOTE_OP_FRAME_BEGIN_KEEP);
+	rrect(&f, 0, 0, 5, 5, 0, WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(count(WHITE), 125);
+}
+
+
+TEST(ui_remote_raster, ops_drawn_one_at_a_time_keep_the_mask) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	// what a backend drawing as it goes passes: no frame around the calls
+	f.len = 0;
+	put8(&f, UV_UI_REMOTE_OP_FRAME_BEGIN);
+	put32(&f, BLACK);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_ops(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	f.len = 0;
+	mask(&f, 10, 10, 10, 10);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_ops(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	f.len = 0;
+	rrect(&f, 0, 0, W, H, 0, WHITE);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_ops(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(count(WHITE), 100);
+	TEST_ASSERT_EQ(count(BLACK), W * H - 100);
+
+	// a command cut short is refused
+	f.len = 0;
+	rrect(&f, 0, 0, 5, 5, 0, WHITE);
+	TEST_ASSERT_FALSE(uv_ui_remote_raster_ops(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, (uint16_t) (f.len - 1)));
+	TEST_ASSERT_EQ(count(WHITE), 100);
+	TEST_ASSERT_TRUE(guards_intact());
+}
+
+
+TEST(ui_remote_raster, translucent_colors_blend) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, 0xFF0000FFu);
+	rrect(&f, 0, 0, 10, 10, 0, 0x80FF0000u);
+	rrect(&f, 20, 0, 10, 10, 0x00, 0x00FFFFFFu);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(px(5, 5), 0xFF80007Fu);
+	// fully transparent draws nothing
+	TEST_ASSERT_EQ(px(25, 5), 0xFF0000FFu);
+}
+
+
+/// @brief: A frame with one of every shape, in opaque colors that RGB565
+/// holds exactly
+static void every_shape(frame_st *f) {
+	begin(f, 0xFF0000FFu);
+	rrect(f, 2, 2, 30, 20, 6, 0xFF848284u);
+	line(f, 0, 40, 60, 30, 3, 0xFF00FF00u);
+	put8(f, UV_UI_REMOTE_OP_POINT);
+	put16(f, 50);
+	put16(f, 10);
+	put16(f, 9);
+	put32(f, 0xFFFFFF00u);
+	put8(f, UV_UI_REMOTE_OP_LINESTRIP);
+	put8(f, 4); // UI_STRIP_TYPE_BELOW
+	put16(f, 2);
+	put32(f, 0xFFFF0000u);
+	put16(f, 3);
+	put32(f, 0x0028000Au);
+	put32(f, 0x00200020u);
+	put32(f, 0x0030003Au);
+	string(f, 40, 30, 0x200, "Aa", WHITE);
+	bitmap(f, 4, 30, 6, 6, 1, WHITE);
+	end(f);
+}
+
+
+TEST(ui_remote_raster, every_color_mode_draws_the_same_frame) {
+	static uv_ui_remote_raster_st r;
+	static uv_ui_remote_palette_st pal;
+	static frame_st f, coded;
+	static uint32_t argb[W * H];
+	setup(&r);
+	every_shape(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	memcpy(argb, fb, sizeof(argb));
+
+	uv_ui_remote_color_mode_e modes[] = {
+			UV_UI_REMOTE_COLOR_RGB565,
+			UV_UI_REMOTE_COLOR_PALETTE
+	};
+	for (uint8_t i = 0; i < 2; i++) {
+		uv_ui_remote_palette_init(&pal);
+		coded.len = uv_ui_remote_color_convert(&pal, modes[i], f.data, f.len,
+				coded.data, sizeof(coded.data));
+		TEST_ASSERT_NE(coded.len, 0);
+		setup(&r);
+		TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, modes[i], coded.data, coded.len));
+		TEST_ASSERT_EQ(memcmp(argb, fb, sizeof(argb)), 0);
+	}
+}
+
+
+TEST(ui_remote_raster, strings_are_placed_by_their_alignment) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	string(&f, 10, 10, 0, "A", WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(count(WHITE), 8 * 8);
+	TEST_ASSERT_EQ(px(10, 10), WHITE);
+	TEST_ASSERT_EQ(px(17, 17), WHITE);
+
+	// right aligned: two advances to the left of x, and centered on y
+	begin(&f, BLACK);
+	string(&f, 40, 20, 0x800 | 0x400, "aa", WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(count(WHITE), 2 * 4 * 8);
+	TEST_ASSERT_EQ(px(28, 16), WHITE);
+	TEST_ASSERT_EQ(px(27, 16), BLACK);
+	TEST_ASSERT_EQ(px(28, 15), BLACK);
+	TEST_ASSERT_EQ(px(34, 23), WHITE);
+
+	// lines below each other, and UTF-8 to the nordic glyph slots
+	begin(&f, BLACK);
+	string(&f, 0, 0, 0, "A\n\xC3\xA4", WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(px(0, 0), WHITE);
+	TEST_ASSERT_EQ(px(0, FONT_H), 0xFF888888u);
+	TEST_ASSERT_EQ(count(0xFF888888u), 8 * 8);
+}
+
+
+TEST(ui_remote_raster, bitmaps_repeat_or_stop_at_their_border) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	bitmap(&f, 10, 10, 5, 5, 1, WHITE);
+	bitmap(&f, 30, 10, 5, 5, 0, WHITE);
+	// tinted and half transparent
+	bitmap(&f, 50, 10, 1, 1, 0, 0x80808080u);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_EQ(px(10, 10), 0xFFFF0000u);
+	TEST_ASSERT_EQ(px(11, 11), BLACK);
+	TEST_ASSERT_EQ(px(14, 14), 0xFFFF0000u);
+	TEST_ASSERT_EQ(px(13, 12), 0xFF00FF00u);
+	TEST_ASSERT_EQ(px(30, 11), 0xFF0000FFu);
+	TEST_ASSERT_EQ(px(32, 12), BLACK);
+	TEST_ASSERT_EQ(px(50, 10), 0xFF400000u);
+}
+
+
+TEST(ui_remote_raster, malformed_frames_are_refused) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	rrect(&f, 0, 0, 10, 10, 0, WHITE);
+	// no FRAME_END
+	TEST_ASSERT_FALSE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	// cut in the middle of an op
+	end(&f);
+	TEST_ASSERT_FALSE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len - 4));
+	// a delta is rebuilt before it is drawn
+	f.len = 0;
+	put8(&f, UV_UI_REMOTE_OP_FRAME_DELTA);
+	put32(&f, 0);
+	put32(&f, 0);
+	end(&f);
+	TEST_ASSERT_FALSE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_TRUE(guards_intact());
+}
+
+
+TEST(ui_remote_raster, nothing_is_drawn_outside_the_framebuffer) {
+	static uv_ui_remote_raster_st r;
+	static frame_st f;
+	setup(&r);
+	begin(&f, BLACK);
+	// a mask larger than the screen does not open up what is past its edges
+	mask(&f, -1000, -1000, 30000, 30000);
+	rrect(&f, -32768, -32768, 65535, 65535, 30000, WHITE);
+	rrect(&f, W - 2, H - 2, 1000, 1000, 3, WHITE);
+	line(&f, -32768, -32768, 32767, 32767, 1000, 0x80FFFFFFu);
+	line(&f, -20, 5, W + 20, 5, 0, WHITE);
+	put8(&f, UV_UI_REMOTE_OP_POLYGON);
+	put32(&f, WHITE);
+	put16(&f, 3);
+	put32(&f, 0x80008000u);
+	put32(&f, 0x7FFF0000u);
+	put32(&f, 0x00007FFFu);
+	put8(&f, UV_UI_REMOTE_OP_LINESTRIP);
+	put8(&f, 2); // UI_STRIP_TYPE_LEFT
+	put16(&f, 5000);
+	put32(&f, WHITE);
+	put16(&f, 2);
+	put32(&f, 0x8000FFF0u);
+	put32(&f, 0x7FFF0040u);
+	string(&f, W - 3, H - 3, 0, "AAAA\nAAAA", WHITE);
+	string(&f, -3, -3, 0x800, "AAAA", WHITE);
+	bitmap(&f, -1, -1, 32767, 32767, 1, WHITE);
+	bitmap(&f, W - 1, H - 1, 10, 10, 0, WHITE);
+	end(&f);
+	TEST_ASSERT_TRUE(uv_ui_remote_raster_frame(&r, UV_UI_REMOTE_COLOR_ARGB8888,
+			f.data, f.len));
+	TEST_ASSERT_TRUE(guards_intact());
+}
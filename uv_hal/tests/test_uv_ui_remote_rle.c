@@ -0,0 +1,199 @@
+/*
+ * This file is part of the uv_hal distribution (www.usevolt.fi).
+ * Copyright (c) 2017 Usevolt Oy.
+ *
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 usevolt
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uv_test.h"
+#include "uv_ui_remote.h"
+
+#include <string.h>
+
+/// @file: Tests for the run-length code of remote UI assets.
+///
+/// The source codes out of flash through a window and the sink decodes chunk by
+/// chunk, so what matters is that neither the window refills nor the chunk
+/// boundaries change the bytes that come out at the end.
+
+
+#define ASSET_MAX		8192
+
+
+/// @brief: Codes *len* bytes of *src* the way the encoder does, refilling the
+/// window *fill* bytes at a time and writing chunks of at most *chunk* bytes.
+/// Returns the coded length.
+static uint32_t code(const uint8_t *src, uint32_t len, uint16_t fill,
+		uint16_t chunk, uint8_t *dest) {
+	uv_ui_remote_rle_enc_st enc;
+	uv_ui_remote_rle_enc_init(&enc);
+	uint32_t off = 0;
+	uint32_t out = 0;
+	bool more = true;
+	while (more) {
+		uint16_t n = 0;
+		bool fill_more = true;
+		while (fill_more) {
+			uint32_t want = len - off;
+			if (want > fill) {
+				want = fill;
+			}
+			if (want > uv_ui_remote_rle_enc_space(&enc)) {
+				want = uv_ui_remote_rle_enc_space(&enc);
+			}
+			memcpy(&enc.window[enc.len], &src[off], want);
+			enc.len += want;
+			off += want;
+			uint16_t coded = uv_ui_remote_rle_encode(&enc, off == len,
+					&dest[out + n], (uint16_t) (chunk - n));
+			n += coded;
+			// a chunk is only closed once no more of the asset would fit
+			fill_more = (coded > 0) ||
+					((off < len) && (uv_ui_remote_rle_enc_space(&enc) > 0));
+		}
+		out += n;
+		more = (off < len) || (enc.len > 0);
+	}
+	return out;
+}
+
+
+static uint32_t decode(const uint8_t *src, uint32_t len, uint16_t step,
+		uint8_t *dest, uint32_t dest_len) {
+	uv_ui_remote_rle_dec_st dec;
+	uv_ui_remote_rle_dec_init(&dec);
+	uint32_t out = 0;
+	for (uint32_t i = 0; i < len; i += step) {
+		uint16_t n = (uint16_t) (((len - i) < step) ? (len - i) : step);
+		out += uv_ui_remote_rle_decode(&dec, &src[i], n, &dest[out], dest_len - out);
+	}
+	return out;
+}
+
+
+/// @brief: A 4 bits per pixel glyph cell: blank margins around a shape
+static void glyphs(uint8_t *dest, uint32_t len) {
+	for (uint32_t i = 0; i < len; i++) {
+		uint32_t row = (i / 8) % 24;
+		uint32_t col = i % 8;
+		dest[i] = ((row > 4) && (row < 20) && (col > 1) && (col < 6)) ?
+				(((col == 2) || (col == 5)) ? 0x4F : 0xFF) : 0;
+	}
+}
+
+
+static void noise(uint8_t *dest, uint32_t len) {
+	uint32_t x = 12345;
+	for (uint32_t i = 0; i < len; i++) {
+		x = x * 1103515245u + 12345u;
+		dest[i] = (uint8_t) (x >> 16);
+	}
+}
+
+
+static void round_trip(const uint8_t *src, uint32_t len) {
+	static uint8_t coded[2 * ASSET_MAX];
+	static uint8_t reference[2 * ASSET_MAX];
+	static uint8_t decoded[ASSET_MAX];
+	static const uint16_t fills[] = { 1, 7, 130, 191, UV_UI_REMOTE_RLE_WINDOW };
+	static const uint16_t chunks[] = { 2, 3, 50, UV_UI_REMOTE_ASSET_CHUNK };
+	for (uint8_t f = 0; f < sizeof(fills) / sizeof(fills[0]); f++) {
+		for (uint8_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+			uint32_t n = code(src, len, fills[f], chunks[c], coded);
+			// where the window is refilled never changes the code
+			uint32_t ref_len = code(src, len, UV_UI_REMOTE_RLE_WINDOW, chunks[c],
+					reference);
+			TEST_ASSERT_EQ(n, ref_len);
+			TEST_ASSERT_TRUE(memcmp(coded, reference, n) == 0);
+			for (uint16_t step = 1; step <= 200; step = (uint16_t) (step * 3 + 1)) {
+				memset(decoded, 0xAA, sizeof(decoded));
+				TEST_ASSERT_EQ(decode(coded, n, step, decoded, len), len);
+				TEST_ASSERT_TRUE(memcmp(decoded, src, len) == 0);
+			}
+		}
+	}
+}
+
+
+
+TEST(ui_remote_rle, glyph_atlases_round_trip_and_shrink) {
+	static uint8_t src[ASSET_MAX];
+	static uint8_t coded[2 * ASSET_MAX];
+	glyphs(src, sizeof(src));
+	round_trip(src, sizeof(src));
+	TEST_ASSERT_TRUE(code(src, sizeof(src), 256, 191, coded) * 3 < sizeof(src) * 2);
+}
+
+
+TEST(ui_remote_rle, noise_round_trips_within_the_worst_case_growth) {
+	static uint8_t src[ASSET_MAX];
+	static uint8_t coded[2 * ASSET_MAX];
+	noise(src, sizeof(src));
+	round_trip(src, sizeof(src));
+	// one control byte per 128 literal bytes
+	uint32_t n = code(src, sizeof(src), 256, 60000, coded);
+	TEST_ASSERT_TRUE(n <= sizeof(src) + (sizeof(src) + 127) / 128);
+}
+
+
+TEST(ui_remote_rle, runs_at_every_length_round_trip) {
+	static uint8_t src[ASSET_MAX];
+	uint32_t len = 0;
+	for (uint32_t run = 1; (run < 300) && (len + run < sizeof(src)); run++) {
+		memset(&src[len], (int) (run & 0xFF), run);
+		len += run;
+	}
+	round_trip(src, len);
+}
+
+
+TEST(ui_remote_rle, a_blank_asset_codes_to_two_bytes_per_run) {
+	static uint8_t src[129 * 10];
+	static uint8_t coded[sizeof(src)];
+	memset(src, 0, sizeof(src));
+	TEST_ASSERT_EQ(code(src, sizeof(src), 256, 191, coded), 20);
+	round_trip(src, sizeof(src));
+}
+
+
+TEST(ui_remote_rle, tiny_assets_round_trip) {
+	uint8_t src[3] = { 1, 1, 2 };
+	round_trip(src, 1);
+	round_trip(src, 2);
+	round_trip(src, 3);
+	uint8_t coded[8];
+	TEST_ASSERT_EQ(code(src, 0, 256, 191, coded), 0);
+}
+
+
+TEST(ui_remote_rle, decode_never_writes_past_the_destination) {
+	uint8_t coded[] = { 0x80 + 50 - 2, 0x11, 0x02, 1, 2, 3 };
+	uint8_t dest[40];
+	memset(dest, 0, sizeof(dest));
+	uv_ui_remote_rle_dec_st dec;
+	uv_ui_remote_rle_dec_init(&dec);
+	TEST_ASSERT_EQ(uv_ui_remote_rle_decode(&dec, coded, sizeof(coded), dest, 32), 32);
+	TEST_ASSERT_EQ(dest[31], 0x11);
+	TEST_ASSERT_EQ(dest[32], 0);
+}